@@ -467,6 +467,27 @@
 #define CH_CFG_USE_JOBS                     TRUE
 #endif
 
+/**
+ * @brief   Software Timers APIs.
+ * @details If enabled then the software timers service APIs are included
+ *          in the kernel.
+ *
+ * @note    The default is @p TRUE.
+ */
+#if !defined(CH_CFG_USE_SWTIMERS)
+#define CH_CFG_USE_SWTIMERS                 TRUE
+#endif
+
+/**
+ * @brief   Number of slots in the software timers wheel.
+ * @note    Must be a power of two.
+ *
+ * @note    The default is @p 64.
+ */
+#if !defined(CH_CFG_SWTIMERS_WHEEL_SIZE)
+#define CH_CFG_SWTIMERS_WHEEL_SIZE          64
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -0,0 +1,37 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MCUCONF_H
+#define MCUCONF_H
+
+/*
+ * Simulated MAC settings, the link is specified on the command line.
+ */
+#if !defined(_FROM_ASM_)
+extern const char *lwipbench_path;
+extern const char *lwipbench_peer;
+extern unsigned lwipbench_latency;
+extern unsigned lwipbench_loss;
+#endif
+
+#define USE_SIM_MAC1                        TRUE
+#define USE_SIM_MAC2                        FALSE
+#define SIM_MAC1_PATH                       lwipbench_path
+#define SIM_MAC1_PEER                       lwipbench_peer
+#define SIM_MAC_LATENCY                     TIME_MS2I(lwipbench_latency)
+#define SIM_MAC_LOSS                        lwipbench_loss
+
+#endif /* MCUCONF_H */
@@ -0,0 +1,206 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+
+#include "lwipthread.h"
+
+#include "lwip/api.h"
+
+/*
+ * TCP throughput benchmark between two simulator processes connected by
+ * the simulated MAC, one process runs as server and counts the received
+ * bytes, the other runs as client and sends data for the specified time.
+ */
+
+#define LWIPBENCH_PORT          5001
+#define LWIPBENCH_CHUNK         8192U
+#define LWIPBENCH_PATH_A        "/tmp/chsim-lwip-a"
+#define LWIPBENCH_PATH_B        "/tmp/chsim-lwip-b"
+#define LWIPBENCH_NETMASK       IP4_ADDR_VALUE(255, 255, 255, 0)
+#define LWIPBENCH_SERVER_ADDR   IP4_ADDR_VALUE(192, 168, 100, 1)
+#define LWIPBENCH_CLIENT_ADDR   IP4_ADDR_VALUE(192, 168, 100, 2)
+
+/*
+ * Link settings, see mcuconf.h.
+ */
+const char *lwipbench_path;
+const char *lwipbench_peer;
+unsigned lwipbench_latency;
+unsigned lwipbench_loss;
+
+static uint8_t server_macaddr[6] = {0xC2, 0xAF, 0x51, 0x03, 0xCF, 0x01};
+static uint8_t client_macaddr[6] = {0xC2, 0xAF, 0x51, 0x03, 0xCF, 0x02};
+
+/*
+ * Data sent by the client, it is never modified so it is passed to lwIP
+ * by reference.
+ */
+static uint8_t chunk[LWIPBENCH_CHUNK];
+
+static void print_result(const char *what, uint64_t bytes, systime_t start) {
+  uint32_t ms;
+
+  ms = (uint32_t)TIME_I2MS(chVTTimeElapsedSinceX(start));
+  if (ms == 0U) {
+    ms = 1U;
+  }
+  printf("%s %lu bytes in %lu mS, %lu KB/S\n", what,
+         (unsigned long)bytes, (unsigned long)ms,
+         (unsigned long)((bytes * 1000U) / ((uint64_t)ms * 1024U)));
+  fflush(stdout);
+}
+
+/*
+ * Server, the received data is counted and discarded.
+ */
+static void server(void) {
+  struct netconn *listener, *conn;
+  struct netbuf *nb;
+
+  listener = netconn_new(NETCONN_TCP);
+  (void) netconn_bind(listener, IP_ADDR_ANY, LWIPBENCH_PORT);
+  (void) netconn_listen(listener);
+
+  while (true) {
+    uint64_t bytes;
+    systime_t start;
+
+    if (netconn_accept(listener, &conn) != ERR_OK) {
+      continue;
+    }
+    printf("Connection accepted\n");
+    fflush(stdout);
+
+    bytes = 0U;
+    start = chVTGetSystemTime();
+    while (netconn_recv(conn, &nb) == ERR_OK) {
+      bytes += netbuf_len(nb);
+      netbuf_delete(nb);
+    }
+    print_result("Received", bytes, start);
+
+    (void) netconn_close(conn);
+    netconn_delete(conn);
+  }
+}
+
+/*
+ * Client, data is sent for the specified time.
+ */
+static void client(unsigned seconds) {
+  struct netconn *conn;
+  ip_addr_t addr;
+  uint64_t bytes;
+  systime_t start;
+  sysinterval_t duration = TIME_S2I(seconds);
+
+  ip4_addr_set_u32(ip_2_ip4(&addr), LWIPBENCH_SERVER_ADDR);
+
+  /* The server could still be starting.*/
+  while (true) {
+    conn = netconn_new(NETCONN_TCP);
+    if (netconn_connect(conn, &addr, LWIPBENCH_PORT) == ERR_OK) {
+      break;
+    }
+    netconn_delete(conn);
+    chThdSleepMilliseconds(500);
+  }
+  printf("Connected, sending for %u S\n", seconds);
+  fflush(stdout);
+
+  bytes = 0U;
+  start = chVTGetSystemTime();
+  while (chVTTimeElapsedSinceX(start) < duration) {
+    if (netconn_write(conn, chunk, sizeof chunk, NETCONN_NOCOPY) != ERR_OK) {
+      break;
+    }
+    bytes += sizeof chunk;
+  }
+  print_result("Sent", bytes, start);
+
+  (void) netconn_close(conn);
+  netconn_delete(conn);
+}
+
+/*
+ * Application entry point.
+ */
+int main(int argc, char *argv[]) {
+  lwipthread_opts_t opts;
+  bool is_server;
+  unsigned seconds = 10U;
+
+  if ((argc < 2) || (argc > 5) ||
+      ((strcmp(argv[1], "server") != 0) && (strcmp(argv[1], "client") != 0))) {
+    printf("Usage: %s server|client [<ms> [<loss> [<seconds>]]]\n", argv[0]);
+    return 1;
+  }
+  is_server = strcmp(argv[1], "server") == 0;
+  if (argc >= 3) {
+    lwipbench_latency = (unsigned)strtoul(argv[2], NULL, 0);
+  }
+  if (argc >= 4) {
+    lwipbench_loss = (unsigned)strtoul(argv[3], NULL, 0);
+  }
+  if (argc >= 5) {
+    seconds = (unsigned)strtoul(argv[4], NULL, 0);
+  }
+
+  /* The two ends use swapped socket paths.*/
+  memset(&opts, 0, sizeof opts);
+  opts.netmask  = LWIPBENCH_NETMASK;
+  opts.addrMode = NET_ADDRESS_STATIC;
+  if (is_server) {
+    lwipbench_path  = LWIPBENCH_PATH_A;
+    lwipbench_peer  = LWIPBENCH_PATH_B;
+    opts.macaddress = server_macaddr;
+    opts.address    = LWIPBENCH_SERVER_ADDR;
+  }
+  else {
+    lwipbench_path  = LWIPBENCH_PATH_B;
+    lwipbench_peer  = LWIPBENCH_PATH_A;
+    opts.macaddress = client_macaddr;
+    opts.address    = LWIPBENCH_CLIENT_ADDR;
+  }
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   * - lwIP initialization, the simulated MAC is started on the link
+   *   specified above.
+   */
+  halInit();
+  chSysInit();
+  lwipInit(&opts);
+
+  if (is_server) {
+    server();
+  }
+  else {
+    client(seconds);
+  }
+
+  return 0;
+}
@@ -0,0 +1,199 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Buffers queues throughput benchmark, "bqbench [<bytes>]" transfers data
+ * between two threads through a pair of buffers queues connected by a
+ * loopback stand-in for a packet driver like the Serial over USB one.
+ * The transfer is performed twice, first copying the data through the
+ * read/write functions then accessing the packet buffers in place using
+ * the borrow/return functions. Data is generated and verified in both
+ * cases.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+#include "chprintf.h"
+
+#define BQBENCH_PACKET_SIZE     512U
+#define BQBENCH_PACKETS         8U
+#define BQBENCH_DEFAULT_SIZE    64000000U
+
+static uint8_t ib_buffers[BQ_BUFFER_SIZE(BQBENCH_PACKETS,
+                                         BQBENCH_PACKET_SIZE)];
+static uint8_t ob_buffers[BQ_BUFFER_SIZE(BQBENCH_PACKETS,
+                                         BQBENCH_PACKET_SIZE)];
+static input_buffers_queue_t ibq;
+static output_buffers_queue_t obq;
+static THD_WORKING_AREA(wa_writer, 1024);
+
+static size_t bench_total;
+static bool bench_borrow;
+
+/*
+ * Loopback stand-in driver, the packets posted in the output queue are
+ * "transmitted" into the input queue as soon as there is space for them.
+ * It is invoked by both queues notifications, in locked state.
+ */
+static void loopback_notify(io_buffers_queue_t *bqp) {
+
+  (void)bqp;
+
+  while (true) {
+    uint8_t *ip, *op;
+    size_t n;
+
+    ip = ibqGetEmptyBufferI(&ibq);
+    if (ip == NULL) {
+      break;
+    }
+    op = obqGetFullBufferI(&obq, &n);
+    if (op == NULL) {
+      break;
+    }
+    memcpy(ip, op, n);
+    ibqPostFullBufferI(&ibq, n);
+    obqReleaseEmptyBufferI(&obq);
+  }
+}
+
+static void fill(uint8_t *p, size_t offset, size_t n) {
+
+  while (n > 0U) {
+    *p++ = (uint8_t)offset++;
+    n--;
+  }
+}
+
+static size_t check(const uint8_t *p, size_t offset, size_t n) {
+  size_t errors = 0U;
+
+  while (n > 0U) {
+    if (*p++ != (uint8_t)offset++) {
+      errors++;
+    }
+    n--;
+  }
+
+  return errors;
+}
+
+static THD_FUNCTION(writer, arg) {
+  uint8_t buf[BQBENCH_PACKET_SIZE];
+  size_t done = 0U;
+
+  (void)arg;
+
+  while (done < bench_total) {
+    uint8_t *p;
+    size_t n;
+
+    if (bench_borrow) {
+      n = obqBorrowTimeout(&obq, &p, TIME_INFINITE);
+    }
+    else {
+      p = buf;
+      n = sizeof buf;
+    }
+    if (n > bench_total - done) {
+      n = bench_total - done;
+    }
+
+    fill(p, done, n);
+
+    if (bench_borrow) {
+      obqReturn(&obq, n);
+    }
+    else {
+      n = obqWriteTimeout(&obq, buf, n, TIME_INFINITE);
+    }
+    done += n;
+  }
+  obqFlush(&obq);
+}
+
+static void bench(BaseSequentialStream *chp, bool borrow, size_t total) {
+  uint8_t buf[BQBENCH_PACKET_SIZE];
+  size_t done, errors;
+  systime_t start;
+  thread_t *tp;
+  uint32_t ms;
+
+  ibqObjectInit(&ibq, false, ib_buffers, BQBENCH_PACKET_SIZE,
+                BQBENCH_PACKETS, loopback_notify, NULL);
+  obqObjectInit(&obq, false, ob_buffers, BQBENCH_PACKET_SIZE,
+                BQBENCH_PACKETS, loopback_notify, NULL);
+  bench_total  = total;
+  bench_borrow = borrow;
+
+  start = chVTGetSystemTime();
+  tp = chThdCreateStatic(wa_writer, sizeof wa_writer,
+                         chThdGetPriorityX(), writer, NULL);
+  done   = 0U;
+  errors = 0U;
+  while (done < total) {
+    uint8_t *p;
+    size_t n;
+
+    if (borrow) {
+      n = ibqBorrowTimeout(&ibq, &p, TIME_INFINITE);
+    }
+    else {
+      p = buf;
+      n = ibqReadTimeout(&ibq, buf, sizeof buf, TIME_INFINITE);
+    }
+
+    errors += check(p, done, n);
+
+    if (borrow) {
+      ibqReturn(&ibq, n);
+    }
+    done += n;
+#if defined(SIMULATOR)
+    /* Letting the simulated timer advance.*/
+    _sim_check_for_interrupts();
+#endif
+  }
+  chThdWait(tp);
+  ms = (uint32_t)TIME_I2MS(chVTTimeElapsedSinceX(start));
+  if (ms == 0U) {
+    ms = 1U;
+  }
+
+  chprintf(chp, "%s: %U bytes in %U mS, %U KB/S, %U errors"
+                SHELL_NEWLINE_STR,
+           borrow ? "borrow" : "copy", (uint32_t)done, ms,
+           (uint32_t)(done / ms), (uint32_t)errors);
+}
+
+void cmd_bqbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  size_t total = BQBENCH_DEFAULT_SIZE;
+
+  if (argc > 1) {
+    chprintf(chp, "Usage: bqbench [<bytes>]" SHELL_NEWLINE_STR);
+    return;
+  }
+  if (argc == 1) {
+    total = (size_t)strtoul(argv[0], NULL, 0);
+  }
+
+  bench(chp, false, total);
+  bench(chp, true, total);
+}
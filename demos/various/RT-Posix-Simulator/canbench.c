@@ -0,0 +1,390 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * CAN driver benchmark, "canbench [<bitrate>]" runs on the simulated CAN
+ * bus. Frames are first moved from CAND1 to CAND2 on a bus taking no time,
+ * in bursts as large as the software receive rings, received one at a time
+ * then in batches. A set of identifiers is then sent through the software
+ * acceptance filters of the receiver and the accepted frames are checked.
+ * The last run uses the specified bit rate (default 500000), CAND1 sends a
+ * high priority frame every millisecond while CAND2 floods the bus with
+ * lower priority frames, CAND3 receives both streams. The periodic frames
+ * must all go through because they win the arbitration, the flood takes
+ * what is left of the bus.
+ */
+
+#include <stdlib.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+#include "chprintf.h"
+
+#if (HAL_USE_CAN == TRUE) && (CAN_USE_RX_QUEUES == TRUE)
+
+#define CANBENCH_DEFAULT_FRAMES     100000U
+#define CANBENCH_DEFAULT_BITRATE    500000U
+#define CANBENCH_BURST              CAN_RX_QUEUE_SIZE
+#define CANBENCH_TIMEOUT            TIME_MS2I(100)
+#define CANBENCH_DURATION           TIME_MS2I(1000)
+#define CANBENCH_PERIODIC_ID        CAN_SW_FILTER_STD(0x100)
+#define CANBENCH_FLOOD_ID           CAN_SW_FILTER_STD(0x200)
+#define CANBENCH_UNUSED_ID          CAN_SW_FILTER_STD(0x7FF)
+
+/*
+ * Sender thread parameters, identifiers use the software filters encoding.
+ */
+typedef struct {
+  CANDriver                 *canp;
+  const uint32_t            *ids;
+  size_t                    nids;
+  uint32_t                  frames;
+  sysinterval_t             period;
+  uint32_t                  sent;
+} sender_t;
+
+static THD_WORKING_AREA(wa_sender1, 1024);
+static THD_WORKING_AREA(wa_sender2, 1024);
+static CANRxFrame rxbuf[CANBENCH_BURST];
+
+static const CANConfig instant_config = {0U};
+
+/*
+ * Filters installed on the receiver, both exact identifiers and masks.
+ */
+static const can_sw_filter_t filters[] = {
+  {CAN_SW_FILTER_STD(0x123),        CAN_SW_FILTER_MASK_ALL},
+  {CAN_SW_FILTER_STD(0x456),        CAN_SW_FILTER_MASK_ALL},
+  {CAN_SW_FILTER_EXT(0x01ABCDE0),   CAN_SW_FILTER_MASK_ALL},
+  {CAN_SW_FILTER_STD(0x700),        CAN_SW_FILTER_IDE | 0x7F0U},
+  {CAN_SW_FILTER_EXT(0x18DA0000),   CAN_SW_FILTER_IDE | 0x1FFF0000U}
+};
+
+/*
+ * Filter matching nothing on the bus, used to make a node deaf.
+ */
+static const can_sw_filter_t deaf_filter = {
+  CANBENCH_UNUSED_ID, CAN_SW_FILTER_MASK_ALL
+};
+
+static void make_frame(CANTxFrame *ctfp, uint32_t id, uint32_t seq) {
+
+  if ((id & CAN_SW_FILTER_IDE) != 0U) {
+    ctfp->IDE = 1U;
+    ctfp->EID = id & 0x1FFFFFFFU;
+  }
+  else {
+    ctfp->IDE = 0U;
+    ctfp->SID = id;
+  }
+  ctfp->RTR = 0U;
+  ctfp->DLC = 8U;
+  ctfp->data32[0] = seq;
+  ctfp->data32[1] = id;
+}
+
+static uint32_t frame_id(const CANRxFrame *crfp) {
+
+  return crfp->IDE ? CAN_SW_FILTER_EXT(crfp->EID) : CAN_SW_FILTER_STD(crfp->SID);
+}
+
+/*
+ * Nominal frame length as accounted by the simulated bus.
+ */
+static uint32_t frame_bits(const CANRxFrame *crfp) {
+
+  return (crfp->IDE ? 67U : 47U) + ((uint32_t)crfp->DLC * 8U);
+}
+
+static THD_FUNCTION(sender, arg) {
+  sender_t *sp = arg;
+  CANTxFrame txf;
+
+  while (!chThdShouldTerminateX() && (sp->sent < sp->frames)) {
+    make_frame(&txf, sp->ids[sp->sent % sp->nids], sp->sent);
+    if (canTransmitTimeout(sp->canp, CAN_ANY_MAILBOX, &txf,
+                           CANBENCH_TIMEOUT) == MSG_OK) {
+      sp->sent++;
+    }
+    if (sp->period != (sysinterval_t)0) {
+      chThdSleep(sp->period);
+    }
+  }
+}
+
+static void recv_bench(BaseSequentialStream *chp, bool batch,
+                       uint32_t frames) {
+  CANTxFrame txf;
+  uint32_t seq, errors, calls, ms;
+  systime_t start;
+
+  canStart(&CAND1, &instant_config);
+  canStart(&CAND2, &instant_config);
+
+  errors = 0U;
+  calls = 0U;
+  start = chVTGetSystemTime();
+  for (seq = 0U; seq < frames; ) {
+    uint32_t burst, i, n;
+
+    burst = frames - seq < CANBENCH_BURST ? frames - seq : CANBENCH_BURST;
+    for (i = 0U; i < burst; i++) {
+      make_frame(&txf, CAN_SW_FILTER_STD(seq + i), seq + i);
+      (void) canTransmitTimeout(&CAND1, CAN_ANY_MAILBOX, &txf, TIME_INFINITE);
+    }
+
+    for (i = 0U; i < burst; i += n) {
+      uint32_t j;
+
+      if (batch) {
+        n = (uint32_t)canReceiveBatch(&CAND2, CAN_ANY_MAILBOX, rxbuf,
+                                      burst - i, CANBENCH_TIMEOUT);
+      }
+      else {
+        n = canReceiveTimeout(&CAND2, CAN_ANY_MAILBOX, rxbuf,
+                              CANBENCH_TIMEOUT) == MSG_OK ? 1U : 0U;
+      }
+      calls++;
+      if (n == 0U) {
+        break;
+      }
+      for (j = 0U; j < n; j++) {
+        if ((rxbuf[j].data32[0] != seq + i + j) ||
+            (rxbuf[j].SID != ((seq + i + j) & 0x7FFU))) {
+          errors++;
+        }
+      }
+    }
+    if (i < burst) {
+      errors += burst - i;
+    }
+    seq += burst;
+  }
+  ms = (uint32_t)TIME_I2MS(chVTTimeElapsedSinceX(start));
+  if (ms == 0U) {
+    ms = 1U;
+  }
+
+  canStop(&CAND2);
+  canStop(&CAND1);
+
+  chprintf(chp, "%s: %U frames in %U mS, %U frames/S, %U calls, %U errors"
+                SHELL_NEWLINE_STR,
+           batch ? "batch" : "single", seq, ms,
+           (uint32_t)(((uint64_t)seq * 1000U) / ms), calls, errors);
+}
+
+/*
+ * Reference implementation of the software filters.
+ */
+static bool reference_accept(uint32_t id) {
+  size_t i;
+
+  for (i = 0U; i < sizeof filters / sizeof filters[0]; i++) {
+    if (((id ^ filters[i].id) & filters[i].mask) == 0U) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void filters_bench(BaseSequentialStream *chp) {
+  static uint32_t ids[2048U + 64U];
+  sender_t s = {&CAND1, ids, 0U, 0U, (sysinterval_t)0, 0U};
+  uint32_t expected, accepted, errors, i;
+  thread_t *tp;
+
+  /* All the standard identifiers then a set of extended identifiers
+     around the extended filters.*/
+  for (i = 0U; i < 2048U; i++) {
+    ids[s.nids++] = CAN_SW_FILTER_STD(i);
+  }
+  for (i = 0U; i < 32U; i++) {
+    ids[s.nids++] = CAN_SW_FILTER_EXT(0x01ABCDD0U + i);
+    ids[s.nids++] = CAN_SW_FILTER_EXT(0x18D9FFF0U + (i * 0x1111U));
+  }
+  s.frames = (uint32_t)s.nids;
+  expected = 0U;
+  for (i = 0U; i < s.nids; i++) {
+    if (reference_accept(ids[i])) {
+      expected++;
+    }
+  }
+
+  canStart(&CAND1, &instant_config);
+  canStart(&CAND2, &instant_config);
+  if (canSetSoftwareFilters(&CAND2, filters,
+                            sizeof filters / sizeof filters[0]) != HAL_SUCCESS) {
+    chprintf(chp, "filters: installation failed" SHELL_NEWLINE_STR);
+    canStop(&CAND2);
+    canStop(&CAND1);
+    return;
+  }
+
+  tp = chThdCreateStatic(wa_sender1, sizeof wa_sender1,
+                         chThdGetPriorityX() - 1, sender, &s);
+  accepted = 0U;
+  errors = 0U;
+  while (true) {
+    size_t n, j;
+
+    n = canReceiveBatch(&CAND2, CAN_ANY_MAILBOX, rxbuf, CANBENCH_BURST,
+                        CANBENCH_TIMEOUT);
+    if (n == 0U) {
+      break;
+    }
+    for (j = 0U; j < n; j++) {
+      if (!reference_accept(frame_id(&rxbuf[j])) ||
+          (rxbuf[j].data32[1] != frame_id(&rxbuf[j]))) {
+        errors++;
+      }
+    }
+    accepted += (uint32_t)n;
+  }
+  chThdTerminate(tp);
+  chThdWait(tp);
+  if ((accepted != expected) || (s.sent != s.frames)) {
+    errors++;
+  }
+
+  (void) canSetSoftwareFilters(&CAND2, NULL, 0U);
+  canStop(&CAND2);
+  canStop(&CAND1);
+
+  chprintf(chp, "filters: %U frames sent, %U accepted, %U expected, "
+                "%U errors" SHELL_NEWLINE_STR,
+           s.sent, accepted, expected, errors);
+}
+
+static void bus_bench(BaseSequentialStream *chp, uint32_t bitrate) {
+  static const uint32_t periodic_id = CANBENCH_PERIODIC_ID;
+  static const uint32_t flood_id = CANBENCH_FLOOD_ID;
+  const CANConfig config = {bitrate};
+  sender_t periodic = {&CAND1, &periodic_id, 1U, 0xFFFFFFFFU,
+                       TIME_MS2I(1), 0U};
+  sender_t flood = {&CAND2, &flood_id, 1U, 0xFFFFFFFFU,
+                    (sysinterval_t)0, 0U};
+  uint32_t nperiodic, nflood, errors, ms, load;
+  uint64_t bits;
+  thread_t *tp1, *tp2;
+  systime_t start, last;
+
+  canStart(&CAND1, &config);
+  canStart(&CAND2, &config);
+  canStart(&CAND3, &config);
+
+  /* The senders do not listen to each other.*/
+  (void) canSetSoftwareFilters(&CAND1, &deaf_filter, 1U);
+  (void) canSetSoftwareFilters(&CAND2, &deaf_filter, 1U);
+
+  tp1 = chThdCreateStatic(wa_sender1, sizeof wa_sender1,
+                          chThdGetPriorityX() - 1, sender, &periodic);
+  tp2 = chThdCreateStatic(wa_sender2, sizeof wa_sender2,
+                          chThdGetPriorityX() - 1, sender, &flood);
+  nperiodic = 0U;
+  nflood = 0U;
+  errors = 0U;
+  bits = 0U;
+  start = chVTGetSystemTime();
+  last = start;
+  while (true) {
+    size_t n, j;
+
+    if ((tp1 != NULL) &&
+        (chVTTimeElapsedSinceX(start) >= CANBENCH_DURATION)) {
+      chThdTerminate(tp1);
+      chThdTerminate(tp2);
+      chThdWait(tp1);
+      chThdWait(tp2);
+      tp1 = NULL;
+    }
+    n = canReceiveBatch(&CAND3, CAN_ANY_MAILBOX, rxbuf, CANBENCH_BURST,
+                        CANBENCH_TIMEOUT);
+    if (n == 0U) {
+      if (tp1 == NULL) {
+        break;
+      }
+      continue;
+    }
+    last = chVTGetSystemTimeX();
+    for (j = 0U; j < n; j++) {
+      uint32_t id = frame_id(&rxbuf[j]);
+
+      if ((id == periodic_id) && (rxbuf[j].data32[0] == nperiodic)) {
+        nperiodic++;
+      }
+      else if ((id == flood_id) && (rxbuf[j].data32[0] == nflood)) {
+        nflood++;
+      }
+      else {
+        errors++;
+      }
+      bits += frame_bits(&rxbuf[j]);
+    }
+  }
+  /* The time spent waiting for the last timeout is not accounted.*/
+  ms = (uint32_t)TIME_I2MS(chTimeDiffX(start, last));
+  if (ms == 0U) {
+    ms = 1U;
+  }
+  if ((nperiodic != periodic.sent) || (nflood != flood.sent)) {
+    errors++;
+  }
+  load = bitrate > 0U ? (uint32_t)((bits * 100000U) / ((uint64_t)bitrate * ms))
+                      : 0U;
+
+  (void) canSetSoftwareFilters(&CAND2, NULL, 0U);
+  (void) canSetSoftwareFilters(&CAND1, NULL, 0U);
+  canStop(&CAND3);
+  canStop(&CAND2);
+  canStop(&CAND1);
+
+  chprintf(chp, "bus: %U frames in %U mS, %U frames/S, %U%% load, "
+                "%U periodic, %U flood, %U errors" SHELL_NEWLINE_STR,
+           nperiodic + nflood, ms,
+           (uint32_t)(((uint64_t)(nperiodic + nflood) * 1000U) / ms),
+           load, nperiodic, nflood, errors);
+}
+
+void cmd_canbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  uint32_t bitrate = CANBENCH_DEFAULT_BITRATE;
+
+  if (argc > 1) {
+    chprintf(chp, "Usage: canbench [<bitrate>]" SHELL_NEWLINE_STR);
+    return;
+  }
+  if (argc >= 1) {
+    bitrate = (uint32_t)strtoul(argv[0], NULL, 0);
+  }
+
+  recv_bench(chp, false, CANBENCH_DEFAULT_FRAMES);
+  recv_bench(chp, true, CANBENCH_DEFAULT_FRAMES);
+  filters_bench(chp);
+  bus_bench(chp, bitrate);
+}
+
+#else /* !((HAL_USE_CAN == TRUE) && (CAN_USE_RX_QUEUES == TRUE)) */
+
+void cmd_canbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+
+  (void)argc;
+  (void)argv;
+  chprintf(chp, "canbench requires HAL_USE_CAN and CAN_USE_RX_QUEUES"
+                SHELL_NEWLINE_STR);
+}
+
+#endif /* !((HAL_USE_CAN == TRUE) && (CAN_USE_RX_QUEUES == TRUE)) */
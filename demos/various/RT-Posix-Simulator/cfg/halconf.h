@@ -51,7 +51,7 @@
  * @brief   Enables the CAN subsystem.
  */
 #if !defined(HAL_USE_CAN) || defined(__DOXYGEN__)
-#define HAL_USE_CAN                         FALSE
+#define HAL_USE_CAN                         TRUE
 #endif
 
 /**
@@ -86,7 +86,7 @@
  * @brief   Enables the I2C subsystem.
  */
 #if !defined(HAL_USE_I2C) || defined(__DOXYGEN__)
-#define HAL_USE_I2C                         FALSE
+#define HAL_USE_I2C                         TRUE
 #endif
 
 /**
@@ -107,7 +107,7 @@
  * @brief   Enables the MAC subsystem.
  */
 #if !defined(HAL_USE_MAC) || defined(__DOXYGEN__)
-#define HAL_USE_MAC                         FALSE
+#define HAL_USE_MAC                         TRUE
 #endif
 
 /**
@@ -163,7 +163,7 @@
  * @brief   Enables the SPI subsystem.
  */
 #if !defined(HAL_USE_SPI) || defined(__DOXYGEN__)
-#define HAL_USE_SPI                         FALSE
+#define HAL_USE_SPI                         TRUE
 #endif
 
 /**
@@ -259,6 +259,29 @@
 #define CAN_ENFORCE_USE_CALLBACKS           FALSE
 #endif
 
+/**
+ * @brief   Enables the software receive queues.
+ */
+#if !defined(CAN_USE_RX_QUEUES) || defined(__DOXYGEN__)
+#define CAN_USE_RX_QUEUES                   TRUE
+#endif
+
+/**
+ * @brief   Size of each software receive ring.
+ * @note    Must be a power of two.
+ */
+#if !defined(CAN_RX_QUEUE_SIZE) || defined(__DOXYGEN__)
+#define CAN_RX_QUEUE_SIZE                   16
+#endif
+
+/**
+ * @brief   Size of the exact identifiers hash table of the software filters.
+ * @note    Must be a power of two.
+ */
+#if !defined(CAN_SW_FILTERS_HASH_SIZE) || defined(__DOXYGEN__)
+#define CAN_SW_FILTERS_HASH_SIZE            32
+#endif
+
 /*===========================================================================*/
 /* CRY driver related settings.                                              */
 /*===========================================================================*/
@@ -312,6 +335,14 @@
 #define I2C_USE_MUTUAL_EXCLUSION            TRUE
 #endif
 
+/**
+ * @brief   Enables the asynchronous batches queue APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(I2C_USE_QUEUE) || defined(__DOXYGEN__)
+#define I2C_USE_QUEUE                       TRUE
+#endif
+
 /*===========================================================================*/
 /* MAC driver related settings.                                              */
 /*===========================================================================*/
@@ -320,7 +351,7 @@
  * @brief   Enables the zero-copy API.
  */
 #if !defined(MAC_USE_ZERO_COPY) || defined(__DOXYGEN__)
-#define MAC_USE_ZERO_COPY                   FALSE
+#define MAC_USE_ZERO_COPY                   TRUE
 #endif
 
 /**
@@ -491,7 +522,22 @@
  * @note    Disabling this option saves both code and data space.
  */
 #if !defined(SPI_SELECT_MODE) || defined(__DOXYGEN__)
-#define SPI_SELECT_MODE                     SPI_SELECT_MODE_PAD
+#define SPI_SELECT_MODE                     SPI_SELECT_MODE_LLD
+#endif
+
+/**
+ * @brief   Enables the transactions queue APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(SPI_USE_QUEUE) || defined(__DOXYGEN__)
+#define SPI_USE_QUEUE                       TRUE
+#endif
+
+/**
+ * @brief   Number of priority lanes of the transactions queue.
+ */
+#if !defined(SPI_QUEUE_LANES) || defined(__DOXYGEN__)
+#define SPI_QUEUE_LANES                     2
 #endif
 
 /*===========================================================================*/
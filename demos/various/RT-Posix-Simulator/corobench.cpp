@@ -0,0 +1,139 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Coroutines executor benchmark, the same number of tasks is run as
+ * coroutines sharing a single thread and as one thread per task, each
+ * task yields a number of times. The switch rate and the memory used by
+ * each task are compared.
+ */
+
+#include <stdlib.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+#include "chprintf.h"
+#include "chcoro.hpp"
+
+using namespace chibios_rt;
+
+#define BENCH_DEFAULT_TASKS     8U
+#define BENCH_CYCLES            100000U
+#define BENCH_THREAD_STACK      1024U
+#define BENCH_MAX_THREADS       64U
+
+static uint32_t bench_switches;
+static thread_t *bench_threads[BENCH_MAX_THREADS];
+
+static CoroutineTask bench_coroutine(unsigned cycles) {
+
+  for (unsigned i = 0U; i < cycles; i++) {
+    bench_switches++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+    co_await Coroutine::yield();
+  }
+}
+
+static THD_FUNCTION(bench_thread, arg) {
+  unsigned cycles = (unsigned)(uintptr_t)arg;
+
+  for (unsigned i = 0U; i < cycles; i++) {
+    bench_switches++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+    chThdYield();
+  }
+}
+
+/* Free memory, the heap grows from the core allocator.*/
+static size_t bench_free(void) {
+  size_t total;
+
+  (void) chHeapStatus(NULL, &total, NULL);
+  return total + chCoreGetStatusX();
+}
+
+static void bench_report(BaseSequentialStream *chp, const char *name,
+                         unsigned n, sysinterval_t elapsed, size_t used) {
+  uint32_t ms = (uint32_t)TIME_I2MS(elapsed);
+
+  if ((n == 0U) || (ms == 0U)) {
+    return;
+  }
+  chprintf(chp, "%s: %u tasks, %U switches/S, %U bytes/task" SHELL_NEWLINE_STR,
+           name, n, (uint32_t)(((uint64_t)bench_switches * 1000U) / ms),
+           (uint32_t)(used / n));
+}
+
+extern "C" void cmd_corobench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  unsigned i, n = BENCH_DEFAULT_TASKS;
+  systime_t start;
+  size_t before, used;
+
+  if (argc > 1) {
+    chprintf(chp, "Usage: corobench [tasks]" SHELL_NEWLINE_STR);
+    return;
+  }
+  if (argc == 1) {
+    n = (unsigned)atoi(argv[0]);
+    if (n == 0U) {
+      n = BENCH_DEFAULT_TASKS;
+    }
+  }
+
+  /* One thread for each task, the threads run below the shell thread
+     priority and round-robin among themselves.*/
+  bench_switches = 0U;
+  before = bench_free();
+  for (i = 0U; (i < n) && (i < BENCH_MAX_THREADS); i++) {
+    bench_threads[i] = chThdCreateFromHeap(NULL,
+                                           THD_WORKING_AREA_SIZE(BENCH_THREAD_STACK),
+                                           "bench", chThdGetPriorityX() - 1,
+                                           bench_thread,
+                                           (void *)(uintptr_t)BENCH_CYCLES);
+    if (bench_threads[i] == NULL) {
+      chprintf(chp, "out of memory after %u threads" SHELL_NEWLINE_STR, i);
+      break;
+    }
+  }
+  used = before - bench_free();
+  start = chVTGetSystemTime();
+  for (unsigned j = 0U; j < i; j++) {
+    (void) chThdWait(bench_threads[j]);
+  }
+  bench_report(chp, "Threads", i, chVTTimeElapsedSinceX(start), used);
+
+  /* Coroutines on a single executor, the executor runs on the shell
+     thread.*/
+  CoroutineExecutor executor;
+
+  bench_switches = 0U;
+  before = bench_free();
+  for (i = 0U; i < n; i++) {
+    if (!executor.spawn(bench_coroutine(BENCH_CYCLES))) {
+      chprintf(chp, "out of memory after %u coroutines" SHELL_NEWLINE_STR, i);
+      break;
+    }
+  }
+  used = before - bench_free();
+  start = chVTGetSystemTime();
+  executor.run();
+  bench_report(chp, "Coroutines", i, chVTTimeElapsedSinceX(start), used);
+}
@@ -0,0 +1,407 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * I2C driver benchmark, "i2cbench [<clock>]" polls 12 register file sensors
+ * on the simulated I2CD1 bus at the specified clock (default 400000). Each
+ * round reads the sample registers of all the sensors, first with one
+ * synchronous i2cMasterTransmitTimeout() per sensor, then as a single
+ * transactions batch whose completion is waited for, notified by an event
+ * or overlapped with the processing of the previous round.
+ * A last run checks that a missing device fails its own transaction only,
+ * that the timeout of a queued batch removes it from the queue only and
+ * that the timeout of the batch in progress locks the driver until it is
+ * restarted.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+#include "chprintf.h"
+
+#if (HAL_USE_I2C == TRUE) && (I2C_USE_QUEUE == TRUE)
+
+#define I2CBENCH_DEFAULT_CLOCK      400000U
+#define I2CBENCH_SENSORS            12U
+#define I2CBENCH_ROUNDS             200U
+#define I2CBENCH_REGS               16U
+#define I2CBENCH_READ_SIZE          6U
+#define I2CBENCH_BASE_ADDR          0x40U
+#define I2CBENCH_MISSING_ADDR       0x70U
+#define I2CBENCH_SLOW_CLOCK         100U
+
+#define SENSOR_REG_SAMPLE           0x00U
+#define SENSOR_REG_ID               0x04U
+
+/*===========================================================================*/
+/* Device models.                                                            */
+/*===========================================================================*/
+
+/*
+ * Sensor taking a sample each time its registers are read, the sample
+ * sequence number is followed by the device address.
+ */
+typedef struct {
+  sim_i2c_regfile_t         rf;
+  uint8_t                   regs[I2CBENCH_REGS];
+  uint32_t                  sample;
+} sensor_t;
+
+static sensor_t sensors[I2CBENCH_SENSORS];
+static sim_i2c_device_t *devices[I2CBENCH_SENSORS + 1U];
+static I2CConfig config = {0U, devices};
+
+static void sensor_update(sim_i2c_regfile_t *rfp) {
+  sensor_t *sp = (sensor_t *)rfp;
+
+  sp->sample++;
+  memcpy(&sp->regs[SENSOR_REG_SAMPLE], &sp->sample, sizeof sp->sample);
+}
+
+static void sensors_init(void) {
+  unsigned i;
+
+  for (i = 0U; i < I2CBENCH_SENSORS; i++) {
+    memset(&sensors[i], 0, sizeof sensors[i]);
+    sim_i2c_regfile_init(&sensors[i].rf, I2CBENCH_BASE_ADDR + i,
+                         sensors[i].regs, I2CBENCH_REGS, sensor_update);
+    sensors[i].regs[SENSOR_REG_ID]     = (uint8_t)(I2CBENCH_BASE_ADDR + i);
+    sensors[i].regs[SENSOR_REG_ID + 1] = 0xA5U;
+    devices[i] = &sensors[i].rf.dev;
+  }
+  devices[I2CBENCH_SENSORS] = NULL;
+}
+
+/*===========================================================================*/
+/* Polling.                                                                  */
+/*===========================================================================*/
+
+typedef enum {
+  MODE_SYNC = 0,
+  MODE_BATCH = 1,
+  MODE_EVENT = 2,
+  MODE_PIPELINED = 3
+} bench_mode_t;
+
+static const uint8_t sample_reg[1] = {SENSOR_REG_SAMPLE};
+static uint8_t data[2][I2CBENCH_SENSORS][I2CBENCH_READ_SIZE];
+static i2c_transaction_t txns[2][I2CBENCH_SENSORS];
+static i2c_batch_t batches[2];
+static uint32_t last[I2CBENCH_SENSORS];
+static volatile uint32_t completed;
+static event_source_t batch_event;
+
+/*
+ * Invoked from the driver ISR as each transaction ends.
+ */
+static void txn_cb(I2CDriver *i2cp, i2c_transaction_t *txnp) {
+
+  (void)i2cp;
+  (void)txnp;
+  completed++;
+}
+
+static void batches_init(void) {
+  unsigned i, j;
+
+  for (j = 0U; j < 2U; j++) {
+    for (i = 0U; i < I2CBENCH_SENSORS; i++) {
+      txns[j][i] = (i2c_transaction_t){.addr    = I2CBENCH_BASE_ADDR + i,
+                                       .txbuf   = sample_reg,
+                                       .txbytes = sizeof sample_reg,
+                                       .rxbuf   = data[j][i],
+                                       .rxbytes = I2CBENCH_READ_SIZE,
+                                       .end_cb  = txn_cb};
+    }
+    batches[j] = (i2c_batch_t){.txns  = txns[j],
+                               .n     = I2CBENCH_SENSORS,
+                               .event = &batch_event,
+                               .flags = (eventflags_t)1 << j};
+  }
+}
+
+/*
+ * Processing of a round, the samples of each sensor must be increasing.
+ */
+static uint32_t round_check(uint8_t (*p)[I2CBENCH_READ_SIZE]) {
+  uint32_t errors = 0U;
+  unsigned i;
+
+  for (i = 0U; i < I2CBENCH_SENSORS; i++) {
+    uint32_t sample;
+
+    memcpy(&sample, p[i], sizeof sample);
+    if ((sample <= last[i]) ||
+        (p[i][SENSOR_REG_ID] != (uint8_t)(I2CBENCH_BASE_ADDR + i))) {
+      errors++;
+    }
+    last[i] = sample;
+  }
+
+  return errors;
+}
+
+static void polling_bench(BaseSequentialStream *chp, bench_mode_t mode,
+                          uint32_t clock) {
+  static const char *names[] = {"sync", "batch", "event", "pipelined"};
+  event_listener_t el;
+  uint32_t round, ms, load, errors, waits;
+  uint64_t bits;
+  systime_t start;
+  unsigned i;
+
+  memset(last, 0, sizeof last);
+  errors    = 0U;
+  waits     = 0U;
+  completed = 0U;
+  config.clock = clock;
+  chEvtRegister(&batch_event, &el, 0);
+  i2cStart(&I2CD1, &config);
+
+  start = chVTGetSystemTime();
+  for (round = 0U; round < I2CBENCH_ROUNDS; round++) {
+    unsigned slot = round % 2U;
+
+    switch (mode) {
+    case MODE_SYNC:
+      for (i = 0U; i < I2CBENCH_SENSORS; i++) {
+        if (i2cMasterTransmitTimeout(&I2CD1, I2CBENCH_BASE_ADDR + i,
+                                     sample_reg, sizeof sample_reg,
+                                     data[0][i], I2CBENCH_READ_SIZE,
+                                     TIME_INFINITE) != MSG_OK) {
+          errors++;
+        }
+        waits++;
+      }
+      slot = 0U;
+      break;
+    case MODE_BATCH:
+      i2cQueueBatch(&I2CD1, &batches[0]);
+      if (i2cWaitBatchTimeout(&I2CD1, &batches[0],
+                              TIME_INFINITE) != MSG_OK) {
+        errors++;
+      }
+      waits++;
+      slot = 0U;
+      break;
+    case MODE_EVENT:
+      i2cQueueBatch(&I2CD1, &batches[0]);
+      (void) chEvtWaitAny(ALL_EVENTS);
+      if ((chEvtGetAndClearFlags(&el) & 1U) == 0U) {
+        errors++;
+      }
+      waits++;
+      slot = 0U;
+      break;
+    default:
+      /* The next round is queued before processing the current one.*/
+      if (round == 0U) {
+        i2cQueueBatch(&I2CD1, &batches[0]);
+      }
+      if (round + 1U < I2CBENCH_ROUNDS) {
+        i2cQueueBatch(&I2CD1, &batches[slot ^ 1U]);
+      }
+      if (i2cWaitBatchTimeout(&I2CD1, &batches[slot],
+                              TIME_INFINITE) != MSG_OK) {
+        errors++;
+      }
+      waits++;
+      break;
+    }
+    errors += round_check(data[slot]);
+  }
+  ms = (uint32_t)TIME_I2MS(chVTTimeElapsedSinceX(start));
+  if (ms == 0U) {
+    ms = 1U;
+  }
+
+  i2cStop(&I2CD1);
+  chEvtUnregister(&batch_event, &el);
+  (void) chEvtGetAndClearEvents(ALL_EVENTS);
+
+  /* Start, address, register, repeated start, address, data and stop.*/
+  bits = (uint64_t)I2CBENCH_ROUNDS * I2CBENCH_SENSORS *
+         (2U + 9U * (2U + sizeof sample_reg + I2CBENCH_READ_SIZE));
+  load = clock > 0U ? (uint32_t)((bits * 100000U) / ((uint64_t)clock * ms))
+                    : 0U;
+  if ((mode != MODE_SYNC) &&
+      (completed != I2CBENCH_ROUNDS * I2CBENCH_SENSORS)) {
+    errors++;
+  }
+
+  chprintf(chp, "%s: %U rounds in %U mS, %U rounds/S, %U%% bus load, "
+                "%U waits/round, %U errors" SHELL_NEWLINE_STR,
+           names[mode], I2CBENCH_ROUNDS, ms,
+           (uint32_t)(((uint64_t)I2CBENCH_ROUNDS * 1000U) / ms), load,
+           waits / I2CBENCH_ROUNDS, errors);
+}
+
+/*===========================================================================*/
+/* Errors.                                                                   */
+/*===========================================================================*/
+
+static void nack_test(BaseSequentialStream *chp, uint32_t clock) {
+  static const i2caddr_t addrs[3] = {I2CBENCH_BASE_ADDR,
+                                     I2CBENCH_MISSING_ADDR,
+                                     I2CBENCH_BASE_ADDR + 1U};
+  i2c_batch_t batch = {.txns = txns[0], .n = 3U};
+  bool ok = true;
+  unsigned i;
+
+  for (i = 0U; i < 3U; i++) {
+    txns[0][i].addr   = addrs[i];
+    txns[0][i].end_cb = NULL;
+  }
+  config.clock = clock;
+  i2cStart(&I2CD1, &config);
+
+  i2cQueueBatch(&I2CD1, &batch);
+  if (i2cWaitBatchTimeout(&I2CD1, &batch, TIME_INFINITE) != MSG_RESET) {
+    ok = false;
+  }
+  for (i = 0U; i < 3U; i++) {
+    bool missing = addrs[i] == I2CBENCH_MISSING_ADDR;
+
+    if ((txns[0][i].result != (missing ? MSG_RESET : MSG_OK)) ||
+        (txns[0][i].errors != (missing ? I2C_ACK_FAILURE : I2C_NO_ERROR))) {
+      ok = false;
+    }
+  }
+
+  /* The synchronous API reports the same failure.*/
+  if ((i2cMasterReceiveTimeout(&I2CD1, I2CBENCH_MISSING_ADDR, data[0][0],
+                               I2CBENCH_READ_SIZE,
+                               TIME_INFINITE) != MSG_RESET) ||
+      (i2cGetErrors(&I2CD1) != I2C_ACK_FAILURE)) {
+    ok = false;
+  }
+
+  i2cStop(&I2CD1);
+
+  chprintf(chp, "nack: %s" SHELL_NEWLINE_STR, ok ? "passed" : "failed");
+}
+
+static void timeout_test(BaseSequentialStream *chp, uint32_t clock) {
+  i2c_batch_t batch1 = {.txns = txns[0], .n = 3U};
+  i2c_batch_t batch2 = {.txns = txns[1], .n = 3U};
+  i2c_batch_t batch3 = {.txns = &txns[1][3], .n = 3U};
+  bool ok = true;
+  unsigned i;
+
+  /* At the slow clock each transaction takes almost one second, the
+     transaction in progress is stuck for the waiting thread.*/
+  config.clock = I2CBENCH_SLOW_CLOCK;
+  i2cStart(&I2CD1, &config);
+
+  i2cQueueBatch(&I2CD1, &batch1);
+  i2cQueueBatch(&I2CD1, &batch2);
+  i2cQueueBatch(&I2CD1, &batch3);
+  if (i2cWaitBatchTimeout(&I2CD1, &batch1, TIME_IMMEDIATE) != MSG_TIMEOUT) {
+    ok = false;
+  }
+
+  /* A queued batch timing out is only removed from the queue, the batch
+     in progress continues.*/
+  if ((i2cWaitBatchTimeout(&I2CD1, &batch2,
+                           TIME_MS2I(50)) != MSG_TIMEOUT) ||
+      (I2CD1.state == I2C_LOCKED) ||
+      (i2cWaitBatchTimeout(&I2CD1, &batch1, TIME_IMMEDIATE) != MSG_TIMEOUT)) {
+    ok = false;
+  }
+  for (i = 0U; i < 3U; i++) {
+    if ((txns[1][i].result != MSG_TIMEOUT) ||
+        (txns[1][i].errors != I2C_NO_ERROR)) {
+      ok = false;
+    }
+    txns[1][i].result = MSG_OK;
+  }
+
+  /* Queued again after the remaining batch.*/
+  i2cQueueBatch(&I2CD1, &batch2);
+
+  /* The batch in progress timing out locks the driver.*/
+  if ((i2cWaitBatchTimeout(&I2CD1, &batch1,
+                           TIME_MS2I(50)) != MSG_TIMEOUT) ||
+      (I2CD1.state != I2C_LOCKED)) {
+    ok = false;
+  }
+  for (i = 0U; i < 3U; i++) {
+    if ((txns[0][i].result != MSG_TIMEOUT) ||
+        (txns[0][i].errors != (i == 0U ? I2C_TIMEOUT : I2C_NO_ERROR)) ||
+        (txns[1][i].result != MSG_TIMEOUT) ||
+        (txns[1][i + 3U].result != MSG_TIMEOUT)) {
+      ok = false;
+    }
+  }
+
+  /* The queued batches have been aborted as well.*/
+  if ((i2cWaitBatchTimeout(&I2CD1, &batch2, TIME_IMMEDIATE) != MSG_TIMEOUT) ||
+      (i2cWaitBatchTimeout(&I2CD1, &batch3, TIME_IMMEDIATE) != MSG_TIMEOUT)) {
+    ok = false;
+  }
+
+  /* Recovery.*/
+  i2cStop(&I2CD1);
+  config.clock = clock;
+  i2cStart(&I2CD1, &config);
+  txns[0][1].addr = I2CBENCH_BASE_ADDR + 1U;
+  i2cQueueBatch(&I2CD1, &batch1);
+  if ((i2cWaitBatchTimeout(&I2CD1, &batch1, TIME_INFINITE) != MSG_OK) ||
+      (txns[0][0].errors != I2C_NO_ERROR)) {
+    ok = false;
+  }
+  i2cStop(&I2CD1);
+
+  chprintf(chp, "timeout: %s" SHELL_NEWLINE_STR, ok ? "passed" : "failed");
+}
+
+void cmd_i2cbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  uint32_t clock = I2CBENCH_DEFAULT_CLOCK;
+
+  if (argc > 1) {
+    chprintf(chp, "Usage: i2cbench [<clock>]" SHELL_NEWLINE_STR);
+    return;
+  }
+  if (argc >= 1) {
+    clock = (uint32_t)strtoul(argv[0], NULL, 0);
+  }
+
+  chEvtObjectInit(&batch_event);
+  sensors_init();
+  batches_init();
+
+  polling_bench(chp, MODE_SYNC, clock);
+  polling_bench(chp, MODE_BATCH, clock);
+  polling_bench(chp, MODE_EVENT, clock);
+  polling_bench(chp, MODE_PIPELINED, clock);
+  nack_test(chp, clock);
+  timeout_test(chp, clock);
+}
+
+#else /* !((HAL_USE_I2C == TRUE) && (I2C_USE_QUEUE == TRUE)) */
+
+void cmd_i2cbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+
+  (void)argc;
+  (void)argv;
+  chprintf(chp, "i2cbench requires HAL_USE_I2C and I2C_USE_QUEUE"
+                SHELL_NEWLINE_STR);
+}
+
+#endif /* !((HAL_USE_I2C == TRUE) && (I2C_USE_QUEUE == TRUE)) */
@@ -0,0 +1,186 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Input queues wakeup policy check, "iqbench [<bytes>]" transfers data one
+ * byte at a time from a writer thread to a higher priority reader thread
+ * through an input queue, the reader requests frames of
+ * IQBENCH_FRAME_SIZE bytes. The transfer is repeated for each wakeup
+ * policy and the reader wakeups are counted by the writer:
+ * - "default", the reader is resumed on each byte.
+ * - "threshold", the reader is resumed once for each frame.
+ * - "delimiter", shorter frames are ended by a delimiter, the reader is
+ *   resumed once for each frame and each read returns one frame.
+ * - "idle", the writer pauses after short bursts, the reader is resumed
+ *   at the start of each burst and each read returns one burst after the
+ *   idle gap.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+#include "chprintf.h"
+
+#define IQBENCH_QUEUE_SIZE      512U
+#define IQBENCH_FRAME_SIZE      256U
+#define IQBENCH_DELIM_SIZE      100U
+#define IQBENCH_BURST_SIZE      10U
+#define IQBENCH_BURSTS          20U
+#define IQBENCH_IDLE            TIME_MS2I(5)
+#define IQBENCH_DELIMITER       '\n'
+#define IQBENCH_DEFAULT_SIZE    65536U
+
+static uint8_t iq_buffer[IQBENCH_QUEUE_SIZE];
+static input_queue_t iq;
+static THD_WORKING_AREA(wa_writer, 1024);
+
+static size_t bench_total;
+static size_t bench_frame;
+static bool bench_delim;
+static bool bench_pause;
+static uint32_t bench_wakeups;
+
+/*
+ * Writes a byte, a wakeup is counted when the reader was waiting before
+ * the write and it is not anymore after.
+ */
+static void put(uint8_t b) {
+
+  chSysLock();
+  while (true) {
+    bool waiting = !chThdQueueIsEmptyI(&iq.q_waiting);
+
+    if (iqPutI(&iq, b) == MSG_OK) {
+      if (waiting && chThdQueueIsEmptyI(&iq.q_waiting)) {
+        bench_wakeups++;
+      }
+      break;
+    }
+
+    /* Queue full, letting the reader run.*/
+    chSysUnlock();
+    chThdSleep(1);
+    chSysLock();
+  }
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+static THD_FUNCTION(writer, arg) {
+  size_t i;
+
+  (void)arg;
+
+  for (i = 0U; i < bench_total; i++) {
+    bool last = (i % bench_frame) == bench_frame - 1U;
+
+    if (bench_delim && last) {
+      put(IQBENCH_DELIMITER);
+    }
+    else {
+      put((uint8_t)('0' + (i % 10U)));
+    }
+    if (bench_pause && last) {
+      chThdSleep(IQBENCH_IDLE * 3U);
+    }
+#if defined(SIMULATOR)
+    /* Letting the simulated timer advance.*/
+    _sim_check_for_interrupts();
+#endif
+  }
+}
+
+static bool bench(BaseSequentialStream *chp, const char *name,
+                  size_t threshold, msg_t delimiter, sysinterval_t idle,
+                  size_t frame, size_t total) {
+  uint8_t buf[IQBENCH_FRAME_SIZE];
+  size_t done, frames, errors;
+  uint32_t expected;
+  thread_t *tp;
+
+  iqObjectInit(&iq, iq_buffer, sizeof iq_buffer, NULL, NULL);
+  chSysLock();
+  iqSetWakeupI(&iq, threshold, delimiter, idle);
+  chSysUnlock();
+  bench_total   = total;
+  bench_frame   = frame;
+  bench_delim   = delimiter != IQ_NO_DELIMITER;
+  bench_pause   = idle != TIME_INFINITE;
+  bench_wakeups = 0U;
+
+  tp = chThdCreateStatic(wa_writer, sizeof wa_writer,
+                         chThdGetPriorityX() - 1, writer, NULL);
+  done   = 0U;
+  frames = 0U;
+  errors = 0U;
+  while (done < total) {
+    size_t n;
+
+    n = iqReadTimeout(&iq, buf, sizeof buf, TIME_MS2I(1000));
+    if (n == 0U) {
+      break;
+    }
+
+    /* Each read must return exactly one frame.*/
+    if ((n != frame) ||
+        (bench_delim && (buf[n - 1U] != (uint8_t)IQBENCH_DELIMITER))) {
+      errors++;
+    }
+    frames++;
+    done += n;
+  }
+  chThdWait(tp);
+
+  /* One wakeup per byte without batching, one per frame otherwise.*/
+  expected = threshold == 1U ? (uint32_t)total : (uint32_t)(total / frame);
+  if ((done != total) || (bench_wakeups != expected)) {
+    errors++;
+  }
+
+  chprintf(chp, "%s: %U bytes, %U frames, %U wakeups, %s"
+                SHELL_NEWLINE_STR,
+           name, (uint32_t)done, (uint32_t)frames, bench_wakeups,
+           errors == 0U ? "OK" : "FAILED");
+
+  return errors == 0U;
+}
+
+void cmd_iqbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  size_t total = IQBENCH_DEFAULT_SIZE;
+
+  if (argc > 1) {
+    chprintf(chp, "Usage: iqbench [<bytes>]" SHELL_NEWLINE_STR);
+    return;
+  }
+  if (argc == 1) {
+    total = (size_t)strtoul(argv[0], NULL, 0);
+  }
+  total -= total % IQBENCH_FRAME_SIZE;
+
+  (void) bench(chp, "default", 1U, IQ_NO_DELIMITER, TIME_INFINITE,
+               IQBENCH_FRAME_SIZE, total);
+  (void) bench(chp, "threshold", IQBENCH_FRAME_SIZE, IQ_NO_DELIMITER,
+               TIME_INFINITE, IQBENCH_FRAME_SIZE, total);
+  (void) bench(chp, "delimiter", IQBENCH_FRAME_SIZE, IQBENCH_DELIMITER,
+               TIME_INFINITE, IQBENCH_DELIM_SIZE,
+               total - (total % IQBENCH_DELIM_SIZE));
+  (void) bench(chp, "idle", IQBENCH_FRAME_SIZE, IQ_NO_DELIMITER,
+               IQBENCH_IDLE, IQBENCH_BURST_SIZE,
+               IQBENCH_BURST_SIZE * IQBENCH_BURSTS);
+}
@@ -0,0 +1,235 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Deferred logging benchmark, "logbench" checks the records storage, the
+ * formatting of the records on flush and the reader wakeup of a log
+ * buffer, then a producer stores records with two arguments for one
+ * second while a reader thread fetches them and the number of records
+ * stored per second is printed.
+ */
+
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+#include "chprintf.h"
+#include "memstreams.h"
+#include "chlog.h"
+
+#define LOGBENCH_SIZE           4U
+#define LOGBENCH_BENCH_SIZE     16U
+
+static chlog_record_t records[LOGBENCH_BENCH_SIZE];
+static chlog_buffer_t log1;
+static char text[256];
+static MemoryStream ms;
+static volatile bool stop;
+static THD_WORKING_AREA(waLogBench, 512);
+
+static void text_reset(void) {
+
+  memset(text, 0, sizeof text);
+  msObjectInit(&ms, (uint8_t *)text, sizeof text - 1U, 0U);
+}
+
+static THD_FUNCTION(producer, arg) {
+
+  (void)arg;
+
+  chThdSleepMilliseconds(1);
+  CHLOG_WARNING(&log1, "wakeup");
+}
+
+static THD_FUNCTION(reader, arg) {
+  chlog_record_t r;
+
+  (void)arg;
+
+  while (!stop) {
+    (void) chlogWaitTimeout(&log1, TIME_MS2I(10));
+    while (chlogFetchX(&log1, &r)) {
+    }
+  }
+}
+
+/*
+ * Records are fetched back in order with their level, format and
+ * arguments, floating point arguments keep their bit pattern. The records
+ * exceeding the buffer size are dropped and counted, records above
+ * CHLOG_LEVEL do not evaluate their arguments.
+ */
+static void storage_test(BaseSequentialStream *chp) {
+  chlog_record_t r;
+  bool ok = true;
+  unsigned i;
+
+  chlogObjectInit(&log1, records, LOGBENCH_SIZE);
+
+  CHLOG_ERROR(&log1, "error");
+  CHLOG_WARNING(&log1, "%d %d %d %d", 1, 2, 3, 4);
+  CHLOG_INFO(&log1, "%f", CHLOG_FLOAT(0.1));
+  if (!chlogFetchX(&log1, &r) || (r.level != CHLOG_LEVEL_ERROR) ||
+      (r.nargs != 0U) || (strcmp(r.fmt, "error") != 0)) {
+    ok = false;
+  }
+  if (!chlogFetchX(&log1, &r) || (r.level != CHLOG_LEVEL_WARNING) ||
+      (r.nargs != 4U) || (r.args[0] != 1U) || (r.args[3] != 4U)) {
+    ok = false;
+  }
+  if (!chlogFetchX(&log1, &r) || (r.nargs != 1U) ||
+      (r.args[0] != 0x3DCCCCCDU)) {
+    ok = false;
+  }
+  if (chlogFetchX(&log1, &r)) {
+    ok = false;
+  }
+
+  for (i = 0U; i < LOGBENCH_SIZE + 2U; i++) {
+    CHLOG_INFO(&log1, "%u", i);
+  }
+  if (chlogGetDroppedX(&log1) != 2U) {
+    ok = false;
+  }
+
+#if CHLOG_LEVEL < CHLOG_LEVEL_DEBUG
+  i = 0U;
+  CHLOG_DEBUG(&log1, "%u", i++);
+  if ((i != 0U) || (chlogGetDroppedX(&log1) != 2U)) {
+    ok = false;
+  }
+#endif
+
+  chprintf(chp, "storage: %s" SHELL_NEWLINE_STR, ok ? "passed" : "failed");
+}
+
+/*
+ * Each conversion prints its argument with the type expected by the
+ * conversion, dropped records are reported by the next flush only.
+ */
+static void format_test(BaseSequentialStream *chp) {
+  bool ok = true;
+  unsigned i;
+
+  chlogObjectInit(&log1, records, LOGBENCH_SIZE);
+  text_reset();
+
+  CHLOG_INFO(&log1, "%s=%d", "a", -5);
+  CHLOG_INFO(&log1, "%lx/%u", 0xABCDUL, 7U);
+  CHLOG_INFO(&log1, "[%*d][%-3c]%%", 4, 12, 'x');
+  CHLOG_ERROR(&log1, "%lld", (long long)-3);
+  if ((chlogFlush(&log1, (BaseSequentialStream *)&ms) != 4U) ||
+      (strstr(text, " I a=-5\r\n") == NULL) ||
+      (strstr(text, " I ABCD/7\r\n") == NULL) ||
+      (strstr(text, " I [  12][x  ]%\r\n") == NULL) ||
+      (strstr(text, " E -3\r\n") == NULL)) {
+    ok = false;
+  }
+
+#if CHPRINTF_USE_FLOAT
+  text_reset();
+  CHLOG_INFO(&log1, "%.3f", CHLOG_FLOAT(-2.125f));
+  if ((chlogFlush(&log1, (BaseSequentialStream *)&ms) != 1U) ||
+      (strstr(text, " I -2.125\r\n") == NULL)) {
+    ok = false;
+  }
+#endif
+
+  for (i = 0U; i < LOGBENCH_SIZE + 1U; i++) {
+    CHLOG_INFO(&log1, "%u", i);
+  }
+  text_reset();
+  if ((chlogFlush(&log1, (BaseSequentialStream *)&ms) != LOGBENCH_SIZE) ||
+      (strstr(text, "*** 1 records dropped") == NULL)) {
+    ok = false;
+  }
+  text_reset();
+  if ((chlogFlush(&log1, (BaseSequentialStream *)&ms) != 0U) ||
+      (text[0] != '\0')) {
+    ok = false;
+  }
+
+  chprintf(chp, "format: %s" SHELL_NEWLINE_STR, ok ? "passed" : "failed");
+}
+
+/*
+ * A reader waiting on the empty buffer times out unless a lower priority
+ * producer stores a record.
+ */
+static void wakeup_test(BaseSequentialStream *chp) {
+  chlog_record_t r;
+  thread_t *tp;
+  bool ok = true;
+
+  chlogObjectInit(&log1, records, LOGBENCH_SIZE);
+
+  if (chlogWaitTimeout(&log1, TIME_IMMEDIATE) != MSG_TIMEOUT) {
+    ok = false;
+  }
+
+  tp = chThdCreateStatic(waLogBench, sizeof waLogBench,
+                         chThdGetPriorityX() - 1, producer, NULL);
+  if ((chlogWaitTimeout(&log1, TIME_MS2I(100)) != MSG_OK) ||
+      !chlogFetchX(&log1, &r) || (r.level != CHLOG_LEVEL_WARNING)) {
+    ok = false;
+  }
+  (void) chThdWait(tp);
+
+  chprintf(chp, "wakeup: %s" SHELL_NEWLINE_STR, ok ? "passed" : "failed");
+}
+
+static void store_bench(BaseSequentialStream *chp) {
+  systime_t start, end;
+  thread_t *tp;
+  uint32_t n = 0U;
+
+  chlogObjectInit(&log1, records, LOGBENCH_BENCH_SIZE);
+  stop = false;
+  tp = chThdCreateStatic(waLogBench, sizeof waLogBench,
+                         chThdGetPriorityX() + 1, reader, NULL);
+
+  chThdSleep(1);
+  start = chVTGetSystemTime();
+  end = chTimeAddX(start, TIME_MS2I(1000));
+  do {
+    CHLOG_INFO(&log1, "%u %u", n, 0U);
+    n++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while (chVTIsSystemTimeWithinX(start, end));
+
+  stop = true;
+  (void) chThdWait(tp);
+
+  chprintf(chp, "store: %U records/S, %U dropped" SHELL_NEWLINE_STR,
+           n - chlogGetDroppedX(&log1), chlogGetDroppedX(&log1));
+}
+
+void cmd_logbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: logbench" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  storage_test(chp);
+  format_test(chp);
+  wakeup_test(chp);
+  store_bench(chp);
+}
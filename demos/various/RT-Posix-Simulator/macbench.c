@@ -0,0 +1,268 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * MAC driver throughput benchmark, "macbench [<frames> [<ms> [<loss>]]]"
+ * sends full size frames through the simulated MAC, which loops them back
+ * into its own receive buffers. The transfer is performed twice, first
+ * copying the frames through the descriptors streams then attaching the
+ * header and payload buffers by reference and reading the received frames
+ * in place, like the lwIP bindings do in zero-copy mode.
+ * A last run sends the frames from ETHD1 to ETHD2 over a socket link with
+ * the specified latency and loss (frames every 1000), keeping a limited
+ * number of frames in flight.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+#include "chprintf.h"
+
+#define MACBENCH_HEADER_SIZE    54U
+#define MACBENCH_PAYLOAD_SIZE   1460U
+#define MACBENCH_FRAME_SIZE     (MACBENCH_HEADER_SIZE + MACBENCH_PAYLOAD_SIZE)
+#define MACBENCH_HEADERS        8U
+#define MACBENCH_DEFAULT_FRAMES 1000000U
+#define MACBENCH_LINK_WINDOW    4U
+#define MACBENCH_LINK_TIMEOUT   TIME_MS2I(100)
+#define MACBENCH_LINK1_PATH     "/tmp/chsim-eth1"
+#define MACBENCH_LINK2_PATH     "/tmp/chsim-eth2"
+
+static uint8_t headers[MACBENCH_HEADERS][MACBENCH_HEADER_SIZE];
+static uint8_t payload[MACBENCH_PAYLOAD_SIZE];
+static uint8_t rxbuf[MACBENCH_FRAME_SIZE];
+static uint32_t released;
+
+/*
+ * Called when the MAC no longer uses an attached buffer.
+ */
+static void tx_release(MACDriver *macp, void *ref) {
+
+  (void)macp;
+  (void)ref;
+  released++;
+}
+
+static uint8_t mac_address[6] = {0xC2, 0xAF, 0x51, 0x03, 0xCF, 0x46};
+
+static const MACConfig mac_config = {mac_address, tx_release, NULL};
+
+/*
+ * Prepares a frame header with the sequence number in it, headers are
+ * rotated because an attached header must not change until released.
+ */
+static uint8_t *make_header(uint32_t seq) {
+  uint8_t *hp = headers[seq % MACBENCH_HEADERS];
+
+  memcpy(&hp[0], mac_address, 6);
+  memcpy(&hp[6], mac_address, 6);
+  hp[12] = 0x08;
+  hp[13] = 0x00;
+  memcpy(&hp[14], &seq, sizeof seq);
+
+  return hp;
+}
+
+static bool check_frame(const uint8_t *p, size_t n, uint32_t seq) {
+
+  return (n == MACBENCH_FRAME_SIZE) &&
+         (memcmp(&p[14], &seq, sizeof seq) == 0) &&
+         (p[MACBENCH_FRAME_SIZE - 1U] == payload[MACBENCH_PAYLOAD_SIZE - 1U]);
+}
+
+static void bench(BaseSequentialStream *chp, bool zerocopy, uint32_t frames) {
+  MACTransmitDescriptor td;
+  MACReceiveDescriptor rd;
+  uint32_t seq, errors, ms;
+  systime_t start;
+
+  released = 0U;
+  macStart(&ETHD1, &mac_config);
+
+  errors = 0U;
+  start = chVTGetSystemTime();
+  for (seq = 0U; seq < frames; seq++) {
+    const uint8_t *p;
+    uint8_t *hp;
+    size_t n;
+
+    if (macWaitTransmitDescriptor(&ETHD1, &td, TIME_INFINITE) != MSG_OK) {
+      errors++;
+      break;
+    }
+    hp = make_header(seq);
+#if MAC_USE_ZERO_COPY == TRUE
+    if (zerocopy) {
+      (void) macAttachTransmitBuffer(&td, hp, MACBENCH_HEADER_SIZE, NULL);
+      (void) macAttachTransmitBuffer(&td, payload, MACBENCH_PAYLOAD_SIZE, hp);
+    }
+    else
+#endif
+    {
+      (void) macWriteTransmitDescriptor(&td, hp, MACBENCH_HEADER_SIZE);
+      (void) macWriteTransmitDescriptor(&td, payload, MACBENCH_PAYLOAD_SIZE);
+    }
+    macReleaseTransmitDescriptor(&td);
+
+    if (macWaitReceiveDescriptor(&ETHD1, &rd, TIME_INFINITE) != MSG_OK) {
+      errors++;
+      break;
+    }
+#if MAC_USE_ZERO_COPY == TRUE
+    if (zerocopy) {
+      p = macGetNextReceiveBuffer(&rd, &n);
+    }
+    else
+#endif
+    {
+      p = rxbuf;
+      n = macReadReceiveDescriptor(&rd, rxbuf, sizeof rxbuf);
+    }
+    if (!check_frame(p, n, seq)) {
+      errors++;
+    }
+    macReleaseReceiveDescriptor(&rd);
+
+#if defined(SIMULATOR)
+    /* Letting the simulated timer advance.*/
+    if ((seq & 15U) == 0U) {
+      _sim_check_for_interrupts();
+    }
+#endif
+  }
+  ms = (uint32_t)TIME_I2MS(chVTTimeElapsedSinceX(start));
+  if (ms == 0U) {
+    ms = 1U;
+  }
+
+  /* All the attached buffers must have been given back after stop.*/
+  macStop(&ETHD1);
+  if (zerocopy && (released != frames)) {
+    errors++;
+  }
+
+  chprintf(chp, "%s: %U frames in %U mS, %U frames/S, %U errors"
+                SHELL_NEWLINE_STR,
+           zerocopy ? "zero-copy" : "copy", seq, ms,
+           (uint32_t)(((uint64_t)seq * 1000U) / ms), errors);
+}
+
+static void link_bench(BaseSequentialStream *chp, uint32_t frames,
+                       sysinterval_t latency, uint32_t loss) {
+  const sim_mac_link_t link1 = {MACBENCH_LINK1_PATH, MACBENCH_LINK2_PATH,
+                                latency, loss};
+  const sim_mac_link_t link2 = {MACBENCH_LINK2_PATH, MACBENCH_LINK1_PATH,
+                                latency, loss};
+  const MACConfig config1 = {mac_address, NULL, &link1};
+  const MACConfig config2 = {mac_address, NULL, &link2};
+  MACTransmitDescriptor td;
+  MACReceiveDescriptor rd;
+  uint32_t sent, received, lost, errors, ms;
+  systime_t start;
+
+  macStart(&ETHD1, &config1);
+  macStart(&ETHD2, &config2);
+
+  sent = 0U;
+  received = 0U;
+  lost = 0U;
+  errors = 0U;
+  start = chVTGetSystemTime();
+  while (received + lost < frames) {
+    uint32_t seq;
+    size_t n;
+
+    /* Filling the window.*/
+    while ((sent < frames) &&
+           (sent - (received + lost) < MACBENCH_LINK_WINDOW)) {
+      uint8_t *hp = make_header(sent);
+
+      (void) macWaitTransmitDescriptor(&ETHD1, &td, TIME_INFINITE);
+      (void) macWriteTransmitDescriptor(&td, hp, MACBENCH_HEADER_SIZE);
+      (void) macWriteTransmitDescriptor(&td, payload, MACBENCH_PAYLOAD_SIZE);
+      macReleaseTransmitDescriptor(&td);
+      sent++;
+    }
+
+    /* Frames not arrived within the timeout are lost.*/
+    if (macWaitReceiveDescriptor(&ETHD2, &rd,
+                                 latency + MACBENCH_LINK_TIMEOUT) != MSG_OK) {
+      lost = sent - received;
+      continue;
+    }
+    n = macReadReceiveDescriptor(&rd, rxbuf, sizeof rxbuf);
+    memcpy(&seq, &rxbuf[14], sizeof seq);
+    if ((seq < received + lost) || !check_frame(rxbuf, n, seq)) {
+      errors++;
+    }
+    else {
+      lost += seq - (received + lost);
+      received++;
+    }
+    macReleaseReceiveDescriptor(&rd);
+  }
+  ms = (uint32_t)TIME_I2MS(chVTTimeElapsedSinceX(start));
+  if (ms == 0U) {
+    ms = 1U;
+  }
+
+  /* All the lost frames must have been accounted by the transmitter.*/
+  if (lost != ETHD1.txlost + ETHD2.rxdropped) {
+    errors++;
+  }
+  macStop(&ETHD2);
+  macStop(&ETHD1);
+
+  chprintf(chp, "link: %U frames in %U mS, %U frames/S, %U lost, %U errors"
+                SHELL_NEWLINE_STR,
+           received, ms, (uint32_t)(((uint64_t)received * 1000U) / ms),
+           lost, errors);
+}
+
+void cmd_macbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  uint32_t frames = MACBENCH_DEFAULT_FRAMES;
+  sysinterval_t latency = 0;
+  uint32_t loss = 0U;
+  unsigned i;
+
+  if (argc > 3) {
+    chprintf(chp, "Usage: macbench [<frames> [<ms> [<loss>]]]"
+                  SHELL_NEWLINE_STR);
+    return;
+  }
+  if (argc >= 1) {
+    frames = (uint32_t)strtoul(argv[0], NULL, 0);
+  }
+  if (argc >= 2) {
+    latency = TIME_MS2I(strtoul(argv[1], NULL, 0));
+  }
+  if (argc >= 3) {
+    loss = (uint32_t)strtoul(argv[2], NULL, 0);
+  }
+
+  for (i = 0U; i < MACBENCH_PAYLOAD_SIZE; i++) {
+    payload[i] = (uint8_t)i;
+  }
+
+  bench(chp, false, frames);
+#if MAC_USE_ZERO_COPY == TRUE
+  bench(chp, true, frames);
+#endif
+  link_bench(chp, frames, latency, loss);
+}
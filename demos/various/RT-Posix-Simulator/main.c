@@ -29,7 +29,30 @@ static thread_t *cdtp;
 static thread_t *shelltp1;
 static thread_t *shelltp2;
 
+extern void cmd_corobench(BaseSequentialStream *chp, int argc, char *argv[]);
+extern void cmd_sdbench(BaseSequentialStream *chp, int argc, char *argv[]);
+extern void cmd_bqbench(BaseSequentialStream *chp, int argc, char *argv[]);
+extern void cmd_iqbench(BaseSequentialStream *chp, int argc, char *argv[]);
+extern void cmd_printfbench(BaseSequentialStream *chp, int argc, char *argv[]);
+extern void cmd_scanfbench(BaseSequentialStream *chp, int argc, char *argv[]);
+extern void cmd_macbench(BaseSequentialStream *chp, int argc, char *argv[]);
+extern void cmd_canbench(BaseSequentialStream *chp, int argc, char *argv[]);
+extern void cmd_spibench(BaseSequentialStream *chp, int argc, char *argv[]);
+extern void cmd_i2cbench(BaseSequentialStream *chp, int argc, char *argv[]);
+extern void cmd_logbench(BaseSequentialStream *chp, int argc, char *argv[]);
+
 static const ShellCommand commands[] = {
+  {"corobench", cmd_corobench},
+  {"sdbench", cmd_sdbench},
+  {"bqbench", cmd_bqbench},
+  {"iqbench", cmd_iqbench},
+  {"printfbench", cmd_printfbench},
+  {"scanfbench", cmd_scanfbench},
+  {"macbench", cmd_macbench},
+  {"canbench", cmd_canbench},
+  {"spibench", cmd_spibench},
+  {"i2cbench", cmd_i2cbench},
+  {"logbench", cmd_logbench},
   {NULL, NULL}
 };
 
@@ -0,0 +1,80 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Formatted output throughput benchmark, "printfbench" formats a set of
+ * typical log lines for one second on a null stream, then in a string
+ * buffer, and prints the number of lines formatted per second.
+ */
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+#include "chprintf.h"
+#include "nullstreams.h"
+
+#define BENCH_GROUP             16U
+
+static uint32_t bench_format(BaseSequentialStream *chp,
+                             char *buf, size_t size) {
+  systime_t start, end;
+  uint32_t n = 0U;
+
+  chThdSleep(1);
+  start = chVTGetSystemTime();
+  end = chTimeAddX(start, TIME_MS2I(1000));
+  do {
+    unsigned i;
+
+    /* Lines are formatted in groups in order to make the loop overhead
+       negligible.*/
+    for (i = 0U; i < BENCH_GROUP; i++) {
+      if (chp != NULL) {
+        (void)chprintf(chp, "%10u %-8s %5d 0x%08x %c\r\n",
+                       (unsigned)n, "thread", -(int)(n & 1023U),
+                       (unsigned)n * 2654435761U, 'I');
+      }
+      else {
+        (void)chsnprintf(buf, size, "%10u %-8s %5d 0x%08x %c\r\n",
+                         (unsigned)n, "thread", -(int)(n & 1023U),
+                         (unsigned)n * 2654435761U, 'I');
+      }
+      n++;
+    }
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while (chVTIsSystemTimeWithinX(start, end));
+
+  return n;
+}
+
+void cmd_printfbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  static NullStream ns;
+  char buf[64];
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: printfbench" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  nullObjectInit(&ns);
+  chprintf(chp, "chprintf:   %U lines/S" SHELL_NEWLINE_STR,
+           bench_format((BaseSequentialStream *)&ns, NULL, 0U));
+  chprintf(chp, "chsnprintf: %U lines/S" SHELL_NEWLINE_STR,
+           bench_format(NULL, buf, sizeof buf));
+}
@@ -0,0 +1,121 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Formatted input throughput benchmark, "scanfbench" parses a typical
+ * telemetry line from a memory stream for one second and prints the number
+ * of lines parsed per second. Floating point fields are included if
+ * CHSCANF_USE_FLOAT is enabled, in that case the rounding of values just
+ * above the halfway point between two floats is checked first.
+ */
+
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+#include "chprintf.h"
+#include "chscanf.h"
+#include "memstreams.h"
+
+#define BENCH_GROUP             16U
+
+#if CHSCANF_USE_FLOAT
+static char line[] = "T 1234567 -273 0x1F2E voltage 3.3125 -1.5e-3\r\n";
+#else
+static char line[] = "T 1234567 -273 0x1F2E voltage 3 -15\r\n";
+#endif
+
+#if CHSCANF_USE_FLOAT
+/*
+ * The inputs are just above the halfway point between 1.0f and the next
+ * float, they round to the halfway point as doubles and then to 1.0f if
+ * rounded to nearest twice.
+ */
+static void rounding_test(BaseSequentialStream *chp) {
+  static char in1[] = "1.0000000596046447753906251";
+  static char in2[] = "100000005960464477539062500000001e-32";
+  static char in3[] = "0x1.0000010000000000001p0";
+  float f1 = 0.0f, f2 = 0.0f, f3 = 0.0f;
+  bool ok = true;
+
+  if ((chsnscanf(in1, sizeof in1, "%f", &f1) != 1) ||
+      (chsnscanf(in2, sizeof in2, "%f", &f2) != 1) ||
+      (chsnscanf(in3, sizeof in3, "%f", &f3) != 1) ||
+      (f1 != 1.00000012f) || (f2 != 1.00000012f) || (f3 != 1.00000012f)) {
+    ok = false;
+  }
+
+  chprintf(chp, "rounding: %s" SHELL_NEWLINE_STR, ok ? "passed" : "failed");
+}
+#endif
+
+void cmd_scanfbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  MemoryStream ms;
+  systime_t start, end;
+  uint32_t n = 0U, errors = 0U;
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: scanfbench" SHELL_NEWLINE_STR);
+    return;
+  }
+
+#if CHSCANF_USE_FLOAT
+  rounding_test(chp);
+#endif
+
+  msObjectInit(&ms, (uint8_t *)line, sizeof line - 1U, sizeof line - 1U);
+
+  chThdSleep(1);
+  start = chVTGetSystemTime();
+  end = chTimeAddX(start, TIME_MS2I(1000));
+  do {
+    unsigned i;
+
+    /* Lines are parsed in groups in order to make the loop overhead
+       negligible.*/
+    for (i = 0U; i < BENCH_GROUP; i++) {
+      unsigned long ticks;
+      int temp;
+      unsigned id;
+      char name[16];
+#if CHSCANF_USE_FLOAT
+      float v1, v2;
+#else
+      int v1, v2;
+#endif
+
+      ms.offset = 0U;
+#if CHSCANF_USE_FLOAT
+      if (chscanf((BaseBufferedStream *)&ms, "T %lu %d %x %15s %f %f",
+                  &ticks, &temp, &id, name, &v1, &v2) != 6) {
+#else
+      if (chscanf((BaseBufferedStream *)&ms, "T %lu %d %x %15s %d %d",
+                  &ticks, &temp, &id, name, &v1, &v2) != 6) {
+#endif
+        errors++;
+      }
+      n++;
+    }
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while (chVTIsSystemTimeWithinX(start, end));
+
+  chprintf(chp, "chscanf: %U lines/S, %U errors" SHELL_NEWLINE_STR,
+           n, errors);
+}
@@ -0,0 +1,83 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Simulated serial throughput benchmark, the command is invoked from a
+ * shell and transfers data over the same connection:
+ * - "sdbench tx <bytes>" writes the data to the port, the host side must
+ *   drain it, for example:
+ *   (echo "sdbench tx 100000000"; sleep 30) | nc 127.0.0.1 29001 | tail -c 80
+ * - "sdbench rx <bytes>" reads the data from the port, for example:
+ *   (echo "sdbench rx 100000000"; head -c 100000000 /dev/zero; sleep 5) |
+ *   nc 127.0.0.1 29001 | tail -c 80
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+#include "chprintf.h"
+
+#define SDBENCH_BLOCK_SIZE      1024U
+
+void cmd_sdbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  uint8_t buf[SDBENCH_BLOCK_SIZE];
+  size_t total, done;
+  systime_t start;
+  uint32_t ms;
+  bool tx;
+
+  if ((argc != 2) ||
+      ((strcmp(argv[0], "tx") != 0) && (strcmp(argv[0], "rx") != 0))) {
+    chprintf(chp, "Usage: sdbench tx|rx <bytes>" SHELL_NEWLINE_STR);
+    return;
+  }
+  tx = strcmp(argv[0], "tx") == 0;
+  total = (size_t)strtoul(argv[1], NULL, 0);
+  memset(buf, '.', sizeof buf);
+
+  start = chVTGetSystemTime();
+  done = 0U;
+  while (done < total) {
+    size_t n = total - done;
+
+    if (n > sizeof buf) {
+      n = sizeof buf;
+    }
+    if (tx) {
+      n = streamWrite(chp, buf, n);
+    }
+    else {
+      n = streamRead(chp, buf, n);
+    }
+
+    /* Zero means that the queue has been reset on disconnection.*/
+    if (n == 0U) {
+      break;
+    }
+    done += n;
+  }
+  ms = (uint32_t)TIME_I2MS(chVTTimeElapsedSinceX(start));
+  if (ms == 0U) {
+    ms = 1U;
+  }
+
+  chprintf(chp, SHELL_NEWLINE_STR "%s: %U bytes in %U mS, %U KB/S"
+                SHELL_NEWLINE_STR,
+           argv[0], (uint32_t)done, ms, (uint32_t)(done / ms));
+}
@@ -0,0 +1,424 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * SPI driver benchmark, "spibench [<bitrate>]" runs two clients sharing the
+ * simulated SPID1 bus, one polling a sensor and one reading a memory, at
+ * the specified bit rate (default 8000000). The clients first use the
+ * synchronous APIs under spiAcquireBus(), then queue one transaction at a
+ * time and finally keep several transactions in flight.
+ * A last run measures how many bulk memory transactions, chained by their
+ * own callbacks, a periodic sensor transaction has to wait for when queued
+ * in the high priority lane or in the same lane as the bulk transfers.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+#include "chprintf.h"
+
+#if (HAL_USE_SPI == TRUE) && (SPI_USE_QUEUE == TRUE)
+
+#define SPIBENCH_DEFAULT_BITRATE    8000000U
+#define SPIBENCH_OPS                5000U
+#define SPIBENCH_DEPTH              4U
+#define SPIBENCH_MEMORY_SIZE        4096U
+#define SPIBENCH_READ_SIZE          16U
+#define SPIBENCH_BULK_SIZE          256U
+#define SPIBENCH_BULK_DEPTH         8U
+#define SPIBENCH_SAMPLES            200U
+
+#define MEMORY_CMD_READ             0x03U
+#define SENSOR_CMD_SAMPLE           0x10U
+
+/*===========================================================================*/
+/* Device models.                                                            */
+/*===========================================================================*/
+
+/*
+ * Memory with 16 bits addresses, a read command is followed by the address
+ * then the data is shifted out.
+ */
+typedef struct {
+  sim_spi_device_t          dev;
+  uint8_t                   mem[SPIBENCH_MEMORY_SIZE];
+  unsigned                  phase;
+  uint8_t                   cmd;
+  uint16_t                  addr;
+} memory_t;
+
+/*
+ * Sensor taking a sample when selected, the sample sequence number is
+ * shifted out after the command.
+ */
+typedef struct {
+  sim_spi_device_t          dev;
+  uint32_t                  sample;
+  unsigned                  phase;
+} sensor_t;
+
+static void memory_select(sim_spi_device_t *devp) {
+  memory_t *mp = (memory_t *)devp;
+
+  mp->phase = 0U;
+}
+
+static uint8_t memory_exchange(sim_spi_device_t *devp, uint8_t b) {
+  memory_t *mp = (memory_t *)devp;
+
+  switch (mp->phase++) {
+  case 0:
+    mp->cmd = b;
+    return 0xFFU;
+  case 1:
+    mp->addr = (uint16_t)(b << 8);
+    return 0xFFU;
+  case 2:
+    mp->addr |= b;
+    return 0xFFU;
+  default:
+    if (mp->cmd == MEMORY_CMD_READ) {
+      return mp->mem[mp->addr++ % SPIBENCH_MEMORY_SIZE];
+    }
+    return 0xFFU;
+  }
+}
+
+static void sensor_select(sim_spi_device_t *devp) {
+  sensor_t *sp = (sensor_t *)devp;
+
+  sp->sample++;
+  sp->phase = 0U;
+}
+
+static uint8_t sensor_exchange(sim_spi_device_t *devp, uint8_t b) {
+  sensor_t *sp = (sensor_t *)devp;
+  unsigned phase = sp->phase++;
+
+  (void)b;
+  if ((phase >= 1U) && (phase <= 4U)) {
+    return (uint8_t)(sp->sample >> ((phase - 1U) * 8U));
+  }
+  return 0xFFU;
+}
+
+static memory_t memory = {
+  .dev = {memory_select, NULL, memory_exchange}
+};
+static sensor_t sensor = {
+  .dev = {sensor_select, NULL, sensor_exchange}
+};
+
+/*===========================================================================*/
+/* Clients.                                                                  */
+/*===========================================================================*/
+
+typedef enum {
+  MODE_SYNC = 0,
+  MODE_QUEUED = 1,
+  MODE_PIPELINED = 2
+} bench_mode_t;
+
+/*
+ * Client operation, the same transfers are used by all the modes.
+ */
+typedef struct {
+  SPIConfig                 config;
+  uint8_t                   cmd[3];
+  size_t                    cmdsize;
+  uint8_t                   data[SPIBENCH_DEPTH][SPIBENCH_BULK_SIZE];
+  size_t                    datasize;
+  spi_transfer_t            transfers[SPIBENCH_DEPTH][2];
+  spi_transaction_t         txns[SPIBENCH_DEPTH];
+  bool                      (*check)(const uint8_t *p, uint32_t seq);
+  bench_mode_t              mode;
+  uint32_t                  errors;
+} client_t;
+
+static client_t sensor_client, memory_client;
+static THD_WORKING_AREA(wa_client1, 1024);
+static THD_WORKING_AREA(wa_client2, 1024);
+
+static bool sensor_check(const uint8_t *p, uint32_t seq) {
+  uint32_t sample;
+
+  (void)seq;
+  memcpy(&sample, p, sizeof sample);
+  return sample != 0U;
+}
+
+static bool memory_check(const uint8_t *p, uint32_t seq) {
+  unsigned i;
+
+  (void)seq;
+  for (i = 0U; i < SPIBENCH_READ_SIZE; i++) {
+    if (p[i] != (uint8_t)(0x40U + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void client_init(client_t *cp, sim_spi_device_t *devp,
+                        uint32_t bitrate, const uint8_t *cmd, size_t cmdsize,
+                        size_t datasize, unsigned lane,
+                        bool (*check)(const uint8_t *p, uint32_t seq)) {
+  unsigned i;
+
+  memset(cp, 0, sizeof *cp);
+  cp->config.device  = devp;
+  cp->config.bitrate = bitrate;
+  memcpy(cp->cmd, cmd, cmdsize);
+  cp->cmdsize  = cmdsize;
+  cp->datasize = datasize;
+  cp->check    = check;
+  for (i = 0U; i < SPIBENCH_DEPTH; i++) {
+    cp->transfers[i][0] = (spi_transfer_t){SPI_XFER_SELECT, cmdsize,
+                                           cp->cmd, NULL};
+    cp->transfers[i][1] = (spi_transfer_t){SPI_XFER_UNSELECT, datasize,
+                                           NULL, cp->data[i]};
+    cp->txns[i].config    = &cp->config;
+    cp->txns[i].transfers = cp->transfers[i];
+    cp->txns[i].n         = 2U;
+    cp->txns[i].lane      = lane;
+  }
+}
+
+static THD_FUNCTION(client, arg) {
+  client_t *cp = arg;
+  uint32_t seq;
+
+  for (seq = 0U; seq < SPIBENCH_OPS; seq++) {
+    unsigned slot = seq % SPIBENCH_DEPTH;
+
+    switch (cp->mode) {
+    case MODE_SYNC:
+      spiAcquireBus(&SPID1);
+      spiStart(&SPID1, &cp->config);
+      spiSelect(&SPID1);
+      spiSend(&SPID1, cp->cmdsize, cp->cmd);
+      spiReceive(&SPID1, cp->datasize, cp->data[slot]);
+      spiUnselect(&SPID1);
+      spiReleaseBus(&SPID1);
+      break;
+    case MODE_QUEUED:
+      spiQueueTransaction(&SPID1, &cp->txns[slot]);
+      (void) spiWaitTransactionTimeout(&SPID1, &cp->txns[slot],
+                                       TIME_INFINITE);
+      break;
+    default:
+      /* Waiting for the oldest transaction then reusing its slot.*/
+      if (seq >= SPIBENCH_DEPTH) {
+        (void) spiWaitTransactionTimeout(&SPID1, &cp->txns[slot],
+                                         TIME_INFINITE);
+        if (!cp->check(cp->data[slot], seq - SPIBENCH_DEPTH)) {
+          cp->errors++;
+        }
+      }
+      spiQueueTransaction(&SPID1, &cp->txns[slot]);
+      continue;
+    }
+    if (!cp->check(cp->data[slot], seq)) {
+      cp->errors++;
+    }
+  }
+
+  /* Pipelined mode, draining the transactions in flight.*/
+  if (cp->mode == MODE_PIPELINED) {
+    for (seq = SPIBENCH_OPS; seq < SPIBENCH_OPS + SPIBENCH_DEPTH; seq++) {
+      unsigned slot = seq % SPIBENCH_DEPTH;
+
+      (void) spiWaitTransactionTimeout(&SPID1, &cp->txns[slot],
+                                       TIME_INFINITE);
+      if (!cp->check(cp->data[slot], seq - SPIBENCH_DEPTH)) {
+        cp->errors++;
+      }
+    }
+  }
+}
+
+static void clients_bench(BaseSequentialStream *chp, bench_mode_t mode,
+                          uint32_t bitrate) {
+  static const char *names[] = {"sync", "queued", "pipelined"};
+  static const uint8_t sensor_cmd[1] = {SENSOR_CMD_SAMPLE};
+  static const uint8_t memory_cmd[3] = {MEMORY_CMD_READ, 0x00U, 0x40U};
+  thread_t *tp1, *tp2;
+  uint32_t ms, ops, load;
+  uint64_t bits;
+  systime_t start;
+
+  client_init(&sensor_client, &sensor.dev, bitrate, sensor_cmd,
+              sizeof sensor_cmd, 4U, 0U, sensor_check);
+  client_init(&memory_client, &memory.dev, bitrate, memory_cmd,
+              sizeof memory_cmd, SPIBENCH_READ_SIZE, 0U, memory_check);
+  sensor_client.mode = mode;
+  memory_client.mode = mode;
+
+  spiStart(&SPID1, &sensor_client.config);
+  start = chVTGetSystemTime();
+  tp1 = chThdCreateStatic(wa_client1, sizeof wa_client1,
+                          chThdGetPriorityX() - 1, client, &sensor_client);
+  tp2 = chThdCreateStatic(wa_client2, sizeof wa_client2,
+                          chThdGetPriorityX() - 1, client, &memory_client);
+  chThdWait(tp1);
+  chThdWait(tp2);
+  ms = (uint32_t)TIME_I2MS(chVTTimeElapsedSinceX(start));
+  if (ms == 0U) {
+    ms = 1U;
+  }
+  spiStop(&SPID1);
+
+  ops  = 2U * SPIBENCH_OPS;
+  bits = (uint64_t)SPIBENCH_OPS * 8U *
+         (sensor_client.cmdsize + sensor_client.datasize +
+          memory_client.cmdsize + memory_client.datasize);
+  load = bitrate > 0U ? (uint32_t)((bits * 100000U) / ((uint64_t)bitrate * ms))
+                      : 0U;
+
+  chprintf(chp, "%s: %U transactions in %U mS, %U transactions/S, "
+                "%U%% bus load, %U errors" SHELL_NEWLINE_STR,
+           names[mode], ops, ms, (uint32_t)(((uint64_t)ops * 1000U) / ms),
+           load, sensor_client.errors + memory_client.errors);
+}
+
+/*===========================================================================*/
+/* Priority lanes.                                                           */
+/*===========================================================================*/
+
+static SPIConfig bulk_config;
+static uint8_t bulk_cmd[3] = {MEMORY_CMD_READ, 0x00U, 0x00U};
+static uint8_t bulk_data[SPIBENCH_BULK_DEPTH][SPIBENCH_BULK_SIZE];
+static spi_transfer_t bulk_transfers[SPIBENCH_BULK_DEPTH][2];
+static spi_transaction_t bulk_txns[SPIBENCH_BULK_DEPTH];
+static volatile uint32_t bulk_done;
+static volatile bool bulk_stop;
+
+/*
+ * Bulk transactions queue themselves again from the callback, the queue
+ * never empties and no thread is involved.
+ */
+static void bulk_cb(SPIDriver *spip, spi_transaction_t *txnp) {
+
+  bulk_done++;
+  if (!bulk_stop) {
+    spiQueueTransactionI(spip, txnp);
+  }
+}
+
+static void lanes_bench(BaseSequentialStream *chp, unsigned lane,
+                        uint32_t bitrate) {
+  static const uint8_t sensor_cmd[1] = {SENSOR_CMD_SAMPLE};
+  uint32_t i, waited, maxwaited, errors, last;
+  unsigned j;
+
+  client_init(&sensor_client, &sensor.dev, bitrate, sensor_cmd,
+              sizeof sensor_cmd, 4U, lane, sensor_check);
+  bulk_config.device  = &memory.dev;
+  bulk_config.bitrate = bitrate;
+  for (j = 0U; j < SPIBENCH_BULK_DEPTH; j++) {
+    bulk_transfers[j][0] = (spi_transfer_t){SPI_XFER_SELECT, sizeof bulk_cmd,
+                                            bulk_cmd, NULL};
+    bulk_transfers[j][1] = (spi_transfer_t){SPI_XFER_UNSELECT,
+                                            SPIBENCH_BULK_SIZE,
+                                            NULL, bulk_data[j]};
+    bulk_txns[j] = (spi_transaction_t){.config    = &bulk_config,
+                                       .transfers = bulk_transfers[j],
+                                       .n         = 2U,
+                                       .lane      = SPI_QUEUE_LANES - 1U,
+                                       .end_cb    = bulk_cb};
+  }
+  bulk_done = 0U;
+  bulk_stop = false;
+
+  spiStart(&SPID1, &bulk_config);
+  for (j = 0U; j < SPIBENCH_BULK_DEPTH; j++) {
+    spiQueueTransaction(&SPID1, &bulk_txns[j]);
+  }
+
+  waited = 0U;
+  maxwaited = 0U;
+  errors = 0U;
+  last = 0U;
+  for (i = 0U; i < SPIBENCH_SAMPLES; i++) {
+    spi_transaction_t *txnp = &sensor_client.txns[0];
+    uint32_t before, sample, n;
+
+    chThdSleepMilliseconds(1);
+    before = bulk_done;
+    spiQueueTransaction(&SPID1, txnp);
+    (void) spiWaitTransactionTimeout(&SPID1, txnp, TIME_INFINITE);
+    n = bulk_done - before;
+    waited += n;
+    if (n > maxwaited) {
+      maxwaited = n;
+    }
+    memcpy(&sample, sensor_client.data[0], sizeof sample);
+    if (sample <= last) {
+      errors++;
+    }
+    last = sample;
+  }
+
+  bulk_stop = true;
+  for (j = 0U; j < SPIBENCH_BULK_DEPTH; j++) {
+    (void) spiWaitTransactionTimeout(&SPID1, &bulk_txns[j], TIME_INFINITE);
+  }
+  spiStop(&SPID1);
+
+  chprintf(chp, "lane %u: %U samples, %U.%02U bulk transactions waited on "
+                "average, %U max, %U bulk, %U errors" SHELL_NEWLINE_STR,
+           lane, SPIBENCH_SAMPLES, waited / SPIBENCH_SAMPLES,
+           ((waited % SPIBENCH_SAMPLES) * 100U) / SPIBENCH_SAMPLES,
+           maxwaited, bulk_done, errors);
+}
+
+void cmd_spibench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  uint32_t bitrate = SPIBENCH_DEFAULT_BITRATE;
+  unsigned i;
+
+  if (argc > 1) {
+    chprintf(chp, "Usage: spibench [<bitrate>]" SHELL_NEWLINE_STR);
+    return;
+  }
+  if (argc >= 1) {
+    bitrate = (uint32_t)strtoul(argv[0], NULL, 0);
+  }
+
+  for (i = 0U; i < SPIBENCH_MEMORY_SIZE; i++) {
+    memory.mem[i] = (uint8_t)i;
+  }
+
+  clients_bench(chp, MODE_SYNC, bitrate);
+  clients_bench(chp, MODE_QUEUED, bitrate);
+  clients_bench(chp, MODE_PIPELINED, bitrate);
+  lanes_bench(chp, 0U, bitrate);
+  lanes_bench(chp, SPI_QUEUE_LANES - 1U, bitrate);
+}
+
+#else /* !((HAL_USE_SPI == TRUE) && (SPI_USE_QUEUE == TRUE)) */
+
+void cmd_spibench(BaseSequentialStream *chp, int argc, char *argv[]) {
+
+  (void)argc;
+  (void)argv;
+  chprintf(chp, "spibench requires HAL_USE_SPI and SPI_USE_QUEUE"
+                SHELL_NEWLINE_STR);
+}
+
+#endif /* !((HAL_USE_SPI == TRUE) && (SPI_USE_QUEUE == TRUE)) */
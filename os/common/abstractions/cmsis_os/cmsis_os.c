@@ -55,6 +55,9 @@ static semaphore_t semaphores[CMSIS_CFG_NUM_SEMAPHORES];
 static memory_pool_t timpool;
 static struct os_timer_cb timers[CMSIS_CFG_NUM_TIMERS];
 
+static swtimers_service_t timsrv;
+static THD_WORKING_AREA(timsrv_wa, CMSIS_CFG_TIMERS_STACK);
+
 /*===========================================================================*/
 /* Module local functions.                                                   */
 /*===========================================================================*/
@@ -67,17 +70,26 @@ __STATIC_INLINE sysinterval_t tmo(uint32_t millisec) {
 }
 
 /**
- * @brief   Virtual timers common callback.
+ * @brief   Software timers common callback.
+ * @note    Periodic timers are re-armed by the timers service.
  */
-static void timer_cb(void const *arg) {
+static void timer_cb(void *arg) {
 
   osTimerId timer_id = (osTimerId)arg;
   timer_id->ptimer(timer_id->argument);
-  if (timer_id->type == osTimerPeriodic) {
-    chSysLockFromISR();
-    chVTDoSetI(&timer_id->vt, TIME_MS2I(timer_id->millisec),
-               (vtfunc_t)timer_cb, timer_id);
-    chSysUnlockFromISR();
+}
+
+/**
+ * @brief   Timers service thread.
+ */
+static THD_FUNCTION(timsrv_thread, arg) {
+
+  (void)arg;
+
+  chRegSetThreadName("timers");
+
+  while (true) {
+    (void) chSwtDispatch(&timsrv);
   }
 }
 
@@ -104,6 +116,10 @@ osStatus osKernelInitialize(void) {
   chPoolObjectInit(&timpool, sizeof(struct os_timer_cb), chCoreAllocAlignedI);
   chPoolLoadArray(&timpool, timers, CMSIS_CFG_NUM_TIMERS);
 
+  chSwtServiceObjectInit(&timsrv, CMSIS_CFG_TIMERS_RESOLUTION);
+  (void) chThdCreateStatic(timsrv_wa, sizeof timsrv_wa,
+                           CMSIS_CFG_TIMERS_PRIO, timsrv_thread, NULL);
+
   return osOK;
 }
 
@@ -250,7 +266,10 @@ osTimerId osTimerCreate(const osTimerDef_t *timer_def,
   }
 
   osTimerId timer = chPoolAlloc(&timpool);
-  chVTObjectInit(&timer->vt);
+  if (timer == NULL) {
+    return NULL;
+  }
+  chSwtObjectInit(&timer->st);
   timer->ptimer = timer_def->ptimer;
   timer->type = type;
   timer->argument = argument;
@@ -285,7 +304,9 @@ osStatus osTimerStart(osTimerId timer_id, uint32_t millisec) {
   }
 
   timer_id->millisec = millisec;
-  chVTSet(&timer_id->vt, TIME_MS2I(millisec), (vtfunc_t)timer_cb, timer_id);
+  chSwtSet(&timsrv, &timer_id->st, TIME_MS2I(millisec),
+           timer_id->type == osTimerPeriodic ? TIME_MS2I(millisec) : 0,
+           timer_cb, timer_id);
 
   return osOK;
 }
@@ -311,11 +332,16 @@ osStatus osTimerStop(osTimerId timer_id) {
     return osErrorISR;
   }
 
-  if (chVTIsArmed(&timer_id->vt) == false) {
+  chSysLock();
+
+  if (chSwtIsArmedI(&timer_id->st) == false) {
+    chSysUnlock();
     return osErrorResource;
   }
 
-  chVTReset(&timer_id->vt);
+  chSwtResetI(&timsrv, &timer_id->st);
+
+  chSysUnlock();
 
   return osOK;
 }
@@ -340,7 +366,7 @@ osStatus osTimerDelete(osTimerId timer_id) {
     return osErrorISR;
   }
 
-  chVTReset(&timer_id->vt);
+  chSwtReset(&timsrv, &timer_id->st);
   chPoolFree(&timpool, (void *)timer_id);
 
   return osOK;
@@ -840,7 +866,7 @@ void *osMailCAlloc(osMailQId queue_id, uint32_t millisec) {
   }
 
   if (mail != NULL) {
-    memset(mail, 0, queue_id->free.pool.object_size);
+    memset(mail, 0, chFifoGetObjectSizeX(queue_id));
   }
 
   return mail;
@@ -103,6 +103,27 @@
 #define CMSIS_CFG_NUM_TIMERS        4
 #endif
 
+/**
+ * @brief   Resolution of the timers service.
+ */
+#if !defined(CMSIS_CFG_TIMERS_RESOLUTION)
+#define CMSIS_CFG_TIMERS_RESOLUTION TIME_MS2I(1)
+#endif
+
+/**
+ * @brief   Stack size of the timers service thread.
+ */
+#if !defined(CMSIS_CFG_TIMERS_STACK)
+#define CMSIS_CFG_TIMERS_STACK      256
+#endif
+
+/**
+ * @brief   Priority of the timers service thread.
+ */
+#if !defined(CMSIS_CFG_TIMERS_PRIO)
+#define CMSIS_CFG_TIMERS_PRIO       (NORMALPRIO + osPriorityHigh)
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -131,6 +152,10 @@
 #error "CMSIS RTOS requires CH_CFG_USE_DYNAMIC"
 #endif
 
+#if CH_CFG_USE_SWTIMERS == FALSE
+#error "CMSIS RTOS requires CH_CFG_USE_SWTIMERS"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -197,7 +222,7 @@ typedef thread_t *osThreadId;
  * @brief   Type of pointer to timer control block.
  */
 typedef struct os_timer_cb {
-  virtual_timer_t           vt;
+  swtimer_t                 st;
   os_timer_type             type;
   os_ptimer                 ptimer;
   void                      *argument;
@@ -66,6 +66,10 @@
 #error "NASA OSAL requires CH_CFG_USE_HEAP"
 #endif
 
+#if CH_CFG_USE_SWTIMERS == FALSE
+#error "NASA OSAL requires CH_CFG_USE_SWTIMERS"
+#endif
+
 /*===========================================================================*/
 /* Module local definitions.                                                 */
 /*===========================================================================*/
@@ -79,6 +83,27 @@
 #define MIN_QUEUE_DEPTH     1
 #define MAX_QUEUE_DEPTH     16384
 
+/**
+ * @brief   Resolution of the timers service.
+ */
+#if !defined(OSAL_TIMERS_RESOLUTION)
+#define OSAL_TIMERS_RESOLUTION      TIME_MS2I(1)
+#endif
+
+/**
+ * @brief   Stack size of the timers service thread.
+ */
+#if !defined(OSAL_TIMERS_STACK)
+#define OSAL_TIMERS_STACK           512
+#endif
+
+/**
+ * @brief   Priority of the timers service thread.
+ */
+#if !defined(OSAL_TIMERS_PRIO)
+#define OSAL_TIMERS_PRIO            HIGHPRIO
+#endif
+
 /*===========================================================================*/
 /* Module exported variables.                                                */
 /*===========================================================================*/
@@ -101,7 +126,7 @@ typedef struct {
   OS_TimerCallback_t    callback_ptr;
   uint32                start_time;
   uint32                interval_time;
-  virtual_timer_t       vt;
+  swtimer_t             st;
 } osal_timer_t;
 
 /**
@@ -135,6 +160,7 @@ typedef struct {
   int (*printf)(const char *fmt, ...);
   virtual_timer_t       vt;
   OS_time_t             localtime;
+  swtimers_service_t    timers_service;
   memory_pool_t         timers_pool;
   memory_pool_t         queues_pool;
   memory_pool_t         binary_semaphores_pool;
@@ -153,6 +179,8 @@ typedef struct {
 
 static osal_t osal;
 
+static THD_WORKING_AREA(timers_wa, OSAL_TIMERS_STACK);
+
 /*===========================================================================*/
 /* Module local functions.                                                   */
 /*===========================================================================*/
@@ -174,19 +202,27 @@ static void systime_update(void *p) {
 }
 
 /**
- * @brief   Virtual timers callback.
+ * @brief   Software timers callback.
+ * @note    Periodic timers are re-armed by the timers service.
  */
 static void timer_handler(void *p) {
   osal_timer_t *otp = (osal_timer_t *)p;
 
   /* Real callback.*/
   otp->callback_ptr((uint32)p);
+}
 
-  /* Timer restart if an interval is defined.*/
-  if (otp->interval_time != 0) {
-    chSysLockFromISR();
-    chVTSetI(&otp->vt, TIME_US2I(otp->interval_time), timer_handler, p);
-    chSysUnlockFromISR();
+/**
+ * @brief   Timers service thread.
+ */
+static THD_FUNCTION(timers_thread, arg) {
+
+  (void)arg;
+
+  chRegSetThreadName("timers");
+
+  while (true) {
+    (void) chSwtDispatch(&osal.timers_service);
   }
 }
 
@@ -270,6 +306,12 @@ int32 OS_API_Init(void) {
   chVTObjectInit(&osal.vt);
   chVTSet(&osal.vt, TIME_MS2I(1), systime_update, (void *)TIME_MS2I(1));
 
+  /* Timers service initialization, application timers callbacks are
+     invoked by the service thread.*/
+  chSwtServiceObjectInit(&osal.timers_service, OSAL_TIMERS_RESOLUTION);
+  (void) chThdCreateStatic(timers_wa, sizeof timers_wa,
+                           OSAL_TIMERS_PRIO, timers_thread, NULL);
+
   /* Timers pool initialization.*/
   chPoolObjectInit(&osal.timers_pool,
                    sizeof (osal_timer_t),
@@ -481,14 +523,14 @@ int32 OS_TimerCreate(uint32 *timer_id, const char *timer_name,
   }
 
   strncpy(otp->name, timer_name, OS_MAX_API_NAME - 1);
-  chVTObjectInit(&otp->vt);
+  chSwtObjectInit(&otp->st);
   otp->start_time    = 0;
   otp->interval_time = 0;
   otp->callback_ptr  = callback_ptr;
   otp->is_free       = 0;   /* Note, last.*/
 
   *timer_id = (uint32)otp;
-  *clock_accuracy = (uint32)(1000000 / CH_CFG_ST_FREQUENCY);
+  *clock_accuracy = (uint32)TIME_I2US(OSAL_TIMERS_RESOLUTION);
 
   return OS_SUCCESS;
 }
@@ -517,7 +559,7 @@ int32 OS_TimerDelete(uint32 timer_id) {
   otp->is_free = 1;
 
   /* Resetting the timer.*/
-  chVTResetI(&otp->vt);
+  chSwtResetI(&osal.timers_service, &otp->st);
   otp->start_time    = 0;
   otp->interval_time = 0;
 
@@ -555,12 +597,14 @@ int32 OS_TimerSet(uint32 timer_id, uint32 start_time, uint32 interval_time) {
   sts = chSysGetStatusAndLockX();
 
   if (start_time == 0) {
-    chVTResetI(&otp->vt);
+    chSwtResetI(&osal.timers_service, &otp->st);
   }
   else {
     otp->start_time    = start_time;
     otp->interval_time = interval_time;
-    chVTSetI(&otp->vt, TIME_US2I(start_time), timer_handler, (void *)timer_id);
+    chSwtSetI(&osal.timers_service, &otp->st,
+              TIME_US2I(start_time), TIME_US2I(interval_time),
+              timer_handler, (void *)timer_id);
   }
 
   /* Leaving the critical zone.*/
@@ -639,7 +683,7 @@ int32 OS_TimerGetInfo(uint32 timer_id, OS_timer_prop_t *timer_prop) {
   timer_prop->creator       = (uint32)0;
   timer_prop->start_time    = otp->start_time;
   timer_prop->interval_time = otp->interval_time;
-  timer_prop->accuracy      = (uint32)(1000000 / CH_CFG_ST_FREQUENCY);
+  timer_prop->accuracy      = (uint32)TIME_I2US(OSAL_TIMERS_RESOLUTION);
 
   /* Leaving the critical zone.*/
   chSysRestoreStatusX(sts);
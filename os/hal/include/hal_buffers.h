@@ -121,6 +121,11 @@ struct io_buffers_queue {
    * @brief   Boundary for R/W sequential access.
    */
   uint8_t               *top;
+  /**
+   * @brief   Current buffer lent to the application.
+   * @note    While set the current buffer is not flushed automatically.
+   */
+  bool                  borrowed;
   /**
    * @brief   Data notification callback.
    */
@@ -318,6 +323,9 @@ extern "C" {
   msg_t ibqGetTimeout(input_buffers_queue_t *ibqp, sysinterval_t timeout);
   size_t ibqReadTimeout(input_buffers_queue_t *ibqp, uint8_t *bp,
                         size_t n, sysinterval_t timeout);
+  size_t ibqBorrowTimeout(input_buffers_queue_t *ibqp, uint8_t **pp,
+                          sysinterval_t timeout);
+  void ibqReturn(input_buffers_queue_t *ibqp, size_t n);
   void obqObjectInit(output_buffers_queue_t *obqp, bool suspended, uint8_t *bp,
                      size_t size, size_t n, bqnotify_t onfy, void *link);
   void obqResetI(output_buffers_queue_t *obqp);
@@ -334,6 +342,9 @@ extern "C" {
                       sysinterval_t timeout);
   size_t obqWriteTimeout(output_buffers_queue_t *obqp, const uint8_t *bp,
                          size_t n, sysinterval_t timeout);
+  size_t obqBorrowTimeout(output_buffers_queue_t *obqp, uint8_t **pp,
+                          sysinterval_t timeout);
+  void obqReturn(output_buffers_queue_t *obqp, size_t n);
   bool obqTryFlushI(output_buffers_queue_t *obqp);
   void obqFlush(output_buffers_queue_t *obqp);
 #ifdef __cplusplus
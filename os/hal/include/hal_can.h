@@ -62,6 +62,30 @@
  */
 #define CAN_ANY_MAILBOX             0U
 
+/**
+ * @name    Software filters identifiers encoding
+ * @{
+ */
+/**
+ * @brief   Extended identifier flag.
+ */
+#define CAN_SW_FILTER_IDE           0x20000000U
+/**
+ * @brief   Mask matching the whole identifier, filters using this mask
+ *          are looked up through the hash table.
+ */
+#define CAN_SW_FILTER_MASK_ALL      0x3FFFFFFFU
+/**
+ * @brief   Encodes a standard identifier.
+ */
+#define CAN_SW_FILTER_STD(id)       ((uint32_t)(id) & 0x7FFU)
+/**
+ * @brief   Encodes an extended identifier.
+ */
+#define CAN_SW_FILTER_EXT(id)       (((uint32_t)(id) & 0x1FFFFFFFU) |       \
+                                     CAN_SW_FILTER_IDE)
+/** @} */
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -86,12 +110,51 @@
 #if !defined(CAN_ENFORCE_USE_CALLBACKS) || defined(__DOXYGEN__)
 #define CAN_ENFORCE_USE_CALLBACKS   FALSE
 #endif
+
+/**
+ * @brief   Enables the software receive queues.
+ * @details If enabled the receive ISR moves the frames from the receive
+ *          mailboxes into a software ring for each mailbox, the frames are
+ *          checked against the software acceptance filters before being
+ *          queued.
+ */
+#if !defined(CAN_USE_RX_QUEUES) || defined(__DOXYGEN__)
+#define CAN_USE_RX_QUEUES           FALSE
+#endif
+
+/**
+ * @brief   Size of each software receive ring.
+ * @note    Must be a power of two.
+ */
+#if !defined(CAN_RX_QUEUE_SIZE) || defined(__DOXYGEN__)
+#define CAN_RX_QUEUE_SIZE           16
+#endif
+
+/**
+ * @brief   Size of the exact identifiers hash table of the software filters.
+ * @note    Must be a power of two.
+ */
+#if !defined(CAN_SW_FILTERS_HASH_SIZE) || defined(__DOXYGEN__)
+#define CAN_SW_FILTERS_HASH_SIZE    32
+#endif
 /** @} */
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if (CAN_USE_RX_QUEUES == TRUE) || defined(__DOXYGEN__)
+#if (CAN_RX_QUEUE_SIZE < 2) ||                                              \
+    ((CAN_RX_QUEUE_SIZE & (CAN_RX_QUEUE_SIZE - 1)) != 0)
+#error "CAN_RX_QUEUE_SIZE must be a power of two"
+#endif
+
+#if (CAN_SW_FILTERS_HASH_SIZE < 1) ||                                       \
+    ((CAN_SW_FILTERS_HASH_SIZE & (CAN_SW_FILTERS_HASH_SIZE - 1)) != 0)
+#error "CAN_SW_FILTERS_HASH_SIZE must be a power of two"
+#endif
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -108,6 +171,48 @@ typedef enum {
   CAN_SLEEP = 5                             /**< Sleep state.               */
 } canstate_t;
 
+/**
+ * @brief   Software acceptance filter.
+ * @details A frame is accepted if its identifier, encoded using
+ *          @p CAN_SW_FILTER_STD() or @p CAN_SW_FILTER_EXT(), masked by
+ *          @p mask is equal to @p id masked by @p mask.
+ */
+typedef struct {
+  /**
+   * @brief   Encoded identifier.
+   */
+  uint32_t                  id;
+  /**
+   * @brief   Identifier mask.
+   */
+  uint32_t                  mask;
+} can_sw_filter_t;
+
+#if (CAN_USE_RX_QUEUES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Software receive queues fields.
+ * @note    This macro is part of the mandatory fields of the LLD
+ *          @p CANDriver structure.
+ */
+#define _can_rx_queues_data                                                 \
+  /* Receive rings, one for each receive mailbox.*/                         \
+  CANRxFrame                rxring[CAN_RX_MAILBOXES][CAN_RX_QUEUE_SIZE];    \
+  /* Rings read counters.*/                                                 \
+  uint32_t                  rxrdcnt[CAN_RX_MAILBOXES];                      \
+  /* Rings write counters.*/                                                \
+  uint32_t                  rxwrcnt[CAN_RX_MAILBOXES];                      \
+  /* Software filters array or NULL.*/                                      \
+  const can_sw_filter_t     *swfilters;                                     \
+  /* Number of software filters.*/                                          \
+  size_t                    swnfilters;                                     \
+  /* Number of software filters with a partial mask.*/                      \
+  size_t                    swmasked;                                       \
+  /* Exact identifiers hash table.*/                                        \
+  uint32_t                  swhash[CAN_SW_FILTERS_HASH_SIZE];
+#else
+#define _can_rx_queues_data
+#endif
+
 #include "hal_can_lld.h"
 
 /*===========================================================================*/
@@ -158,12 +263,16 @@ typedef enum {
 /**
  * @brief   RX mailbox empty full event.
  */
+#if (CAN_USE_RX_QUEUES == FALSE) || defined(__DOXYGEN__)
 #define _can_rx_full_isr(canp, flags) {                                     \
   osalSysLockFromISR();                                                     \
   osalThreadDequeueAllI(&(canp)->rxqueue, MSG_OK);                          \
   osalEventBroadcastFlagsI(&(canp)->rxfull_event, flags);                   \
   osalSysUnlockFromISR();                                                   \
 }
+#else
+#define _can_rx_full_isr(canp, flags) _can_rx_queues_isr(canp, flags)
+#endif
 
 /**
  * @brief   Wakeup event.
@@ -192,6 +301,7 @@ typedef enum {
   osalSysUnlockFromISR();                                                   \
 }
 
+#if CAN_USE_RX_QUEUES == FALSE
 #define _can_rx_full_isr(canp, flags) {                                     \
   if ((canp)->rxfull_cb != NULL) {                                          \
     (canp)->rxfull_cb(canp, flags);                                         \
@@ -200,6 +310,9 @@ typedef enum {
   osalThreadDequeueAllI(&(canp)->rxqueue, MSG_OK);                          \
   osalSysUnlockFromISR();                                                   \
 }
+#else
+#define _can_rx_full_isr(canp, flags) _can_rx_queues_isr(canp, flags)
+#endif
 
 #define _can_wakeup_isr(canp) {                                             \
   if ((canp)->wakeup_cb != NULL) {                                          \
@@ -246,6 +359,17 @@ extern "C" {
   void canSleep(CANDriver *canp);
   void canWakeup(CANDriver *canp);
 #endif
+#if CAN_USE_RX_QUEUES == TRUE
+  size_t canReceiveBatch(CANDriver *canp,
+                         canmbx_t mailbox,
+                         CANRxFrame *crfp,
+                         size_t n,
+                         sysinterval_t timeout);
+  bool canSetSoftwareFilters(CANDriver *canp,
+                             const can_sw_filter_t *filters,
+                             size_t n);
+  void _can_rx_queues_isr(CANDriver *canp, uint32_t flags);
+#endif
 #ifdef __cplusplus
 }
 #endif
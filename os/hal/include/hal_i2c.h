@@ -62,6 +62,14 @@
 #define I2C_USE_MUTUAL_EXCLUSION    TRUE
 #endif
 
+/**
+ * @brief   Enables the asynchronous batches queue APIs.
+ * @note    Requires support from the low level driver.
+ */
+#if !defined(I2C_USE_QUEUE) || defined(__DOXYGEN__)
+#define I2C_USE_QUEUE               FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -82,8 +90,161 @@ typedef enum {
   I2C_LOCKED = 5                            /**< @brief Bus locked.         */
 } i2cstate_t;
 
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of an I2C transaction descriptor.
+ */
+typedef struct hal_i2c_transaction i2c_transaction_t;
+
+/**
+ * @brief   Type of an I2C transactions batch.
+ */
+typedef struct hal_i2c_batch i2c_batch_t;
+
+/**
+ * @brief   Batches queue fields.
+ * @note    This macro is part of the mandatory fields of the LLD
+ *          @p I2CDriver structure.
+ */
+#define _i2c_queue_data                                                     \
+  /* Batch being executed or NULL.*/                                        \
+  i2c_batch_t               *batch;                                         \
+  /* First queued batch.*/                                                  \
+  i2c_batch_t               *qhead;                                         \
+  /* Last queued batch.*/                                                   \
+  i2c_batch_t               *qtail;
+#else
+#define _i2c_queue_data
+#endif
+
 #include "hal_i2c_lld.h"
 
+#if !defined(I2C_SUPPORTS_QUEUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Asynchronous transfers support in the low level driver.
+ */
+#define I2C_SUPPORTS_QUEUE          FALSE
+#endif
+
+#if (I2C_USE_QUEUE == TRUE) && (I2C_SUPPORTS_QUEUE == FALSE)
+#error "I2C_USE_QUEUE not supported by the I2C low level driver"
+#endif
+
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Batch state machine possible states.
+ */
+typedef enum {
+  I2C_BATCH_IDLE = 0,                       /**< @brief Never queued.       */
+  I2C_BATCH_QUEUED = 1,                     /**< @brief Waiting.            */
+  I2C_BATCH_ACTIVE = 2,                     /**< @brief Being executed.     */
+  I2C_BATCH_DONE = 3                        /**< @brief Completed.          */
+} i2cbatchstate_t;
+
+/**
+ * @brief   I2C transaction notification callback type.
+ * @note    The callback is invoked in locked state.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] txnp      pointer to the completed transaction
+ */
+typedef void (*i2ctxncallback_t)(I2CDriver *i2cp, i2c_transaction_t *txnp);
+
+/**
+ * @brief   Structure representing an I2C transaction descriptor.
+ * @details A transaction optionally writes @p txbytes bytes then, after a
+ *          repeated start, reads @p rxbytes bytes.
+ */
+struct hal_i2c_transaction {
+  /**
+   * @brief   Slave address.
+   */
+  i2caddr_t                 addr;
+  /**
+   * @brief   Transmit buffer or @p NULL.
+   */
+  const uint8_t             *txbuf;
+  /**
+   * @brief   Number of bytes to be transmitted, can be zero.
+   */
+  size_t                    txbytes;
+  /**
+   * @brief   Receive buffer or @p NULL.
+   */
+  uint8_t                   *rxbuf;
+  /**
+   * @brief   Number of bytes to be received, can be zero.
+   */
+  size_t                    rxbytes;
+  /**
+   * @brief   Completion callback or @p NULL.
+   */
+  i2ctxncallback_t          end_cb;
+  /* End of the user fields.*/
+  /**
+   * @brief   Transaction result, @p MSG_OK, @p MSG_RESET in case of
+   *          errors or @p MSG_TIMEOUT if aborted by a timeout.
+   */
+  msg_t                     result;
+  /**
+   * @brief   Error flags of the transaction.
+   */
+  i2cflags_t                errors;
+};
+
+/**
+ * @brief   Structure representing an I2C transactions batch.
+ * @details The transactions of a batch are executed back to back from the
+ *          driver ISR, the batch completion is notified once for all of
+ *          them.
+ * @note    The fields after the user fields must be zero before the first
+ *          use, static or designated initializers take care of this.
+ */
+struct hal_i2c_batch {
+  /**
+   * @brief   Transactions array.
+   */
+  i2c_transaction_t         *txns;
+  /**
+   * @brief   Number of transactions in the array.
+   */
+  size_t                    n;
+  /**
+   * @brief   Event source broadcast on completion or @p NULL.
+   */
+  event_source_t            *event;
+  /**
+   * @brief   Flags broadcast with @p event.
+   */
+  eventflags_t              flags;
+  /* End of the user fields.*/
+  /**
+   * @brief   Batch state.
+   */
+  volatile i2cbatchstate_t  state;
+  /**
+   * @brief   Index of the transaction being executed.
+   */
+  size_t                    index;
+  /**
+   * @brief   Number of failed transactions.
+   */
+  size_t                    failed;
+  /**
+   * @brief   Batch result, valid when completed.
+   */
+  msg_t                     result;
+  /**
+   * @brief   Next queued batch.
+   */
+  i2c_batch_t               *next;
+  /**
+   * @brief   Thread waiting for the batch completion.
+   */
+  thread_reference_t        thread;
+};
+#endif /* I2C_USE_QUEUE == TRUE */
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
@@ -95,11 +256,24 @@ typedef enum {
  *
  * @notapi
  */
+#if (I2C_USE_QUEUE == FALSE) || defined(__DOXYGEN__)
 #define _i2c_wakeup_isr(i2cp) do {                                          \
   osalSysLockFromISR();                                                     \
   osalThreadResumeI(&(i2cp)->thread, MSG_OK);                               \
   osalSysUnlockFromISR();                                                   \
 } while (0)
+#else
+#define _i2c_wakeup_isr(i2cp) do {                                          \
+  osalSysLockFromISR();                                                     \
+  if ((i2cp)->batch != NULL) {                                              \
+    _i2c_queue_isr_i(i2cp, MSG_OK);                                         \
+  }                                                                         \
+  else {                                                                    \
+    osalThreadResumeI(&(i2cp)->thread, MSG_OK);                             \
+  }                                                                         \
+  osalSysUnlockFromISR();                                                   \
+} while (0)
+#endif
 
 /**
  * @brief   Wakes up the waiting thread notifying errors.
@@ -108,11 +282,24 @@ typedef enum {
  *
  * @notapi
  */
+#if (I2C_USE_QUEUE == FALSE) || defined(__DOXYGEN__)
 #define _i2c_wakeup_error_isr(i2cp) do {                                    \
   osalSysLockFromISR();                                                     \
   osalThreadResumeI(&(i2cp)->thread, MSG_RESET);                            \
   osalSysUnlockFromISR();                                                   \
 } while (0)
+#else
+#define _i2c_wakeup_error_isr(i2cp) do {                                    \
+  osalSysLockFromISR();                                                     \
+  if ((i2cp)->batch != NULL) {                                              \
+    _i2c_queue_isr_i(i2cp, MSG_RESET);                                      \
+  }                                                                         \
+  else {                                                                    \
+    osalThreadResumeI(&(i2cp)->thread, MSG_RESET);                          \
+  }                                                                         \
+  osalSysUnlockFromISR();                                                   \
+} while (0)
+#endif
 
 /**
  * @brief   Wrap i2cMasterTransmitTimeout function with TIME_INFINITE timeout.
@@ -154,6 +341,13 @@ extern "C" {
   void i2cAcquireBus(I2CDriver *i2cp);
   void i2cReleaseBus(I2CDriver *i2cp);
 #endif
+#if I2C_USE_QUEUE == TRUE
+  void i2cQueueBatchI(I2CDriver *i2cp, i2c_batch_t *bp);
+  void i2cQueueBatch(I2CDriver *i2cp, i2c_batch_t *bp);
+  msg_t i2cWaitBatchTimeout(I2CDriver *i2cp, i2c_batch_t *bp,
+                            sysinterval_t timeout);
+  void _i2c_queue_isr_i(I2CDriver *i2cp, msg_t msg);
+#endif
 
 #ifdef __cplusplus
 }
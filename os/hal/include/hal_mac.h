@@ -39,7 +39,7 @@
  * @{
  */
 /**
- * @brief   Enables an event sources for incoming packets.
+ * @brief   Enables the zero-copy API.
  */
 #if !defined(MAC_USE_ZERO_COPY) || defined(__DOXYGEN__)
 #define MAC_USE_ZERO_COPY           FALSE
@@ -75,8 +75,26 @@ typedef enum {
  */
 typedef struct MACDriver MACDriver;
 
+/**
+ * @brief   Type of a transmit buffer release callback.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] ref       reference passed to @p macAttachTransmitBuffer()
+ */
+typedef void (*macbufcb_t)(MACDriver *macp, void *ref);
+
 #include "hal_mac_lld.h"
 
+/**
+ * @brief   Support for buffer references.
+ * @details Drivers setting this capability can transmit frames directly
+ *          from application buffers and allow receive descriptors to be
+ *          kept and released later, in any order and from any thread.
+ */
+#if !defined(MAC_SUPPORTS_BUFFER_REFERENCES) || defined(__DOXYGEN__)
+#define MAC_SUPPORTS_BUFFER_REFERENCES      FALSE
+#endif
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
@@ -86,7 +104,7 @@ typedef struct MACDriver MACDriver;
  * @{
  */
 /**
- * @brief   Enables the zero-copy API.
+ * @brief   Returns the receive event source.
  *
  * @param[in] macp      pointer to the @p MACDriver object
  * @return              The pointer to the @p EventSource structure.
@@ -167,6 +185,33 @@ typedef struct MACDriver MACDriver;
  */
 #define macGetNextReceiveBuffer(rdp, sizep)                                 \
   mac_lld_get_next_receive_buffer(rdp, sizep)
+
+#if (MAC_SUPPORTS_BUFFER_REFERENCES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Appends an application buffer to a transmit descriptor.
+ * @details The buffer is transmitted in place, it must not be modified
+ *          until the MAC gives it back through the @p txrelease_cb
+ *          configuration callback.
+ * @note    If the buffer cannot be appended then all the data previously
+ *          added to the descriptor is discarded, the frame can then be
+ *          composed again using @p macWriteTransmitDescriptor().
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] buf       pointer to the buffer to be transmitted
+ * @param[in] size      size of the buffer
+ * @param[in] ref       reference passed to the release callback once
+ *                      the frame has been transmitted, @p NULL if no
+ *                      notification is required for this buffer
+ * @return              The operation result.
+ * @retval true         if the buffer has been appended.
+ * @retval false        if the frame size or the number of buffers per
+ *                      frame would be exceeded.
+ *
+ * @api
+ */
+#define macAttachTransmitBuffer(tdp, buf, size, ref)                        \
+  mac_lld_attach_transmit_buffer(tdp, buf, size, ref)
+#endif
 #endif /* MAC_USE_ZERO_COPY */
 /** @} */
 
@@ -191,6 +236,9 @@ extern "C" {
                                  sysinterval_t timeout);
   void macReleaseReceiveDescriptor(MACReceiveDescriptor *rdp);
   bool macPollLinkStatus(MACDriver *macp);
+#if (MAC_USE_ZERO_COPY == TRUE) && (MAC_SUPPORTS_BUFFER_REFERENCES == TRUE)
+  void macReclaimTransmitBuffers(MACDriver *macp);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -40,6 +40,11 @@
 #define Q_FULL          MSG_TIMEOUT /**< @brief Queue full,                 */
 /** @} */
 
+/**
+ * @brief   No input wakeup delimiter.
+ */
+#define IQ_NO_DELIMITER ((msg_t)-1)
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -82,6 +87,13 @@ struct io_queue {
   uint8_t               *q_rdptr;   /**< @brief Read pointer.               */
   qnotify_t             q_notify;   /**< @brief Data notification callback. */
   void                  *q_link;    /**< @brief Application defined field.  */
+  size_t                q_wakeup;   /**< @brief Input wakeup threshold.     */
+  size_t                q_wanted;   /**< @brief Input bytes awaited by the
+                                         reader, shared by all the
+                                         waiting readers.                   */
+  msg_t                 q_delim;    /**< @brief Input wakeup delimiter.     */
+  sysinterval_t         q_idle;     /**< @brief Input wakeup idle gap.      */
+  systime_t             q_stamp;    /**< @brief Time of the last input.     */
 };
 
 /**
@@ -302,7 +314,10 @@ extern "C" {
   void iqObjectInit(input_queue_t *iqp, uint8_t *bp, size_t size,
                     qnotify_t infy, void *link);
   void iqResetI(input_queue_t *iqp);
+  void iqSetWakeupI(input_queue_t *iqp, size_t threshold,
+                    msg_t delimiter, sysinterval_t idle);
   msg_t iqPutI(input_queue_t *iqp, uint8_t b);
+  size_t iqWriteI(input_queue_t *iqp, const uint8_t *bp, size_t n);
   msg_t iqGetI(input_queue_t *iqp);
   msg_t iqGetTimeout(input_queue_t *iqp, sysinterval_t timeout);
   size_t iqReadI(input_queue_t *iqp, uint8_t *bp, size_t n);
@@ -315,6 +330,7 @@ extern "C" {
   msg_t oqPutI(output_queue_t *oqp, uint8_t b);
   msg_t oqPutTimeout(output_queue_t *oqp, uint8_t b, sysinterval_t timeout);
   msg_t oqGetI(output_queue_t *oqp);
+  size_t oqReadI(output_queue_t *oqp, uint8_t *bp, size_t n);
   size_t oqWriteI(output_queue_t *oqp, const uint8_t *bp, size_t n);
   size_t oqWriteTimeout(output_queue_t *oqp, const uint8_t *bp,
                         size_t n, sysinterval_t timeout);
@@ -298,8 +298,12 @@ extern "C" {
   void sdStop(SerialDriver *sdp);
   void sdIncomingDataI(SerialDriver *sdp, uint8_t b);
   msg_t sdRequestDataI(SerialDriver *sdp);
+  size_t sdIncomingDataBlockI(SerialDriver *sdp, const uint8_t *bp, size_t n);
+  size_t sdRequestDataBlockI(SerialDriver *sdp, uint8_t *bp, size_t n);
   bool sdPutWouldBlock(SerialDriver *sdp);
   bool sdGetWouldBlock(SerialDriver *sdp);
+  void sdSetWakeup(SerialDriver *sdp, size_t threshold,
+                   msg_t delimiter, sysinterval_t idle);
   msg_t sdControl(SerialDriver *sdp, unsigned int operation, void *arg);
 #ifdef __cplusplus
 }
@@ -166,6 +166,68 @@ struct SerialUSBDriver {
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @name    Macro Functions
+ * @{
+ */
+/**
+ * @brief   Borrows the received data in place.
+ * @details Gives direct access to the unread data of the current USB
+ *          packet buffer so that it can be parsed without copies.
+ * @note    This function bypasses the indirect access to the channel and
+ *          accesses directly the input buffers queue.
+ *
+ * @param[in] sdup      pointer to a @p SerialUSBDriver object
+ * @param[out] pp       pointer to a variable receiving the data pointer
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ * @return              The number of bytes available at @p *pp.
+ * @retval 0            if a timeout occurred or the queue has been reset.
+ *
+ * @api
+ */
+#define sduBorrowReadTimeout(sdup, pp, timeout)                             \
+  ibqBorrowTimeout(&(sdup)->ibqueue, pp, timeout)
+
+/**
+ * @brief   Returns a buffer borrowed using @p sduBorrowReadTimeout().
+ *
+ * @param[in] sdup      pointer to a @p SerialUSBDriver object
+ * @param[in] n         number of bytes consumed
+ *
+ * @api
+ */
+#define sduReturnRead(sdup, n) ibqReturn(&(sdup)->ibqueue, n)
+
+/**
+ * @brief   Borrows free space for in place writing.
+ * @details Gives direct access to the free part of the current USB packet
+ *          buffer so that a response can be built without copies.
+ * @note    This function bypasses the indirect access to the channel and
+ *          accesses directly the output buffers queue.
+ *
+ * @param[in] sdup      pointer to a @p SerialUSBDriver object
+ * @param[out] pp       pointer to a variable receiving the space pointer
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ * @return              The number of bytes available at @p *pp.
+ * @retval 0            if a timeout occurred or the queue has been reset.
+ *
+ * @api
+ */
+#define sduBorrowWriteTimeout(sdup, pp, timeout)                            \
+  obqBorrowTimeout(&(sdup)->obqueue, pp, timeout)
+
+/**
+ * @brief   Returns a buffer borrowed using @p sduBorrowWriteTimeout().
+ * @note    A partially filled buffer is sent on the next SOF.
+ *
+ * @param[in] sdup      pointer to a @p SerialUSBDriver object
+ * @param[in] n         number of bytes written
+ *
+ * @api
+ */
+#define sduReturnWrite(sdup, n) obqReturn(&(sdup)->obqueue, n)
+/** @} */
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
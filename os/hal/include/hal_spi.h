@@ -44,6 +44,18 @@
 #define SPI_SELECT_MODE_LLD                 4   /** @brief LLD-defined mode.*/
 /** @} */
 
+/**
+ * @name    Transaction transfer flags
+ * @{
+ */
+#define SPI_XFER_SELECT                     1U  /** @brief Asserts the slave
+                                                    select before the
+                                                    transfer.               */
+#define SPI_XFER_UNSELECT                   2U  /** @brief Deasserts the
+                                                    slave select after the
+                                                    transfer.               */
+/** @} */
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -83,6 +95,22 @@
 #if !defined(SPI_SELECT_MODE) || defined(__DOXYGEN__)
 #define SPI_SELECT_MODE                     SPI_SELECT_MODE_PAD
 #endif
+
+/**
+ * @brief   Enables the transactions queue APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(SPI_USE_QUEUE) || defined(__DOXYGEN__)
+#define SPI_USE_QUEUE                       FALSE
+#endif
+
+/**
+ * @brief   Number of priority lanes of the transactions queue.
+ * @details Lane zero has the highest priority.
+ */
+#if !defined(SPI_QUEUE_LANES) || defined(__DOXYGEN__)
+#define SPI_QUEUE_LANES                     2
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -106,6 +134,10 @@
 #error "current SPI_SELECT_MODE requires HAL_USE_PAL"
 #endif
 
+#if (SPI_USE_QUEUE == TRUE) && (SPI_QUEUE_LANES < 1)
+#error "invalid SPI_QUEUE_LANES value"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -186,6 +218,120 @@ struct hal_spi_config {
   spi_lld_config_fields;
 };
 
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Transaction state machine possible states.
+ */
+typedef enum {
+  SPI_TXN_IDLE = 0,                 /**< Never queued.                      */
+  SPI_TXN_QUEUED = 1,               /**< Waiting in its lane.               */
+  SPI_TXN_ACTIVE = 2,               /**< Being executed.                    */
+  SPI_TXN_DONE = 3                  /**< Completed.                         */
+} spitxnstate_t;
+
+/**
+ * @brief   Type of a SPI transaction.
+ */
+typedef struct hal_spi_transaction spi_transaction_t;
+
+/**
+ * @brief   SPI transaction notification callback type.
+ * @note    The callback is invoked in locked state, I-class functions can
+ *          be used from there, for example in order to queue the same
+ *          transaction again.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object executing the
+ *                      transaction
+ * @param[in] txnp      pointer to the completed transaction
+ */
+typedef void (*spitxncallback_t)(SPIDriver *spip, spi_transaction_t *txnp);
+
+/**
+ * @brief   Single transfer within a transaction.
+ * @note    A transfer with @p n equal to zero only operates the slave
+ *          select signal.
+ */
+typedef struct {
+  /**
+   * @brief   Transfer flags, a combination of @p SPI_XFER_SELECT and
+   *          @p SPI_XFER_UNSELECT.
+   */
+  uint32_t                  flags;
+  /**
+   * @brief   Number of words to be transferred.
+   */
+  size_t                    n;
+  /**
+   * @brief   Transmit buffer or @p NULL for receive or ignore transfers.
+   */
+  const void                *txbuf;
+  /**
+   * @brief   Receive buffer or @p NULL for send or ignore transfers.
+   */
+  void                      *rxbuf;
+} spi_transfer_t;
+
+/**
+ * @brief   Structure representing a SPI transaction.
+ * @details A transaction is a list of transfers executed back to back on
+ *          the same slave device, the driver moves from a transfer to the
+ *          next and from a transaction to the next from within its ISR.
+ * @note    The fields after the user fields must be zero before the first
+ *          use, static or designated initializers take care of this.
+ */
+struct hal_spi_transaction {
+  /**
+   * @brief   Configuration of the addressed device.
+   * @note    The peripheral is reprogrammed from within the ISR when
+   *          consecutive transactions use different configurations, the
+   *          LLD start function must allow this while the driver is
+   *          active.
+   */
+  const SPIConfig           *config;
+  /**
+   * @brief   Transfers array.
+   */
+  const spi_transfer_t      *transfers;
+  /**
+   * @brief   Number of transfers in the array.
+   */
+  size_t                    n;
+  /**
+   * @brief   Priority lane, zero is the highest priority.
+   */
+  unsigned                  lane;
+  /**
+   * @brief   Completion callback or @p NULL.
+   */
+  spitxncallback_t          end_cb;
+  /**
+   * @brief   Event source broadcast on completion or @p NULL.
+   */
+  event_source_t            *event;
+  /**
+   * @brief   Flags broadcast with @p event.
+   */
+  eventflags_t              flags;
+  /* End of the user fields.*/
+  /**
+   * @brief   Transaction state.
+   */
+  volatile spitxnstate_t    state;
+  /**
+   * @brief   Index of the transfer being executed.
+   */
+  size_t                    index;
+  /**
+   * @brief   Next transaction in the lane.
+   */
+  spi_transaction_t         *next;
+  /**
+   * @brief   Thread waiting for the transaction completion.
+   */
+  thread_reference_t        thread;
+};
+#endif /* SPI_USE_QUEUE == TRUE */
+
 /**
  * @brief   Structure representing an SPI driver.
  */
@@ -210,6 +356,24 @@ struct hal_spi_driver {
    */
   mutex_t                   mutex;
 #endif /* SPI_USE_MUTUAL_EXCLUSION == TRUE */
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Configuration passed to @p spiStart(), restored when the
+   *          transactions queue becomes empty.
+   */
+  const SPIConfig           *qconfig;
+  /**
+   * @brief   Transaction being executed or @p NULL.
+   */
+  spi_transaction_t         *txn;
+  /**
+   * @brief   Transactions queues, one for each priority lane.
+   */
+  struct {
+    spi_transaction_t       *head;
+    spi_transaction_t       *tail;
+  }                         lanes[SPI_QUEUE_LANES];
+#endif /* SPI_USE_QUEUE == TRUE */
 #if defined(SPI_DRIVER_EXT_FIELDS)
   SPI_DRIVER_EXT_FIELDS
 #endif
@@ -436,6 +600,7 @@ do {                                                                        \
  *
  * @notapi
  */
+#if (SPI_USE_QUEUE == FALSE) || defined(__DOXYGEN__)
 #define _spi_isr_code(spip) {                                               \
   if ((spip)->config->end_cb) {                                             \
     (spip)->state = SPI_COMPLETE;                                           \
@@ -447,6 +612,24 @@ do {                                                                        \
     (spip)->state = SPI_READY;                                              \
   _spi_wakeup_isr(spip);                                                    \
 }
+#else /* SPI_USE_QUEUE == TRUE */
+#define _spi_isr_code(spip) {                                               \
+  if ((spip)->txn != NULL) {                                                \
+    _spi_queue_isr(spip);                                                   \
+  }                                                                         \
+  else {                                                                    \
+    if ((spip)->config->end_cb) {                                           \
+      (spip)->state = SPI_COMPLETE;                                         \
+      (spip)->config->end_cb(spip);                                         \
+      if ((spip)->state == SPI_COMPLETE)                                    \
+        (spip)->state = SPI_READY;                                          \
+    }                                                                       \
+    else                                                                    \
+      (spip)->state = SPI_READY;                                            \
+    _spi_wakeup_isr(spip);                                                  \
+  }                                                                         \
+}
+#endif /* SPI_USE_QUEUE == TRUE */
 
 /**
  * @brief   Half buffer filled ISR code in circular mode.
@@ -521,6 +704,14 @@ extern "C" {
   void spiAcquireBus(SPIDriver *spip);
   void spiReleaseBus(SPIDriver *spip);
 #endif
+#if SPI_USE_QUEUE == TRUE
+  void spiQueueTransactionI(SPIDriver *spip, spi_transaction_t *txnp);
+  void spiQueueTransaction(SPIDriver *spip, spi_transaction_t *txnp);
+  msg_t spiWaitTransactionTimeout(SPIDriver *spip,
+                                  spi_transaction_t *txnp,
+                                  sysinterval_t timeout);
+  void _spi_queue_isr(SPIDriver *spip);
+#endif
 #ifdef __cplusplus
 }
 #endif
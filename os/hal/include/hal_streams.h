@@ -157,7 +157,11 @@ typedef struct {
 #define _base_buffered_stream_methods                                       \
   _base_sequential_stream_methods                                           \
   /* Channel unget method */                                                \
-  msg_t (*unget)(void *instance, uint8_t b);
+  msg_t (*unget)(void *instance, uint8_t b);                                \
+  /* Channel borrow method */                                               \
+  size_t (*borrow)(void *instance, const uint8_t **pp);                     \
+  /* Channel return method */                                               \
+  void (*ret)(void *instance, size_t n);
 
 /**
  * @brief   @p BaseBufferedStream specific data.
@@ -211,6 +215,34 @@ typedef struct {
  * @api
  */
 #define streamUnget(ip, b) ((ip)->vmt->unget(ip, b))
+
+/**
+ * @brief   Buffered Stream borrow.
+ * @details This function gives direct access to the data already buffered
+ *          by the stream, it never blocks. The data is not consumed until
+ *          it is returned using @p streamReturn().
+ *
+ * @param[in] ip        pointer to a @p BaseBufferedStream or derived class
+ * @param[out] pp       pointer to a variable receiving the data pointer
+ * @return              The number of bytes available at @p *pp.
+ * @retval 0            if no data is buffered or the stream does not
+ *                      support direct access.
+ *
+ * @api
+ */
+#define streamBorrow(ip, pp) ((ip)->vmt->borrow(ip, pp))
+
+/**
+ * @brief   Buffered Stream return.
+ * @details Consumes data previously borrowed using @p streamBorrow().
+ *
+ * @param[in] ip        pointer to a @p BaseBufferedStream or derived class
+ * @param[in] n         number of bytes consumed, it cannot exceed the
+ *                      size returned by @p streamBorrow()
+ *
+ * @api
+ */
+#define streamReturn(ip, n) ((ip)->vmt->ret(ip, n))
 /** @} */
 
 #endif /* HAL_STREAMS_H */
@@ -96,8 +96,23 @@ static msg_t _unget(void* ip, uint8_t b) {
   return b;
 }
 
+static size_t _borrow(void *ip, const uint8_t **pp) {
+  BufferedStreamAdapter* bsap = ip;
+
+  /* Only the ungot data is buffered, the wrapped stream is not.*/
+  *pp = bsap->buffer + bsap->ndx;
+
+  return BUFSTREAM_BUFFER_SIZE - bsap->ndx;
+}
+
+static void _return(void *ip, size_t n) {
+  BufferedStreamAdapter* bsap = ip;
+
+  bsap->ndx += n;
+}
+
 static const struct BufferedStreamAdapterVMT vmt = {
-  (size_t)0, _writes, _reads, _put, _get, _unget
+  (size_t)0, _writes, _reads, _put, _get, _unget, _borrow, _return
 };
 
 /*===========================================================================*/
@@ -0,0 +1,443 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+/**
+ * @file    chlog.c
+ * @brief   Deferred logging code.
+ *
+ * @addtogroup HAL_CHLOG
+ * @details Deferred binary logging. Logging a record only stores the
+ *          format string pointer, a time stamp and the raw arguments
+ *          into a buffer, no formatting and no stream access happen in
+ *          the caller context.<br>
+ *          Records are formatted later by a low priority thread calling
+ *          @p chlogFlush() or fetched raw using @p chlogFetchX() for
+ *          decoding on a host, in that case the format strings are
+ *          resolved from the firmware image.<br>
+ *          Each buffer is a lock-free single-producer single-consumer
+ *          ring, producers running in different contexts or on different
+ *          cores use separate buffers so they never contend. Records are
+ *          dropped and counted when a buffer is full.
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+#include "chprintf.h"
+#include "chlog.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum size of a conversion specification.
+ */
+#define CHLOG_SPEC_SIZE             16U
+
+/**
+ * @name    Counters access
+ * @details The records counters are shared between the producer and the
+ *          reader without locking, the compiler atomics order the records
+ *          copy with the counters publication.
+ * @{
+ */
+#if defined(__GNUC__) || defined(__clang__) || defined(__DOXYGEN__)
+#define log_load_acquire(p)         __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define log_store_release(p, v)     __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define log_full_barrier()          __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#define log_load_acquire(p)         (*(p))
+#define log_store_release(p, v)     (*(p) = (v))
+#define log_full_barrier()
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+static const char levels[] = {'-', 'E', 'W', 'I', 'D'};
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the next argument of a record.
+ *
+ * @param[in] rp        pointer to the record
+ * @param[in,out] ip    pointer to the arguments index
+ * @return              The argument or zero if there are no more.
+ *
+ * @notapi
+ */
+static uintptr_t log_next_arg(const chlog_record_t *rp, unsigned *ip) {
+
+  if (*ip >= (unsigned)rp->nargs) {
+    return (uintptr_t)0;
+  }
+  return rp->args[(*ip)++];
+}
+
+/**
+ * @brief   Formats a record on a stream.
+ * @details The literal text is written as is, each conversion is passed
+ *          to @p chprintf() alone with its argument converted back to the
+ *          type expected by the conversion. Arguments consumed by a
+ *          @p * width or precision are inserted into the specification.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream implementing
+ *                      object
+ * @param[in] rp        pointer to the record
+ *
+ * @notapi
+ */
+static void log_format(BaseSequentialStream *chp, const chlog_record_t *rp) {
+  const char *fmt = rp->fmt;
+  unsigned argi = 0U;
+
+  while (true) {
+    char spec[CHLOG_SPEC_SIZE];
+    const char *t = fmt;
+    bool is_long = false, is_long_long = false;
+    uintptr_t arg;
+    size_t n = 0U;
+    char c;
+
+    /* Literal text.*/
+    while ((*fmt != '\0') && (*fmt != '%')) {
+      fmt++;
+    }
+    if (fmt > t) {
+      (void) streamWrite(chp, (const uint8_t *)t, (size_t)(fmt - t));
+    }
+    if (*fmt == '\0') {
+      return;
+    }
+
+    /* Collecting the conversion specification, the last position is
+       reserved for the conversion character.*/
+    spec[n++] = *fmt++;
+    while ((*fmt != '\0') && (strchr("-+0123456789.*lL", *fmt) != NULL) &&
+           (n < CHLOG_SPEC_SIZE - 2U)) {
+      c = *fmt++;
+      if (c == '*') {
+        /* The argument is replaced by its value, truncated to the space
+           left in the specification.*/
+        (void) chsnprintf(&spec[n], CHLOG_SPEC_SIZE - 1U - n, "%d",
+                          (int)(intptr_t)log_next_arg(rp, &argi));
+        n += strlen(&spec[n]);
+      }
+      else {
+        if ((c == 'l') || (c == 'L')) {
+          is_long_long = is_long;
+          is_long = true;
+        }
+        spec[n++] = c;
+      }
+    }
+    c = *fmt;
+    if (c == '\0') {
+      return;
+    }
+    fmt++;
+    spec[n++] = c;
+    spec[n]   = '\0';
+
+    /* Upper case conversions are the long variants in chprintf().*/
+    if ((c >= 'A') && (c <= 'Z')) {
+      is_long = true;
+    }
+
+    switch (c) {
+    case 'c':
+      (void) chprintf(chp, spec, (int)log_next_arg(rp, &argi));
+      break;
+    case 's':
+      (void) chprintf(chp, spec, (const char *)log_next_arg(rp, &argi));
+      break;
+    case 'p':
+      (void) chprintf(chp, spec, (void *)log_next_arg(rp, &argi));
+      break;
+    case 'd':
+    case 'D':
+    case 'i':
+    case 'I':
+      arg = log_next_arg(rp, &argi);
+      if (is_long_long) {
+        (void) chprintf(chp, spec, (long long)(intptr_t)arg);
+      }
+      else if (is_long) {
+        (void) chprintf(chp, spec, (long)(intptr_t)arg);
+      }
+      else {
+        (void) chprintf(chp, spec, (int)(intptr_t)arg);
+      }
+      break;
+    case 'u':
+    case 'U':
+    case 'x':
+    case 'X':
+    case 'o':
+    case 'O':
+      arg = log_next_arg(rp, &argi);
+      if (is_long_long) {
+        (void) chprintf(chp, spec, (unsigned long long)arg);
+      }
+      else if (is_long) {
+        (void) chprintf(chp, spec, (unsigned long)arg);
+      }
+      else {
+        (void) chprintf(chp, spec, (unsigned)arg);
+      }
+      break;
+    case 'f':
+      {
+        union {
+          uint32_t          u;
+          float             f;
+        } v;
+
+        /* Bit pattern stored by CHLOG_FLOAT().*/
+        v.u = (uint32_t)log_next_arg(rp, &argi);
+        (void) chprintf(chp, spec, (double)v.f);
+      }
+      break;
+    default:
+      /* No argument, "%%" and unknown conversions.*/
+      (void) chprintf(chp, spec);
+      break;
+    }
+  }
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p chlog_buffer_t object.
+ *
+ * @param[out] lbp      pointer to a @p chlog_buffer_t object
+ * @param[in] records   pointer to the records buffer
+ * @param[in] n         number of records in the buffer, must be a power
+ *                      of two
+ *
+ * @init
+ */
+void chlogObjectInit(chlog_buffer_t *lbp, chlog_record_t *records,
+                     size_t n) {
+
+  osalDbgCheck((lbp != NULL) && (records != NULL) &&
+               (n > 0U) && ((n & (n - 1U)) == 0U));
+
+  lbp->records  = records;
+  lbp->mask     = n - 1U;
+  lbp->wrcnt    = (size_t)0;
+  lbp->rdcnt    = (size_t)0;
+  lbp->waiting  = false;
+  lbp->reader   = NULL;
+  lbp->dropped  = (uint32_t)0;
+  lbp->reported = (uint32_t)0;
+}
+
+/**
+ * @brief   Stores a log record.
+ * @details The record is published in the ring without locking, a
+ *          critical zone is entered only when the reader waits for
+ *          records.
+ * @note    This function is meant to be invoked through the logging
+ *          macros, the macros are removed at compile time for the levels
+ *          disabled by @p CHLOG_LEVEL.
+ * @note    Only one producer context is allowed on a buffer.
+ *
+ * @param[in] lbp       pointer to a @p chlog_buffer_t object
+ * @param[in] level     record level
+ * @param[in] fmt       format string
+ * @param[in] nargs     number of valid arguments
+ * @param[in] a0        first argument
+ * @param[in] a1        second argument
+ * @param[in] a2        third argument
+ * @param[in] a3        fourth argument
+ * @return              The operation result.
+ * @retval true         if the record has been stored.
+ * @retval false        if the buffer was full and the record dropped.
+ *
+ * @xclass
+ */
+bool chlogWriteX(chlog_buffer_t *lbp, unsigned level, const char *fmt,
+                 unsigned nargs, uintptr_t a0, uintptr_t a1,
+                 uintptr_t a2, uintptr_t a3) {
+  size_t wrcnt = lbp->wrcnt;
+  chlog_record_t *rp;
+
+  /* The read counter is acquired in order to see the reader releasing
+     the slots.*/
+  if (wrcnt - log_load_acquire(&lbp->rdcnt) > lbp->mask) {
+    lbp->dropped++;
+    return false;
+  }
+
+  /* The record is filled in place.*/
+  rp = &lbp->records[wrcnt & lbp->mask];
+  rp->fmt     = fmt;
+  rp->time    = osalOsGetSystemTimeX();
+  rp->level   = (uint8_t)level;
+  rp->nargs   = (uint8_t)nargs;
+  rp->args[0] = a0;
+  rp->args[1] = a1;
+  rp->args[2] = a2;
+  rp->args[3] = a3;
+
+  /* Publishing the record.*/
+  log_store_release(&lbp->wrcnt, wrcnt + 1U);
+
+  /* The barrier orders the publication with the waiting flag check, the
+     reader does the opposite under lock before suspending.*/
+  log_full_barrier();
+  if (lbp->waiting) {
+    syssts_t sts = osalSysGetStatusAndLockX();
+
+    if (lbp->reader != NULL) {
+      lbp->waiting = false;
+      osalThreadResumeI(&lbp->reader, MSG_OK);
+    }
+
+    osalSysRestoreStatusX(sts);
+  }
+
+  return true;
+}
+
+/**
+ * @brief   Fetches the oldest log record.
+ * @note    Only one reader is allowed on a buffer.
+ *
+ * @param[in] lbp       pointer to a @p chlog_buffer_t object
+ * @param[out] rp       pointer to the record to be filled
+ * @return              The operation result.
+ * @retval true         if a record has been fetched.
+ * @retval false        if the buffer is empty.
+ *
+ * @xclass
+ */
+bool chlogFetchX(chlog_buffer_t *lbp, chlog_record_t *rp) {
+
+  size_t rdcnt;
+
+  osalDbgCheck((lbp != NULL) && (rp != NULL));
+
+  /* The write counter is acquired in order to see the record published
+     by the producer.*/
+  rdcnt = lbp->rdcnt;
+  if (log_load_acquire(&lbp->wrcnt) == rdcnt) {
+    return false;
+  }
+  *rp = lbp->records[rdcnt & lbp->mask];
+
+  /* Releasing the slot to the producer.*/
+  log_store_release(&lbp->rdcnt, rdcnt + 1U);
+
+  return true;
+}
+
+/**
+ * @brief   Waits for log records.
+ * @note    Only the reader can wait on a buffer.
+ *
+ * @param[in] lbp       pointer to a @p chlog_buffer_t object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation result.
+ * @retval MSG_OK       if records are available.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chlogWaitTimeout(chlog_buffer_t *lbp, sysinterval_t timeout) {
+  msg_t msg = MSG_OK;
+
+  osalDbgCheck(lbp != NULL);
+
+  osalSysLock();
+
+  /* Announcing the wait before checking, see chlogWriteX().*/
+  lbp->waiting = true;
+  log_full_barrier();
+  if (log_load_acquire(&lbp->wrcnt) == lbp->rdcnt) {
+    msg = osalThreadSuspendTimeoutS(&lbp->reader, timeout);
+  }
+  lbp->waiting = false;
+
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Formats the pending log records on a stream.
+ * @details Each record is printed on a line prefixed by its time stamp
+ *          and level, records dropped since the previous flush are
+ *          reported.
+ * @note    Only one reader is allowed on a buffer.
+ *
+ * @param[in] lbp       pointer to a @p chlog_buffer_t object
+ * @param[in] chp       pointer to a @p BaseSequentialStream implementing
+ *                      object
+ * @return              The number of formatted records.
+ *
+ * @api
+ */
+size_t chlogFlush(chlog_buffer_t *lbp, BaseSequentialStream *chp) {
+  chlog_record_t r;
+  uint32_t dropped;
+  size_t n = 0;
+
+  osalDbgCheck((lbp != NULL) && (chp != NULL));
+
+  while (chlogFetchX(lbp, &r)) {
+    chprintf(chp, "%10lu %c ", (unsigned long)r.time,
+             levels[r.level <= CHLOG_LEVEL_DEBUG ? r.level : 0U]);
+    log_format(chp, &r);
+    chprintf(chp, "\r\n");
+    n++;
+  }
+
+  dropped = chlogGetDroppedX(lbp);
+  if (dropped != lbp->reported) {
+    chprintf(chp, "*** %lu records dropped\r\n",
+             (unsigned long)(dropped - lbp->reported));
+    lbp->reported = dropped;
+  }
+
+  return n;
+}
+
+/** @} */
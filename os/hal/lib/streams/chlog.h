@@ -0,0 +1,365 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+/**
+ * @file    chlog.h
+ * @brief   Deferred logging macros and structures.
+ *
+ * @addtogroup HAL_CHLOG
+ * @{
+ */
+
+#ifndef CHLOG_H
+#define CHLOG_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Log levels
+ * @{
+ */
+#define CHLOG_LEVEL_NONE            0U
+#define CHLOG_LEVEL_ERROR           1U
+#define CHLOG_LEVEL_WARNING         2U
+#define CHLOG_LEVEL_INFO            3U
+#define CHLOG_LEVEL_DEBUG           4U
+/** @} */
+
+/**
+ * @brief   Maximum number of arguments stored in a record.
+ */
+#define CHLOG_MAX_ARGS              4U
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Compile-time log level.
+ * @details Records with a level above this setting are removed at compile
+ *          time, their arguments are not evaluated.
+ */
+#if !defined(CHLOG_LEVEL) || defined(__DOXYGEN__)
+#define CHLOG_LEVEL                 CHLOG_LEVEL_INFO
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if CHLOG_LEVEL > CHLOG_LEVEL_DEBUG
+#error "invalid CHLOG_LEVEL value"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a log record.
+ * @details Records store the format string pointer and the raw arguments,
+ *          formatting happens when the record is flushed.
+ */
+typedef struct {
+  /**
+   * @brief   Format string.
+   */
+  const char                *fmt;
+  /**
+   * @brief   System time of the record.
+   */
+  systime_t                 time;
+  /**
+   * @brief   Record level.
+   */
+  uint8_t                   level;
+  /**
+   * @brief   Number of arguments.
+   */
+  uint8_t                   nargs;
+  /**
+   * @brief   Raw arguments.
+   */
+  uintptr_t                 args[CHLOG_MAX_ARGS];
+} chlog_record_t;
+
+/**
+ * @brief   Type of a log buffer.
+ * @details The buffer is a lock-free single-producer single-consumer
+ *          ring of records, storing a record never enters a critical
+ *          zone unless the reader is waiting.
+ * @note    A buffer accepts records from a single producer context, a
+ *          thread, an ISR or a core. Separate buffers must be used for
+ *          other producers, one reader can flush all of them.
+ */
+typedef struct {
+  /**
+   * @brief   Records buffer.
+   */
+  chlog_record_t            *records;
+  /**
+   * @brief   Number of records in the buffer minus one.
+   */
+  size_t                    mask;
+  /**
+   * @brief   Stored records counter.
+   * @note    Only written by the producer.
+   */
+  volatile size_t           wrcnt;
+  /**
+   * @brief   Fetched records counter.
+   * @note    Only written by the reader.
+   */
+  volatile size_t           rdcnt;
+  /**
+   * @brief   The reader is waiting for records.
+   */
+  volatile bool             waiting;
+  /**
+   * @brief   Waiting reader.
+   */
+  thread_reference_t        reader;
+  /**
+   * @brief   Number of records dropped because the buffer was full.
+   * @note    Only written by the producer.
+   */
+  volatile uint32_t         dropped;
+  /**
+   * @brief   Dropped records already reported by @p chlogFlush().
+   * @note    Only written by the reader.
+   */
+  uint32_t                  reported;
+} chlog_buffer_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @name    Logging macros
+ * @{
+ */
+/**
+ * @brief   Logs an error record.
+ * @note    Arguments are stored as @p uintptr_t and converted back to
+ *          the type expected by their conversion on flush, values wider
+ *          than @p uintptr_t are truncated. Strings passed to @p \%s must
+ *          stay valid until the record is flushed.
+ * @note    Arguments of @p \%f conversions must be wrapped in
+ *          @p CHLOG_FLOAT(). With GCC a floating point argument not
+ *          wrapped fails the build of C sources.
+ *
+ * @param[in] lbp       pointer to a @p chlog_buffer_t object
+ * @param[in] ...       format string followed by up to
+ *                      @p CHLOG_MAX_ARGS arguments
+ *
+ * @xclass
+ */
+#if (CHLOG_LEVEL >= CHLOG_LEVEL_ERROR) || defined(__DOXYGEN__)
+#define CHLOG_ERROR(lbp, ...)   __chlog_write(lbp, CHLOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define CHLOG_ERROR(lbp, ...)   do {} while (false)
+#endif
+
+/**
+ * @brief   Logs a warning record.
+ * @note    Arguments are stored as @p uintptr_t and converted back to
+ *          the type expected by their conversion on flush, values wider
+ *          than @p uintptr_t are truncated. Strings passed to @p \%s must
+ *          stay valid until the record is flushed.
+ * @note    Arguments of @p \%f conversions must be wrapped in
+ *          @p CHLOG_FLOAT(). With GCC a floating point argument not
+ *          wrapped fails the build of C sources.
+ *
+ * @param[in] lbp       pointer to a @p chlog_buffer_t object
+ * @param[in] ...       format string followed by up to
+ *                      @p CHLOG_MAX_ARGS arguments
+ *
+ * @xclass
+ */
+#if (CHLOG_LEVEL >= CHLOG_LEVEL_WARNING) || defined(__DOXYGEN__)
+#define CHLOG_WARNING(lbp, ...) __chlog_write(lbp, CHLOG_LEVEL_WARNING, __VA_ARGS__)
+#else
+#define CHLOG_WARNING(lbp, ...) do {} while (false)
+#endif
+
+/**
+ * @brief   Logs an information record.
+ * @note    Arguments are stored as @p uintptr_t and converted back to
+ *          the type expected by their conversion on flush, values wider
+ *          than @p uintptr_t are truncated. Strings passed to @p \%s must
+ *          stay valid until the record is flushed.
+ * @note    Arguments of @p \%f conversions must be wrapped in
+ *          @p CHLOG_FLOAT(). With GCC a floating point argument not
+ *          wrapped fails the build of C sources.
+ *
+ * @param[in] lbp       pointer to a @p chlog_buffer_t object
+ * @param[in] ...       format string followed by up to
+ *                      @p CHLOG_MAX_ARGS arguments
+ *
+ * @xclass
+ */
+#if (CHLOG_LEVEL >= CHLOG_LEVEL_INFO) || defined(__DOXYGEN__)
+#define CHLOG_INFO(lbp, ...)    __chlog_write(lbp, CHLOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define CHLOG_INFO(lbp, ...)    do {} while (false)
+#endif
+
+/**
+ * @brief   Logs a debug record.
+ * @note    Arguments are stored as @p uintptr_t and converted back to
+ *          the type expected by their conversion on flush, values wider
+ *          than @p uintptr_t are truncated. Strings passed to @p \%s must
+ *          stay valid until the record is flushed.
+ * @note    Arguments of @p \%f conversions must be wrapped in
+ *          @p CHLOG_FLOAT(). With GCC a floating point argument not
+ *          wrapped fails the build of C sources.
+ *
+ * @param[in] lbp       pointer to a @p chlog_buffer_t object
+ * @param[in] ...       format string followed by up to
+ *                      @p CHLOG_MAX_ARGS arguments
+ *
+ * @xclass
+ */
+#if (CHLOG_LEVEL >= CHLOG_LEVEL_DEBUG) || defined(__DOXYGEN__)
+#define CHLOG_DEBUG(lbp, ...)   __chlog_write(lbp, CHLOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define CHLOG_DEBUG(lbp, ...)   do {} while (false)
+#endif
+
+/**
+ * @brief   Floating point argument.
+ * @details The value is stored as the bit pattern of a @p float, it is
+ *          printed with full single precision on flush.
+ *
+ * @param[in] x         floating point value
+ */
+#define CHLOG_FLOAT(x)          __chlog_float((float)(x))
+/** @} */
+
+/**
+ * @brief   Counts the arguments following the format string.
+ * @note    Passing more than @p CHLOG_MAX_ARGS arguments, up to sixteen,
+ *          fails the build on the undeclared
+ *          @p CHLOG_TOO_MANY_ARGUMENTS identifier.
+ *
+ * @notapi
+ */
+#define __chlog_nargs(...)                                                  \
+  __chlog_nargs_(__VA_ARGS__,                                               \
+                 CHLOG_TOO_MANY_ARGUMENTS, CHLOG_TOO_MANY_ARGUMENTS,        \
+                 CHLOG_TOO_MANY_ARGUMENTS, CHLOG_TOO_MANY_ARGUMENTS,        \
+                 CHLOG_TOO_MANY_ARGUMENTS, CHLOG_TOO_MANY_ARGUMENTS,        \
+                 CHLOG_TOO_MANY_ARGUMENTS, CHLOG_TOO_MANY_ARGUMENTS,        \
+                 CHLOG_TOO_MANY_ARGUMENTS, CHLOG_TOO_MANY_ARGUMENTS,        \
+                 CHLOG_TOO_MANY_ARGUMENTS, CHLOG_TOO_MANY_ARGUMENTS,        \
+                 4U, 3U, 2U, 1U, 0U, 0)
+#define __chlog_nargs_(fmt, a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10,    \
+                       a11, a12, a13, a14, a15, n, ...) n
+
+/**
+ * @brief   Stores a record padding the missing arguments.
+ *
+ * @notapi
+ */
+#define __chlog_write(lbp, level, ...)                                      \
+  __chlog_write_(lbp, level, __chlog_nargs(__VA_ARGS__), __VA_ARGS__,       \
+                 0, 0, 0, 0)
+#define __chlog_write_(lbp, level, n, fmt, a0, a1, a2, a3, ...)             \
+  (void) chlogWriteX(lbp, level, fmt, n, __chlog_arg(a0), __chlog_arg(a1),  \
+                     __chlog_arg(a2), __chlog_arg(a3))
+
+/**
+ * @brief   Converts an argument to @p uintptr_t.
+ * @note    With GCC floating point arguments are rejected at compile
+ *          time, a plain conversion would silently truncate them.
+ *
+ * @notapi
+ */
+#if (defined(__GNUC__) && !defined(__cplusplus)) || defined(__DOXYGEN__)
+#define __chlog_arg(x)                                                      \
+  __builtin_choose_expr(__builtin_classify_type(x) == 8,                    \
+                        __chlog_float_not_wrapped(), (uintptr_t)(x))
+#else
+#define __chlog_arg(x)          ((uintptr_t)(x))
+#endif
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chlogObjectInit(chlog_buffer_t *lbp, chlog_record_t *records,
+                       size_t n);
+  bool chlogWriteX(chlog_buffer_t *lbp, unsigned level, const char *fmt,
+                   unsigned nargs, uintptr_t a0, uintptr_t a1,
+                   uintptr_t a2, uintptr_t a3);
+  bool chlogFetchX(chlog_buffer_t *lbp, chlog_record_t *rp);
+#if defined(__GNUC__) && !defined(__cplusplus)
+  uintptr_t __chlog_float_not_wrapped(void)
+      __attribute__((error("floating point log arguments must be wrapped "
+                           "in CHLOG_FLOAT()")));
+#endif
+  msg_t chlogWaitTimeout(chlog_buffer_t *lbp, sysinterval_t timeout);
+  size_t chlogFlush(chlog_buffer_t *lbp, BaseSequentialStream *chp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Stores a @p float into an argument.
+ *
+ * @param[in] f         the value
+ * @return              The argument holding the value bit pattern.
+ *
+ * @notapi
+ */
+static inline uintptr_t __chlog_float(float f) {
+  union {
+    float               f;
+    uint32_t            u;
+  } v;
+
+  v.f = f;
+  return (uintptr_t)v.u;
+}
+
+/**
+ * @brief   Returns the number of dropped records.
+ *
+ * @param[in] lbp       pointer to a @p chlog_buffer_t object
+ * @return              The number of records dropped since
+ *                      initialization.
+ *
+ * @xclass
+ */
+static inline uint32_t chlogGetDroppedX(chlog_buffer_t *lbp) {
+
+  return lbp->dropped;
+}
+
+#endif /* CHLOG_H */
+
+/** @} */
@@ -28,71 +28,195 @@
  * @{
  */
 
+#include <string.h>
+
 #include "hal.h"
 #include "chprintf.h"
 #include "memstreams.h"
 
-#define MAX_FILLER 11
+#define MAX_FILLER 22
 #define FLOAT_PRECISION 9
 
-static char *long_to_string_with_divisor(char *p,
-                                         long num,
-                                         unsigned radix,
-                                         long divisor) {
-  int i;
-  char *q;
-  long l, ll;
+/**
+ * @brief   Type of the widest integer handled by the conversions.
+ */
+#if (CHPRINTF_USE_LONG_LONG == TRUE) || defined(__DOXYGEN__)
+typedef unsigned long long chp_uint_t;
+#else
+typedef unsigned long chp_uint_t;
+#endif
+
+/**
+ * @brief   Output buffer, characters are collected here and written to the
+ *          stream in blocks.
+ */
+typedef struct {
+  BaseSequentialStream  *chp;
+  size_t                n;
+  uint8_t               buf[CHPRINTF_BUFFER_SIZE];
+} outbuf_t;
+
+static const char dec_pairs[200] = {
+  '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8',
+  '0','9','1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7',
+  '1','8','1','9','2','0','2','1','2','2','2','3','2','4','2','5','2','6',
+  '2','7','2','8','2','9','3','0','3','1','3','2','3','3','3','4','3','5',
+  '3','6','3','7','3','8','3','9','4','0','4','1','4','2','4','3','4','4',
+  '4','5','4','6','4','7','4','8','4','9','5','0','5','1','5','2','5','3',
+  '5','4','5','5','5','6','5','7','5','8','5','9','6','0','6','1','6','2',
+  '6','3','6','4','6','5','6','6','6','7','6','8','6','9','7','0','7','1',
+  '7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9','8','0',
+  '8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+  '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8',
+  '9','9'
+};
 
-  l = num;
-  if (divisor == 0) {
-    ll = num;
-  } else {
-    ll = divisor;
+static const uint32_t pow10[FLOAT_PRECISION] = {
+  10U, 100U, 1000U, 10000U, 100000U, 1000000U, 10000000U, 100000000U,
+  1000000000U
+};
+
+static void ob_flush(outbuf_t *obp) {
+
+  if (obp->n > 0U) {
+    (void) streamWrite(obp->chp, obp->buf, obp->n);
+    obp->n = 0U;
   }
+}
 
-  q = p + MAX_FILLER;
-  do {
-    i = (int)(l % radix);
-    i += '0';
-    if (i > '9') {
-      i += 'A' - '0' - 10;
+static inline void ob_put(outbuf_t *obp, char c) {
+
+  obp->buf[obp->n++] = (uint8_t)c;
+  if (obp->n >= sizeof (obp->buf)) {
+    ob_flush(obp);
+  }
+}
+
+static void ob_write(outbuf_t *obp, const char *s, size_t n) {
+
+  /* Large blocks bypass the buffer.*/
+  if (n >= sizeof (obp->buf)) {
+    ob_flush(obp);
+    (void) streamWrite(obp->chp, (const uint8_t *)s, n);
+    return;
+  }
+
+  while (n > 0U) {
+    size_t chunk = sizeof (obp->buf) - obp->n;
+
+    if (chunk > n) {
+      chunk = n;
     }
-    *--q = i;
-    l /= radix;
-  } while ((ll /= radix) != 0);
+    memcpy(&obp->buf[obp->n], s, chunk);
+    obp->n += chunk;
+    s      += chunk;
+    n      -= chunk;
+    if (obp->n >= sizeof (obp->buf)) {
+      ob_flush(obp);
+    }
+  }
+}
 
-  i = (int)(p + MAX_FILLER - q);
-  do
-    *p++ = *q++;
-  while (--i);
+static void ob_fill(outbuf_t *obp, char c, int n) {
 
-  return p;
+  while (n > 0) {
+    ob_put(obp, c);
+    n--;
+  }
 }
 
-static char *ch_ltoa(char *p, long num, unsigned radix) {
+/*
+ * Decimal conversion of a 32 bits value producing at least "width" digits,
+ * two digits are produced for each step using a lookup table, divisions
+ * by a constant are turned into reciprocal multiplications by the compiler.
+ */
+static char *u32_to_dec(char *p, uint32_t num, unsigned width) {
+  unsigned n;
+  char *q;
+
+  n = 1U;
+  while ((n < 10U) && (num >= pow10[n - 1U])) {
+    n++;
+  }
+  if (n < width) {
+    n = width;
+  }
+
+  q = p + n;
+  while (num >= 100U) {
+    uint32_t r = num % 100U;
+
+    num /= 100U;
+    q -= 2;
+    q[0] = dec_pairs[r * 2U];
+    q[1] = dec_pairs[(r * 2U) + 1U];
+  }
+  if (num >= 10U) {
+    q -= 2;
+    q[0] = dec_pairs[num * 2U];
+    q[1] = dec_pairs[(num * 2U) + 1U];
+  }
+  else {
+    *--q = (char)('0' + num);
+  }
+  while (q > p) {
+    *--q = '0';
+  }
 
-  return long_to_string_with_divisor(p, num, radix, 0);
+  return p + n;
 }
 
-#if CHPRINTF_USE_FLOAT
-static const long pow10[FLOAT_PRECISION] = {
-    10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
-};
+static char *ch_utoa_dec(char *p, chp_uint_t num) {
+
+  /* Wider values are split in 9 digits groups, the wide division is only
+     performed for values not fitting 32 bits.*/
+  if ((sizeof (chp_uint_t) > sizeof (uint32_t)) && (num > 0xFFFFFFFFU)) {
+    chp_uint_t hi = num / 1000000000U;
+
+    p = ch_utoa_dec(p, hi);
+    return u32_to_dec(p, (uint32_t)(num - (hi * 1000000000U)), 9U);
+  }
+
+  return u32_to_dec(p, (uint32_t)num, 0U);
+}
+
+static char *ch_utoa_pow2(char *p, chp_uint_t num, unsigned shift) {
+  chp_uint_t t;
+  unsigned n;
+  char *q;
+
+  n = 1U;
+  t = num >> shift;
+  while (t != 0U) {
+    n++;
+    t >>= shift;
+  }
 
+  q = p + n;
+  do {
+    unsigned d = (unsigned)num & ((1U << shift) - 1U);
+
+    *--q = (char)(d < 10U ? '0' + d : 'A' - 10U + d);
+    num >>= shift;
+  } while (q > p);
+
+  return p + n;
+}
+
+#if CHPRINTF_USE_FLOAT
 static char *ftoa(char *p, double num, unsigned long precision) {
-  long l;
+  uint32_t l;
 
   if ((precision == 0) || (precision > FLOAT_PRECISION)) {
     precision = FLOAT_PRECISION;
   }
-  precision = pow10[precision - 1];
 
-  l = (long)num;
-  p = long_to_string_with_divisor(p, l, 10, 0);
+  l = (uint32_t)num;
+  p = u32_to_dec(p, l, 0U);
   *p++ = '.';
-  l = (long)((num - l) * precision);
+  l = (uint32_t)((num - l) * pow10[precision - 1]);
 
-  return long_to_string_with_divisor(p, l, 10, precision / 10);
+  return u32_to_dec(p, l, (unsigned)precision);
 }
 #endif
 
@@ -100,7 +224,8 @@ static char *ftoa(char *p, double num, unsigned long precision) {
  * @brief   System formatted output function.
  * @details This function implements a minimal @p vprintf()-like functionality
  *          with output on a @p BaseSequentialStream.
- *          The general parameters format is: %[-][width|*][.precision|*][l|L]p.
+ *          The general parameters format is:
+ *          %[-][+][0][width|*][.precision|*][l|ll|L]p.
  *          The following parameter types (p) are supported:
  *          - <b>x</b> hexadecimal integer.
  *          - <b>X</b> hexadecimal long.
@@ -113,6 +238,9 @@ static char *ftoa(char *p, double num, unsigned long precision) {
  *          - <b>c</b> character.
  *          - <b>s</b> string.
  *          .
+ *          The @p ll modifier selects @p long @p long arguments.
+ * @note    The output is collected in a buffer of @p CHPRINTF_BUFFER_SIZE
+ *          bytes and written to the stream in blocks.
  *
  * @param[in] chp       pointer to a @p BaseSequentialStream implementing object
  * @param[in] fmt       formatting string
@@ -123,11 +251,12 @@ static char *ftoa(char *p, double num, unsigned long precision) {
  * @api
  */
 int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
+  outbuf_t ob;
   char *p, *s, c, filler;
   int i, precision, width;
   int n = 0;
-  bool is_long, left_align, do_sign;
-  long l;
+  bool is_long, is_long_long, left_align, do_sign, negative;
+  chp_uint_t u;
 #if CHPRINTF_USE_FLOAT
   float f;
   char tmpbuf[2*MAX_FILLER + 1];
@@ -135,18 +264,27 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
   char tmpbuf[MAX_FILLER + 1];
 #endif
 
+  ob.chp = chp;
+  ob.n   = 0U;
+
   while (true) {
+    const char *t = fmt;
+
+    /* Literal text is written as a single block.*/
+    while ((*fmt != 0) && (*fmt != '%')) {
+      fmt++;
+    }
+    if (fmt > t) {
+      ob_write(&ob, t, (size_t)(fmt - t));
+      n += (int)(fmt - t);
+    }
+
     c = *fmt++;
     if (c == 0) {
+      ob_flush(&ob);
       return n;
     }
     
-    if (c != '%') {
-      streamPut(chp, (uint8_t)c);
-      n++;
-      continue;
-    }
-    
     p = tmpbuf;
     s = tmpbuf;
 
@@ -182,6 +320,7 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
       while (true) {
         c = *fmt++;
         if (c == 0) {
+          ob_flush(&ob);
           return n;
         }
         if (c >= '0' && c <= '9') {
@@ -199,6 +338,7 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
     if (c == '.') {
       c = *fmt++;
       if (c == 0) {
+        ob_flush(&ob);
         return n;
       }
       if (c == '*') {
@@ -211,17 +351,24 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
           precision = precision * 10 + c;
           c = *fmt++;
           if (c == 0) {
+            ob_flush(&ob);
             return n;
           }
         }
       }
     }
     
-    /* Long modifier.*/
+    /* Long and long long modifiers.*/
+    is_long_long = false;
     if (c == 'l' || c == 'L') {
       is_long = true;
       c = *fmt++;
+      if (c == 'l') {
+        is_long_long = true;
+        c = *fmt++;
+      }
       if (c == 0) {
+        ob_flush(&ob);
         return n;
       }
     }
@@ -250,21 +397,32 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
     case 'd':
     case 'I':
     case 'i':
-      if (is_long) {
-        l = va_arg(ap, long);
+      if (is_long_long) {
+        long long l = va_arg(ap, long long);
+
+        u = l < 0 ? (chp_uint_t)0U - (chp_uint_t)l : (chp_uint_t)l;
+        negative = l < 0;
+      }
+      else if (is_long) {
+        long l = va_arg(ap, long);
+
+        u = l < 0 ? (chp_uint_t)0U - (chp_uint_t)l : (chp_uint_t)l;
+        negative = l < 0;
       }
       else {
-        l = va_arg(ap, int);
+        int l = va_arg(ap, int);
+
+        u = l < 0 ? (chp_uint_t)0U - (chp_uint_t)l : (chp_uint_t)l;
+        negative = l < 0;
       }
-      if (l < 0) {
+      if (negative) {
         *p++ = '-';
-        l = -l;
       }
       else
         if (do_sign) {
           *p++ = '+';
         }
-      p = ch_ltoa(p, l, 10);
+      p = ch_utoa_dec(p, u);
       break;
 #if CHPRINTF_USE_FLOAT
     case 'f':
@@ -285,23 +443,31 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
     case 'x':
     case 'P':
     case 'p':
-      c = 16;
+      c = 4;
       goto unsigned_common;
     case 'U':
     case 'u':
-      c = 10;
+      c = 0;
       goto unsigned_common;
     case 'O':
     case 'o':
-      c = 8;
+      c = 3;
 unsigned_common:
-      if (is_long) {
-        l = va_arg(ap, unsigned long);
+      if (is_long_long) {
+        u = (chp_uint_t)va_arg(ap, unsigned long long);
+      }
+      else if (is_long) {
+        u = va_arg(ap, unsigned long);
+      }
+      else {
+        u = va_arg(ap, unsigned int);
+      }
+      if (c == 0) {
+        p = ch_utoa_dec(p, u);
       }
       else {
-        l = va_arg(ap, unsigned int);
+        p = ch_utoa_pow2(p, u, (unsigned)c);
       }
-      p = ch_ltoa(p, l, c);
       break;
     default:
       *p++ = c;
@@ -311,30 +477,17 @@ unsigned_common:
     if ((width -= i) < 0) {
       width = 0;
     }
+    n += i + width;
     if (left_align == false) {
-      width = -width;
-    }
-    if (width < 0) {
-      if ((*s == '-' || *s == '+') && filler == '0') {
-        streamPut(chp, (uint8_t)*s++);
-        n++;
+      if ((width > 0) && (*s == '-' || *s == '+') && filler == '0') {
+        ob_put(&ob, *s++);
         i--;
       }
-      do {
-        streamPut(chp, (uint8_t)filler);
-        n++;
-      } while (++width != 0);
-    }
-    while (--i >= 0) {
-      streamPut(chp, (uint8_t)*s++);
-      n++;
-    }
-
-    while (width) {
-      streamPut(chp, (uint8_t)filler);
-      n++;
-      width--;
+      ob_fill(&ob, filler, width);
+      width = 0;
     }
+    ob_write(&ob, s, (size_t)i);
+    ob_fill(&ob, filler, width);
   }
 }
 
@@ -342,7 +495,8 @@ unsigned_common:
  * @brief   System formatted output function.
  * @details This function implements a minimal @p printf() like functionality
  *          with output on a @p BaseSequentialStream.
- *          The general parameters format is: %[-][width|*][.precision|*][l|L]p.
+ *          The general parameters format is:
+ *          %[-][+][0][width|*][.precision|*][l|ll|L]p.
  *          The following parameter types (p) are supported:
  *          - <b>x</b> hexadecimal integer.
  *          - <b>X</b> hexadecimal long.
@@ -355,6 +509,7 @@ unsigned_common:
  *          - <b>c</b> character.
  *          - <b>s</b> string.
  *          .
+ *          The @p ll modifier selects @p long @p long arguments.
  *
  * @param[in] chp       pointer to a @p BaseSequentialStream implementing object
  * @param[in] fmt       formatting string
@@ -377,7 +532,8 @@ int chprintf(BaseSequentialStream *chp, const char *fmt, ...) {
 /**
  * @brief   System formatted output function.
  * @details This function implements a minimal @p snprintf()-like functionality.
- *          The general parameters format is: %[-][width|*][.precision|*][l|L]p.
+ *          The general parameters format is:
+ *          %[-][+][0][width|*][.precision|*][l|ll|L]p.
  *          The following parameter types (p) are supported:
  *          - <b>x</b> hexadecimal integer.
  *          - <b>X</b> hexadecimal long.
@@ -390,6 +546,7 @@ int chprintf(BaseSequentialStream *chp, const char *fmt, ...) {
  *          - <b>c</b> character.
  *          - <b>s</b> string.
  *          .
+ *          The @p ll modifier selects @p long @p long arguments.
  * @post    @p str is NUL-terminated, unless @p size is 0.
  *
  * @param[in] str       pointer to a buffer
@@ -417,7 +574,8 @@ int chsnprintf(char *str, size_t size, const char *fmt, ...) {
 /**
  * @brief   System formatted output function.
  * @details This function implements a minimal @p vsnprintf()-like functionality.
- *          The general parameters format is: %[-][width|*][.precision|*][l|L]p.
+ *          The general parameters format is:
+ *          %[-][+][0][width|*][.precision|*][l|ll|L]p.
  *          The following parameter types (p) are supported:
  *          - <b>x</b> hexadecimal integer.
  *          - <b>X</b> hexadecimal long.
@@ -430,6 +588,7 @@ int chsnprintf(char *str, size_t size, const char *fmt, ...) {
  *          - <b>c</b> character.
  *          - <b>s</b> string.
  *          .
+ *          The @p ll modifier selects @p long @p long arguments.
  * @post    @p str is NUL-terminated, unless @p size is 0.
  *
  * @param[in] str       pointer to a buffer
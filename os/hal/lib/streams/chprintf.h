@@ -34,6 +34,28 @@
 #define CHPRINTF_USE_FLOAT          FALSE
 #endif
 
+/**
+ * @brief   Long long type support.
+ * @note    If disabled the @p ll arguments are still consumed but
+ *          truncated to @p long.
+ */
+#if !defined(CHPRINTF_USE_LONG_LONG) || defined(__DOXYGEN__)
+#define CHPRINTF_USE_LONG_LONG      TRUE
+#endif
+
+/**
+ * @brief   Size of the output buffer allocated on the stack.
+ * @details The formatted output is written to the stream in blocks of up
+ *          to this size.
+ */
+#if !defined(CHPRINTF_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define CHPRINTF_BUFFER_SIZE        32
+#endif
+
+#if CHPRINTF_BUFFER_SIZE < 1
+#error "invalid CHPRINTF_BUFFER_SIZE value"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
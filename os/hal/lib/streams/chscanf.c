@@ -28,42 +28,414 @@
  */
 
 #include <ctype.h>
+#include <string.h>
 
 #include "hal.h"
 #include "chscanf.h"
 #include "memstreams.h"
 
-static long sym_to_val(char sym, int base)
+/**
+ * @brief   Input scanner state.
+ * @details Characters are taken from a window borrowed from the stream when
+ *          the stream has buffered data, from @p streamGet() otherwise.
+ */
+typedef struct {
+  BaseBufferedStream    *chp;
+  const uint8_t         *base;
+  const uint8_t         *ptr;
+  const uint8_t         *end;
+  bool                  windowed;
+} scanner_t;
+
+static void sc_release(scanner_t *scp) {
+
+  if (scp->ptr > scp->base) {
+    streamReturn(scp->chp, (size_t)(scp->ptr - scp->base));
+  }
+  scp->base = NULL;
+  scp->ptr  = NULL;
+  scp->end  = NULL;
+}
+
+static msg_t sc_fill(scanner_t *scp) {
+  const uint8_t *p;
+  size_t n;
+
+  /* Consuming the exhausted window and trying to borrow a new one.*/
+  sc_release(scp);
+  n = streamBorrow(scp->chp, &p);
+  if (n > 0U) {
+    scp->base     = p;
+    scp->ptr      = p + 1;
+    scp->end      = p + n;
+    scp->windowed = true;
+    return (msg_t)*p;
+  }
+
+  scp->windowed = false;
+  return streamGet(scp->chp);
+}
+
+static inline msg_t sc_get(scanner_t *scp) {
+
+  if (scp->ptr < scp->end) {
+    scp->windowed = true;
+    return (msg_t)*scp->ptr++;
+  }
+
+  return sc_fill(scp);
+}
+
+static void sc_unget(scanner_t *scp, msg_t c) {
+
+  /* A stream error is not a character, nothing to put back.*/
+  if (c < 0) {
+    return;
+  }
+
+  if (scp->windowed && (scp->ptr > scp->base)) {
+    scp->ptr--;
+  }
+  else {
+    (void) streamUnget(scp->chp, (uint8_t)c);
+  }
+}
+
+static inline long sym_to_val(msg_t sym, int base)
+{
+  unsigned long v;
+
+  v = (unsigned long)sym - (unsigned long)'0';
+  if (v > 9UL) {
+    v = ((unsigned long)sym | 0x20UL) - (unsigned long)'a';
+    if (v > 5UL) {
+      return -1;
+    }
+    v += 10UL;
+  }
+
+  return v < (unsigned long)base ? (long)v : -1;
+}
+
+#if CHSCANF_USE_FLOAT
+
+/* Significand digits are accumulated while below this limit, it leaves
+   room for one more digit in base 10 or 16.*/
+#define MANT_LIMIT 0x0CCCCCCCCCCCCCCCULL
+
+/* Powers of ten exactly representable as double.*/
+static const double pow10_exact[23] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const double pow10_big[5] = {
+  1e16, 1e32, 1e64, 1e128, 1e256
+};
+
+/* Maximum number of digits kept after the leading ones.*/
+#define TAIL_DIGITS 18U
+
+/* Decimal significand, the leading digits are followed by up to
+   TAIL_DIGITS more digits kept for the exact comparisons, "sticky" is set
+   if non-zero digits have been dropped after those.*/
+typedef struct {
+  uint64_t mant;
+  uint64_t tail;
+  unsigned ntail;
+  bool     sticky;
+} decimal_t;
+
+/* Big integers used for the exact comparisons, large enough for any
+   double value scaled by its decimal exponent.*/
+#define BIG_WORDS 40
+
+typedef struct {
+  unsigned n;
+  uint32_t w[BIG_WORDS];
+} bignum_t;
+
+static void big_set(bignum_t *bp, uint64_t v)
+{
+  bp->w[0] = (uint32_t)v;
+  bp->w[1] = (uint32_t)(v >> 32);
+  bp->n    = bp->w[1] != 0U ? 2U : (bp->w[0] != 0U ? 1U : 0U);
+}
+
+static bool big_mul(bignum_t *bp, uint32_t m)
+{
+  uint64_t carry = 0U;
+  unsigned i;
+
+  for (i = 0U; i < bp->n; i++) {
+    carry += (uint64_t)bp->w[i] * m;
+    bp->w[i] = (uint32_t)carry;
+    carry >>= 32;
+  }
+  if (carry != 0U) {
+    if (bp->n >= BIG_WORDS) {
+      return false;
+    }
+    bp->w[bp->n++] = (uint32_t)carry;
+  }
+
+  return true;
+}
+
+static bool big_add(bignum_t *bp, uint64_t v)
 {
-  sym = tolower(sym);
-  if (sym <= '7' && sym >= '0') {
-    return sym - '0';
-  }
-  switch (base) {
-  case 16:
-    if (sym <= 'f' && sym >= 'a') {
-      return (sym - 'a' + 0xa);
+  unsigned i;
+
+  for (i = 0U; v != 0U; i++) {
+    uint64_t s;
+
+    if (i >= bp->n) {
+      if (bp->n >= BIG_WORDS) {
+        return false;
+      }
+      bp->w[bp->n++] = 0U;
     }
-    /* fallthrough */
-  case 10:
-    if (sym == '8') {
-      return 8;
+    s = (uint64_t)bp->w[i] + (v & 0xFFFFFFFFU);
+    bp->w[i] = (uint32_t)s;
+    v = (v >> 32) + (s >> 32);
+  }
+
+  return true;
+}
+
+static bool big_mul10(bignum_t *bp, unsigned n)
+{
+  uint32_t m = 1U;
+
+  /* 10^9 is the largest power fitting 32 bits.*/
+  while (n >= 9U) {
+    if (!big_mul(bp, 1000000000U)) {
+      return false;
     }
-    if (sym == '9') {
-      return 9;
+    n -= 9U;
+  }
+  while (n > 0U) {
+    m *= 10U;
+    n--;
+  }
+
+  return big_mul(bp, m);
+}
+
+static bool big_pow5(bignum_t *bp, unsigned long e)
+{
+  uint32_t m = 1U;
+
+  /* 5^13 is the largest power fitting 32 bits.*/
+  while (e >= 13UL) {
+    if (!big_mul(bp, 1220703125U)) {
+      return false;
     }
-    /* fallthrough */
-  default:
-    return -1;
+    e -= 13UL;
+  }
+  while (e > 0UL) {
+    m *= 5U;
+    e--;
   }
+
+  return big_mul(bp, m);
 }
 
-#if CHSCANF_USE_FLOAT
+static bool big_shl(bignum_t *bp, unsigned long s)
+{
+  unsigned words = (unsigned)(s / 32UL);
+  unsigned bits  = (unsigned)(s % 32UL);
+  unsigned i;
+
+  if (bp->n == 0U) {
+    return true;
+  }
+  if ((bp->n + words + 1U) > BIG_WORDS) {
+    return false;
+  }
+
+  bp->w[bp->n + words] = 0U;
+  for (i = bp->n; i > 0U; i--) {
+    uint64_t v = (uint64_t)bp->w[i - 1U] << bits;
+
+    bp->w[i + words]      |= (uint32_t)(v >> 32);
+    bp->w[i + words - 1U]  = (uint32_t)v;
+  }
+  for (i = 0U; i < words; i++) {
+    bp->w[i] = 0U;
+  }
+  bp->n += words + 1U;
+  if (bp->w[bp->n - 1U] == 0U) {
+    bp->n--;
+  }
+
+  return true;
+}
+
+static int big_cmp(const bignum_t *ap, const bignum_t *bp)
+{
+  unsigned i;
+
+  if (ap->n != bp->n) {
+    return ap->n > bp->n ? 1 : -1;
+  }
+  for (i = ap->n; i > 0U; i--) {
+    if (ap->w[i - 1U] != bp->w[i - 1U]) {
+      return ap->w[i - 1U] > bp->w[i - 1U] ? 1 : -1;
+    }
+  }
+
+  return 0;
+}
+
+/* Compares the kept digits of dp * 10^e with h * 2^k exactly, returns
+   false if the numbers exceed the big integers size.*/
+static bool ch_cmp10(const decimal_t *dp, long e, uint64_t h, long k,
+                     int *resp)
+{
+  bignum_t a, b;
+  bool ok = true;
+
+  big_set(&a, dp->mant);
+  big_set(&b, h);
+
+  /* The tail digits extend the significand.*/
+  if (dp->ntail > 0U) {
+    ok = big_mul10(&a, dp->ntail) && big_add(&a, dp->tail);
+    e -= (long)dp->ntail;
+  }
+
+  /* 10^e is 5^e * 2^e, the power of five is moved on the side where it is
+     positive, then the powers of two are aligned.*/
+  if (e >= 0) {
+    ok = ok && big_pow5(&a, (unsigned long)e);
+  } else {
+    ok = ok && big_pow5(&b, (unsigned long)-e);
+  }
+  if (e > k) {
+    ok = ok && big_shl(&a, (unsigned long)(e - k));
+  } else {
+    ok = ok && big_shl(&b, (unsigned long)(k - e));
+  }
+
+  *resp = big_cmp(&a, &b);
+
+  return ok;
+}
+
+/* Corrects an approximation of dp * 10^e, within few units in the last
+   place, to the correctly rounded value by comparing the input with the
+   halfway points to the adjacent values. If non-zero digits have been
+   dropped then the input is slightly above the kept digits, a tie with
+   them is resolved upward.*/
+static double ch_correct10(const decimal_t *dp, long e, double z)
+{
+  unsigned iter;
+
+  for (iter = 0U; iter < 4U; iter++) {
+    uint64_t bits, m;
+    unsigned ex;
+    long k;
+    int r;
+
+    memcpy(&bits, &z, sizeof (bits));
+    if (bits >= 0x7FF0000000000000ULL) {
+      break;
+    }
+    ex = (unsigned)(bits >> 52);
+    m  = bits & 0x000FFFFFFFFFFFFFULL;
+    if (ex == 0U) {
+      k = -1074;
+    } else {
+      m |= 0x0010000000000000ULL;
+      k  = (long)ex - 1075;
+    }
+
+    /* Halfway point to the next value, ties go to the even one.*/
+    if (!ch_cmp10(dp, e, (m * 2U) + 1U, k - 1, &r)) {
+      break;
+    }
+    if ((r == 0) && dp->sticky) {
+      r = 1;
+    }
+    if ((r > 0) || ((r == 0) && ((m & 1U) != 0U))) {
+      bits++;
+      memcpy(&z, &bits, sizeof (z));
+      continue;
+    }
+    if (bits == 0U) {
+      break;
+    }
+
+    /* Halfway point to the previous value, the spacing halves below a
+       power of two.*/
+    if ((m == 0x0010000000000000ULL) && (ex > 1U)) {
+      if (!ch_cmp10(dp, e, (m * 4U) - 1U, k - 2, &r)) {
+        break;
+      }
+    } else {
+      if (!ch_cmp10(dp, e, (m * 2U) - 1U, k - 1, &r)) {
+        break;
+      }
+    }
+    if ((r == 0) && dp->sticky) {
+      r = 1;
+    }
+    if ((r < 0) || ((r == 0) && ((m & 1U) != 0U))) {
+      bits--;
+      memcpy(&z, &bits, sizeof (z));
+      continue;
+    }
+    break;
+  }
+
+  return z;
+}
 
-/* Custom mixed-type power function. The internal promotion of the result to a double
-   allows for a greater dynamic range than integral types. This function is mostly for
-   simplicity, to allow us to do floating point math without either requiring any
-   libc linkages, or actually having to write floating point algorithms ourselves */
+/* Rounds the correctly rounded approximation of dp * 10^e to odd, if the
+   input is not exactly representable and the last bit is even then the
+   value is moved one unit toward the input. A double rounded to odd
+   converts to the correctly rounded float, rounding to nearest twice could
+   land on the wrong float when the double is a halfway point.*/
+static double ch_odd10(const decimal_t *dp, long e, double z)
+{
+  uint64_t bits, m;
+  unsigned ex;
+  long k;
+  int r;
+
+  memcpy(&bits, &z, sizeof (bits));
+  if ((bits == 0U) || (bits >= 0x7FF0000000000000ULL) ||
+      ((bits & 1U) != 0U)) {
+    return z;
+  }
+  ex = (unsigned)(bits >> 52);
+  m  = bits & 0x000FFFFFFFFFFFFFULL;
+  if (ex == 0U) {
+    k = -1074;
+  } else {
+    m |= 0x0010000000000000ULL;
+    k  = (long)ex - 1075;
+  }
+
+  if (!ch_cmp10(dp, e, m, k, &r)) {
+    return z;
+  }
+  if ((r == 0) && dp->sticky) {
+    r = 1;
+  }
+  if (r > 0) {
+    bits++;
+  } else if (r < 0) {
+    bits--;
+  }
+  memcpy(&z, &bits, sizeof (z));
+
+  return z;
+}
+
+/* Custom mixed-type power function, only used with a base of 2 where the
+   result is exact.*/
 static inline double ch_mpow(double x, unsigned long y)
 {
   double res = 1;
@@ -78,53 +450,100 @@ static inline double ch_mpow(double x, unsigned long y)
   return res;
 }
 
+/* Computes dp * 10^e correctly rounded, the exponent applies to the
+   leading digits. If both operands are exactly representable, which is
+   the case for up to 15 significant digits and exponents up to 22, the
+   single rounding of the final operation gives the correctly rounded
+   result. Other values are scaled by a product of table powers then
+   corrected using exact big integer comparisons.
+   Inputs are correctly rounded up to at least 36 significant digits,
+   further digits only contribute to the sticky flag. Longer inputs can be
+   off by one unit in the last place if a halfway point between two
+   doubles, or two floats for "%f", falls within the dropped digits, or if the kept digits do not
+   fit the big integers used for the comparisons.*/
+static double ch_scale10(const decimal_t *dp, long e)
+{
+  double v = (double)dp->mant;
+  double s;
+  unsigned long ue;
+  long e0 = e;
+  unsigned i;
+
+  if (dp->mant == 0U) {
+    return v;
+  }
+
+  if (dp->mant <= (1ULL << 53)) {
+    if ((e >= -22) && (e <= 22)) {
+      return e >= 0 ? v * pow10_exact[e] : v / pow10_exact[-e];
+    }
+
+    /* Moving part of the exponent into the significand if it stays
+       exact, for example 1e30.*/
+    if ((e > 22) && (e <= 22 + 15)) {
+      double w = v * pow10_exact[e - 22];
+
+      if (w <= (double)(1ULL << 53)) {
+        return w * pow10_exact[22];
+      }
+    }
+  }
+
+  if (e > 330) {
+    return INFINITY;
+  }
+  if (e < -360) {
+    return 0.0;
+  }
+  if (e < -300) {
+    /* Avoiding an overflow of the divisor near the subnormal range.*/
+    v /= 1e300;
+    e += 300;
+  }
+
+  ue = e < 0 ? (unsigned long)-e : (unsigned long)e;
+  s  = pow10_exact[ue & 15UL];
+  ue >>= 4;
+  for (i = 0U; ue != 0UL; i++, ue >>= 1) {
+    if ((ue & 1UL) != 0UL) {
+      s *= pow10_big[i];
+    }
+  }
+
+  return ch_correct10(dp, e0, e > 0 ? v * s : v / s);
+}
+
+/* Appends a digit exceeding the significand precision.*/
+static inline void ch_tail(decimal_t *dp, long digit)
+{
+
+  if (dp->ntail < TAIL_DIGITS) {
+    dp->tail = (dp->tail * 10U) + (uint64_t)digit;
+    dp->ntail++;
+  } else if (digit != 0) {
+    dp->sticky = true;
+  }
+}
 #endif
 
-/**
- * @brief   System formatted input function.
- * @details This function implements a minimal @p vscanf()-like functionality
- *          with input on a @p BaseSequentialStream.
- *          The general parameters format is: %[*][width][l|L]p
- *          The following parameter types (p) are supported:
- *          - <b>x</b> hexadecimal integer.
- *          - <b>X</b> hexadecimal long.
- *          - <b>o</b> octal integer.
- *          - <b>O</b> octal long.
- *          - <b>d</b> decimal signed integer.
- *          - <b>D</b> decimal signed long.
- *          - <b>u</b> decimal unsigned integer.
- *          - <b>U</b> decimal unsigned long.
- *          - <b>c</b> character.
- *          - <b>s</b> string.
- *          .
- *
- * @param[in] chp       pointer to a @p BufferedStream implementing object
- * @param[in] fmt       formatting string
- * @param[in] ap        list of parameters
- * @return              The number parameters in ap that have been successfully
- *                      filled. This does not conform to the standard in that if
- *                      a failure (either matching or input) occurs before any
- *                      parameters are assigned, the function will return 0.
- *
- * @api
- */
-int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
+static int ch_vscan(scanner_t *scp, const char *fmt, va_list ap)
 {
   char  f;
   msg_t c;
   int   width, base, i;
   int   n = 0;
   void* buf;
-  bool  is_long, is_signed, is_positive;
-  long  vall, digit;
+  bool  is_long, is_signed, is_positive, has_digit;
+  unsigned long vall;
+  long  digit;
 #if CHSCANF_USE_FLOAT
-  long   exp;
-  double valf;
-  char   exp_char;
-  int    exp_base;
-  bool   exp_is_positive, initial_digit;
-  char*  match;
-  int    fixed_point;
+  long     exp, scale;
+  decimal_t dec;
+  double   valf;
+  char     exp_char;
+  bool     exp_is_positive;
+  char*    match;
+  int      digits;
 #endif
 
   /* Peek the first character of the format string. If it is null,
@@ -138,7 +557,7 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
      (no peek function for the stream means an extra character is taken out every iteration of the
      loop, so each loop iteration uses the value of c from the last one. However, the first iteration
      has no value to work with, so we initialize it here) */
-  c = streamGet(chp);
+  c = sc_get(scp);
 
   while (c != STM_RESET && f != 0) {
 
@@ -150,7 +569,7 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
 
     if (isspace(f)) {
       while (isspace(c)) {
-        c = streamGet(chp);
+        c = sc_get(scp);
       }
       f = *fmt++;
       continue;
@@ -160,7 +579,7 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
       if (f != c) {
         break;
       } else {
-        c = streamGet(chp);
+        c = sc_get(scp);
         f = *fmt++;
         continue;
       }
@@ -173,7 +592,7 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
       if (f != c) {
         break;
       } else {
-        c = streamGet(chp);
+        c = sc_get(scp);
         f = *fmt++;
         continue;
       }
@@ -207,23 +626,24 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
 
     is_positive = true;
     is_signed   = true;
+    has_digit   = false;
     base        = 10;
 
     switch (f) {
 
     case 'c':
       /* Not supporting wchar_t, is_long is just ignored */
-      if (width == 0) {
+      if (width < 0) {
         width = 1;
       }
       for (i = 0; i < width; ++i) {
-        if (buf) {
-          ((char*)buf)[i] = c;
-        }
-        c = streamGet(chp);
         if (c == STM_RESET) {
           return n;
         }
+        if (buf) {
+          ((char*)buf)[i] = c;
+        }
+        c = sc_get(scp);
       }
       ++n;
       f = *fmt++;
@@ -232,66 +652,57 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
     case 's':
       /* S specifier discards leading whitespace */
       while (isspace(c)) {
-        c = streamGet(chp);
+        c = sc_get(scp);
         if (c == STM_RESET) {
           return n;
         }
       }
-      /* Not supporting wchar_t, is_long is just ignored */
-      if (width == 0) {
-        width = -1;
-      }
-      for (i = 0; i < width; ++i) {
-
-        if (isspace(c)) {
-          if (buf) {
-            ((char*)buf)[i] = 0;
-          }
-
+      /* Not supporting wchar_t, is_long is just ignored, no width
+         means no limit.*/
+      for (i = 0; (width < 0) || (i < width); ++i) {
+        if (isspace(c) || (c == STM_RESET)) {
           break;
         }
-
         if (buf) {
           ((char*)buf)[i] = c;
         }
-        c = streamGet(chp);
-        if (c == STM_RESET) {
-          return n;
-        }
+        c = sc_get(scp);
       }
-
-      if (width != -1) {
-        if (buf) {
-          ((char*)buf)[width] = 0;
-        }
+      if (buf) {
+        ((char*)buf)[i] = 0;
       }
       ++n;
+      if (c == STM_RESET) {
+        return n;
+      }
       f = *fmt++;
       continue;
 
 #if CHSCANF_USE_FLOAT
     case 'f':
-      valf          = -1;
       exp_char      = 'e';
-      exp_base      = 10;
-      fixed_point   = 0;
-      initial_digit = false;
+      dec.mant      = 0U;
+      dec.tail      = 0U;
+      dec.ntail     = 0U;
+      dec.sticky    = false;
+      scale         = 0;
+      digits        = 0;
       while (isspace(c)) {
-        c = streamGet(chp);
+        c = sc_get(scp);
       }
 
       if (c == '+') {
         if (--width == 0) {
           return n;
         }
-        c = streamGet(chp);
+        c = sc_get(scp);
 
       } else if (c == '-') {
         if (--width == 0) {
           return n;
         }
         is_positive = false;
-        c           = streamGet(chp);
+        c           = sc_get(scp);
       }
 
       /* Special cases: a float can be INF(INITY) or NAN. As a note about this behavior:
@@ -311,20 +722,20 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
       */
 
       if (tolower(c) == 'n') {
-        c = streamGet(chp);
+        c = sc_get(scp);
 
         match = "an";
         while (*match != 0) {
           if (*match != tolower(c)) {
-            streamUnget(chp, c);
+            sc_unget(scp, c);
             return n;
           }
           if (--width == 0) {
-            streamUnget(chp, c);
+            sc_unget(scp, c);
             return n;
           }
           ++match;
-          c = streamGet(chp);
+          c = sc_get(scp);
         }
 
         valf = NAN;
@@ -332,18 +743,18 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
       }
 
       if (tolower(c) == 'i') {
-        c = streamGet(chp);
+        c = sc_get(scp);
 
         match = "nf";
         while (*match != 0) {
           if (*match != tolower(c)) {
-            streamUnget(chp, c);
+            sc_unget(scp, c);
             return n;
           }
           ++match;
-          c = streamGet(chp);
+          c = sc_get(scp);
           if (--width == 0) {
-            streamUnget(chp, c);
+            sc_unget(scp, c);
             return n;
           }
         }
@@ -359,14 +770,14 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
           if (--width == 0) {
             break;
           }
-          c = streamGet(chp);
+          c = sc_get(scp);
         }
 
         goto float_common;
       }
 
       if (c == '0') {
-        c = streamGet(chp);
+        c = sc_get(scp);
         if (--width == 0) {
           valf = 0;
           goto float_common;
@@ -375,74 +786,78 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
         if (c == 'x' || c == 'X') {
           base     = 16;
           exp_char = 'p';
-          exp_base = 2;
-          c        = streamGet(chp);
+          c        = sc_get(scp);
           if (--width == 0) {
-            streamUnget(chp, c);
+            sc_unget(scp, c);
             return n;
           }
         } else {
-          valf = 0;
+          digits = 1;
         }
       }
 
-      if (sym_to_val(c, base) != -1) {
-        valf = 0;
-      }
-
+      /* The significand is accumulated as an integer, digits exceeding its
+         precision only affect the scale and are kept in the tail then
+         in the sticky flag.*/
       while (width--) {
         digit = sym_to_val(c, base);
         if (digit == -1) {
           break;
         }
-        valf = (valf * base) + (double)digit;
-        c    = streamGet(chp);
+        ++digits;
+        if (dec.mant < MANT_LIMIT) {
+          dec.mant = (dec.mant * (unsigned)base) + (uint64_t)digit;
+        } else {
+          ++scale;
+          ch_tail(&dec, digit);
+        }
+        c = sc_get(scp);
       }
 
       if (c == '.') {
-        c = streamGet(chp);
+        c = sc_get(scp);
 
         while (width--) {
           digit = sym_to_val(c, base);
           if (digit == -1) {
             break;
           }
-          if (valf == -1) {
-            valf = 0;
+          ++digits;
+          if (dec.mant < MANT_LIMIT) {
+            dec.mant = (dec.mant * (unsigned)base) + (uint64_t)digit;
+            --scale;
+          } else {
+            ch_tail(&dec, digit);
           }
-          valf = (valf * base) + (double)digit;
-          ++fixed_point;
-          c = streamGet(chp);
+          c = sc_get(scp);
         }
       }
 
-      if (valf == -1.0) {
-        streamUnget(chp, c);
+      if (digits == 0) {
+        sc_unget(scp, c);
         return n;
       }
 
-      valf = valf / ch_mpow(base, fixed_point);
-
+      exp = 0;
       if (tolower(c) == exp_char) {
         if (width-- == 0) {
           return n;
         }
-        c               = streamGet(chp);
+        c               = sc_get(scp);
         exp_is_positive = true;
-        exp             = 0;
 
         if (c == '+') {
           if (width-- == 0) {
             return n;
           }
-          c = streamGet(chp);
+          c = sc_get(scp);
 
         } else if (c == '-') {
           if (width-- == 0) {
             return n;
           }
           exp_is_positive = false;
-          c               = streamGet(chp);
+          c               = sc_get(scp);
         }
         /*
          "When parsing an incomplete floating-point value that ends in the exponent with no digits,
@@ -453,7 +868,7 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
         */
         digit = sym_to_val(c, 10);
         if (digit == -1) {
-          streamUnget(chp, c);
+          sc_unget(scp, c);
           return n;
         }
         while (width--) {
@@ -462,13 +877,43 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
           if (digit == -1) {
             break;
           }
-          exp = (exp * 10) + digit;
-          c   = streamGet(chp);
+          /* Saturating, the result is zero or infinity anyway.*/
+          if (exp < 100000) {
+            exp = (exp * 10) + digit;
+          }
+          c   = sc_get(scp);
+        }
+        if (!exp_is_positive) {
+          exp = -exp;
         }
-        if (exp_is_positive) {
-          valf = valf * (double)ch_mpow(exp_base, exp);
+      }
+
+      /* Hexadecimal significands have a binary exponent, the dropped digits
+         are folded into the last bit and floats are first rounded to odd
+         into a double so that only the final conversion rounds.*/
+      if (base == 16) {
+        uint64_t m = dec.mant;
+
+        if ((dec.tail != 0U) || dec.sticky) {
+          m |= 1U;
+        }
+        if (!is_long) {
+          while (m >= (1ULL << 53)) {
+            m = (m >> 1) | (m & 1U);
+            ++exp;
+          }
+        }
+        exp += scale * 4;
+        valf = (double)m;
+        if (exp >= 0) {
+          valf = valf * ch_mpow(2, (unsigned long)exp);
         } else {
-          valf = valf / (double)ch_mpow(exp_base, exp);
+          valf = valf / ch_mpow(2, (unsigned long)-exp);
+        }
+      } else {
+        valf = ch_scale10(&dec, exp + scale);
+        if (!is_long) {
+          valf = ch_odd10(&dec, exp + scale, valf);
         }
       }
 
@@ -494,36 +939,39 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
     case 'I':
       /* I specifier discards leading whitespace */
       while (isspace(c)) {
-        c = streamGet(chp);
+        c = sc_get(scp);
       }
       /* The char might be +, might be -, might be 0, or might be something else */
       if (c == '+') {
         if (--width == 0) {
           return n;
         }
-        c = streamGet(chp);
+        c = sc_get(scp);
       } else if (c == '-') {
         if (--width == 0) {
           return n;
         }
         is_positive = false;
-        c           = streamGet(chp);
+        c           = sc_get(scp);
       }
 
       if (c == '0') {
+        c = sc_get(scp);
         if (--width == 0) {
-          return ++n;
+          /* The whole field is a zero, it is stored as such.*/
+          has_digit = true;
+          break;
         }
-        c = streamGet(chp);
         if (c == 'x' || c == 'X') {
           base = 16;
           if (--width == 0) {
             return n;
           }
-          c = streamGet(chp);
+          c = sc_get(scp);
 
         } else {
-          base = 8;
+          base      = 8;
+          has_digit = true;
         }
       }
       break;
@@ -531,20 +979,20 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
     case 'd':
     case 'D':
       while (isspace(c)) {
-        c = streamGet(chp);
+        c = sc_get(scp);
       }
       if (c == '+') {
         if (--width == 0) {
           return n;
         }
-        c = streamGet(chp);
+        c = sc_get(scp);
 
       } else if (c == '-') {
         if (--width == 0) {
           return n;
         }
         is_positive = false;
-        c           = streamGet(chp);
+        c           = sc_get(scp);
       }
       break;
     case 'X':
@@ -554,30 +1002,34 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
       is_signed = false;
       base      = 16;
       while (isspace(c)) {
-        c = streamGet(chp);
+        c = sc_get(scp);
       }
       if (c == '+') {
         if (--width == 0) {
           return n;
         }
-        c = streamGet(chp);
+        c = sc_get(scp);
       } else if (c == '-') {
         if (--width == 0) {
           return n;
         }
         is_positive = false;
-        c           = streamGet(chp);
+        c           = sc_get(scp);
       }
       if (c == '0') {
+        c = sc_get(scp);
         if (--width == 0) {
-          return ++n;
+          /* The whole field is a zero, it is stored as such.*/
+          has_digit = true;
+          break;
         }
-        c = streamGet(chp);
         if (c == 'x' || c == 'X') {
           if (--width == 0) {
             return n;
           }
-          c = streamGet(chp);
+          c = sc_get(scp);
+        } else {
+          has_digit = true;
         }
       }
       break;
@@ -585,19 +1037,19 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
     case 'u':
       is_signed = false;
       while (isspace(c)) {
-        c = streamGet(chp);
+        c = sc_get(scp);
       }
       if (c == '+') {
         if (--width == 0) {
           return n;
         }
-        c = streamGet(chp);
+        c = sc_get(scp);
       } else if (c == '-') {
         if (--width == 0) {
           return n;
         }
         is_positive = false;
-        c           = streamGet(chp);
+        c           = sc_get(scp);
       }
       break;
     case 'O':
@@ -605,63 +1057,126 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
       is_signed = false;
       base      = 8;
       while (isspace(c)) {
-        c = streamGet(chp);
+        c = sc_get(scp);
       }
 
       if (c == '+') {
         if (--width == 0) {
           return n;
         }
-        c = streamGet(chp);
+        c = sc_get(scp);
       } else if (c == '-') {
         if (--width == 0) {
           return n;
         }
         is_positive = false;
-        c           = streamGet(chp);
+        c           = sc_get(scp);
       }
 
       break;
     default:
-      streamUnget(chp, c);
+      sc_unget(scp, c);
       return n;
     }
 
     vall = 0UL;
 
-    /* If we don't have at least one additional eligible character, it's a matching failure */
-    if (sym_to_val(c, base) == -1) {
+    /* If we don't have at least one additional eligible character, it's a
+       matching failure, a leading zero already counts as a digit */
+    if (!has_digit && (sym_to_val(c, base) == -1)) {
       break;
     }
 
-    while (width--) {
-      digit = sym_to_val(c, base);
-      if (digit == -1) {
-        break;
+    if (base == 10) {
+      /* Decimal fast path, multiplication by a constant.*/
+      while (width--) {
+        unsigned long d = (unsigned long)c - (unsigned long)'0';
+
+        if (d > 9UL) {
+          break;
+        }
+        vall = (vall * 10UL) + d;
+        c    = sc_get(scp);
+      }
+    } else {
+      while (width--) {
+        digit = sym_to_val(c, base);
+        if (digit == -1) {
+          break;
+        }
+        vall = (vall * (unsigned long)base) + (unsigned long)digit;
+        c    = sc_get(scp);
       }
-      vall = (vall * base) + digit;
-      c    = streamGet(chp);
     }
 
     if (!is_positive) {
-      vall = -1 * vall;
+      vall = 0UL - vall;
     }
 
     if (buf) {
       if (is_long && is_signed) {
-        *((signed long*)buf) = vall;
+        *((signed long*)buf) = (signed long)vall;
       } else if (is_long && !is_signed) {
         *((unsigned long*)buf) = vall;
       } else if (!is_long && is_signed) {
-        *((signed int*)buf) = vall;
+        *((signed int*)buf) = (signed int)vall;
       } else if (!is_long && !is_signed) {
-        *((unsigned int*)buf) = vall;
+        *((unsigned int*)buf) = (unsigned int)vall;
       }
     }
     f = *fmt++;
     ++n;
   }
-  streamUnget(chp, c);
+  sc_unget(scp, c);
+  return n;
+}
+
+/**
+ * @brief   System formatted input function.
+ * @details This function implements a minimal @p vscanf()-like functionality
+ *          with input on a @p BaseSequentialStream.
+ *          The general parameters format is: %[*][width][l|L]p
+ *          The following parameter types (p) are supported:
+ *          - <b>x</b> hexadecimal integer.
+ *          - <b>X</b> hexadecimal long.
+ *          - <b>o</b> octal integer.
+ *          - <b>O</b> octal long.
+ *          - <b>d</b> decimal signed integer.
+ *          - <b>D</b> decimal signed long.
+ *          - <b>u</b> decimal unsigned integer.
+ *          - <b>U</b> decimal unsigned long.
+ *          - <b>c</b> character.
+ *          - <b>s</b> string.
+ *          .
+ * @note    Data already buffered by the stream is scanned in place, see
+ *          @p streamBorrow().
+ *
+ * @param[in] chp       pointer to a @p BufferedStream implementing object
+ * @param[in] fmt       formatting string
+ * @param[in] ap        list of parameters
+ * @return              The number parameters in ap that have been successfully
+ *                      filled. This does not conform to the standard in that if
+ *                      a failure (either matching or input) occurs before any
+ *                      parameters are assigned, the function will return 0.
+ *
+ * @api
+ */
+int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
+{
+  scanner_t sc;
+  int       n;
+
+  sc.chp      = chp;
+  sc.base     = NULL;
+  sc.ptr      = NULL;
+  sc.end      = NULL;
+  sc.windowed = false;
+
+  n = ch_vscan(&sc, fmt, ap);
+
+  /* Consuming the scanned part of the borrowed window, if any.*/
+  sc_release(&sc);
+
   return n;
 }
 
@@ -776,16 +1291,16 @@ int chsnscanf(char *str, size_t size, const char *fmt, ...)
 int chvsnscanf(char *str, size_t size, const char *fmt, va_list ap)
 {
   MemoryStream   ms;
-  size_t         size_wo_nul;
+  size_t         len;
 
-  if (size > 0)
-    size_wo_nul = size - 1;
-  else
-    size_wo_nul = 0;
+  /* The string ends at the first zero or at the buffer end.*/
+  len = 0;
+  while ((len < size) && (str[len] != 0)) {
+    len++;
+  }
 
-  /* Memory stream object to be used as a string writer, reserving one
-     byte for the final zero. */
-  msObjectInit(&ms, (uint8_t*)str, size_wo_nul, 0);
+  /* Memory stream object to be used as a string reader.*/
+  msObjectInit(&ms, (uint8_t*)str, len, len);
 
   /* Performing the scan operation using the common code and
      return number of receiving arguments successfully assigned. */
@@ -97,7 +97,22 @@ static msg_t _unget(void* ip, uint8_t b)
   return MSG_OK;
 }
 
-static const struct MemStreamVMT vmt = {(size_t)0, _writes, _reads, _put, _get, _unget};
+static size_t _borrow(void *ip, const uint8_t **pp) {
+  MemoryStream *msp = ip;
+
+  *pp = msp->buffer + msp->offset;
+
+  return msp->eos - msp->offset;
+}
+
+static void _return(void *ip, size_t n) {
+  MemoryStream *msp = ip;
+
+  msp->offset += n;
+}
+
+static const struct MemStreamVMT vmt = {(size_t)0, _writes, _reads, _put, _get,
+                                        _unget, _borrow, _return};
 
 /*===========================================================================*/
 /* Driver exported functions.                                                */
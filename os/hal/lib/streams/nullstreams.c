@@ -83,7 +83,23 @@ static msg_t unget(void* ip, uint8_t b)
   return MSG_OK;
 }
 
-static const struct NullStreamVMT vmt = {(size_t)0, writes, reads, put, get, unget};
+static size_t borrow(void *ip, const uint8_t **pp) {
+
+  (void)ip;
+
+  *pp = NULL;
+
+  return 0;
+}
+
+static void ret(void *ip, size_t n) {
+
+  (void)ip;
+  (void)n;
+}
+
+static const struct NullStreamVMT vmt = {(size_t)0, writes, reads, put, get,
+                                         unget, borrow, ret};
 
 /*===========================================================================*/
 /* Driver exported functions.                                                */
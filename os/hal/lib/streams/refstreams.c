@@ -0,0 +1,224 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+/**
+ * @file    refstreams.c
+ * @brief   Reference-counted buffer streams code.
+ *
+ * @addtogroup HAL_REFBUF_STREAMS
+ * @details Chains of reference-counted buffers handled as streams.
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+#include "refstreams.h"
+
+#if (defined(CH_CFG_USE_REFBUFS) && (CH_CFG_USE_REFBUFS == TRUE)) ||      \
+    defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static size_t _writes(void *ip, const uint8_t *bp, size_t n) {
+  RefStream *rsp = ip;
+  size_t done = 0;
+
+  while (done < n) {
+    if ((rsp->tail == NULL) || (chRefBufGetTailroomX(rsp->tail) == 0U)) {
+      refbuf_t *rbp;
+
+      if (rsp->pool == NULL) {
+        break;
+      }
+      rbp = chRefBufAllocTimeout(rsp->pool, TIME_IMMEDIATE);
+      if (rbp == NULL) {
+        break;
+      }
+      if (rsp->tail == NULL) {
+        rsp->head = rbp;
+      }
+      else {
+        rsp->tail->next = rbp;
+      }
+      rsp->tail = rbp;
+    }
+    done += chRefBufCopyIn(rsp->tail, bp + done, n - done);
+  }
+  return done;
+}
+
+static size_t _reads(void *ip, uint8_t *bp, size_t n) {
+  RefStream *rsp = ip;
+  size_t done = 0;
+
+  while ((rsp->head != NULL) && (done < n)) {
+    refbuf_t *rbp = rsp->head;
+    size_t chunk = n - done;
+
+    /* Copying from the head buffer only, the following links are consumed
+       in the next iterations.*/
+    if (chunk > chRefBufGetLengthX(rbp)) {
+      chunk = chRefBufGetLengthX(rbp);
+    }
+    memcpy(bp + done, chRefBufGetDataX(rbp), chunk);
+    (void) chRefBufPullX(rbp, chunk);
+    done += chunk;
+
+    /* Buffers are released as soon as they have been consumed, the last
+       one is kept while there is tailroom left for writes.*/
+    if ((chRefBufGetLengthX(rbp) == 0U) &&
+        ((rbp->next != NULL) || (chRefBufGetTailroomX(rbp) == 0U))) {
+      rsp->head = rbp->next;
+      if (rsp->head == NULL) {
+        rsp->tail = NULL;
+      }
+      rbp->next = NULL;
+      chRefBufRelease(rbp);
+    }
+    else if (chunk == 0U) {
+      break;
+    }
+  }
+  return done;
+}
+
+static msg_t _put(void *ip, uint8_t b) {
+
+  if (_writes(ip, &b, 1) == 0U)
+    return MSG_RESET;
+  return MSG_OK;
+}
+
+static msg_t _get(void *ip) {
+  uint8_t b;
+
+  if (_reads(ip, &b, 1) == 0U)
+    return MSG_RESET;
+  return b;
+}
+
+static const struct RefStreamVMT vmt = {(size_t)0, _writes, _reads, _put, _get};
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Reference-counted buffer stream object initialization.
+ *
+ * @param[out] rsp      pointer to the @p RefStream object to be initialized
+ * @param[in] rbpp      pointer to the pool used for extending the chain on
+ *                      write or @p NULL for a read-only stream
+ */
+void rsObjectInit(RefStream *rsp, refbuf_pool_t *rbpp) {
+
+  rsp->vmt  = &vmt;
+  rsp->pool = rbpp;
+  rsp->head = NULL;
+  rsp->tail = NULL;
+}
+
+/**
+ * @brief   Appends a buffer chain to the stream.
+ * @details The caller reference is transferred to the stream, the chain
+ *          payload becomes readable from the stream.
+ * @pre     The chain is consumed by reads so it must not be shared.
+ *
+ * @param[in] rsp       pointer to the @p RefStream object
+ * @param[in] bp        pointer to the buffer chain
+ */
+void rsAttach(RefStream *rsp, refbuf_t *bp) {
+
+  osalDbgCheck((rsp != NULL) && (bp != NULL));
+
+  if (rsp->tail == NULL) {
+    rsp->head = bp;
+  }
+  else {
+    rsp->tail->next = bp;
+  }
+  while (bp->next != NULL) {
+    bp = bp->next;
+  }
+  rsp->tail = bp;
+}
+
+/**
+ * @brief   Removes the buffer chain from the stream.
+ * @details The chain reference is transferred to the caller, this is
+ *          the zero-copy way to hand over what has been written into
+ *          the stream.
+ *
+ * @param[in] rsp       pointer to the @p RefStream object
+ * @return              The buffer chain or @p NULL if the stream is empty.
+ */
+refbuf_t *rsDetach(RefStream *rsp) {
+  refbuf_t *bp;
+
+  osalDbgCheck(rsp != NULL);
+
+  bp = rsp->head;
+  rsp->head = NULL;
+  rsp->tail = NULL;
+
+  return bp;
+}
+
+/**
+ * @brief   Writes a buffer chain into a generic stream.
+ * @details Each buffer payload is passed to the stream in a single write
+ *          operation, the chain is not released.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream implementation
+ * @param[in] bp        pointer to the buffer chain
+ * @return              The number of bytes effectively written.
+ */
+size_t rsWriteChain(BaseSequentialStream *chp, const refbuf_t *bp) {
+  size_t done = 0;
+
+  osalDbgCheck(chp != NULL);
+
+  while (bp != NULL) {
+    size_t n = streamWrite(chp, chRefBufGetDataX(bp), chRefBufGetLengthX(bp));
+
+    done += n;
+    if (n < chRefBufGetLengthX(bp)) {
+      break;
+    }
+    bp = bp->next;
+  }
+  return done;
+}
+
+#endif /* CH_CFG_USE_REFBUFS == TRUE */
+
+/** @} */
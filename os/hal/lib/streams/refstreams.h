@@ -0,0 +1,103 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+/**
+ * @file    refstreams.h
+ * @brief   Reference-counted buffer streams structures and macros.
+ *
+ * @addtogroup HAL_REFBUF_STREAMS
+ * @{
+ */
+
+#ifndef REFSTREAMS_H
+#define REFSTREAMS_H
+
+#if (defined(CH_CFG_USE_REFBUFS) && (CH_CFG_USE_REFBUFS == TRUE)) ||      \
+    defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   @p RefStream specific data.
+ */
+#define _ref_stream_data                                                    \
+  _base_sequential_stream_data                                              \
+  /* Pool used for extending the chain on write.*/                          \
+  refbuf_pool_t         *pool;                                              \
+  /* First buffer of the chain, read side.*/                                \
+  refbuf_t              *head;                                              \
+  /* Last buffer of the chain, write side.*/                                \
+  refbuf_t              *tail;
+
+/**
+ * @brief   @p RefStream virtual methods table.
+ */
+struct RefStreamVMT {
+  _base_sequential_stream_methods
+};
+
+/**
+ * @extends BaseSequentialStream
+ *
+ * @brief   Reference-counted buffer stream object.
+ * @details The stream is backed by a chain of reference-counted buffers,
+ *          writes append to the chain and reads consume it.
+ */
+typedef struct {
+  /** @brief Virtual Methods Table.*/
+  const struct RefStreamVMT *vmt;
+  _ref_stream_data
+} RefStream;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void rsObjectInit(RefStream *rsp, refbuf_pool_t *rbpp);
+  void rsAttach(RefStream *rsp, refbuf_t *bp);
+  refbuf_t *rsDetach(RefStream *rsp);
+  size_t rsWriteChain(BaseSequentialStream *chp, const refbuf_t *bp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CH_CFG_USE_REFBUFS == TRUE */
+
+#endif /* REFSTREAMS_H */
+
+/** @} */
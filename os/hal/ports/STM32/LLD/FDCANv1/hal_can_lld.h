@@ -426,6 +426,12 @@ struct CANDriver {
    */
   can_callback_t            wakeup_cb;
 #endif
+#endif
+#if (CAN_USE_RX_QUEUES == TRUE) || defined (__DOXYGEN__)
+  /**
+   * @brief   Software receive queues.
+   */
+  _can_rx_queues_data
 #endif
   /* End of the mandatory fields.*/
   /**
@@ -0,0 +1,524 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/hal_can_lld.c
+ * @brief   Posix simulator low level CAN driver code.
+ * @details The simulated CAN nodes share a single bus inside the simulator
+ *          process. Pending frames contend for the bus using the standard
+ *          identifier arbitration and occupy it for the nominal duration of
+ *          the frame at the transmitter bit rate, bit stuffing is not
+ *          accounted for. Completed frames are delivered to the receive
+ *          mailboxes of all the other active nodes.
+ *
+ * @addtogroup POSIX_CAN
+ * @{
+ */
+
+#include <sys/time.h>
+
+#include "hal.h"
+
+#if (HAL_USE_CAN == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Number of simulated nodes.
+ */
+#define SIM_CAN_NODES   ((USE_SIM_CAN1 == TRUE) + (USE_SIM_CAN2 == TRUE) +  \
+                         (USE_SIM_CAN3 == TRUE))
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   CAN1 driver identifier.
+ */
+#if (USE_SIM_CAN1 == TRUE) || defined(__DOXYGEN__)
+CANDriver CAND1;
+#endif
+
+/**
+ * @brief   CAN2 driver identifier.
+ */
+#if (USE_SIM_CAN2 == TRUE) || defined(__DOXYGEN__)
+CANDriver CAND2;
+#endif
+
+/**
+ * @brief   CAN3 driver identifier.
+ */
+#if (USE_SIM_CAN3 == TRUE) || defined(__DOXYGEN__)
+CANDriver CAND3;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Nodes attached to the simulated bus.
+ */
+static CANDriver * const nodes[SIM_CAN_NODES] = {
+#if USE_SIM_CAN1 == TRUE
+  &CAND1,
+#endif
+#if USE_SIM_CAN2 == TRUE
+  &CAND2,
+#endif
+#if USE_SIM_CAN3 == TRUE
+  &CAND3,
+#endif
+};
+
+/**
+ * @brief   Simulated bus state.
+ */
+static struct {
+  /**
+   * @brief   Node transmitting the current frame or @p NULL if idle.
+   */
+  CANDriver                 *node;
+  /**
+   * @brief   Transmit mailbox of the current frame.
+   */
+  canmbx_t                  mailbox;
+  /**
+   * @brief   End time of the current frame in nanoseconds.
+   */
+  uint64_t                  end;
+} bus;
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the host time in nanoseconds.
+ */
+static uint64_t can_now(void) {
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return ((uint64_t)tv.tv_sec * 1000000000U) +
+         ((uint64_t)tv.tv_usec * 1000U);
+}
+
+/**
+ * @brief   Arbitration field of a frame, lower values win the bus.
+ * @details The value follows the order of the bits on the wire: the base
+ *          identifier, the RTR or SRR bit, the IDE bit then, for extended
+ *          frames, the identifier extension and the RTR bit.
+ *
+ * @param[in] ctfp      pointer to the frame
+ * @return              The arbitration key.
+ */
+static uint32_t can_arbitration_key(const CANTxFrame *ctfp) {
+
+  if (ctfp->IDE) {
+    return ((ctfp->EID >> 18) << 21) | (1U << 20) | (1U << 19) |
+           ((ctfp->EID & 0x3FFFFU) << 1) | ctfp->RTR;
+  }
+  return ((uint32_t)ctfp->SID << 21) | ((uint32_t)ctfp->RTR << 20);
+}
+
+/**
+ * @brief   Nominal length of a frame in bits, without stuffing.
+ *
+ * @param[in] ctfp      pointer to the frame
+ * @return              The number of bits including the interframe space.
+ */
+static uint32_t can_frame_bits(const CANTxFrame *ctfp) {
+  uint32_t len = 0U;
+
+  if (!ctfp->RTR) {
+    len = ctfp->DLC > 8U ? 8U : ctfp->DLC;
+  }
+
+  return (ctfp->IDE ? 67U : 47U) + (len * 8U);
+}
+
+/**
+ * @brief   Puts on the bus the highest priority pending frame.
+ *
+ * @param[in] start     frame start time in nanoseconds
+ * @return              The operation status.
+ * @retval false        if the bus is left idle.
+ * @retval true         if a frame has been started.
+ */
+static bool can_arbitrate(uint64_t start) {
+  uint32_t bestkey = 0xFFFFFFFFU, bestorder = 0U;
+  unsigned i;
+
+  bus.node = NULL;
+  for (i = 0U; i < SIM_CAN_NODES; i++) {
+    CANDriver *canp = nodes[i];
+    canmbx_t mailbox;
+
+    if (canp->state != CAN_READY) {
+      continue;
+    }
+    for (mailbox = 1U; mailbox <= (canmbx_t)CAN_TX_MAILBOXES; mailbox++) {
+      if ((canp->txpending & CAN_MAILBOX_TO_MASK(mailbox)) != 0U) {
+        uint32_t key = can_arbitration_key(&canp->txmbx[mailbox - 1U]);
+        uint32_t order = canp->txorder[mailbox - 1U];
+
+        /* Between mailboxes of the same node with equal identifiers the
+           oldest request wins.*/
+        if ((bus.node == NULL) || (key < bestkey) ||
+            ((key == bestkey) && (bus.node == canp) &&
+             ((int32_t)(order - bestorder) < 0))) {
+          bestkey     = key;
+          bestorder   = order;
+          bus.node    = canp;
+          bus.mailbox = mailbox;
+        }
+      }
+    }
+  }
+
+  if (bus.node == NULL) {
+    return false;
+  }
+
+  bus.end = start;
+  if (bus.node->config->bitrate > 0U) {
+    bus.end += ((uint64_t)can_frame_bits(&bus.node->txmbx[bus.mailbox - 1U]) *
+                1000000000U) / bus.node->config->bitrate;
+  }
+  return true;
+}
+
+/**
+ * @brief   Delivers the frame at the end of its transmission.
+ * @note    Called with the bus not idle.
+ */
+static void can_complete(void) {
+  CANDriver *sender = bus.node;
+  const CANTxFrame *ctfp = &sender->txmbx[bus.mailbox - 1U];
+  canmbx_t rxmailbox = ctfp->IDE ? 2U : 1U;
+  uint32_t txflags = CAN_MAILBOX_TO_MASK(bus.mailbox);
+  unsigned i;
+
+  for (i = 0U; i < SIM_CAN_NODES; i++) {
+    CANDriver *canp = nodes[i];
+
+    if (canp == sender) {
+      continue;
+    }
+
+#if CAN_USE_SLEEP_MODE == TRUE
+    /* Bus activity wakes up sleeping nodes, the frame itself is lost.*/
+    if (canp->state == CAN_SLEEP) {
+      canp->state = CAN_READY;
+      _can_wakeup_isr(canp);
+      continue;
+    }
+#endif
+
+    if (canp->state == CAN_READY) {
+      unsigned rx = (unsigned)rxmailbox - 1U;
+
+      if (canp->rxfifo[rx].cnt < (unsigned)SIM_CAN_RX_FIFO_SIZE) {
+        CANRxFrame *crfp;
+
+        osalSysLockFromISR();
+        crfp = &canp->rxfifo[rx].frames[(canp->rxfifo[rx].rdidx +
+                                         canp->rxfifo[rx].cnt) %
+                                        SIM_CAN_RX_FIFO_SIZE];
+        crfp->FMI     = 0U;
+        crfp->TIME    = (uint16_t)(bus.end / 1000U);
+        crfp->DLC     = ctfp->DLC;
+        crfp->RTR     = ctfp->RTR;
+        crfp->IDE     = ctfp->IDE;
+        crfp->_align1 = ctfp->_align1;
+        crfp->data32[0] = ctfp->data32[0];
+        crfp->data32[1] = ctfp->data32[1];
+        canp->rxfifo[rx].cnt++;
+        osalSysUnlockFromISR();
+
+        _can_rx_full_isr(canp, CAN_MAILBOX_TO_MASK(rxmailbox));
+      }
+      else {
+        _can_error_isr(canp, CAN_OVERFLOW_ERROR);
+      }
+    }
+  }
+
+  osalSysLockFromISR();
+  sender->txpending &= ~txflags;
+  osalSysUnlockFromISR();
+
+  _can_tx_empty_isr(sender, txflags);
+}
+
+/**
+ * @brief   Returns the index of a free transmit mailbox.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number, @p CAN_ANY_MAILBOX for any mailbox
+ * @return              The free mailbox index or zero if none.
+ */
+static canmbx_t can_free_tx_mailbox(CANDriver *canp, canmbx_t mailbox) {
+
+  if (mailbox == CAN_ANY_MAILBOX) {
+    for (mailbox = 1U; mailbox <= (canmbx_t)CAN_TX_MAILBOXES; mailbox++) {
+      if ((canp->txpending & CAN_MAILBOX_TO_MASK(mailbox)) == 0U) {
+        return mailbox;
+      }
+    }
+    return 0U;
+  }
+  return (canp->txpending & CAN_MAILBOX_TO_MASK(mailbox)) == 0U ? mailbox : 0U;
+}
+
+/**
+ * @brief   Returns the index of a non-empty receive mailbox.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number, @p CAN_ANY_MAILBOX for any mailbox
+ * @return              The non-empty mailbox index or zero if none.
+ */
+static canmbx_t can_full_rx_mailbox(CANDriver *canp, canmbx_t mailbox) {
+
+  if (mailbox == CAN_ANY_MAILBOX) {
+    for (mailbox = 1U; mailbox <= (canmbx_t)CAN_RX_MAILBOXES; mailbox++) {
+      if (canp->rxfifo[mailbox - 1U].cnt > 0U) {
+        return mailbox;
+      }
+    }
+    return 0U;
+  }
+  return canp->rxfifo[mailbox - 1U].cnt > 0U ? mailbox : 0U;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level CAN driver initialization.
+ *
+ * @notapi
+ */
+void can_lld_init(void) {
+  unsigned i;
+
+  for (i = 0U; i < SIM_CAN_NODES; i++) {
+    canObjectInit(nodes[i]);
+    nodes[i]->txpending = 0U;
+  }
+  bus.node = NULL;
+}
+
+/**
+ * @brief   Configures and activates the CAN peripheral.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_start(CANDriver *canp) {
+  unsigned i;
+
+  canp->txpending = 0U;
+  canp->txcnt     = 0U;
+  for (i = 0U; i < (unsigned)CAN_RX_MAILBOXES; i++) {
+    canp->rxfifo[i].rdidx = 0U;
+    canp->rxfifo[i].cnt   = 0U;
+  }
+}
+
+/**
+ * @brief   Deactivates the CAN peripheral.
+ * @note    A frame being transmitted by the node is truncated.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_stop(CANDriver *canp) {
+
+  if (bus.node == canp) {
+    bus.node = NULL;
+  }
+  canp->txpending = 0U;
+}
+
+/**
+ * @brief   Determines whether a frame can be transmitted.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number, @p CAN_ANY_MAILBOX for any mailbox
+ *
+ * @return              The queue space availability.
+ * @retval false        no space in the transmit queue.
+ * @retval true         transmit slot available.
+ *
+ * @notapi
+ */
+bool can_lld_is_tx_empty(CANDriver *canp, canmbx_t mailbox) {
+
+  return can_free_tx_mailbox(canp, mailbox) != 0U;
+}
+
+/**
+ * @brief   Inserts a frame into the transmit queue.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] ctfp      pointer to the CAN frame to be transmitted
+ * @param[in] mailbox   mailbox number,  @p CAN_ANY_MAILBOX for any mailbox
+ *
+ * @notapi
+ */
+void can_lld_transmit(CANDriver *canp,
+                      canmbx_t mailbox,
+                      const CANTxFrame *ctfp) {
+
+  mailbox = can_free_tx_mailbox(canp, mailbox);
+  canp->txmbx[mailbox - 1U]   = *ctfp;
+  canp->txorder[mailbox - 1U] = canp->txcnt++;
+  canp->txpending |= CAN_MAILBOX_TO_MASK(mailbox);
+}
+
+/**
+ * @brief   Determines whether a frame has been received.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number, @p CAN_ANY_MAILBOX for any mailbox
+ *
+ * @return              The queue space availability.
+ * @retval false        no space in the transmit queue.
+ * @retval true         transmit slot available.
+ *
+ * @notapi
+ */
+bool can_lld_is_rx_nonempty(CANDriver *canp, canmbx_t mailbox) {
+
+  return can_full_rx_mailbox(canp, mailbox) != 0U;
+}
+
+/**
+ * @brief   Receives a frame from the input queue.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number, @p CAN_ANY_MAILBOX for any mailbox
+ * @param[out] crfp     pointer to the buffer where the CAN frame is copied
+ *
+ * @notapi
+ */
+void can_lld_receive(CANDriver *canp,
+                     canmbx_t mailbox,
+                     CANRxFrame *crfp) {
+  unsigned rx;
+
+  rx = (unsigned)can_full_rx_mailbox(canp, mailbox) - 1U;
+  *crfp = canp->rxfifo[rx].frames[canp->rxfifo[rx].rdidx];
+  canp->rxfifo[rx].rdidx = (canp->rxfifo[rx].rdidx + 1U) %
+                           SIM_CAN_RX_FIFO_SIZE;
+  canp->rxfifo[rx].cnt--;
+}
+
+/**
+ * @brief   Tries to abort an ongoing transmission.
+ * @note    A frame already on the bus cannot be aborted.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number
+ *
+ * @notapi
+ */
+void can_lld_abort(CANDriver *canp,
+                   canmbx_t mailbox) {
+
+  if ((bus.node != canp) || (bus.mailbox != mailbox)) {
+    canp->txpending &= ~CAN_MAILBOX_TO_MASK(mailbox);
+  }
+}
+
+#if (CAN_USE_SLEEP_MODE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Enters the sleep mode.
+ * @note    A sleeping node neither transmits nor receives, the first frame
+ *          seen on the bus wakes it up.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_sleep(CANDriver *canp) {
+
+  (void)canp;
+}
+
+/**
+ * @brief   Enforces leaving the sleep mode.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_wakeup(CANDriver *canp) {
+
+  (void)canp;
+}
+#endif /* CAN_USE_SLEEP_MODE == TRUE */
+
+/**
+ * @brief   Simulated bus activity.
+ * @details Completes the frames whose time on the bus has elapsed, frames
+ *          pending at the end of a transmission follow back to back.
+ *
+ * @return              The interrupt activity status.
+ * @retval false        if no interrupt occurred.
+ * @retval true         if an interrupt occurred.
+ *
+ * @notapi
+ */
+bool can_lld_interrupt_pending(void) {
+  bool b = false;
+  uint64_t now = can_now();
+
+  if ((bus.node == NULL) && !can_arbitrate(now)) {
+    return false;
+  }
+
+  OSAL_IRQ_PROLOGUE();
+
+  while ((bus.node != NULL) && (bus.end <= now)) {
+    uint64_t end = bus.end;
+
+    can_complete();
+    b = true;
+    (void)can_arbitrate(end);
+  }
+
+  OSAL_IRQ_EPILOGUE();
+
+  return b;
+}
+
+#endif /* HAL_USE_CAN == TRUE */
+
+/** @} */
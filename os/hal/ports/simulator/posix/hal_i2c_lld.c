@@ -0,0 +1,431 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/hal_i2c_lld.c
+ * @brief   Posix simulator low level I2C driver code.
+ * @details The configuration lists the device models on the bus, data is
+ *          exchanged with the addressed model when a transfer starts and
+ *          the completion interrupt is raised after the time the transfer
+ *          takes at the configured bus clock. Transfers started from the
+ *          completion interrupt follow the previous one back to back.
+ *
+ * @addtogroup POSIX_I2C
+ * @{
+ */
+
+#include <sys/time.h>
+
+#include "hal.h"
+
+#if (HAL_USE_I2C == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   I2C1 driver identifier.
+ */
+#if (USE_SIM_I2C1 == TRUE) || defined(__DOXYGEN__)
+I2CDriver I2CD1;
+#endif
+
+/**
+ * @brief   I2C2 driver identifier.
+ */
+#if (USE_SIM_I2C2 == TRUE) || defined(__DOXYGEN__)
+I2CDriver I2CD2;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the host time in nanoseconds.
+ */
+static uint64_t i2c_now(void) {
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return ((uint64_t)tv.tv_sec * 1000000000U) +
+         ((uint64_t)tv.tv_usec * 1000U);
+}
+
+/**
+ * @brief   Register file write.
+ * @details The first byte selects the register, the following bytes are
+ *          stored starting from it.
+ */
+static bool regfile_write(sim_i2c_device_t *devp,
+                          const uint8_t *buf, size_t n) {
+  sim_i2c_regfile_t *rfp = (sim_i2c_regfile_t *)devp;
+  size_t i;
+
+  if ((size_t)buf[0] >= rfp->size) {
+    return false;
+  }
+
+  rfp->ptr = (size_t)buf[0];
+  for (i = 1U; i < n; i++) {
+    rfp->regs[rfp->ptr] = buf[i];
+    rfp->ptr = (rfp->ptr + 1U) % rfp->size;
+  }
+
+  return true;
+}
+
+/**
+ * @brief   Register file read.
+ * @details Returns the registers starting from the selected one.
+ */
+static bool regfile_read(sim_i2c_device_t *devp, uint8_t *buf, size_t n) {
+  sim_i2c_regfile_t *rfp = (sim_i2c_regfile_t *)devp;
+  size_t i;
+
+  if (rfp->update != NULL) {
+    rfp->update(rfp);
+  }
+
+  for (i = 0U; i < n; i++) {
+    buf[i] = rfp->regs[rfp->ptr];
+    rfp->ptr = (rfp->ptr + 1U) % rfp->size;
+  }
+
+  return true;
+}
+
+/**
+ * @brief   Performs a transfer and schedules its completion.
+ * @note    A transfer to an address without device is not acknowledged
+ *          after the address byte.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[in] txbuf     pointer to the transmit buffer
+ * @param[in] txbytes   number of bytes to be transmitted, can be zero
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received, can be zero
+ */
+static void i2c_transfer(I2CDriver *i2cp, i2caddr_t addr,
+                         const uint8_t *txbuf, size_t txbytes,
+                         uint8_t *rxbuf, size_t rxbytes) {
+  sim_i2c_device_t * const *dpp = i2cp->config->devices;
+  sim_i2c_device_t *devp = NULL;
+  uint64_t bits;
+
+  while ((dpp != NULL) && (*dpp != NULL)) {
+    if ((*dpp)->addr == addr) {
+      devp = *dpp;
+      break;
+    }
+    dpp++;
+  }
+
+  /* Start and stop conditions, then 9 bits for the address byte and for
+     each data byte of each direction.*/
+  i2cp->pending = I2C_NO_ERROR;
+  bits = 2U;
+  if (devp == NULL) {
+    i2cp->pending = I2C_ACK_FAILURE;
+    bits += 9U;
+  }
+  else {
+    if (txbytes > 0U) {
+      bits += 9U * (1U + (uint64_t)txbytes);
+      if (!devp->write(devp, txbuf, txbytes)) {
+        i2cp->pending = I2C_ACK_FAILURE;
+      }
+    }
+    if ((rxbytes > 0U) && (i2cp->pending == I2C_NO_ERROR)) {
+      bits += 9U * (1U + (uint64_t)rxbytes);
+      if (!devp->read(devp, rxbuf, rxbytes)) {
+        i2cp->pending = I2C_ACK_FAILURE;
+      }
+    }
+  }
+
+  if (i2cp->config->clock == 0U) {
+    i2cp->end = i2c_now();
+  }
+  else {
+    i2cp->end = i2cp->chained != 0U ? i2cp->chained : i2c_now();
+    i2cp->end += (bits * 1000000000U) / i2cp->config->clock;
+  }
+  i2cp->busy = true;
+}
+
+/**
+ * @brief   Serves the transfer completion interrupts of a driver.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] now       current host time in nanoseconds
+ * @return              The interrupt activity status.
+ */
+static bool i2c_serve_interrupt(I2CDriver *i2cp, uint64_t now) {
+  bool b = false;
+
+  while (i2cp->busy && (i2cp->end < now)) {
+    i2cp->busy    = false;
+    i2cp->chained = i2cp->end;
+    i2cp->errors  = i2cp->pending;
+    if (i2cp->errors != I2C_NO_ERROR) {
+      _i2c_wakeup_error_isr(i2cp);
+    }
+    else {
+      _i2c_wakeup_isr(i2cp);
+    }
+    i2cp->chained = 0U;
+    b = true;
+  }
+
+  return b;
+}
+
+/**
+ * @brief   Waits for the completion of the transfer in progress.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ * @return              The operation status.
+ */
+static msg_t i2c_wait_s(I2CDriver *i2cp, sysinterval_t timeout) {
+  msg_t msg;
+
+  msg = osalThreadSuspendTimeoutS(&i2cp->thread, timeout);
+  if (msg == MSG_TIMEOUT) {
+    i2cp->busy = false;
+  }
+
+  return msg;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level I2C driver initialization.
+ *
+ * @notapi
+ */
+void i2c_lld_init(void) {
+
+#if USE_SIM_I2C1 == TRUE
+  i2cObjectInit(&I2CD1);
+  I2CD1.thread  = NULL;
+  I2CD1.busy    = false;
+  I2CD1.chained = 0U;
+#endif
+#if USE_SIM_I2C2 == TRUE
+  i2cObjectInit(&I2CD2);
+  I2CD2.thread  = NULL;
+  I2CD2.busy    = false;
+  I2CD2.chained = 0U;
+#endif
+}
+
+/**
+ * @brief   Configures and activates the I2C peripheral.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+void i2c_lld_start(I2CDriver *i2cp) {
+
+  (void)i2cp;
+}
+
+/**
+ * @brief   Deactivates the I2C peripheral.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+void i2c_lld_stop(I2CDriver *i2cp) {
+
+  i2cp->busy = false;
+}
+
+/**
+ * @brief   Receives data via the I2C bus as master.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more I2C errors occurred, the errors can
+ *                      be retrieved using @p i2cGetErrors().
+ * @retval MSG_TIMEOUT  if a timeout occurred before operation end.
+ *
+ * @notapi
+ */
+msg_t i2c_lld_master_receive_timeout(I2CDriver *i2cp, i2caddr_t addr,
+                                     uint8_t *rxbuf, size_t rxbytes,
+                                     sysinterval_t timeout) {
+
+  i2c_transfer(i2cp, addr, NULL, 0U, rxbuf, rxbytes);
+  return i2c_wait_s(i2cp, timeout);
+}
+
+/**
+ * @brief   Transmits data via the I2C bus as master.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[in] txbuf     pointer to the transmit buffer
+ * @param[in] txbytes   number of bytes to be transmitted
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more I2C errors occurred, the errors can
+ *                      be retrieved using @p i2cGetErrors().
+ * @retval MSG_TIMEOUT  if a timeout occurred before operation end.
+ *
+ * @notapi
+ */
+msg_t i2c_lld_master_transmit_timeout(I2CDriver *i2cp, i2caddr_t addr,
+                                      const uint8_t *txbuf, size_t txbytes,
+                                      uint8_t *rxbuf, size_t rxbytes,
+                                      sysinterval_t timeout) {
+
+  i2c_transfer(i2cp, addr, txbuf, txbytes, rxbuf, rxbytes);
+  return i2c_wait_s(i2cp, timeout);
+}
+
+/**
+ * @brief   Starts an asynchronous transfer as master.
+ * @details The transfer writes @p txbytes bytes, if any, then reads
+ *          @p rxbytes bytes, if any, after a repeated start. The end of
+ *          the transfer is notified using @p _i2c_wakeup_isr() or
+ *          @p _i2c_wakeup_error_isr().
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[in] txbuf     pointer to the transmit buffer
+ * @param[in] txbytes   number of bytes to be transmitted, can be zero
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received, can be zero
+ *
+ * @notapi
+ */
+void i2c_lld_start_transfer(I2CDriver *i2cp, i2caddr_t addr,
+                            const uint8_t *txbuf, size_t txbytes,
+                            uint8_t *rxbuf, size_t rxbytes) {
+
+  i2c_transfer(i2cp, addr, txbuf, txbytes, rxbuf, rxbytes);
+}
+
+/**
+ * @brief   Simulated transfers completion.
+ *
+ * @return              The interrupt activity status.
+ * @retval false        if no interrupt occurred.
+ * @retval true         if an interrupt occurred.
+ *
+ * @notapi
+ */
+bool i2c_lld_interrupt_pending(void) {
+  bool b = false;
+  uint64_t now;
+
+#if USE_SIM_I2C1 == TRUE
+  b = b || I2CD1.busy;
+#endif
+#if USE_SIM_I2C2 == TRUE
+  b = b || I2CD2.busy;
+#endif
+  if (!b) {
+    return false;
+  }
+
+  b = false;
+  now = i2c_now();
+
+  OSAL_IRQ_PROLOGUE();
+
+#if USE_SIM_I2C1 == TRUE
+  if (i2c_serve_interrupt(&I2CD1, now)) {
+    b = true;
+  }
+#endif
+#if USE_SIM_I2C2 == TRUE
+  if (i2c_serve_interrupt(&I2CD2, now)) {
+    b = true;
+  }
+#endif
+
+  OSAL_IRQ_EPILOGUE();
+
+  return b;
+}
+
+/**
+ * @brief   Initializes a register file device model.
+ *
+ * @param[out] rfp      pointer to the @p sim_i2c_regfile_t object
+ * @param[in] addr      slave address of the device
+ * @param[in] regs      registers array
+ * @param[in] size      number of registers, from 1 to 256
+ * @param[in] update    function invoked before each read or @p NULL
+ *
+ * @init
+ */
+void sim_i2c_regfile_init(sim_i2c_regfile_t *rfp, i2caddr_t addr,
+                          uint8_t *regs, size_t size,
+                          sim_i2c_regfile_cb_t update) {
+
+  osalDbgCheck((rfp != NULL) && (regs != NULL) &&
+               (size > 0U) && (size <= 256U));
+
+  rfp->dev.addr  = addr;
+  rfp->dev.write = regfile_write;
+  rfp->dev.read  = regfile_read;
+  rfp->regs      = regs;
+  rfp->size      = size;
+  rfp->update    = update;
+  rfp->ptr       = 0U;
+}
+
+#endif /* HAL_USE_I2C == TRUE */
+
+/** @} */
@@ -0,0 +1,280 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/hal_i2c_lld.h
+ * @brief   Posix simulator low level I2C driver header.
+ *
+ * @addtogroup POSIX_I2C
+ * @{
+ */
+
+#ifndef HAL_I2C_LLD_H
+#define HAL_I2C_LLD_H
+
+#if (HAL_USE_I2C == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Asynchronous transfers support.
+ */
+#define I2C_SUPPORTS_QUEUE              TRUE
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   I2C1 driver enable switch.
+ * @details If set to @p TRUE the support for I2C1 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_I2C1) || defined(__DOXYGEN__)
+#define USE_SIM_I2C1                    TRUE
+#endif
+
+/**
+ * @brief   I2C2 driver enable switch.
+ * @details If set to @p TRUE the support for I2C2 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_I2C2) || defined(__DOXYGEN__)
+#define USE_SIM_I2C2                    TRUE
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (USE_SIM_I2C1 == FALSE) && (USE_SIM_I2C2 == FALSE)
+#error "I2C driver activated but no I2C peripheral assigned"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type representing an I2C address.
+ */
+typedef uint16_t i2caddr_t;
+
+/**
+ * @brief   Type of I2C Driver condition flags.
+ */
+typedef uint32_t i2cflags_t;
+
+/**
+ * @brief   Type of a simulated I2C device.
+ */
+typedef struct sim_i2c_device sim_i2c_device_t;
+
+/**
+ * @brief   Simulated I2C device model.
+ * @details Device models embed this structure, the driver invokes the write
+ *          function with the bytes written in a transfer and the read
+ *          function with the bytes read after the repeated start. The
+ *          functions are invoked in locked state and return @p false in
+ *          order to not acknowledge a byte.
+ */
+struct sim_i2c_device {
+  /**
+   * @brief   Slave address (7 bits).
+   */
+  i2caddr_t                 addr;
+  /**
+   * @brief   Bytes written by the master.
+   */
+  bool                      (*write)(sim_i2c_device_t *devp,
+                                     const uint8_t *buf, size_t n);
+  /**
+   * @brief   Bytes read by the master.
+   */
+  bool                      (*read)(sim_i2c_device_t *devp,
+                                    uint8_t *buf, size_t n);
+};
+
+/**
+ * @brief   Type of a simulated register file device.
+ */
+typedef struct sim_i2c_regfile sim_i2c_regfile_t;
+
+/**
+ * @brief   Register file update function type.
+ *
+ * @param[in] rfp       pointer to the @p sim_i2c_regfile_t object
+ */
+typedef void (*sim_i2c_regfile_cb_t)(sim_i2c_regfile_t *rfp);
+
+/**
+ * @brief   Simulated register file device.
+ * @details The model of the most common sensors and EEPROM-like devices:
+ *          the first byte written selects a register, the following bytes
+ *          are written starting from that register and the reads return
+ *          the registers starting from the selected one, the register
+ *          pointer auto-increments and wraps.
+ */
+struct sim_i2c_regfile {
+  /**
+   * @brief   Device model, must be the first field.
+   */
+  sim_i2c_device_t          dev;
+  /**
+   * @brief   Registers array.
+   */
+  uint8_t                   *regs;
+  /**
+   * @brief   Number of registers, up to 256.
+   */
+  size_t                    size;
+  /**
+   * @brief   Function invoked before each read or @p NULL.
+   */
+  sim_i2c_regfile_cb_t      update;
+  /**
+   * @brief   Register pointer.
+   */
+  size_t                    ptr;
+};
+
+/**
+ * @brief   Type of I2C driver configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief   Bus clock in Hz, zero means that transfers end at the next
+   *          interrupts poll.
+   */
+  uint32_t                  clock;
+  /**
+   * @brief   @p NULL terminated array of the devices on the bus.
+   */
+  sim_i2c_device_t * const  *devices;
+} I2CConfig;
+
+/**
+ * @brief   Type of a structure representing an I2C driver.
+ */
+typedef struct I2CDriver I2CDriver;
+
+/**
+ * @brief   Structure representing an I2C driver.
+ */
+struct I2CDriver {
+  /**
+   * @brief   Driver state.
+   */
+  i2cstate_t                state;
+  /**
+   * @brief   Current configuration data.
+   */
+  const I2CConfig           *config;
+  /**
+   * @brief   Error flags.
+   */
+  i2cflags_t                errors;
+#if (I2C_USE_MUTUAL_EXCLUSION == TRUE) || defined(__DOXYGEN__)
+  mutex_t                   mutex;
+#endif
+  _i2c_queue_data
+#if defined(I2C_DRIVER_EXT_FIELDS)
+  I2C_DRIVER_EXT_FIELDS
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief   Thread waiting for I/O completion.
+   */
+  thread_reference_t        thread;
+  /**
+   * @brief   A transfer is in progress.
+   */
+  bool                      busy;
+  /**
+   * @brief   Error flags of the transfer in progress.
+   */
+  i2cflags_t                pending;
+  /**
+   * @brief   End time of the current transfer in nanoseconds.
+   */
+  uint64_t                  end;
+  /**
+   * @brief   Start time of a transfer chained from the ISR, zero otherwise.
+   */
+  uint64_t                  chained;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Get errors from I2C driver.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+#define i2c_lld_get_errors(i2cp) ((i2cp)->errors)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if (USE_SIM_I2C1 == TRUE) && !defined(__DOXYGEN__)
+extern I2CDriver I2CD1;
+#endif
+
+#if (USE_SIM_I2C2 == TRUE) && !defined(__DOXYGEN__)
+extern I2CDriver I2CD2;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void i2c_lld_init(void);
+  void i2c_lld_start(I2CDriver *i2cp);
+  void i2c_lld_stop(I2CDriver *i2cp);
+  msg_t i2c_lld_master_transmit_timeout(I2CDriver *i2cp, i2caddr_t addr,
+                                        const uint8_t *txbuf, size_t txbytes,
+                                        uint8_t *rxbuf, size_t rxbytes,
+                                        sysinterval_t timeout);
+  msg_t i2c_lld_master_receive_timeout(I2CDriver *i2cp, i2caddr_t addr,
+                                       uint8_t *rxbuf, size_t rxbytes,
+                                       sysinterval_t timeout);
+  void i2c_lld_start_transfer(I2CDriver *i2cp, i2caddr_t addr,
+                              const uint8_t *txbuf, size_t txbytes,
+                              uint8_t *rxbuf, size_t rxbytes);
+  bool i2c_lld_interrupt_pending(void);
+  void sim_i2c_regfile_init(sim_i2c_regfile_t *rfp, i2caddr_t addr,
+                            uint8_t *regs, size_t size,
+                            sim_i2c_regfile_cb_t update);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_I2C == TRUE */
+
+#endif /* HAL_I2C_LLD_H */
+
+/** @} */
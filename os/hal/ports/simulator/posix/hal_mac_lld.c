@@ -0,0 +1,859 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/hal_mac_lld.c
+ * @brief   Posix simulator low level MAC driver code.
+ * @details The simulated MAC either loops the transmitted frames back into
+ *          its own receive buffers or sends them as datagrams to a peer
+ *          UNIX-domain socket, the peer can be another driver of the same
+ *          simulator or a driver of another simulator process. The copy
+ *          performed on transmission stands for the DMA transfers of a
+ *          real controller.
+ *
+ * @addtogroup POSIX_MAC
+ * @{
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#include "hal.h"
+
+#if HAL_USE_MAC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+#define SIM_MAC_TX_FREE         0U
+#define SIM_MAC_TX_LOCKED       1U
+#define SIM_MAC_TX_DONE         2U
+
+#define SIM_MAC_RX_FREE         0U
+#define SIM_MAC_RX_FULL         1U
+#define SIM_MAC_RX_LOCKED       2U
+#define SIM_MAC_RX_PENDING      3U
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   ETHD1 driver identifier.
+ */
+#if USE_SIM_MAC1 || defined(__DOXYGEN__)
+MACDriver ETHD1;
+#endif
+
+/**
+ * @brief   ETHD2 driver identifier.
+ */
+#if USE_SIM_MAC2 || defined(__DOXYGEN__)
+MACDriver ETHD2;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a driver object.
+ *
+ * @param[out] macp     pointer to the @p MACDriver object
+ * @param[in] name      driver name
+ * @param[in] path      default local socket path or @p NULL
+ * @param[in] peer      default peer socket path or @p NULL
+ */
+static void mac_object_init(MACDriver *macp, const char *name,
+                            const char *path, const char *peer) {
+
+  macObjectInit(macp);
+  macp->name             = name;
+  macp->deflink.path     = path;
+  macp->deflink.peer     = peer;
+  macp->deflink.latency  = (sysinterval_t)SIM_MAC_LATENCY;
+  macp->deflink.loss     = (uint32_t)SIM_MAC_LOSS;
+  macp->link             = &macp->deflink;
+  macp->sock             = -1;
+  macp->link_up          = false;
+}
+
+/**
+ * @brief   Opens the link socket.
+ * @note    Errors are fatal, the simulator is terminated.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ */
+static void mac_open(MACDriver *macp) {
+  struct sockaddr_un sun;
+  int flags;
+
+  if ((strlen(macp->link->path) >= sizeof(sun.sun_path)) ||
+      (macp->link->peer == NULL) ||
+      (strlen(macp->link->peer) >= sizeof(sun.sun_path))) {
+    printf("%s: Invalid socket path\n", macp->name);
+    goto abort;
+  }
+
+  macp->sock = socket(AF_UNIX, SOCK_DGRAM, 0);
+  if (macp->sock == -1) {
+    printf("%s: Error creating simulator socket\n", macp->name);
+    goto abort;
+  }
+
+  flags = fcntl(macp->sock, F_GETFL, 0);
+  if (fcntl(macp->sock, F_SETFL, flags | O_NONBLOCK) != 0) {
+    printf("%s: Unable to setup non blocking mode on socket\n", macp->name);
+    goto abort;
+  }
+
+  /* A socket file left by a previous run is removed.*/
+  memset(&sun, 0, sizeof(sun));
+  sun.sun_family = AF_UNIX;
+  strcpy(sun.sun_path, macp->link->path);
+  (void) unlink(macp->link->path);
+  if (bind(macp->sock, (struct sockaddr *)&sun, sizeof(sun))) {
+    printf("%s: Error binding socket\n", macp->name);
+    goto abort;
+  }
+
+  memset(&macp->peeraddr, 0, sizeof(macp->peeraddr));
+  macp->peeraddr.sun_family = AF_UNIX;
+  strcpy(macp->peeraddr.sun_path, macp->link->peer);
+  printf("Simulated link %s bound to %s\n", macp->name, macp->link->path);
+  return;
+
+abort:
+  if (macp->sock != -1)
+    close(macp->sock);
+  exit(1);
+}
+
+/**
+ * @brief   Decides if a transmitted frame is lost.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The frame fate.
+ * @retval true         if the frame must be discarded.
+ * @retval false        if the frame must be delivered.
+ */
+static bool mac_lost(MACDriver *macp) {
+
+  if (macp->link->loss == 0U) {
+    return false;
+  }
+
+  /* Deterministic generator, runs are reproducible.*/
+  macp->seed = (macp->seed * 1664525U) + 1013904223U;
+  return ((macp->seed >> 16) % 1000U) < macp->link->loss;
+}
+
+/**
+ * @brief   Makes the received frames available once their latency expired.
+ * @note    Frames are made available in arrival order.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The delivery status.
+ * @retval true         if frames have been made available.
+ * @retval false        if there are no frames to be made available.
+ */
+static bool mac_deliver_i(MACDriver *macp) {
+  systime_t now = osalOsGetSystemTimeX();
+  bool delivered = false;
+
+  while (macp->rb[macp->rxdue].state == SIM_MAC_RX_PENDING) {
+    sim_mac_rx_buffer_t *rbp = &macp->rb[macp->rxdue];
+
+    if (osalTimeDiffX(rbp->stamp, now) < macp->link->latency) {
+      break;
+    }
+    rbp->state  = SIM_MAC_RX_FULL;
+    macp->rxdue = (macp->rxdue + 1U) % SIM_MAC_RECEIVE_BUFFERS;
+    delivered   = true;
+  }
+
+  if (delivered) {
+    osalThreadDequeueAllI(&macp->rdqueue, MSG_RESET);
+#if MAC_USE_EVENTS
+    osalEventBroadcastFlagsI(&macp->rdevent, 0);
+#endif
+  }
+
+  return delivered;
+}
+
+/**
+ * @brief   Delivers a transmitted frame to the receive buffers.
+ * @note    The frame is dropped if the next receive buffer is not free,
+ *          like a DMA engine stalled on a descriptor not yet returned.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] tbp       pointer to the transmit buffer
+ * @param[in] size      frame size
+ */
+static void mac_loopback_i(MACDriver *macp,
+                           const sim_mac_tx_buffer_t *tbp,
+                           size_t size) {
+  sim_mac_rx_buffer_t *rbp = &macp->rb[macp->rxwr];
+  uint8_t *p;
+  size_t i;
+
+  if (rbp->state != SIM_MAC_RX_FREE) {
+    macp->rxdropped++;
+    return;
+  }
+
+  /* Gathering the fragments.*/
+  p = rbp->buffer;
+  for (i = 0U; i < tbp->nfrags; i++) {
+    memcpy(p, tbp->frags[i].buf, tbp->frags[i].size);
+    p += tbp->frags[i].size;
+  }
+  rbp->size  = size;
+  rbp->stamp = osalOsGetSystemTimeX();
+  rbp->state = SIM_MAC_RX_PENDING;
+  macp->rxwr = (macp->rxwr + 1U) % SIM_MAC_RECEIVE_BUFFERS;
+
+  (void) mac_deliver_i(macp);
+}
+
+/**
+ * @brief   Sends a transmitted frame to the peer socket.
+ * @note    A frame the peer cannot accept is lost, the sender is never
+ *          blocked by the link.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] tbp       pointer to the transmit buffer
+ */
+static void mac_send(MACDriver *macp, const sim_mac_tx_buffer_t *tbp) {
+  struct iovec iov[SIM_MAC_TRANSMIT_FRAGMENTS];
+  struct msghdr msg;
+  size_t i;
+
+  /* Gathering the fragments.*/
+  for (i = 0U; i < tbp->nfrags; i++) {
+    iov[i].iov_base = (void *)tbp->frags[i].buf;
+    iov[i].iov_len  = tbp->frags[i].size;
+  }
+
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_name    = (void *)&macp->peeraddr;
+  msg.msg_namelen = sizeof(macp->peeraddr);
+  msg.msg_iov     = iov;
+  msg.msg_iovlen  = tbp->nfrags;
+  if (sendmsg(macp->sock, &msg, 0) == -1) {
+    macp->txlost++;
+  }
+}
+
+/**
+ * @brief   Receives the frames waiting in the link socket.
+ * @note    No more frames than the free receive buffers are received, the
+ *          excess frames are left in the socket.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The reception status.
+ * @retval true         if frames have been made available.
+ * @retval false        if there are no frames to be made available.
+ */
+static bool mac_receive(MACDriver *macp) {
+  bool delivered;
+
+  while (true) {
+    sim_mac_rx_buffer_t *rbp = &macp->rb[macp->rxwr];
+    uint32_t state;
+    ssize_t n;
+
+    osalSysLockFromISR();
+    state = rbp->state;
+    osalSysUnlockFromISR();
+    if (state != SIM_MAC_RX_FREE) {
+      break;
+    }
+
+    /* Free buffers are only filled here, the buffer can be written
+       outside the critical zone.*/
+    n = recv(macp->sock, rbp->buffer, SIM_MAC_BUFFERS_SIZE, 0);
+    if (n == -1) {
+      break;
+    }
+    if (n == 0) {
+      continue;
+    }
+
+    osalSysLockFromISR();
+    rbp->size  = (size_t)n;
+    rbp->stamp = osalOsGetSystemTimeX();
+    rbp->state = SIM_MAC_RX_PENDING;
+    macp->rxwr = (macp->rxwr + 1U) % SIM_MAC_RECEIVE_BUFFERS;
+    osalSysUnlockFromISR();
+  }
+
+  osalSysLockFromISR();
+  delivered = mac_deliver_i(macp);
+  osalSysUnlockFromISR();
+
+  return delivered;
+}
+
+/**
+ * @brief   Serves the simulated interrupt sources of a driver.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The interrupt status.
+ */
+static bool mac_serve_interrupt(MACDriver *macp) {
+  bool delivered;
+
+  if (macp->state != MAC_ACTIVE) {
+    return false;
+  }
+
+  if (macp->sock != -1) {
+    return mac_receive(macp);
+  }
+
+  osalSysLockFromISR();
+  delivered = mac_deliver_i(macp);
+  osalSysUnlockFromISR();
+
+  return delivered;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level MAC initialization.
+ *
+ * @notapi
+ */
+void mac_lld_init(void) {
+
+#if USE_SIM_MAC1
+  mac_object_init(&ETHD1, "ETHD1", SIM_MAC1_PATH, SIM_MAC1_PEER);
+#endif
+
+#if USE_SIM_MAC2
+  mac_object_init(&ETHD2, "ETHD2", SIM_MAC2_PATH, SIM_MAC2_PEER);
+#endif
+}
+
+/**
+ * @brief   Configures and activates the MAC peripheral.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @notapi
+ */
+void mac_lld_start(MACDriver *macp) {
+  unsigned i;
+
+  for (i = 0U; i < SIM_MAC_TRANSMIT_BUFFERS; i++) {
+    macp->tb[i].state  = SIM_MAC_TX_FREE;
+    macp->tb[i].nfrags = 0U;
+  }
+  for (i = 0U; i < SIM_MAC_RECEIVE_BUFFERS; i++) {
+    macp->rb[i].state = SIM_MAC_RX_FREE;
+  }
+  macp->txnext    = 0U;
+  macp->rxwr      = 0U;
+  macp->rxdue     = 0U;
+  macp->rxrd      = 0U;
+  macp->rxdropped = 0U;
+  macp->txlost    = 0U;
+  macp->seed      = 0x2F6B1D5AU;
+
+  /* Link settings, a socket is only used if a path is specified.*/
+  if ((macp->config != NULL) && (macp->config->link != NULL)) {
+    macp->link = macp->config->link;
+  }
+  else {
+    macp->link = &macp->deflink;
+  }
+  if ((macp->sock == -1) && (macp->link->path != NULL)) {
+    mac_open(macp);
+  }
+
+  /* The simulated link is always up.*/
+  macp->link_up   = true;
+}
+
+/**
+ * @brief   Deactivates the MAC peripheral.
+ * @note    Transmitted buffers still holding references are left in place
+ *          so that the references can be given back.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @notapi
+ */
+void mac_lld_stop(MACDriver *macp) {
+  unsigned i;
+
+  if (macp->state != MAC_STOP) {
+    macp->link_up = false;
+
+    /* Pending frames are discarded.*/
+    for (i = 0U; i < SIM_MAC_RECEIVE_BUFFERS; i++) {
+      if ((macp->rb[i].state == SIM_MAC_RX_FULL) ||
+          (macp->rb[i].state == SIM_MAC_RX_PENDING)) {
+        macp->rb[i].state = SIM_MAC_RX_FREE;
+      }
+    }
+
+    if (macp->sock != -1) {
+      close(macp->sock);
+      (void) unlink(macp->link->path);
+      macp->sock = -1;
+    }
+  }
+}
+
+/**
+ * @brief   Returns a transmission descriptor.
+ * @details One of the available transmission descriptors is locked and
+ *          returned.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] tdp      pointer to a @p MACTransmitDescriptor structure
+ * @return              The operation status.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
+                                      MACTransmitDescriptor *tdp) {
+  unsigned i, n;
+
+  if (!macp->link_up) {
+    return MSG_TIMEOUT;
+  }
+
+  for (n = 0U; n < SIM_MAC_TRANSMIT_BUFFERS; n++) {
+    i = (macp->txnext + n) % SIM_MAC_TRANSMIT_BUFFERS;
+    if (macp->tb[i].state == SIM_MAC_TX_FREE) {
+      macp->tb[i].state  = SIM_MAC_TX_LOCKED;
+      macp->tb[i].nfrags = 0U;
+      macp->tb[i].used   = 0U;
+      macp->txnext       = (i + 1U) % SIM_MAC_TRANSMIT_BUFFERS;
+
+      tdp->offset   = 0U;
+      tdp->size     = SIM_MAC_BUFFERS_SIZE;
+      tdp->macp     = macp;
+      tdp->physdesc = &macp->tb[i];
+
+      return MSG_OK;
+    }
+  }
+
+  return MSG_TIMEOUT;
+}
+
+/**
+ * @brief   Releases a transmit descriptor and starts the transmission of the
+ *          enqueued data as a single frame.
+ *
+ * @param[in] tdp       the pointer to the @p MACTransmitDescriptor structure
+ *
+ * @notapi
+ */
+void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp) {
+  MACDriver *macp = tdp->macp;
+  sim_mac_tx_buffer_t *tbp = tdp->physdesc;
+  size_t i;
+
+  osalDbgAssert(tbp->state == SIM_MAC_TX_LOCKED,
+                "attempt to release a descriptor not locked");
+
+  osalSysLock();
+
+  if (tdp->offset > 0U) {
+    if (mac_lost(macp)) {
+      macp->txlost++;
+    }
+    else if (macp->sock == -1) {
+      mac_loopback_i(macp, tbp, tdp->offset);
+    }
+    else {
+      mac_send(macp, tbp);
+    }
+  }
+
+  /* The buffer is kept until the attached references are given back.*/
+  tbp->state = SIM_MAC_TX_FREE;
+  for (i = 0U; i < tbp->nfrags; i++) {
+    if (tbp->frags[i].ref != NULL) {
+      tbp->state = SIM_MAC_TX_DONE;
+      break;
+    }
+  }
+  osalThreadDequeueAllI(&macp->tdqueue, MSG_RESET);
+
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Returns a receive descriptor.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] rdp      pointer to a @p MACReceiveDescriptor structure
+ * @return              The operation status.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
+                                     MACReceiveDescriptor *rdp) {
+  sim_mac_rx_buffer_t *rbp = &macp->rb[macp->rxrd];
+
+  (void) mac_deliver_i(macp);
+  if (rbp->state != SIM_MAC_RX_FULL) {
+    return MSG_TIMEOUT;
+  }
+
+  rbp->state    = SIM_MAC_RX_LOCKED;
+  macp->rxrd    = (macp->rxrd + 1U) % SIM_MAC_RECEIVE_BUFFERS;
+
+  rdp->offset   = 0U;
+  rdp->size     = rbp->size;
+  rdp->physdesc = rbp;
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Releases a receive descriptor.
+ * @details The descriptor and its buffer are made available for more incoming
+ *          frames.
+ *
+ * @param[in] rdp       the pointer to the @p MACReceiveDescriptor structure
+ *
+ * @notapi
+ */
+void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp) {
+
+  osalDbgAssert(rdp->physdesc->state == SIM_MAC_RX_LOCKED,
+                "attempt to release a descriptor not locked");
+
+  osalSysLock();
+  rdp->physdesc->state = SIM_MAC_RX_FREE;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Updates and returns the link status.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The link status.
+ * @retval true         if the link is active.
+ * @retval false        if the link is down.
+ *
+ * @notapi
+ */
+bool mac_lld_poll_link_status(MACDriver *macp) {
+
+  return macp->link_up;
+}
+
+/**
+ * @brief   Writes to a transmit descriptor's stream.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] buf       pointer to the buffer containing the data to be
+ *                      written
+ * @param[in] size      number of bytes to be written
+ * @return              The number of bytes written into the descriptor's
+ *                      stream, this value can be less than the amount
+ *                      specified in the parameter @p size if the maximum
+ *                      frame size is reached.
+ *
+ * @notapi
+ */
+size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
+                                         uint8_t *buf,
+                                         size_t size) {
+  sim_mac_tx_buffer_t *tbp = tdp->physdesc;
+  uint8_t *p;
+
+  osalDbgAssert(tbp->state == SIM_MAC_TX_LOCKED,
+                "attempt to write a descriptor not locked");
+
+  if (size > tdp->size - tdp->offset) {
+    size = tdp->size - tdp->offset;
+  }
+
+  if (size > 0U) {
+    p = tbp->buffer + tbp->used;
+
+    /* Extending the last fragment if it ends where the data goes, else a
+       new fragment is started.*/
+    if ((tbp->nfrags > 0U) &&
+        (tbp->frags[tbp->nfrags - 1U].buf +
+         tbp->frags[tbp->nfrags - 1U].size == p)) {
+      tbp->frags[tbp->nfrags - 1U].size += size;
+    }
+    else if (tbp->nfrags < SIM_MAC_TRANSMIT_FRAGMENTS) {
+      tbp->frags[tbp->nfrags].buf  = p;
+      tbp->frags[tbp->nfrags].size = size;
+      tbp->frags[tbp->nfrags].ref  = NULL;
+      tbp->nfrags++;
+    }
+    else {
+      return 0U;
+    }
+
+    memcpy(p, buf, size);
+    tbp->used   += size;
+    tdp->offset += size;
+  }
+  return size;
+}
+
+/**
+ * @brief   Reads from a receive descriptor's stream.
+ *
+ * @param[in] rdp       pointer to a @p MACReceiveDescriptor structure
+ * @param[in] buf       pointer to the buffer that will receive the read data
+ * @param[in] size      number of bytes to be read
+ * @return              The number of bytes read from the descriptor's
+ *                      stream, this value can be less than the amount
+ *                      specified in the parameter @p size if there are
+ *                      no more bytes to read.
+ *
+ * @notapi
+ */
+size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
+                                       uint8_t *buf,
+                                       size_t size) {
+
+  osalDbgAssert(rdp->physdesc->state == SIM_MAC_RX_LOCKED,
+                "attempt to read a descriptor not locked");
+
+  if (size > rdp->size - rdp->offset) {
+    size = rdp->size - rdp->offset;
+  }
+
+  if (size > 0U) {
+    memcpy(buf, rdp->physdesc->buffer + rdp->offset, size);
+    rdp->offset += size;
+  }
+  return size;
+}
+
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a pointer to the next transmit buffer in the descriptor
+ *          chain.
+ * @note    The API guarantees that enough buffers can be requested to fill
+ *          a whole frame.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] size      size of the requested buffer. Specify the frame size
+ *                      on the first call then scale the value down subtracting
+ *                      the amount of data already copied into the previous
+ *                      buffers.
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ *                      Note that a returned size lower than the amount
+ *                      requested means that more buffers must be requested
+ *                      in order to fill the frame data entirely.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
+                                          size_t size,
+                                          size_t *sizep) {
+  sim_mac_tx_buffer_t *tbp = tdp->physdesc;
+
+  if ((tdp->offset == 0U) && (size <= tdp->size)) {
+    tbp->frags[0].buf  = tbp->buffer;
+    tbp->frags[0].size = size;
+    tbp->frags[0].ref  = NULL;
+    tbp->nfrags        = 1U;
+    tbp->used          = size;
+    tdp->offset        = size;
+    *sizep             = tdp->size;
+    return tbp->buffer;
+  }
+  *sizep = 0U;
+  return NULL;
+}
+
+/**
+ * @brief   Returns a pointer to the next receive buffer in the descriptor
+ *          chain.
+ * @note    The API guarantees that the descriptor chain contains a whole
+ *          frame.
+ *
+ * @param[in] rdp       pointer to a @p MACReceiveDescriptor structure
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
+                                               size_t *sizep) {
+
+  if (rdp->size > 0U) {
+    *sizep      = rdp->size;
+    rdp->offset = rdp->size;
+    rdp->size   = 0U;
+    return rdp->physdesc->buffer;
+  }
+  *sizep = 0U;
+  return NULL;
+}
+
+/**
+ * @brief   Appends an application buffer to a transmit descriptor.
+ * @note    If the buffer cannot be appended then all the data previously
+ *          added to the descriptor is discarded.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] buf       pointer to the buffer to be transmitted
+ * @param[in] size      size of the buffer
+ * @param[in] ref       reference to be returned once the frame has been
+ *                      transmitted or @p NULL
+ * @return              The operation result.
+ * @retval true         if the buffer has been appended.
+ * @retval false        if the frame size or the number of buffers per
+ *                      frame would be exceeded.
+ *
+ * @notapi
+ */
+bool mac_lld_attach_transmit_buffer(MACTransmitDescriptor *tdp,
+                                    const uint8_t *buf,
+                                    size_t size,
+                                    void *ref) {
+  sim_mac_tx_buffer_t *tbp = tdp->physdesc;
+
+  osalDbgAssert(tbp->state == SIM_MAC_TX_LOCKED,
+                "attempt to attach to a descriptor not locked");
+
+  if ((size > tdp->size - tdp->offset) ||
+      (tbp->nfrags >= SIM_MAC_TRANSMIT_FRAGMENTS)) {
+    tbp->nfrags = 0U;
+    tbp->used   = 0U;
+    tdp->offset = 0U;
+    return false;
+  }
+
+  tbp->frags[tbp->nfrags].buf  = buf;
+  tbp->frags[tbp->nfrags].size = size;
+  tbp->frags[tbp->nfrags].ref  = ref;
+  tbp->nfrags++;
+  tdp->offset += size;
+
+  return true;
+}
+
+/**
+ * @brief   Returns the reference of a transmitted buffer.
+ * @details The descriptor holding the reference is made available for
+ *          new frames.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The reference of a buffer no more used by the MAC.
+ * @retval NULL         if there are no buffers to be given back.
+ *
+ * @notapi
+ */
+void *mac_lld_reclaim_transmit_buffer(MACDriver *macp) {
+  unsigned i;
+  size_t j;
+  void *ref;
+
+  for (i = 0U; i < SIM_MAC_TRANSMIT_BUFFERS; i++) {
+    sim_mac_tx_buffer_t *tbp = &macp->tb[i];
+
+    if (tbp->state == SIM_MAC_TX_DONE) {
+      ref = NULL;
+      for (j = 0U; j < tbp->nfrags; j++) {
+        if (tbp->frags[j].ref != NULL) {
+          if (ref != NULL) {
+            /* More references to be given back later.*/
+            return ref;
+          }
+          ref = tbp->frags[j].ref;
+          tbp->frags[j].ref = NULL;
+        }
+      }
+
+      /* Last reference, the buffer is free again.*/
+      tbp->state = SIM_MAC_TX_FREE;
+      osalThreadDequeueAllI(&macp->tdqueue, MSG_RESET);
+      return ref;
+    }
+  }
+
+  return NULL;
+}
+#endif /* MAC_USE_ZERO_COPY */
+
+/**
+ * @brief   Simulated interrupt sources check.
+ * @details Receives the frames coming from the peer sockets and makes
+ *          available the frames whose latency expired.
+ *
+ * @return              The interrupt status.
+ * @retval true         if an interrupt has been served.
+ * @retval false        if no interrupts occurred.
+ *
+ * @notapi
+ */
+bool mac_lld_interrupt_pending(void) {
+  bool b = false;
+
+  OSAL_IRQ_PROLOGUE();
+
+#if USE_SIM_MAC1
+  if (mac_serve_interrupt(&ETHD1)) {
+    b = true;
+  }
+#endif
+#if USE_SIM_MAC2
+  if (mac_serve_interrupt(&ETHD2)) {
+    b = true;
+  }
+#endif
+
+  OSAL_IRQ_EPILOGUE();
+
+  return b;
+}
+
+#endif /* HAL_USE_MAC */
+
+/** @} */
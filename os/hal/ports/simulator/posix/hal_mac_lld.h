@@ -0,0 +1,440 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/hal_mac_lld.h
+ * @brief   Posix simulator low level MAC driver header.
+ *
+ * @addtogroup POSIX_MAC
+ * @{
+ */
+
+#ifndef HAL_MAC_LLD_H
+#define HAL_MAC_LLD_H
+
+#if HAL_USE_MAC || defined(__DOXYGEN__)
+
+#include <sys/un.h>
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   This implementation supports the zero-copy mode API.
+ */
+#define MAC_SUPPORTS_ZERO_COPY              TRUE
+
+/**
+ * @brief   This implementation supports buffer references.
+ */
+#define MAC_SUPPORTS_BUFFER_REFERENCES      TRUE
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   ETHD1 driver enable switch.
+ * @details If set to @p TRUE the support for ETHD1 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_MAC1) || defined(__DOXYGEN__)
+#define USE_SIM_MAC1                        TRUE
+#endif
+
+/**
+ * @brief   ETHD2 driver enable switch.
+ * @details If set to @p TRUE the support for ETHD2 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_MAC2) || defined(__DOXYGEN__)
+#define USE_SIM_MAC2                        TRUE
+#endif
+
+/**
+ * @brief   ETHD1 default local socket path.
+ * @note    The default is @p NULL, the driver loops the frames back.
+ */
+#if !defined(SIM_MAC1_PATH) || defined(__DOXYGEN__)
+#define SIM_MAC1_PATH                       NULL
+#endif
+
+/**
+ * @brief   ETHD1 default peer socket path.
+ */
+#if !defined(SIM_MAC1_PEER) || defined(__DOXYGEN__)
+#define SIM_MAC1_PEER                       NULL
+#endif
+
+/**
+ * @brief   ETHD2 default local socket path.
+ * @note    The default is @p NULL, the driver loops the frames back.
+ */
+#if !defined(SIM_MAC2_PATH) || defined(__DOXYGEN__)
+#define SIM_MAC2_PATH                       NULL
+#endif
+
+/**
+ * @brief   ETHD2 default peer socket path.
+ */
+#if !defined(SIM_MAC2_PEER) || defined(__DOXYGEN__)
+#define SIM_MAC2_PEER                       NULL
+#endif
+
+/**
+ * @brief   Default latency of the received frames.
+ */
+#if !defined(SIM_MAC_LATENCY) || defined(__DOXYGEN__)
+#define SIM_MAC_LATENCY                     0
+#endif
+
+/**
+ * @brief   Default transmitted frames loss, in frames every 1000.
+ */
+#if !defined(SIM_MAC_LOSS) || defined(__DOXYGEN__)
+#define SIM_MAC_LOSS                        0
+#endif
+
+/**
+ * @brief   Number of available transmit buffers.
+ */
+#if !defined(SIM_MAC_TRANSMIT_BUFFERS) || defined(__DOXYGEN__)
+#define SIM_MAC_TRANSMIT_BUFFERS            4
+#endif
+
+/**
+ * @brief   Number of available receive buffers.
+ */
+#if !defined(SIM_MAC_RECEIVE_BUFFERS) || defined(__DOXYGEN__)
+#define SIM_MAC_RECEIVE_BUFFERS             8
+#endif
+
+/**
+ * @brief   Maximum supported frame size.
+ */
+#if !defined(SIM_MAC_BUFFERS_SIZE) || defined(__DOXYGEN__)
+#define SIM_MAC_BUFFERS_SIZE                1536
+#endif
+
+/**
+ * @brief   Maximum number of buffers composing a transmitted frame.
+ */
+#if !defined(SIM_MAC_TRANSMIT_FRAGMENTS) || defined(__DOXYGEN__)
+#define SIM_MAC_TRANSMIT_FRAGMENTS          4
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if SIM_MAC_TRANSMIT_FRAGMENTS < 1
+#error "invalid SIM_MAC_TRANSMIT_FRAGMENTS value"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated transmit buffer.
+ * @details A frame is transmitted gathering a list of fragments, each
+ *          one is either part of the internal buffer or an application
+ *          buffer attached by reference.
+ */
+typedef struct {
+  /**
+   * @brief   Buffer state.
+   */
+  volatile uint32_t     state;
+  /**
+   * @brief   Number of fragments composing the frame.
+   */
+  size_t                nfrags;
+  /**
+   * @brief   Fragments composing the frame.
+   */
+  struct {
+    const uint8_t       *buf;
+    size_t              size;
+    void                *ref;
+  }                     frags[SIM_MAC_TRANSMIT_FRAGMENTS];
+  /**
+   * @brief   Used part of the internal buffer.
+   */
+  size_t                used;
+  /**
+   * @brief   Internal buffer.
+   */
+  uint8_t               buffer[SIM_MAC_BUFFERS_SIZE];
+} sim_mac_tx_buffer_t;
+
+/**
+ * @brief   Simulated receive buffer.
+ */
+typedef struct {
+  /**
+   * @brief   Buffer state.
+   */
+  volatile uint32_t     state;
+  /**
+   * @brief   Received frame size.
+   */
+  size_t                size;
+  /**
+   * @brief   Arrival time.
+   */
+  systime_t             stamp;
+  /**
+   * @brief   Frame data.
+   */
+  uint8_t               buffer[SIM_MAC_BUFFERS_SIZE];
+} sim_mac_rx_buffer_t;
+
+/**
+ * @brief   Simulated link settings.
+ * @details Frames are exchanged as datagrams over a pair of UNIX-domain
+ *          sockets, the two ends can be drivers of the same simulator
+ *          instance or of two distinct simulator processes.
+ */
+typedef struct {
+  /**
+   * @brief   Local socket path.
+   * @note    If @p NULL the transmitted frames are looped back.
+   */
+  const char            *path;
+  /**
+   * @brief   Peer socket path.
+   */
+  const char            *peer;
+  /**
+   * @brief   Delay before received frames are made available.
+   */
+  sysinterval_t         latency;
+  /**
+   * @brief   Transmitted frames lost, in frames every 1000.
+   */
+  uint32_t              loss;
+} sim_mac_link_t;
+
+/**
+ * @brief   Driver configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief MAC address.
+   */
+  uint8_t               *mac_address;
+  /**
+   * @brief Transmitted buffers release callback.
+   */
+  macbufcb_t            txrelease_cb;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Link settings.
+   * @note  If @p NULL the driver defaults are used.
+   */
+  const sim_mac_link_t  *link;
+} MACConfig;
+
+/**
+ * @brief   Structure representing a MAC driver.
+ */
+struct MACDriver {
+  /**
+   * @brief Driver state.
+   */
+  macstate_t            state;
+  /**
+   * @brief Current configuration data.
+   */
+  const MACConfig       *config;
+  /**
+   * @brief Transmit semaphore.
+   */
+  threads_queue_t       tdqueue;
+  /**
+   * @brief Receive semaphore.
+   */
+  threads_queue_t       rdqueue;
+#if MAC_USE_EVENTS || defined(__DOXYGEN__)
+  /**
+   * @brief Receive event.
+   */
+  event_source_t        rdevent;
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Driver name.
+   */
+  const char            *name;
+  /**
+   * @brief Default link settings.
+   */
+  sim_mac_link_t        deflink;
+  /**
+   * @brief Current link settings.
+   */
+  const sim_mac_link_t  *link;
+  /**
+   * @brief Link socket or -1 in loopback mode.
+   */
+  int                   sock;
+  /**
+   * @brief Peer socket address.
+   */
+  struct sockaddr_un    peeraddr;
+  /**
+   * @brief Losses generator state.
+   */
+  uint32_t              seed;
+  /**
+   * @brief Link status flag.
+   */
+  bool                  link_up;
+  /**
+   * @brief Next transmit buffer to be checked for availability.
+   */
+  unsigned              txnext;
+  /**
+   * @brief Next receive buffer to be filled.
+   */
+  unsigned              rxwr;
+  /**
+   * @brief Next receive buffer to be made available.
+   */
+  unsigned              rxdue;
+  /**
+   * @brief Next receive buffer to be returned.
+   */
+  unsigned              rxrd;
+  /**
+   * @brief Number of frames dropped because no receive buffers were free.
+   */
+  uint32_t              rxdropped;
+  /**
+   * @brief Number of frames lost on transmission.
+   */
+  uint32_t              txlost;
+  /**
+   * @brief Transmit buffers.
+   */
+  sim_mac_tx_buffer_t   tb[SIM_MAC_TRANSMIT_BUFFERS];
+  /**
+   * @brief Receive buffers.
+   */
+  sim_mac_rx_buffer_t   rb[SIM_MAC_RECEIVE_BUFFERS];
+};
+
+/**
+ * @brief   Structure representing a transmit descriptor.
+ */
+typedef struct {
+  /**
+   * @brief Current write offset.
+   */
+  size_t                offset;
+  /**
+   * @brief Available space size.
+   */
+  size_t                size;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Pointer to the owner driver.
+   */
+  MACDriver             *macp;
+  /**
+   * @brief Pointer to the transmit buffer.
+   */
+  sim_mac_tx_buffer_t   *physdesc;
+} MACTransmitDescriptor;
+
+/**
+ * @brief   Structure representing a receive descriptor.
+ */
+typedef struct {
+  /**
+   * @brief Current read offset.
+   */
+  size_t                offset;
+  /**
+   * @brief Available data size.
+   */
+  size_t                size;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Pointer to the receive buffer.
+   */
+  sim_mac_rx_buffer_t   *physdesc;
+} MACReceiveDescriptor;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if USE_SIM_MAC1 && !defined(__DOXYGEN__)
+extern MACDriver ETHD1;
+#endif
+
+#if USE_SIM_MAC2 && !defined(__DOXYGEN__)
+extern MACDriver ETHD2;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void mac_lld_init(void);
+  void mac_lld_start(MACDriver *macp);
+  void mac_lld_stop(MACDriver *macp);
+  msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
+                                        MACTransmitDescriptor *tdp);
+  void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp);
+  msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
+                                       MACReceiveDescriptor *rdp);
+  void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp);
+  bool mac_lld_poll_link_status(MACDriver *macp);
+  size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
+                                           uint8_t *buf,
+                                           size_t size);
+  size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
+                                         uint8_t *buf,
+                                         size_t size);
+#if MAC_USE_ZERO_COPY
+  uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
+                                            size_t size,
+                                            size_t *sizep);
+  const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
+                                                 size_t *sizep);
+  bool mac_lld_attach_transmit_buffer(MACTransmitDescriptor *tdp,
+                                      const uint8_t *buf,
+                                      size_t size,
+                                      void *ref);
+  void *mac_lld_reclaim_transmit_buffer(MACDriver *macp);
+#endif
+  bool mac_lld_interrupt_pending(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_MAC */
+
+#endif /* HAL_MAC_LLD_H */
+
+/** @} */
@@ -130,6 +130,8 @@ static bool connint(SerialDriver *sdp) {
       goto abort;
     }
 
+    sdp->com_txpos = 0;
+    sdp->com_txcnt = 0;
     osalSysLockFromISR();
     chnAddFlagsI(sdp, CHN_CONNECTED);
     osalSysUnlockFromISR();
@@ -147,13 +149,22 @@ abort:
 static bool inint(SerialDriver *sdp) {
 
   if (sdp->com_data != -1) {
-    int i;
-    uint8_t data[32];
+    uint8_t data[SIM_SERIAL_BLOCK_SIZE];
+    size_t space;
+    ssize_t n;
 
     /*
-     * Input.
+     * Input, no more than the free space in the input queue is received,
+     * the excess data is left in the socket.
      */
-    int n = recv(sdp->com_data, data, sizeof(data), 0);
+    osalSysLockFromISR();
+    space = iqGetEmptyI(&sdp->iqueue);
+    osalSysUnlockFromISR();
+    if (space == 0)
+      return false;
+    if (space > sizeof(data))
+      space = sizeof(data);
+    n = recv(sdp->com_data, data, space, 0);
     switch (n) {
     case 0:
       close(sdp->com_data);
@@ -169,11 +180,9 @@ static bool inint(SerialDriver *sdp) {
       sdp->com_data = -1;
       return false;
     }
-    for (i = 0; i < n; i++) {
-      osalSysLockFromISR();
-      sdIncomingDataI(sdp, data[i]);
-      osalSysUnlockFromISR();
-    }
+    osalSysLockFromISR();
+    (void) sdIncomingDataBlockI(sdp, data, (size_t)n);
+    osalSysUnlockFromISR();
     return true;
   }
   return false;
@@ -182,19 +191,23 @@ static bool inint(SerialDriver *sdp) {
 static bool outint(SerialDriver *sdp) {
 
   if (sdp->com_data != -1) {
-    int n;
-    uint8_t data[1];
+    ssize_t n;
 
     /*
-     * Input.
+     * Output, a new block is taken from the output queue only after the
+     * previous one has been completely sent.
      */
-    osalSysLockFromISR();
-    n = sdRequestDataI(sdp);
-    osalSysUnlockFromISR();
-    if (n < 0)
-      return false;
-    data[0] = (uint8_t)n;
-    n = send(sdp->com_data, data, sizeof(data), 0);
+    if (sdp->com_txpos >= sdp->com_txcnt) {
+      osalSysLockFromISR();
+      sdp->com_txcnt = sdRequestDataBlockI(sdp, sdp->com_txbuf,
+                                           sizeof(sdp->com_txbuf));
+      osalSysUnlockFromISR();
+      sdp->com_txpos = 0;
+      if (sdp->com_txcnt == 0)
+        return false;
+    }
+    n = send(sdp->com_data, sdp->com_txbuf + sdp->com_txpos,
+             sdp->com_txcnt - sdp->com_txpos, 0);
     switch (n) {
     case 0:
       close(sdp->com_data);
@@ -210,6 +223,7 @@ static bool outint(SerialDriver *sdp) {
       sdp->com_data = -1;
       return false;
     }
+    sdp->com_txpos += (size_t)n;
     return true;
   }
   return false;
@@ -233,6 +247,8 @@ void sd_lld_init(void) {
   SD1.com_listen = -1;
   SD1.com_data = -1;
   SD1.com_name = "SD1";
+  SD1.com_txpos = 0;
+  SD1.com_txcnt = 0;
 #endif
 
 #if USE_SIM_SERIAL2
@@ -240,6 +256,8 @@ void sd_lld_init(void) {
   SD2.com_listen = -1;
   SD2.com_data = -1;
   SD2.com_name = "SD2";
+  SD2.com_txpos = 0;
+  SD2.com_txcnt = 0;
 #endif
 }
 
@@ -40,6 +40,15 @@
 #define SERIAL_BUFFERS_SIZE                 1024
 #endif
 
+/**
+ * @brief   Socket I/O block size.
+ * @details Maximum amount of data exchanged with the sockets in a single
+ *          operation, the queues are accessed once for each block.
+ */
+#if !defined(SIM_SERIAL_BLOCK_SIZE) || defined(__DOXYGEN__)
+#define SIM_SERIAL_BLOCK_SIZE               SERIAL_BUFFERS_SIZE
+#endif
+
 /**
  * @brief   SD1 driver enable switch.
  * @details If set to @p TRUE the support for SD1 is included.
@@ -112,7 +121,13 @@ typedef struct {
   /* Data socket for simulated serial port.*/                               \
   int                       com_data;                                       \
   /* Port readable name.*/                                                  \
-  const char                *com_name;
+  const char                *com_name;                                      \
+  /* Data taken from the output queue and not yet sent.*/                   \
+  uint8_t                   com_txbuf[SIM_SERIAL_BLOCK_SIZE];               \
+  /* Position of the first byte not yet sent.*/                             \
+  size_t                    com_txpos;                                      \
+  /* Number of bytes in the transmit buffer.*/                              \
+  size_t                    com_txcnt;
 
 /*===========================================================================*/
 /* External declarations.                                                    */
@@ -0,0 +1,357 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/hal_spi_lld.c
+ * @brief   Posix simulator low level SPI driver code.
+ * @details Each configuration addresses a device model, selecting it stands
+ *          for asserting the chip select line. Data is exchanged with the
+ *          model when a transfer starts, the completion interrupt is raised
+ *          after the time the transfer takes at the configured bit rate.
+ *          Transfers started from the completion interrupt follow the
+ *          previous one back to back, like chained DMA descriptors.
+ *
+ * @addtogroup POSIX_SPI
+ * @{
+ */
+
+#include <sys/time.h>
+
+#include "hal.h"
+
+#if (HAL_USE_SPI == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   SPI1 driver identifier.
+ */
+#if (USE_SIM_SPI1 == TRUE) || defined(__DOXYGEN__)
+SPIDriver SPID1;
+#endif
+
+/**
+ * @brief   SPI2 driver identifier.
+ */
+#if (USE_SIM_SPI2 == TRUE) || defined(__DOXYGEN__)
+SPIDriver SPID2;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the host time in nanoseconds.
+ */
+static uint64_t spi_now(void) {
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return ((uint64_t)tv.tv_sec * 1000000000U) +
+         ((uint64_t)tv.tv_usec * 1000U);
+}
+
+/**
+ * @brief   Performs a transfer and schedules its completion.
+ * @note    With no device selected the bus reads as all ones.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of bytes to be exchanged
+ * @param[in] txbuf     the pointer to the transmit buffer or @p NULL
+ * @param[out] rxbuf    the pointer to the receive buffer or @p NULL
+ */
+static void spi_transfer(SPIDriver *spip, size_t n,
+                         const uint8_t *txbuf, uint8_t *rxbuf) {
+  sim_spi_device_t *devp = spip->selected;
+  size_t i;
+
+  for (i = 0U; i < n; i++) {
+    uint8_t b = txbuf != NULL ? txbuf[i] : 0xFFU;
+
+    b = devp != NULL ? devp->exchange(devp, b) : 0xFFU;
+    if (rxbuf != NULL) {
+      rxbuf[i] = b;
+    }
+  }
+
+  if (spip->config->bitrate == 0U) {
+    spip->end = spi_now();
+  }
+  else {
+    spip->end = spip->chained != 0U ? spip->chained : spi_now();
+    spip->end += ((uint64_t)n * 8U * 1000000000U) / spip->config->bitrate;
+  }
+  spip->busy = true;
+}
+
+/**
+ * @brief   Serves the transfer completion interrupts of a driver.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] now       current host time in nanoseconds
+ * @return              The interrupt activity status.
+ */
+static bool spi_serve_interrupt(SPIDriver *spip, uint64_t now) {
+  bool b = false;
+
+  while (spip->busy && (spip->end < now)) {
+    spip->busy    = false;
+    spip->chained = spip->end;
+    _spi_isr_code(spip);
+    spip->chained = 0U;
+    b = true;
+  }
+
+  return b;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level SPI driver initialization.
+ *
+ * @notapi
+ */
+void spi_lld_init(void) {
+
+#if USE_SIM_SPI1 == TRUE
+  spiObjectInit(&SPID1);
+  SPID1.selected = NULL;
+  SPID1.busy     = false;
+  SPID1.chained  = 0U;
+#endif
+#if USE_SIM_SPI2 == TRUE
+  spiObjectInit(&SPID2);
+  SPID2.selected = NULL;
+  SPID2.busy     = false;
+  SPID2.chained  = 0U;
+#endif
+}
+
+/**
+ * @brief   Configures and activates the SPI peripheral.
+ * @note    The simulated peripheral can be reconfigured while active.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_start(SPIDriver *spip) {
+
+  (void)spip;
+}
+
+/**
+ * @brief   Deactivates the SPI peripheral.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_stop(SPIDriver *spip) {
+
+  spip->selected = NULL;
+  spip->busy     = false;
+}
+
+/**
+ * @brief   Asserts the slave select signal and prepares for transfers.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_select(SPIDriver *spip) {
+  sim_spi_device_t *devp = spip->config->device;
+
+  spip->selected = devp;
+  if ((devp != NULL) && (devp->select != NULL)) {
+    devp->select(devp);
+  }
+}
+
+/**
+ * @brief   Deasserts the slave select signal.
+ * @details The previously selected peripheral is unselected.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_unselect(SPIDriver *spip) {
+  sim_spi_device_t *devp = spip->selected;
+
+  spip->selected = NULL;
+  if ((devp != NULL) && (devp->unselect != NULL)) {
+    devp->unselect(devp);
+  }
+}
+
+/**
+ * @brief   Ignores data on the SPI bus.
+ * @details This asynchronous function starts the transmission of a series of
+ *          idle words on the SPI bus and ignores the received data.
+ * @post    At the end of the operation the configured callback is invoked.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be ignored
+ *
+ * @notapi
+ */
+void spi_lld_ignore(SPIDriver *spip, size_t n) {
+
+  spi_transfer(spip, n, NULL, NULL);
+}
+
+/**
+ * @brief   Exchanges data on the SPI bus.
+ * @details This asynchronous function starts a simultaneous transmit/receive
+ *          operation.
+ * @post    At the end of the operation the configured callback is invoked.
+ * @note    Only 8 bits frames are supported.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be exchanged
+ * @param[in] txbuf     the pointer to the transmit buffer
+ * @param[out] rxbuf    the pointer to the receive buffer
+ *
+ * @notapi
+ */
+void spi_lld_exchange(SPIDriver *spip, size_t n,
+                      const void *txbuf, void *rxbuf) {
+
+  spi_transfer(spip, n, txbuf, rxbuf);
+}
+
+/**
+ * @brief   Sends data over the SPI bus.
+ * @details This asynchronous function starts a transmit operation.
+ * @post    At the end of the operation the configured callback is invoked.
+ * @note    Only 8 bits frames are supported.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to send
+ * @param[in] txbuf     the pointer to the transmit buffer
+ *
+ * @notapi
+ */
+void spi_lld_send(SPIDriver *spip, size_t n, const void *txbuf) {
+
+  spi_transfer(spip, n, txbuf, NULL);
+}
+
+/**
+ * @brief   Receives data from the SPI bus.
+ * @details This asynchronous function starts a receive operation.
+ * @post    At the end of the operation the configured callback is invoked.
+ * @note    Only 8 bits frames are supported.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to receive
+ * @param[out] rxbuf    the pointer to the receive buffer
+ *
+ * @notapi
+ */
+void spi_lld_receive(SPIDriver *spip, size_t n, void *rxbuf) {
+
+  spi_transfer(spip, n, NULL, rxbuf);
+}
+
+/**
+ * @brief   Exchanges one frame using a polled wait.
+ * @details This synchronous function exchanges one frame using a polled
+ *          synchronization method. This function is useful when exchanging
+ *          small amount of data on high speed channels, usually in this
+ *          situation is much more efficient just wait for completion using
+ *          polling than suspending the thread waiting for an interrupt.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] frame     the data frame to send over the SPI bus
+ * @return              The received data frame from the SPI bus.
+ */
+uint16_t spi_lld_polled_exchange(SPIDriver *spip, uint16_t frame) {
+  sim_spi_device_t *devp = spip->selected;
+
+  if (devp == NULL) {
+    return 0xFFU;
+  }
+  return devp->exchange(devp, (uint8_t)frame);
+}
+
+/**
+ * @brief   Simulated transfers completion.
+ *
+ * @return              The interrupt activity status.
+ * @retval false        if no interrupt occurred.
+ * @retval true         if an interrupt occurred.
+ *
+ * @notapi
+ */
+bool spi_lld_interrupt_pending(void) {
+  bool b = false;
+  uint64_t now;
+
+#if USE_SIM_SPI1 == TRUE
+  b = b || SPID1.busy;
+#endif
+#if USE_SIM_SPI2 == TRUE
+  b = b || SPID2.busy;
+#endif
+  if (!b) {
+    return false;
+  }
+
+  b = false;
+  now = spi_now();
+
+  OSAL_IRQ_PROLOGUE();
+
+#if USE_SIM_SPI1 == TRUE
+  if (spi_serve_interrupt(&SPID1, now)) {
+    b = true;
+  }
+#endif
+#if USE_SIM_SPI2 == TRUE
+  if (spi_serve_interrupt(&SPID2, now)) {
+    b = true;
+  }
+#endif
+
+  OSAL_IRQ_EPILOGUE();
+
+  return b;
+}
+
+#endif /* HAL_USE_SPI == TRUE */
+
+/** @} */
@@ -0,0 +1,172 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/hal_spi_lld.h
+ * @brief   Posix simulator low level SPI driver header.
+ *
+ * @addtogroup POSIX_SPI
+ * @{
+ */
+
+#ifndef HAL_SPI_LLD_H
+#define HAL_SPI_LLD_H
+
+#if (HAL_USE_SPI == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Circular mode support flag.
+ */
+#define SPI_SUPPORTS_CIRCULAR           FALSE
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   SPI1 driver enable switch.
+ * @details If set to @p TRUE the support for SPI1 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_SPI1) || defined(__DOXYGEN__)
+#define USE_SIM_SPI1                    TRUE
+#endif
+
+/**
+ * @brief   SPI2 driver enable switch.
+ * @details If set to @p TRUE the support for SPI2 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_SPI2) || defined(__DOXYGEN__)
+#define USE_SIM_SPI2                    TRUE
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (USE_SIM_SPI1 == FALSE) && (USE_SIM_SPI2 == FALSE)
+#error "SPI driver activated but no SPI peripheral assigned"
+#endif
+
+#if SPI_SELECT_MODE != SPI_SELECT_MODE_LLD
+#error "the simulated SPI requires SPI_SELECT_MODE_LLD"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a simulated SPI device.
+ */
+typedef struct sim_spi_device sim_spi_device_t;
+
+/**
+ * @brief   Simulated SPI device model.
+ * @details Device models embed this structure, the driver invokes the model
+ *          functions when the device is selected, unselected and for each
+ *          byte exchanged while it is selected. The functions are invoked
+ *          in locked state.
+ */
+struct sim_spi_device {
+  /**
+   * @brief   Device selected or @p NULL.
+   */
+  void                      (*select)(sim_spi_device_t *devp);
+  /**
+   * @brief   Device unselected or @p NULL.
+   */
+  void                      (*unselect)(sim_spi_device_t *devp);
+  /**
+   * @brief   Exchanges a byte, returns the byte shifted out by the device.
+   */
+  uint8_t                   (*exchange)(sim_spi_device_t *devp, uint8_t b);
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level fields of the SPI driver structure.
+ */
+#define spi_lld_driver_fields                                               \
+  /* Currently selected device or NULL.*/                                   \
+  sim_spi_device_t          *selected;                                      \
+  /* A transfer is in progress.*/                                           \
+  bool                      busy;                                           \
+  /* End time of the current transfer in nanoseconds.*/                     \
+  uint64_t                  end;                                            \
+  /* Start time of a transfer chained from the ISR, zero otherwise.*/       \
+  uint64_t                  chained
+
+/**
+ * @brief   Low level fields of the SPI configuration structure.
+ */
+#define spi_lld_config_fields                                               \
+  /* Device addressed by this configuration, it stands for the chip         \
+     select line.*/                                                         \
+  sim_spi_device_t          *device;                                        \
+  /* Bus bit rate in bits per second, zero means that transfers end at      \
+     the next interrupts poll.*/                                            \
+  uint32_t                  bitrate
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if (USE_SIM_SPI1 == TRUE) && !defined(__DOXYGEN__)
+extern SPIDriver SPID1;
+#endif
+
+#if (USE_SIM_SPI2 == TRUE) && !defined(__DOXYGEN__)
+extern SPIDriver SPID2;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void spi_lld_init(void);
+  void spi_lld_start(SPIDriver *spip);
+  void spi_lld_stop(SPIDriver *spip);
+  void spi_lld_select(SPIDriver *spip);
+  void spi_lld_unselect(SPIDriver *spip);
+  void spi_lld_ignore(SPIDriver *spip, size_t n);
+  void spi_lld_exchange(SPIDriver *spip, size_t n,
+                        const void *txbuf, void *rxbuf);
+  void spi_lld_send(SPIDriver *spip, size_t n, const void *txbuf);
+  void spi_lld_receive(SPIDriver *spip, size_t n, void *rxbuf);
+  uint16_t spi_lld_polled_exchange(SPIDriver *spip, uint16_t frame);
+  bool spi_lld_interrupt_pending(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_SPI == TRUE */
+
+#endif /* HAL_SPI_LLD_H */
+
+/** @} */
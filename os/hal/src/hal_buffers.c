@@ -89,6 +89,7 @@ void ibqObjectInit(input_buffers_queue_t *ibqp, bool suspended, uint8_t *bp,
   ibqp->buffers   = bp;
   ibqp->ptr       = NULL;
   ibqp->top       = NULL;
+  ibqp->borrowed  = false;
   ibqp->notify    = infy;
   ibqp->link      = link;
 }
@@ -113,6 +114,7 @@ void ibqResetI(input_buffers_queue_t *ibqp) {
   ibqp->bwrptr    = ibqp->buffers;
   ibqp->ptr       = NULL;
   ibqp->top       = NULL;
+  ibqp->borrowed  = false;
   osalThreadDequeueAllI(&ibqp->waiting, MSG_RESET);
 }
 
@@ -416,6 +418,93 @@ size_t ibqReadTimeout(input_buffers_queue_t *ibqp, uint8_t *bp,
   }
 }
 
+/**
+ * @brief   Borrows the data available in the current input buffer.
+ * @details The function gives direct access to the unread data of the
+ *          current buffer, fetching a new buffer from the queue if required,
+ *          so that the data can be parsed in place without copies.
+ * @note    The buffer must be returned using @p ibqReturn() before any
+ *          other read operation is performed on the queue.
+ * @note    A queue reset while the buffer is borrowed invalidates it, the
+ *          following @p ibqReturn() does nothing in that case.
+ *
+ * @param[in] ibqp      pointer to the @p input_buffers_queue_t object
+ * @param[out] pp       pointer to a variable receiving the pointer to the
+ *                      data or @p NULL if no data is available
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes available at @p *pp.
+ * @retval 0            if a timeout occurred or the queue has been reset.
+ *
+ * @api
+ */
+size_t ibqBorrowTimeout(input_buffers_queue_t *ibqp, uint8_t **pp,
+                        sysinterval_t timeout) {
+  size_t size;
+
+  osalDbgCheck(pp != NULL);
+
+  osalSysLock();
+
+  osalDbgAssert(!ibqp->borrowed, "already borrowed");
+
+  /* This condition indicates that a new buffer must be acquired.*/
+  if (ibqp->ptr == NULL) {
+    msg_t msg;
+
+    msg = ibqGetFullBufferTimeoutS(ibqp, timeout);
+    if (msg != MSG_OK) {
+      osalSysUnlock();
+      *pp = NULL;
+      return (size_t)0;
+    }
+  }
+
+  /* Lending the unread part of the current buffer.*/
+  ibqp->borrowed = true;
+  *pp  = ibqp->ptr;
+  size = (size_t)ibqp->top - (size_t)ibqp->ptr;
+
+  osalSysUnlock();
+
+  return size;
+}
+
+/**
+ * @brief   Returns a buffer previously borrowed using @p ibqBorrowTimeout().
+ * @details The specified amount of data is marked as consumed, if the whole
+ *          buffer has been consumed then it is released in the queue.
+ *          Unconsumed data is returned again by the next read operation.
+ *
+ * @param[in] ibqp      pointer to the @p input_buffers_queue_t object
+ * @param[in] n         number of bytes consumed, it cannot exceed the size
+ *                      returned by @p ibqBorrowTimeout()
+ *
+ * @api
+ */
+void ibqReturn(input_buffers_queue_t *ibqp, size_t n) {
+
+  osalSysLock();
+
+  /* The flag is cleared if the queue has been reset in the meantime.*/
+  if (ibqp->borrowed) {
+    osalDbgCheck(n <= ((size_t)ibqp->top - (size_t)ibqp->ptr));
+
+    ibqp->borrowed = false;
+    ibqp->ptr += n;
+
+    /* Has the current data buffer been finished? if so then release it.*/
+    if (ibqp->ptr >= ibqp->top) {
+      ibqReleaseEmptyBufferS(ibqp);
+    }
+  }
+
+  osalSysUnlock();
+}
+
 /**
  * @brief   Initializes an output buffers queue object.
  *
@@ -445,6 +534,7 @@ void obqObjectInit(output_buffers_queue_t *obqp, bool suspended, uint8_t *bp,
   obqp->buffers   = bp;
   obqp->ptr       = NULL;
   obqp->top       = NULL;
+  obqp->borrowed  = false;
   obqp->notify    = onfy;
   obqp->link      = link;
 }
@@ -469,6 +559,7 @@ void obqResetI(output_buffers_queue_t *obqp) {
   obqp->bwrptr    = obqp->buffers;
   obqp->ptr       = NULL;
   obqp->top       = NULL;
+  obqp->borrowed  = false;
   osalThreadDequeueAllI(&obqp->waiting, MSG_RESET);
 }
 
@@ -779,6 +870,94 @@ size_t obqWriteTimeout(output_buffers_queue_t *obqp, const uint8_t *bp,
   }
 }
 
+/**
+ * @brief   Borrows the free space in the current output buffer.
+ * @details The function gives direct access to the free part of the current
+ *          buffer, fetching a new empty buffer from the queue if required,
+ *          so that data can be formatted in place without copies.
+ * @note    The buffer must be returned using @p obqReturn() before any
+ *          other write operation is performed on the queue. The buffer is
+ *          not flushed while it is borrowed.
+ * @note    A queue reset while the buffer is borrowed invalidates it, the
+ *          following @p obqReturn() does nothing in that case.
+ *
+ * @param[in] obqp      pointer to the @p output_buffers_queue_t object
+ * @param[out] pp       pointer to a variable receiving the pointer to the
+ *                      free space or @p NULL if no space is available
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes available at @p *pp.
+ * @retval 0            if a timeout occurred or the queue has been reset.
+ *
+ * @api
+ */
+size_t obqBorrowTimeout(output_buffers_queue_t *obqp, uint8_t **pp,
+                        sysinterval_t timeout) {
+  size_t size;
+
+  osalDbgCheck(pp != NULL);
+
+  osalSysLock();
+
+  osalDbgAssert(!obqp->borrowed, "already borrowed");
+
+  /* This condition indicates that a new buffer must be acquired.*/
+  if (obqp->ptr == NULL) {
+    msg_t msg;
+
+    msg = obqGetEmptyBufferTimeoutS(obqp, timeout);
+    if (msg != MSG_OK) {
+      osalSysUnlock();
+      *pp = NULL;
+      return (size_t)0;
+    }
+  }
+
+  /* Lending the free part of the current buffer.*/
+  obqp->borrowed = true;
+  *pp  = obqp->ptr;
+  size = (size_t)obqp->top - (size_t)obqp->ptr;
+
+  osalSysUnlock();
+
+  return size;
+}
+
+/**
+ * @brief   Returns a buffer previously borrowed using @p obqBorrowTimeout().
+ * @details The specified amount of data is committed to the buffer, if the
+ *          buffer is full then it is posted in the queue. A partially
+ *          filled buffer is posted by the next flush.
+ *
+ * @param[in] obqp      pointer to the @p output_buffers_queue_t object
+ * @param[in] n         number of bytes written, it cannot exceed the size
+ *                      returned by @p obqBorrowTimeout()
+ *
+ * @api
+ */
+void obqReturn(output_buffers_queue_t *obqp, size_t n) {
+
+  osalSysLock();
+
+  /* The flag is cleared if the queue has been reset in the meantime.*/
+  if (obqp->borrowed) {
+    osalDbgCheck(n <= ((size_t)obqp->top - (size_t)obqp->ptr));
+
+    obqp->borrowed = false;
+    obqp->ptr += n;
+
+    /* Has the current data buffer been finished? if so then post it.*/
+    if (obqp->ptr >= obqp->top) {
+      obqPostFullBufferS(obqp, obqp->bsize - sizeof (size_t));
+    }
+  }
+
+  osalSysUnlock();
+}
+
 /**
  * @brief   Flushes the current, partially filled, buffer to the queue.
  * @note    The notification callback is not invoked because the function
@@ -798,7 +977,7 @@ bool obqTryFlushI(output_buffers_queue_t *obqp) {
 
   /* If queue is empty and there is a buffer partially filled and
      it is not being written.*/
-  if (obqIsEmptyI(obqp) && (obqp->ptr != NULL)) {
+  if (obqIsEmptyI(obqp) && (obqp->ptr != NULL) && !obqp->borrowed) {
     size_t size = (size_t)obqp->ptr - ((size_t)obqp->bwrptr + sizeof (size_t));
 
     if (size > 0U) {
@@ -834,7 +1013,7 @@ void obqFlush(output_buffers_queue_t *obqp) {
   osalSysLock();
 
   /* If there is a buffer partially filled and not being written.*/
-  if (obqp->ptr != NULL) {
+  if ((obqp->ptr != NULL) && !obqp->borrowed) {
     size_t size = ((size_t)obqp->ptr - (size_t)obqp->bwrptr) - sizeof (size_t);
 
     if (size > 0U) {
@@ -22,6 +22,8 @@
  * @{
  */
 
+#include <string.h>
+
 #include "hal.h"
 
 #if (HAL_USE_CAN == TRUE) || defined(__DOXYGEN__)
@@ -30,6 +32,11 @@
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
 
+/**
+ * @brief   Marks the used entries of the software filters hash table.
+ */
+#define CAN_SW_FILTER_USED          0x80000000U
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -42,6 +49,151 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if (CAN_USE_RX_QUEUES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Hash function of the software filters table.
+ *
+ * @param[in] key       encoded identifier
+ * @return              The table index.
+ */
+static inline unsigned can_sw_hash(uint32_t key) {
+
+  return (unsigned)((key * 0x9E3779B1U) >> 16) &
+         ((unsigned)CAN_SW_FILTERS_HASH_SIZE - 1U);
+}
+
+/**
+ * @brief   Inserts an exact identifier in a software filters hash table.
+ *
+ * @param[in,out] hash  the hash table
+ * @param[in] key       encoded identifier
+ * @return              The operation result.
+ * @retval HAL_SUCCESS  if the identifier has been inserted or was already
+ *                      present.
+ * @retval HAL_FAILED   if the table is full.
+ */
+static bool can_sw_insert(uint32_t *hash, uint32_t key) {
+  unsigned i, n;
+
+  i = can_sw_hash(key);
+  for (n = 0U; n < (unsigned)CAN_SW_FILTERS_HASH_SIZE; n++) {
+    if ((hash[i] == 0U) || (hash[i] == (key | CAN_SW_FILTER_USED))) {
+      hash[i] = key | CAN_SW_FILTER_USED;
+      return HAL_SUCCESS;
+    }
+    i = (i + 1U) & ((unsigned)CAN_SW_FILTERS_HASH_SIZE - 1U);
+  }
+
+  return HAL_FAILED;
+}
+
+/**
+ * @brief   Evaluates the software filters on a received frame.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] crfp      pointer to the received frame
+ * @return              The filtering result.
+ * @retval true         if the frame is accepted.
+ * @retval false        if the frame is rejected.
+ */
+static bool can_sw_accept(CANDriver *canp, const CANRxFrame *crfp) {
+  uint32_t key;
+  unsigned i, n;
+
+  if (canp->swfilters == NULL) {
+    return true;
+  }
+
+  if (crfp->IDE != 0U) {
+    key = CAN_SW_FILTER_EXT(crfp->EID);
+  }
+  else {
+    key = CAN_SW_FILTER_STD(crfp->SID);
+  }
+
+  /* Exact identifiers first, looked up in the hash table.*/
+  i = can_sw_hash(key);
+  for (n = 0U; n < (unsigned)CAN_SW_FILTERS_HASH_SIZE; n++) {
+    if (canp->swhash[i] == (key | CAN_SW_FILTER_USED)) {
+      return true;
+    }
+    if (canp->swhash[i] == 0U) {
+      break;
+    }
+    i = (i + 1U) & ((unsigned)CAN_SW_FILTERS_HASH_SIZE - 1U);
+  }
+
+  /* Then the filters with a partial mask.*/
+  if (canp->swmasked > 0U) {
+    const can_sw_filter_t *fp = canp->swfilters;
+    const can_sw_filter_t *end = fp + canp->swnfilters;
+
+    while (fp < end) {
+      if ((fp->mask != CAN_SW_FILTER_MASK_ALL) &&
+          (((key ^ fp->id) & fp->mask) == 0U)) {
+        return true;
+      }
+      fp++;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief   Determines whether a software receive ring contains frames.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number, @p CAN_ANY_MAILBOX for any mailbox
+ * @return              The ring status.
+ */
+static bool can_is_rx_nonempty(CANDriver *canp, canmbx_t mailbox) {
+  unsigned i;
+
+  if (mailbox != CAN_ANY_MAILBOX) {
+    return canp->rxwrcnt[mailbox - 1U] != canp->rxrdcnt[mailbox - 1U];
+  }
+  for (i = 0U; i < (unsigned)CAN_RX_MAILBOXES; i++) {
+    if (canp->rxwrcnt[i] != canp->rxrdcnt[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief   Fetches a frame from a software receive ring.
+ * @pre     The ring must not be empty.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number, @p CAN_ANY_MAILBOX for any mailbox
+ * @param[out] crfp     pointer to the buffer where the CAN frame is copied
+ */
+static void can_receive(CANDriver *canp,
+                        canmbx_t mailbox,
+                        CANRxFrame *crfp) {
+  unsigned i;
+
+  if (mailbox != CAN_ANY_MAILBOX) {
+    i = (unsigned)mailbox - 1U;
+  }
+  else {
+    i = 0U;
+    while (canp->rxwrcnt[i] == canp->rxrdcnt[i]) {
+      i++;
+    }
+  }
+  *crfp = canp->rxring[i][canp->rxrdcnt[i] & (CAN_RX_QUEUE_SIZE - 1U)];
+  canp->rxrdcnt[i]++;
+}
+
+#else /* CAN_USE_RX_QUEUES == FALSE */
+#define can_is_rx_nonempty(canp, mailbox)                                   \
+  can_lld_is_rx_nonempty(canp, mailbox)
+#define can_receive(canp, mailbox, crfp)                                    \
+  can_lld_receive(canp, mailbox, crfp)
+#endif /* CAN_USE_RX_QUEUES == FALSE */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -87,6 +239,14 @@ void canObjectInit(CANDriver *canp) {
   canp->wakeup_cb   = NULL;
 #endif
 #endif /* CAN_ENFORCE_USE_CALLBACKS == TRUE */
+#if CAN_USE_RX_QUEUES == TRUE
+  memset(canp->rxrdcnt, 0, sizeof canp->rxrdcnt);
+  memset(canp->rxwrcnt, 0, sizeof canp->rxwrcnt);
+  memset(canp->swhash, 0, sizeof canp->swhash);
+  canp->swfilters   = NULL;
+  canp->swnfilters  = 0U;
+  canp->swmasked    = 0U;
+#endif
 }
 
 /**
@@ -112,6 +272,11 @@ void canStart(CANDriver *canp, const CANConfig *config) {
   canp->state = CAN_STARTING;
   canp->config = config;
 
+#if CAN_USE_RX_QUEUES == TRUE
+  /* Frames left from a previous session are discarded.*/
+  memcpy(canp->rxrdcnt, canp->rxwrcnt, sizeof canp->rxrdcnt);
+#endif
+
   /* Low level initialization, could be a slow process and sleeps could
      be performed inside.*/
   can_lld_start(canp);
@@ -209,12 +374,12 @@ bool canTryReceiveI(CANDriver *canp,
                 "invalid state");
 
   /* If the RX mailbox is empty then the function fails.*/
-  if (!can_lld_is_rx_nonempty(canp, mailbox)) {
+  if (!can_is_rx_nonempty(canp, mailbox)) {
     return true;
   }
 
   /* Fetching the frame.*/
-  can_lld_receive(canp, mailbox, crfp);
+  can_receive(canp, mailbox, crfp);
 
   return false;
 }
@@ -319,7 +484,7 @@ msg_t canReceiveTimeout(CANDriver *canp,
                 "invalid state");
 
   /*lint -save -e9007 [13.5] Right side is supposed to be pure.*/
-  while ((canp->state == CAN_SLEEP) || !can_lld_is_rx_nonempty(canp, mailbox)) {
+  while ((canp->state == CAN_SLEEP) || !can_is_rx_nonempty(canp, mailbox)) {
   /*lint -restore*/
     msg_t msg = osalThreadEnqueueTimeoutS(&canp->rxqueue, timeout);
     if (msg != MSG_OK) {
@@ -327,11 +492,199 @@ msg_t canReceiveTimeout(CANDriver *canp,
       return msg;
     }
   }
-  can_lld_receive(canp, mailbox, crfp);
+  can_receive(canp, mailbox, crfp);
   osalSysUnlock();
   return MSG_OK;
 }
 
+#if (CAN_USE_RX_QUEUES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Can frames batch receive.
+ * @details The function waits until at least a frame is received then
+ *          fetches all the queued frames up to the specified number.
+ * @note    When @p CAN_ANY_MAILBOX is specified the frames of the lower
+ *          numbered mailboxes are fetched first.
+ * @note    Trying to receive while in sleep mode simply enqueues the thread.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number, @p CAN_ANY_MAILBOX for any mailbox
+ * @param[out] crfp     pointer to an array of @p n frames where the received
+ *                      frames are copied
+ * @param[in] n         maximum number of frames to be fetched
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of frames fetched, zero if the operation
+ *                      timed out or the driver has been stopped while
+ *                      waiting.
+ *
+ * @api
+ */
+size_t canReceiveBatch(CANDriver *canp,
+                       canmbx_t mailbox,
+                       CANRxFrame *crfp,
+                       size_t n,
+                       sysinterval_t timeout) {
+  size_t i;
+
+  osalDbgCheck((canp != NULL) && (crfp != NULL) && (n > 0U) &&
+               (mailbox <= (canmbx_t)CAN_RX_MAILBOXES));
+
+  osalSysLock();
+  osalDbgAssert((canp->state == CAN_READY) || (canp->state == CAN_SLEEP),
+                "invalid state");
+
+  /*lint -save -e9007 [13.5] Right side is supposed to be pure.*/
+  while ((canp->state == CAN_SLEEP) || !can_is_rx_nonempty(canp, mailbox)) {
+  /*lint -restore*/
+    msg_t msg = osalThreadEnqueueTimeoutS(&canp->rxqueue, timeout);
+    if (msg != MSG_OK) {
+      osalSysUnlock();
+      return 0U;
+    }
+  }
+
+  /* Fetching all the frames with a single critical zone.*/
+  i = 0U;
+  do {
+    can_receive(canp, mailbox, &crfp[i]);
+    i++;
+  } while ((i < n) && can_is_rx_nonempty(canp, mailbox));
+  osalSysUnlock();
+
+  return i;
+}
+
+/**
+ * @brief   Sets the software acceptance filters.
+ * @details The filters are evaluated by the receive ISR, rejected frames are
+ *          not queued. Filters whose mask is @p CAN_SW_FILTER_MASK_ALL are
+ *          placed in a hash table and looked up in constant time, the other
+ *          filters are evaluated in sequence.
+ * @note    The filters array must stay valid while in use by the driver.
+ * @note    The hash table is built on the stack before being installed.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] filters   pointer to an array of filters or @p NULL in order to
+ *                      accept all frames
+ * @param[in] n         number of filters in the array
+ * @return              The operation result.
+ * @retval HAL_SUCCESS  if the filters have been installed.
+ * @retval HAL_FAILED   if the exact identifiers exceed the hash table size,
+ *                      the previous filters are kept.
+ *
+ * @api
+ */
+bool canSetSoftwareFilters(CANDriver *canp,
+                           const can_sw_filter_t *filters,
+                           size_t n) {
+  uint32_t hash[CAN_SW_FILTERS_HASH_SIZE];
+  size_t i, masked;
+
+  osalDbgCheck(canp != NULL);
+
+  if ((filters == NULL) || (n == 0U)) {
+    filters = NULL;
+    n = 0U;
+  }
+
+  memset(hash, 0, sizeof hash);
+  masked = 0U;
+  for (i = 0U; i < n; i++) {
+    if (filters[i].mask == CAN_SW_FILTER_MASK_ALL) {
+      if (can_sw_insert(hash, filters[i].id & CAN_SW_FILTER_MASK_ALL)) {
+        return HAL_FAILED;
+      }
+    }
+    else {
+      masked++;
+    }
+  }
+
+  osalSysLock();
+  memcpy(canp->swhash, hash, sizeof hash);
+  canp->swfilters  = filters;
+  canp->swnfilters = n;
+  canp->swmasked   = masked;
+  osalSysUnlock();
+
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Moves the received frames into the software receive rings.
+ * @details The specified receive mailboxes are emptied, the frames passing
+ *          the software filters are queued and the waiting threads are
+ *          notified. Frames not fitting in a full ring are discarded and an
+ *          overflow error is notified.
+ * @note    This function is invoked by the LLD through the
+ *          @p _can_rx_full_isr() macro.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] flags     mask of the non-empty receive mailboxes
+ *
+ * @notapi
+ */
+void _can_rx_queues_isr(CANDriver *canp, uint32_t flags) {
+  uint32_t rxflags = 0U;
+  bool overflow = false;
+  canmbx_t mailbox;
+
+  osalSysLockFromISR();
+  for (mailbox = 1U; mailbox <= (canmbx_t)CAN_RX_MAILBOXES; mailbox++) {
+    unsigned i = (unsigned)mailbox - 1U;
+
+    if ((flags & CAN_MAILBOX_TO_MASK(mailbox)) == 0U) {
+      continue;
+    }
+
+    while (can_lld_is_rx_nonempty(canp, mailbox)) {
+      if (canp->rxwrcnt[i] - canp->rxrdcnt[i] >= (uint32_t)CAN_RX_QUEUE_SIZE) {
+        CANRxFrame discarded;
+
+        can_lld_receive(canp, mailbox, &discarded);
+        overflow = true;
+      }
+      else {
+        CANRxFrame *crfp;
+
+        /* The frame is received in place, the write counter is advanced
+           only if it passes the filters.*/
+        crfp = &canp->rxring[i][canp->rxwrcnt[i] & (CAN_RX_QUEUE_SIZE - 1U)];
+        can_lld_receive(canp, mailbox, crfp);
+        if (can_sw_accept(canp, crfp)) {
+          canp->rxwrcnt[i]++;
+          rxflags |= CAN_MAILBOX_TO_MASK(mailbox);
+        }
+      }
+    }
+  }
+
+  if (rxflags != 0U) {
+    osalThreadDequeueAllI(&canp->rxqueue, MSG_OK);
+  }
+#if CAN_ENFORCE_USE_CALLBACKS == FALSE
+  if (rxflags != 0U) {
+    osalEventBroadcastFlagsI(&canp->rxfull_event, (eventflags_t)rxflags);
+  }
+  if (overflow) {
+    osalEventBroadcastFlagsI(&canp->error_event, CAN_OVERFLOW_ERROR);
+  }
+  osalSysUnlockFromISR();
+#else
+  osalSysUnlockFromISR();
+  if ((rxflags != 0U) && (canp->rxfull_cb != NULL)) {
+    canp->rxfull_cb(canp, rxflags);
+  }
+  if (overflow && (canp->error_cb != NULL)) {
+    canp->error_cb(canp, CAN_OVERFLOW_ERROR);
+  }
+#endif
+}
+#endif /* CAN_USE_RX_QUEUES == TRUE */
+
 #if (CAN_USE_SLEEP_MODE == TRUE) || defined(__DOXYGEN__)
 /**
  * @brief   Enters the sleep mode.
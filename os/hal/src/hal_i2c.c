@@ -45,6 +45,178 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Notifies a batch completion.
+ *
+ * @param[in] bp        pointer to the @p i2c_batch_t object
+ * @param[in] msg       the batch result
+ *
+ * @notapi
+ */
+static void i2c_batch_done(i2c_batch_t *bp, msg_t msg) {
+
+  bp->state  = I2C_BATCH_DONE;
+  bp->result = msg;
+  osalThreadResumeI(&bp->thread, msg);
+  if (bp->event != NULL) {
+    osalEventBroadcastFlagsI(bp->event, bp->flags);
+  }
+}
+
+/**
+ * @brief   Runs the batches queue.
+ * @details Starts the next transaction of the active batch, completed
+ *          batches are notified in place until a transfer is started or
+ *          the queue is empty.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+static void i2c_queue_run(I2CDriver *i2cp) {
+  i2c_batch_t *bp = i2cp->batch;
+
+  while (true) {
+    if (bp == NULL) {
+      bp = i2cp->qhead;
+      if (bp == NULL) {
+        i2cp->state = I2C_READY;
+        return;
+      }
+      i2cp->qhead = bp->next;
+      i2cp->batch = bp;
+      bp->state   = I2C_BATCH_ACTIVE;
+    }
+
+    if (bp->index < bp->n) {
+      const i2c_transaction_t *txnp = &bp->txns[bp->index];
+
+      osalDbgAssert((txnp->txbytes > 0U) || (txnp->rxbytes > 0U),
+                    "empty transaction");
+
+      /* The transfer completion is handled in _i2c_queue_isr_i().*/
+      i2cp->errors = I2C_NO_ERROR;
+      i2cp->state  = txnp->txbytes > 0U ? I2C_ACTIVE_TX : I2C_ACTIVE_RX;
+      i2c_lld_start_transfer(i2cp, txnp->addr,
+                             txnp->txbuf, txnp->txbytes,
+                             txnp->rxbuf, txnp->rxbytes);
+      return;
+    }
+
+    /* Batch completed, it could be queued again by the listeners.*/
+    i2cp->batch = NULL;
+    i2c_batch_done(bp, bp->failed > 0U ? MSG_RESET : MSG_OK);
+    bp = NULL;
+  }
+}
+
+/**
+ * @brief   Fails the transactions not yet executed of a batch.
+ * @details The first transaction not yet executed gets the specified error
+ *          flags, the following ones are failed without errors flags, the
+ *          batch is then completed with @p MSG_TIMEOUT.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] bp        pointer to the @p i2c_batch_t object
+ * @param[in] errors    error flags of the first transaction
+ *
+ * @notapi
+ */
+static void i2c_batch_fail(I2CDriver *i2cp, i2c_batch_t *bp,
+                           i2cflags_t errors) {
+
+  while (bp->index < bp->n) {
+    i2c_transaction_t *txnp = &bp->txns[bp->index];
+
+    txnp->result = MSG_TIMEOUT;
+    txnp->errors = errors;
+    errors       = I2C_NO_ERROR;
+    bp->failed++;
+    bp->index++;
+    if (txnp->end_cb != NULL) {
+      txnp->end_cb(i2cp, txnp);
+    }
+  }
+  i2c_batch_done(bp, MSG_TIMEOUT);
+}
+
+/**
+ * @brief   Removes a batch not yet started from the queue.
+ * @details The batch transactions are failed without errors flags and the
+ *          batch is completed with @p MSG_TIMEOUT, the other batches and
+ *          the driver state are not affected.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] bp        pointer to the @p i2c_batch_t object
+ *
+ * @notapi
+ */
+static void i2c_queue_remove(I2CDriver *i2cp, i2c_batch_t *bp) {
+  i2c_batch_t *prevp = NULL;
+  i2c_batch_t *p = i2cp->qhead;
+
+  while (p != bp) {
+    osalDbgAssert(p != NULL, "not in queue");
+    prevp = p;
+    p     = p->next;
+  }
+  if (prevp == NULL) {
+    i2cp->qhead = bp->next;
+  }
+  else {
+    prevp->next = bp->next;
+  }
+  if (i2cp->qtail == bp) {
+    i2cp->qtail = prevp;
+  }
+  bp->next = NULL;
+
+  i2c_batch_fail(i2cp, bp, I2C_NO_ERROR);
+}
+
+/**
+ * @brief   Aborts the batches queue.
+ * @details The transaction in progress is failed with an @p I2C_TIMEOUT
+ *          error, the transactions not yet executed are failed without
+ *          errors flags and all the pending batches are completed with
+ *          @p MSG_TIMEOUT. The driver is left in the @p I2C_LOCKED state
+ *          like after a timeout of the synchronous APIs.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+static void i2c_queue_abort(I2CDriver *i2cp) {
+  i2c_batch_t *bp = i2cp->batch;
+  i2cflags_t errors = I2C_TIMEOUT;
+
+  /* A late completion of the aborted transfer does not find a batch
+     anymore, the transfer is terminated by i2cStop().*/
+  i2cp->batch = NULL;
+  i2cp->state = I2C_LOCKED;
+
+  if (bp == NULL) {
+    bp = i2cp->qhead;
+    if (bp != NULL) {
+      i2cp->qhead = bp->next;
+    }
+  }
+  while (bp != NULL) {
+    i2c_batch_fail(i2cp, bp, errors);
+    errors = I2C_NO_ERROR;
+
+    /* The batches completed by the listeners cannot be queued again while
+       the driver is locked.*/
+    bp = i2cp->qhead;
+    if (bp != NULL) {
+      i2cp->qhead = bp->next;
+    }
+  }
+  i2cp->qtail = NULL;
+}
+#endif /* I2C_USE_QUEUE == TRUE */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -77,6 +249,12 @@ void i2cObjectInit(I2CDriver *i2cp) {
   osalMutexObjectInit(&i2cp->mutex);
 #endif
 
+#if I2C_USE_QUEUE == TRUE
+  i2cp->batch = NULL;
+  i2cp->qhead = NULL;
+  i2cp->qtail = NULL;
+#endif
+
 #if defined(I2C_DRIVER_EXT_INIT_HOOK)
   I2C_DRIVER_EXT_INIT_HOOK(i2cp);
 #endif
@@ -118,6 +296,9 @@ void i2cStop(I2CDriver *i2cp) {
 
   osalDbgAssert((i2cp->state == I2C_STOP) || (i2cp->state == I2C_READY) ||
                 (i2cp->state == I2C_LOCKED), "invalid state");
+#if I2C_USE_QUEUE == TRUE
+  osalDbgAssert(i2cp->qhead == NULL, "batches pending");
+#endif
 
   i2c_lld_stop(i2cp);
   i2cp->config = NULL;
@@ -282,6 +463,170 @@ void i2cReleaseBus(I2CDriver *i2cp) {
 }
 #endif /* I2C_USE_MUTUAL_EXCLUSION == TRUE */
 
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Queues a transactions batch.
+ * @details The batch is appended to the driver queue and it is started
+ *          immediately if the driver is idle. The transactions are executed
+ *          back to back from the driver ISR without thread intervention,
+ *          the per-transaction callbacks are invoked as each transaction
+ *          ends and the batch completion is notified once.
+ * @pre     The batch must not be already queued.
+ * @pre     The driver must not be locked, after a timeout the driver must
+ *          be restarted using @p i2cStop() and @p i2cStart().
+ * @note    The batch object, the transactions array and the buffers must
+ *          stay valid until the batch is completed.
+ * @note    The synchronous driver APIs must not be used while batches are
+ *          pending.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] bp        pointer to the @p i2c_batch_t object
+ *
+ * @iclass
+ */
+void i2cQueueBatchI(I2CDriver *i2cp, i2c_batch_t *bp) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((i2cp != NULL) && (bp != NULL) &&
+               ((bp->n == 0U) || (bp->txns != NULL)));
+  osalDbgAssert((i2cp->state == I2C_READY) ||
+                (((i2cp->state == I2C_ACTIVE_TX) ||
+                  (i2cp->state == I2C_ACTIVE_RX)) && (i2cp->batch != NULL)),
+                "not ready");
+  osalDbgAssert((bp->state == I2C_BATCH_IDLE) ||
+                (bp->state == I2C_BATCH_DONE), "already queued");
+
+  bp->state  = I2C_BATCH_QUEUED;
+  bp->index  = 0U;
+  bp->failed = 0U;
+  bp->result = MSG_OK;
+  bp->next   = NULL;
+  bp->thread = NULL;
+  if (i2cp->qhead == NULL) {
+    i2cp->qhead = bp;
+  }
+  else {
+    i2cp->qtail->next = bp;
+  }
+  i2cp->qtail = bp;
+
+  if (i2cp->state == I2C_READY) {
+    i2c_queue_run(i2cp);
+  }
+}
+
+/**
+ * @brief   Queues a transactions batch.
+ * @details The batch is appended to the driver queue and it is started
+ *          immediately if the driver is idle.
+ * @pre     The batch must not be already queued.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] bp        pointer to the @p i2c_batch_t object
+ *
+ * @api
+ */
+void i2cQueueBatch(I2CDriver *i2cp, i2c_batch_t *bp) {
+
+  osalSysLock();
+  i2cQueueBatchI(i2cp, bp);
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Waits for a transactions batch completion.
+ * @details If the batch is still queued on timeout then it is removed from
+ *          the queue and completed with @p MSG_TIMEOUT, the other batches
+ *          are not affected.
+ *          If the batch is in progress on timeout then the bus is
+ *          considered stuck, the transaction in progress is failed with
+ *          an @p I2C_TIMEOUT error and all the pending batches are
+ *          completed with @p MSG_TIMEOUT. The driver is then in the
+ *          @p I2C_LOCKED state, like after a timeout of the synchronous
+ *          APIs, and must be restarted using @p i2cStop() and
+ *          @p i2cStart().
+ * @note    A @a TIME_IMMEDIATE timeout only polls the batch state, the
+ *          queue is not aborted.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] bp        pointer to the @p i2c_batch_t object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation result.
+ * @retval MSG_OK       if all the transactions succeeded.
+ * @retval MSG_RESET    if one or more transactions failed, the errors are
+ *                      stored in each transaction descriptor.
+ * @retval MSG_TIMEOUT  if the operation has timed out or the batch has been
+ *                      aborted by the timeout of another batch.
+ *
+ * @api
+ */
+msg_t i2cWaitBatchTimeout(I2CDriver *i2cp,
+                          i2c_batch_t *bp,
+                          sysinterval_t timeout) {
+  msg_t msg;
+
+  osalDbgCheck((i2cp != NULL) && (bp != NULL));
+
+  osalSysLock();
+  osalDbgAssert(bp->state != I2C_BATCH_IDLE, "not queued");
+  if (bp->state != I2C_BATCH_DONE) {
+    msg = osalThreadSuspendTimeoutS(&bp->thread, timeout);
+    if ((msg == MSG_TIMEOUT) && (timeout != TIME_IMMEDIATE)) {
+      if (bp->state == I2C_BATCH_QUEUED) {
+        i2c_queue_remove(i2cp, bp);
+      }
+      else if (bp->state == I2C_BATCH_ACTIVE) {
+        i2c_queue_abort(i2cp);
+      }
+      else {
+        /* Completed after the timeout but before this thread ran.*/
+        msg = bp->result;
+      }
+      osalOsRescheduleS();
+    }
+  }
+  else {
+    msg = bp->result;
+  }
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Batch transaction completed.
+ * @details Records the transaction outcome, invokes its callback then
+ *          continues with the next transaction or batch.
+ * @note    This function is invoked by the LLD through the
+ *          @p _i2c_wakeup_isr() and @p _i2c_wakeup_error_isr() macros.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] msg       @p MSG_OK or @p MSG_RESET
+ *
+ * @notapi
+ */
+void _i2c_queue_isr_i(I2CDriver *i2cp, msg_t msg) {
+  i2c_batch_t *bp = i2cp->batch;
+  i2c_transaction_t *txnp = &bp->txns[bp->index];
+
+  txnp->result = msg;
+  txnp->errors = i2c_lld_get_errors(i2cp);
+  if (msg != MSG_OK) {
+    bp->failed++;
+  }
+  bp->index++;
+  if (txnp->end_cb != NULL) {
+    txnp->end_cb(i2cp, txnp);
+  }
+  i2c_queue_run(i2cp);
+}
+#endif /* I2C_USE_QUEUE == TRUE */
+
 #endif /* HAL_USE_I2C == TRUE */
 
 /** @} */
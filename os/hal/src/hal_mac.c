@@ -34,6 +34,12 @@
 #error "MAC_USE_ZERO_COPY not supported by this implementation"
 #endif
 
+#if (MAC_USE_ZERO_COPY == TRUE) && (MAC_SUPPORTS_BUFFER_REFERENCES == TRUE)
+#define MAC_USE_BUFFER_REFERENCES   TRUE
+#else
+#define MAC_USE_BUFFER_REFERENCES   FALSE
+#endif
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -46,6 +52,34 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if (MAC_USE_BUFFER_REFERENCES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Gives back the transmitted buffers to the application.
+ * @note    The callback is invoked outside the critical zone so it is
+ *          allowed to use any API.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @notapi
+ */
+static void mac_release_buffers(MACDriver *macp) {
+  void *ref;
+
+  while (true) {
+    osalSysLock();
+    ref = mac_lld_reclaim_transmit_buffer(macp);
+    osalSysUnlock();
+
+    if (ref == NULL) {
+      break;
+    }
+    if (macp->config->txrelease_cb != NULL) {
+      macp->config->txrelease_cb(macp, ref);
+    }
+  }
+}
+#endif
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -122,6 +156,16 @@ void macStop(MACDriver *macp) {
                 "invalid state");
 
   mac_lld_stop(macp);
+
+#if MAC_USE_BUFFER_REFERENCES == TRUE
+  /* Buffers still referenced by the descriptors are given back.*/
+  if (macp->config != NULL) {
+    osalSysUnlock();
+    mac_release_buffers(macp);
+    osalSysLock();
+  }
+#endif
+
   macp->config = NULL;
   macp->state  = MAC_STOP;
 
@@ -151,6 +195,9 @@ msg_t macWaitTransmitDescriptor(MACDriver *macp,
                                 MACTransmitDescriptor *tdp,
                                 sysinterval_t timeout) {
   msg_t msg;
+#if MAC_USE_BUFFER_REFERENCES == TRUE
+  void *ref;
+#endif
 
   osalDbgCheck((macp != NULL) && (tdp != NULL));
   osalDbgAssert(macp->state == MAC_ACTIVE, "not active");
@@ -158,6 +205,18 @@ msg_t macWaitTransmitDescriptor(MACDriver *macp,
   osalSysLock();
 
   while ((msg = mac_lld_get_transmit_descriptor(macp, tdp)) != MSG_OK) {
+#if MAC_USE_BUFFER_REFERENCES == TRUE
+    /* Descriptors could be held by buffers not yet given back.*/
+    ref = mac_lld_reclaim_transmit_buffer(macp);
+    if (ref != NULL) {
+      osalSysUnlock();
+      if (macp->config->txrelease_cb != NULL) {
+        macp->config->txrelease_cb(macp, ref);
+      }
+      osalSysLock();
+      continue;
+    }
+#endif
     msg = osalThreadEnqueueTimeoutS(&macp->tdqueue, timeout);
     if (msg == MSG_TIMEOUT) {
       break;
@@ -184,6 +243,29 @@ void macReleaseTransmitDescriptor(MACTransmitDescriptor *tdp) {
   mac_lld_release_transmit_descriptor(tdp);
 }
 
+#if (MAC_USE_BUFFER_REFERENCES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Gives back the transmitted buffers.
+ * @details The buffers attached using @p macAttachTransmitBuffer() whose
+ *          frames have been transmitted are returned to the application
+ *          through the @p txrelease_cb configuration callback.
+ * @note    This also happens when waiting for a transmit descriptor and
+ *          all descriptors are held by buffers not yet given back, calling
+ *          this function periodically limits the buffers retention time.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @api
+ */
+void macReclaimTransmitBuffers(MACDriver *macp) {
+
+  osalDbgCheck(macp != NULL);
+  osalDbgAssert(macp->state == MAC_ACTIVE, "not active");
+
+  mac_release_buffers(macp);
+}
+#endif
+
 /**
  * @brief   Waits for a received frame.
  * @details Stops until a frame is received and buffered. If a frame is
@@ -229,6 +311,9 @@ msg_t macWaitReceiveDescriptor(MACDriver *macp,
  * @brief   Releases a receive descriptor.
  * @details The descriptor and its buffer are made available for more incoming
  *          frames.
+ * @note    If the driver supports buffer references then a descriptor can
+ *          be kept while more frames are received and released later from
+ *          any thread, its buffer stays valid until then.
  *
  * @param[in] rdp       the pointer to the @p MACReceiveDescriptor structure
  *
@@ -43,6 +43,119 @@
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
 
+/**
+ * @brief   Reader wakeup message for the first byte of a burst.
+ * @details The reader is not meant to read the data yet, it just starts
+ *          timing the idle gap.
+ */
+#define IQ_MSG_BURST    ((msg_t)1)
+
+/**
+ * @brief   Reader wakeup message for the end of a frame.
+ * @details A delimiter has been received or the data stream became idle,
+ *          the reader returns the data without waiting for more.
+ */
+#define IQ_MSG_FRAME    ((msg_t)2)
+
+/**
+ * @brief   Input queue readers wakeup.
+ * @details The readers are resumed according to the queue wakeup policy.
+ *
+ * @param[in] iqp       pointer to an @p input_queue_t structure
+ * @param[in] n         number of bytes written
+ * @param[in] wasempty  the queue was empty before the write
+ * @param[in] delim     a delimiter has been written
+ *
+ * @notapi
+ */
+static void iq_wakeup(input_queue_t *iqp, size_t n,
+                      bool wasempty, bool delim) {
+
+  if (iqp->q_idle != TIME_INFINITE) {
+    iqp->q_stamp = osalOsGetSystemTimeX();
+  }
+
+  if (delim) {
+    osalThreadDequeueAllI(&iqp->q_waiting, IQ_MSG_FRAME);
+  }
+  else if (iqp->q_counter >= iqp->q_wanted) {
+    if ((iqp->q_wakeup > (size_t)1) || (n > (size_t)1)) {
+      osalThreadDequeueAllI(&iqp->q_waiting, MSG_OK);
+    }
+    else {
+      /* No wakeup threshold, a single byte can only satisfy one reader.*/
+      osalThreadDequeueNextI(&iqp->q_waiting, MSG_OK);
+    }
+  }
+  else if (wasempty && (iqp->q_idle != TIME_INFINITE)) {
+    osalThreadDequeueAllI(&iqp->q_waiting, IQ_MSG_BURST);
+  }
+}
+
+/**
+ * @brief   Waits for input according to the queue wakeup policy.
+ * @details The reader is resumed when the wakeup threshold is reached, when
+ *          a delimiter is received or when the data stream is idle for the
+ *          specified gap. The threshold is capped to the number of bytes
+ *          required by the reader.
+ * @note    On timeout the data already in the queue, if any, is returned
+ *          as the end of a frame.
+ *
+ * @param[in] iqp       pointer to an @p input_queue_t structure
+ * @param[in] n         number of bytes still required by the reader
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The wait result.
+ * @retval MSG_OK       if there is data to be read.
+ * @retval IQ_MSG_FRAME if there is data to be read and the reader should
+ *                      not wait for more.
+ * @retval MSG_TIMEOUT  if the specified time expired.
+ * @retval MSG_RESET    if the queue has been reset.
+ *
+ * @sclass
+ */
+static msg_t iq_wait(input_queue_t *iqp, size_t n, sysinterval_t timeout) {
+  systime_t start = osalOsGetSystemTimeX();
+
+  iqp->q_wanted = n < iqp->q_wakeup ? n : iqp->q_wakeup;
+
+  while (true) {
+    systime_t now = osalOsGetSystemTimeX();
+    sysinterval_t tmo = timeout;
+    msg_t msg;
+
+    /* Remaining time before the timeout.*/
+    if (timeout != TIME_INFINITE) {
+      sysinterval_t elapsed = osalTimeDiffX(start, now);
+
+      if (elapsed >= timeout) {
+        return iqIsEmptyI(iqp) ? MSG_TIMEOUT : IQ_MSG_FRAME;
+      }
+      tmo = timeout - elapsed;
+    }
+
+    /* Data below the threshold is returned after an idle gap.*/
+    if ((iqp->q_idle != TIME_INFINITE) && !iqIsEmptyI(iqp)) {
+      sysinterval_t gap = osalTimeDiffX(iqp->q_stamp, now);
+
+      if (gap >= iqp->q_idle) {
+        return IQ_MSG_FRAME;
+      }
+      if (iqp->q_idle - gap < tmo) {
+        tmo = iqp->q_idle - gap;
+      }
+    }
+
+    msg = osalThreadEnqueueTimeoutS(&iqp->q_waiting, tmo);
+    if ((msg == MSG_OK) || (msg == IQ_MSG_FRAME) || (msg == MSG_RESET)) {
+      return msg;
+    }
+  }
+}
+
 /**
  * @brief   Non-blocking input queue read.
  * @details The function reads data from an input queue into a buffer. The
@@ -91,6 +204,102 @@ static size_t iq_read(input_queue_t *iqp, uint8_t *bp, size_t n) {
   return n;
 }
 
+/**
+ * @brief   Non-blocking input queue write.
+ * @details The function writes data from a buffer to an input queue. The
+ *          operation completes when the specified amount of data has been
+ *          transferred or when the input queue has been filled.
+ *
+ * @param[in] iqp       pointer to an @p input_queue_t structure
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred, the
+ *                      value 0 is reserved
+ * @return              The number of bytes effectively transferred.
+ *
+ * @notapi
+ */
+static size_t iq_write(input_queue_t *iqp, const uint8_t *bp, size_t n) {
+  size_t s1, s2;
+
+  osalDbgCheck(n > 0U);
+
+  /* Number of bytes that can be written in a single atomic operation.*/
+  if (n > iqGetEmptyI(iqp)) {
+    n = iqGetEmptyI(iqp);
+  }
+
+  /* Number of bytes before buffer limit.*/
+  /*lint -save -e9033 [10.8] Checked to be safe.*/
+  s1 = (size_t)(iqp->q_top - iqp->q_wrptr);
+  /*lint -restore*/
+  if (n < s1) {
+    memcpy((void *)iqp->q_wrptr, (const void *)bp, n);
+    iqp->q_wrptr += n;
+  }
+  else if (n > s1) {
+    memcpy((void *)iqp->q_wrptr, (const void *)bp, s1);
+    bp += s1;
+    s2 = n - s1;
+    memcpy((void *)iqp->q_buffer, (const void *)bp, s2);
+    iqp->q_wrptr = iqp->q_buffer + s2;
+  }
+  else {
+    memcpy((void *)iqp->q_wrptr, (const void *)bp, n);
+    iqp->q_wrptr = iqp->q_buffer;
+  }
+
+  iqp->q_counter += n;
+  return n;
+}
+
+/**
+ * @brief   Non-blocking output queue read.
+ * @details The function reads data from an output queue into a buffer. The
+ *          operation completes when the specified amount of data has been
+ *          transferred or when the output queue has been emptied.
+ *
+ * @param[in] oqp       pointer to an @p output_queue_t structure
+ * @param[out] bp       pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred, the
+ *                      value 0 is reserved
+ * @return              The number of bytes effectively transferred.
+ *
+ * @notapi
+ */
+static size_t oq_read(output_queue_t *oqp, uint8_t *bp, size_t n) {
+  size_t s1, s2;
+
+  osalDbgCheck(n > 0U);
+
+  /* Number of bytes that can be read in a single atomic operation.*/
+  if (n > oqGetFullI(oqp)) {
+    n = oqGetFullI(oqp);
+  }
+
+  /* Number of bytes before buffer limit.*/
+  /*lint -save -e9033 [10.8] Checked to be safe.*/
+  s1 = (size_t)(oqp->q_top - oqp->q_rdptr);
+  /*lint -restore*/
+  if (n < s1) {
+    memcpy((void *)bp, (void *)oqp->q_rdptr, n);
+    oqp->q_rdptr += n;
+  }
+  else if (n > s1) {
+    memcpy((void *)bp, (void *)oqp->q_rdptr, s1);
+    bp += s1;
+    s2 = n - s1;
+    memcpy((void *)bp, (void *)oqp->q_buffer, s2);
+    oqp->q_rdptr = oqp->q_buffer + s2;
+  }
+  else {
+    memcpy((void *)bp, (void *)oqp->q_rdptr, n);
+    oqp->q_rdptr = oqp->q_buffer;
+  }
+
+  oqp->q_counter += n;
+  return n;
+}
+
 /**
  * @brief   Non-blocking output queue write.
  * @details The function writes data from a buffer to an output queue. The
@@ -185,6 +394,57 @@ void iqObjectInit(input_queue_t *iqp, uint8_t *bp, size_t size,
   iqp->q_top     = bp + size;
   iqp->q_notify  = infy;
   iqp->q_link    = link;
+  iqp->q_wakeup  = (size_t)1;
+  iqp->q_wanted  = (size_t)1;
+  iqp->q_delim   = IQ_NO_DELIMITER;
+  iqp->q_idle    = TIME_INFINITE;
+  iqp->q_stamp   = (systime_t)0;
+}
+
+/**
+ * @brief   Sets the input queue wakeup policy.
+ * @details By default a waiting reader is resumed on each received byte,
+ *          the policy allows to resume it once for a whole block of data.
+ *          The reader is resumed when any of the enabled conditions is met:
+ *          - At least @p threshold bytes are in the queue, the threshold
+ *            is capped to the amount of data required by the reader.
+ *          - The @p delimiter byte is received.
+ *          - Some data is in the queue and no more data has been received
+ *            for the @p idle interval.
+ *          .
+ * @note    The policy is meant to be set before any reader is waiting.
+ * @note    The policy is meant for queues with a single reader, the
+ *          amount of data awaited is kept in the queue and it is shared
+ *          by all the waiting readers, the last reader entering the wait
+ *          sets it for all of them.
+ * @note    Frames are not kept separated in the queue, a delimiter or an
+ *          idle gap just resumes the reader. Data received after the end
+ *          of a frame and before the reader runs is returned by the same
+ *          read, up to the requested size, so a read can return data past
+ *          a delimiter.
+ *
+ * @param[in] iqp       pointer to an @p input_queue_t structure
+ * @param[in] threshold wakeup threshold in bytes, one means no batching,
+ *                      it cannot exceed the queue size
+ * @param[in] delimiter wakeup delimiter byte or @p IQ_NO_DELIMITER
+ * @param[in] idle      idle gap or @p TIME_INFINITE to disable it
+ *
+ * @iclass
+ */
+void iqSetWakeupI(input_queue_t *iqp, size_t threshold,
+                  msg_t delimiter, sysinterval_t idle) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((threshold > 0U) && (threshold <= qSizeX(iqp)) &&
+               (idle != TIME_IMMEDIATE) &&
+               ((delimiter == IQ_NO_DELIMITER) ||
+                ((delimiter >= 0) && (delimiter <= 255))));
+
+  iqp->q_wakeup = threshold;
+  iqp->q_wanted = threshold;
+  iqp->q_delim  = delimiter;
+  iqp->q_idle   = idle;
+  iqp->q_stamp  = osalOsGetSystemTimeX();
 }
 
 /**
@@ -227,13 +487,15 @@ msg_t iqPutI(input_queue_t *iqp, uint8_t b) {
 
   /* Queue space check.*/
   if (!iqIsFullI(iqp)) {
+    bool wasempty = iqIsEmptyI(iqp);
+
     iqp->q_counter++;
     *iqp->q_wrptr++ = b;
     if (iqp->q_wrptr >= iqp->q_top) {
       iqp->q_wrptr = iqp->q_buffer;
     }
 
-    osalThreadDequeueNextI(&iqp->q_waiting, MSG_OK);
+    iq_wakeup(iqp, (size_t)1, wasempty, (msg_t)b == iqp->q_delim);
 
     return MSG_OK;
   }
@@ -241,6 +503,40 @@ msg_t iqPutI(input_queue_t *iqp, uint8_t b) {
   return MSG_TIMEOUT;
 }
 
+/**
+ * @brief   Input queue block write.
+ * @details The function writes data from a buffer into the low end of an
+ *          input queue. The operation completes immediately.
+ * @note    This is the block variant of @p iqPutI(), low level drivers
+ *          receiving data in blocks should use this function in order to
+ *          enter the critical zone once for the whole block.
+ *
+ * @param[in] iqp       pointer to an @p input_queue_t structure
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred, the
+ *                      value 0 is reserved
+ * @return              The number of bytes effectively transferred, it is
+ *                      less than @p n if the queue became full.
+ *
+ * @iclass
+ */
+size_t iqWriteI(input_queue_t *iqp, const uint8_t *bp, size_t n) {
+  bool wasempty = iqIsEmptyI(iqp);
+  size_t wr;
+
+  osalDbgCheckClassI();
+
+  wr = iq_write(iqp, bp, n);
+  if (wr > (size_t)0) {
+    bool delim = (iqp->q_delim != IQ_NO_DELIMITER) &&
+                 (memchr((const void *)bp, (int)iqp->q_delim, wr) != NULL);
+
+    iq_wakeup(iqp, wr, wasempty, delim);
+  }
+
+  return wr;
+}
+
 /**
  * @brief   Input queue non-blocking read.
  * @details This function reads a byte value from an input queue. The
@@ -308,7 +604,7 @@ msg_t iqGetTimeout(input_queue_t *iqp, sysinterval_t timeout) {
 
   /* Waiting until there is a character available or a timeout occurs.*/
   while (iqIsEmptyI(iqp)) {
-    msg_t msg = osalThreadEnqueueTimeoutS(&iqp->q_waiting, timeout);
+    msg_t msg = iq_wait(iqp, (size_t)1, timeout);
     if (msg < MSG_OK) {
       osalSysUnlock();
       return msg;
@@ -368,6 +664,9 @@ size_t iqReadI(input_queue_t *iqp, uint8_t *bp, size_t n) {
  *          operation completes when the specified amount of data has been
  *          transferred or after the specified timeout or if the queue has
  *          been reset.
+ * @note    If the queue wakeup policy has a delimiter or an idle gap then
+ *          the operation also completes at the end of a frame, see
+ *          @p iqSetWakeupI().
  * @note    The function is not atomic, if you need atomicity it is suggested
  *          to use a semaphore or a mutex for mutual exclusion.
  * @note    The callback is invoked after removing each character from the
@@ -390,6 +689,7 @@ size_t iqReadTimeout(input_queue_t *iqp, uint8_t *bp,
                      size_t n, sysinterval_t timeout) {
   qnotify_t nfy = iqp->q_notify;
   size_t max = n;
+  bool frame = false;
 
   osalDbgCheck(n > 0U);
 
@@ -400,10 +700,21 @@ size_t iqReadTimeout(input_queue_t *iqp, uint8_t *bp,
 
     done = iq_read(iqp, bp, n);
     if (done == (size_t)0) {
-      msg_t msg = osalThreadEnqueueTimeoutS(&iqp->q_waiting, timeout);
+      msg_t msg;
 
-      /* Anything except MSG_OK causes the operation to stop.*/
-      if (msg != MSG_OK) {
+      /* The end of a frame has been already read.*/
+      if (frame) {
+        break;
+      }
+
+      msg = iq_wait(iqp, n, timeout);
+
+      /* Anything except MSG_OK or the end of a frame causes the operation
+         to stop.*/
+      if (msg == IQ_MSG_FRAME) {
+        frame = true;
+      }
+      else if (msg != MSG_OK) {
         break;
       }
     }
@@ -600,6 +911,39 @@ msg_t oqGetI(output_queue_t *oqp) {
   return MSG_TIMEOUT;
 }
 
+/**
+ * @brief   Output queue block read.
+ * @details The function reads data from the low end of an output queue
+ *          into a buffer. The operation completes immediately.
+ * @note    This is the block variant of @p oqGetI(), low level drivers
+ *          transmitting data in blocks should use this function in order
+ *          to enter the critical zone once for the whole block.
+ *
+ * @param[in] oqp       pointer to an @p output_queue_t structure
+ * @param[out] bp       pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred, the
+ *                      value 0 is reserved
+ * @return              The number of bytes effectively transferred, zero
+ *                      if the queue is empty.
+ *
+ * @iclass
+ */
+size_t oqReadI(output_queue_t *oqp, uint8_t *bp, size_t n) {
+  size_t rd;
+
+  osalDbgCheckClassI();
+
+  rd = oq_read(oqp, bp, n);
+
+  /* All the waiting writers are resumed, each one checks again the
+     queue state.*/
+  if (rd > (size_t)0) {
+    osalThreadDequeueAllI(&oqp->q_waiting, MSG_OK);
+  }
+
+  return rd;
+}
+
 /**
  * @brief   Output queue non-blocking write.
  * @details The function writes data from a buffer to an output queue. The
@@ -275,6 +275,64 @@ msg_t sdRequestDataI(SerialDriver *sdp) {
   return b;
 }
 
+/**
+ * @brief   Handles a block of incoming data.
+ * @details This function must be called from the input interrupt service
+ *          routine of drivers receiving data in blocks, the whole block is
+ *          enqueued at once and the related events are generated.
+ * @note    The incoming data event is only generated when the input queue
+ *          becomes non-empty.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver structure
+ * @param[in] bp        pointer to the received data
+ * @param[in] n         number of received bytes, the value 0 is reserved
+ * @return              The number of bytes written in the driver's Input
+ *                      Queue, the excess data is lost.
+ *
+ * @iclass
+ */
+size_t sdIncomingDataBlockI(SerialDriver *sdp, const uint8_t *bp, size_t n) {
+  size_t wr;
+
+  osalDbgCheckClassI();
+  osalDbgCheck((sdp != NULL) && (bp != NULL) && (n > 0U));
+
+  if (iqIsEmptyI(&sdp->iqueue))
+    chnAddFlagsI(sdp, CHN_INPUT_AVAILABLE);
+  wr = iqWriteI(&sdp->iqueue, bp, n);
+  if (wr < n)
+    chnAddFlagsI(sdp, SD_QUEUE_FULL_ERROR);
+  return wr;
+}
+
+/**
+ * @brief   Handles a block of outgoing data.
+ * @details Must be called from the output interrupt service routine of
+ *          drivers transmitting data in blocks in order to get the next
+ *          bytes to be transmitted.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver structure
+ * @param[out] bp       pointer to the buffer for the data to be transmitted
+ * @param[in] n         size of the buffer, the value 0 is reserved
+ * @return              The number of bytes read from the driver's output
+ *                      queue.
+ * @retval 0            if the queue is empty (the lower driver usually
+ *                      disables the interrupt source when this happens).
+ *
+ * @iclass
+ */
+size_t sdRequestDataBlockI(SerialDriver *sdp, uint8_t *bp, size_t n) {
+  size_t rd;
+
+  osalDbgCheckClassI();
+  osalDbgCheck((sdp != NULL) && (bp != NULL) && (n > 0U));
+
+  rd = oqReadI(&sdp->oqueue, bp, n);
+  if (rd == (size_t)0)
+    chnAddFlagsI(sdp, CHN_OUTPUT_EMPTY);
+  return rd;
+}
+
 /**
  * @brief   Direct output check on a @p SerialDriver.
  * @note    This function bypasses the indirect access to the channel and
@@ -325,6 +383,33 @@ bool sdGetWouldBlock(SerialDriver *sdp) {
   return b;
 }
 
+/**
+ * @brief   Sets the input wakeup policy of a @p SerialDriver.
+ * @details A thread reading from the driver is resumed when at least
+ *          @p threshold bytes have been received, when the @p delimiter
+ *          byte is received or when the line is idle for the @p idle
+ *          interval, see @p iqSetWakeupI().
+ * @note    Under streaming load a reader waiting for a whole frame is
+ *          resumed once instead of once for each received byte.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver object
+ * @param[in] threshold wakeup threshold in bytes, one means no batching,
+ *                      it cannot exceed the input queue size
+ * @param[in] delimiter wakeup delimiter byte or @p IQ_NO_DELIMITER
+ * @param[in] idle      idle gap or @p TIME_INFINITE to disable it
+ *
+ * @api
+ */
+void sdSetWakeup(SerialDriver *sdp, size_t threshold,
+                 msg_t delimiter, sysinterval_t idle) {
+
+  osalDbgCheck(sdp != NULL);
+
+  osalSysLock();
+  iqSetWakeupI(&sdp->iqueue, threshold, delimiter, idle);
+  osalSysUnlock();
+}
+
 /**
  * @brief   Control operation on a serial port.
  *
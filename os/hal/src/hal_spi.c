@@ -42,6 +42,110 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Removes the first transaction from the highest priority lane.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @return              The transaction or @p NULL if the queue is empty.
+ */
+static spi_transaction_t *spi_queue_fetch(SPIDriver *spip) {
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)SPI_QUEUE_LANES; i++) {
+    spi_transaction_t *txnp = spip->lanes[i].head;
+
+    if (txnp != NULL) {
+      spip->lanes[i].head = txnp->next;
+      return txnp;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief   Runs the transactions queue.
+ * @details Transfers without data and completed transactions are processed
+ *          in place until a data transfer is started or the queue is
+ *          empty.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+static void spi_queue_run(SPIDriver *spip) {
+  spi_transaction_t *txnp = spip->txn;
+
+  while (true) {
+    if (txnp == NULL) {
+      txnp = spi_queue_fetch(spip);
+      if (txnp == NULL) {
+        /* Queue empty, back to the configuration of spiStart().*/
+        if (spip->config != spip->qconfig) {
+          spip->config = spip->qconfig;
+          spi_lld_start(spip);
+        }
+        spip->state = SPI_READY;
+        return;
+      }
+
+      spip->state = SPI_ACTIVE;
+      spip->txn   = txnp;
+      txnp->state = SPI_TXN_ACTIVE;
+      if (spip->config != txnp->config) {
+        spip->config = txnp->config;
+        spi_lld_start(spip);
+      }
+    }
+
+    while (txnp->index < txnp->n) {
+      const spi_transfer_t *xp = &txnp->transfers[txnp->index];
+
+      if ((xp->flags & SPI_XFER_SELECT) != 0U) {
+        spiSelectI(spip);
+      }
+      if (xp->n > 0U) {
+        /* The transfer completion is handled in _spi_queue_isr().*/
+        if (xp->txbuf == NULL) {
+          if (xp->rxbuf == NULL) {
+            spiStartIgnoreI(spip, xp->n);
+          }
+          else {
+            spiStartReceiveI(spip, xp->n, xp->rxbuf);
+          }
+        }
+        else {
+          if (xp->rxbuf == NULL) {
+            spiStartSendI(spip, xp->n, xp->txbuf);
+          }
+          else {
+            spiStartExchangeI(spip, xp->n, xp->txbuf, xp->rxbuf);
+          }
+        }
+        return;
+      }
+      if ((xp->flags & SPI_XFER_UNSELECT) != 0U) {
+        spiUnselectI(spip);
+      }
+      txnp->index++;
+    }
+
+    /* Transaction completed, the callback could queue it again.*/
+    spip->txn   = NULL;
+    txnp->state = SPI_TXN_DONE;
+    osalThreadResumeI(&txnp->thread, MSG_OK);
+    if (txnp->event != NULL) {
+      osalEventBroadcastFlagsI(txnp->event, txnp->flags);
+    }
+    if (txnp->end_cb != NULL) {
+      txnp->end_cb(spip, txnp);
+    }
+    txnp = NULL;
+  }
+}
+#endif /* SPI_USE_QUEUE == TRUE */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -75,6 +179,18 @@ void spiObjectInit(SPIDriver *spip) {
 #if SPI_USE_MUTUAL_EXCLUSION == TRUE
   osalMutexObjectInit(&spip->mutex);
 #endif
+#if SPI_USE_QUEUE == TRUE
+  {
+    unsigned i;
+
+    spip->qconfig = NULL;
+    spip->txn     = NULL;
+    for (i = 0U; i < (unsigned)SPI_QUEUE_LANES; i++) {
+      spip->lanes[i].head = NULL;
+      spip->lanes[i].tail = NULL;
+    }
+  }
+#endif
 #if defined(SPI_DRIVER_EXT_INIT_HOOK)
   SPI_DRIVER_EXT_INIT_HOOK(spip);
 #endif
@@ -96,6 +212,9 @@ void spiStart(SPIDriver *spip, const SPIConfig *config) {
   osalDbgAssert((spip->state == SPI_STOP) || (spip->state == SPI_READY),
                 "invalid state");
   spip->config = config;
+#if SPI_USE_QUEUE == TRUE
+  spip->qconfig = config;
+#endif
   spi_lld_start(spip);
   spip->state = SPI_READY;
   osalSysUnlock();
@@ -464,6 +583,129 @@ void spiReleaseBus(SPIDriver *spip) {
 }
 #endif /* SPI_USE_MUTUAL_EXCLUSION == TRUE */
 
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Queues a transaction.
+ * @details The transaction is appended to its priority lane and it is
+ *          started immediately if the driver is idle. Queued transactions
+ *          are executed back to back from the driver ISR, a transaction is
+ *          never interrupted by a higher priority one.
+ * @pre     The transaction must not be already queued.
+ * @note    The transaction object and the transfers array must stay valid
+ *          until the transaction is completed.
+ * @note    The other driver APIs must not be used while transactions are
+ *          pending.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] txnp      pointer to the @p spi_transaction_t object
+ *
+ * @iclass
+ */
+void spiQueueTransactionI(SPIDriver *spip, spi_transaction_t *txnp) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((spip != NULL) && (txnp != NULL) &&
+               (txnp->config != NULL) &&
+               (txnp->lane < (unsigned)SPI_QUEUE_LANES));
+  osalDbgAssert((spip->state == SPI_READY) || (spip->state == SPI_ACTIVE),
+                "not ready");
+  osalDbgAssert((txnp->state == SPI_TXN_IDLE) ||
+                (txnp->state == SPI_TXN_DONE), "already queued");
+
+  txnp->state  = SPI_TXN_QUEUED;
+  txnp->index  = 0U;
+  txnp->next   = NULL;
+  txnp->thread = NULL;
+  if (spip->lanes[txnp->lane].head == NULL) {
+    spip->lanes[txnp->lane].head = txnp;
+  }
+  else {
+    spip->lanes[txnp->lane].tail->next = txnp;
+  }
+  spip->lanes[txnp->lane].tail = txnp;
+
+  if (spip->state == SPI_READY) {
+    spi_queue_run(spip);
+  }
+}
+
+/**
+ * @brief   Queues a transaction.
+ * @details The transaction is appended to its priority lane and it is
+ *          started immediately if the driver is idle.
+ * @pre     The transaction must not be already queued.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] txnp      pointer to the @p spi_transaction_t object
+ *
+ * @api
+ */
+void spiQueueTransaction(SPIDriver *spip, spi_transaction_t *txnp) {
+
+  osalSysLock();
+  spiQueueTransactionI(spip, txnp);
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Waits for a transaction completion.
+ * @note    A timeout does not remove the transaction from the queue.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] txnp      pointer to the @p spi_transaction_t object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation result.
+ * @retval MSG_OK       if the transaction has been completed.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t spiWaitTransactionTimeout(SPIDriver *spip,
+                                spi_transaction_t *txnp,
+                                sysinterval_t timeout) {
+  msg_t msg = MSG_OK;
+
+  osalDbgCheck((spip != NULL) && (txnp != NULL));
+
+  osalSysLock();
+  osalDbgAssert(txnp->state != SPI_TXN_IDLE, "not queued");
+  if (txnp->state != SPI_TXN_DONE) {
+    msg = osalThreadSuspendTimeoutS(&txnp->thread, timeout);
+  }
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Transaction transfer completed.
+ * @details Deasserts the slave select if required then continues with the
+ *          next transfer or transaction.
+ * @note    This function is invoked by the LLD through the
+ *          @p _spi_isr_code() macro.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void _spi_queue_isr(SPIDriver *spip) {
+  spi_transaction_t *txnp = spip->txn;
+
+  osalSysLockFromISR();
+  if ((txnp->transfers[txnp->index].flags & SPI_XFER_UNSELECT) != 0U) {
+    spiUnselectI(spip);
+  }
+  txnp->index++;
+  spi_queue_run(spip);
+  osalSysUnlockFromISR();
+}
+#endif /* SPI_USE_QUEUE == TRUE */
+
 #endif /* HAL_USE_SPI == TRUE */
 
 /** @} */
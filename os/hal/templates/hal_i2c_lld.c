@@ -182,6 +182,34 @@ msg_t i2c_lld_master_transmit_timeout(I2CDriver *i2cp, i2caddr_t addr,
   return MSG_OK;
 }
 
+/**
+ * @brief   Starts an asynchronous transfer as master.
+ * @details The transfer writes @p txbytes bytes, if any, then reads
+ *          @p rxbytes bytes, if any, after a repeated start. The end of
+ *          the transfer is notified using @p _i2c_wakeup_isr() or
+ *          @p _i2c_wakeup_error_isr().
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[in] txbuf     pointer to the transmit buffer
+ * @param[in] txbytes   number of bytes to be transmitted, can be zero
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received, can be zero
+ *
+ * @notapi
+ */
+void i2c_lld_start_transfer(I2CDriver *i2cp, i2caddr_t addr,
+                            const uint8_t *txbuf, size_t txbytes,
+                            uint8_t *rxbuf, size_t rxbytes) {
+
+  (void)i2cp;
+  (void)addr;
+  (void)txbuf;
+  (void)txbytes;
+  (void)rxbuf;
+  (void)rxbytes;
+}
+
 #endif /* HAL_USE_I2C == TRUE */
 
 /** @} */
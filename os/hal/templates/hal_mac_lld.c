@@ -306,6 +306,54 @@ const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
 
   return NULL;
 }
+
+/**
+ * @brief   Appends an application buffer to a transmit descriptor.
+ * @note    If the buffer cannot be appended then all the data previously
+ *          added to the descriptor is discarded.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] buf       pointer to the buffer to be transmitted
+ * @param[in] size      size of the buffer
+ * @param[in] ref       reference to be returned once the frame has been
+ *                      transmitted or @p NULL
+ * @return              The operation result.
+ * @retval true         if the buffer has been appended.
+ * @retval false        if the frame size or the number of buffers per
+ *                      frame would be exceeded.
+ *
+ * @notapi
+ */
+bool mac_lld_attach_transmit_buffer(MACTransmitDescriptor *tdp,
+                                    const uint8_t *buf,
+                                    size_t size,
+                                    void *ref) {
+
+  (void)tdp;
+  (void)buf;
+  (void)size;
+  (void)ref;
+
+  return false;
+}
+
+/**
+ * @brief   Returns the reference of a transmitted buffer.
+ * @details The descriptor holding the reference is made available for
+ *          new frames.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The reference of a buffer no more used by the MAC.
+ * @retval NULL         if there are no buffers to be given back.
+ *
+ * @notapi
+ */
+void *mac_lld_reclaim_transmit_buffer(MACDriver *macp) {
+
+  (void)macp;
+
+  return NULL;
+}
 #endif /* MAC_USE_ZERO_COPY == TRUE */
 
 #endif /* HAL_USE_MAC == TRUE */
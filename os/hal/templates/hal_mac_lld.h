@@ -36,6 +36,11 @@
  */
 #define MAC_SUPPORTS_ZERO_COPY      TRUE
 
+/**
+ * @brief   This implementation supports buffer references.
+ */
+#define MAC_SUPPORTS_BUFFER_REFERENCES  TRUE
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -70,6 +75,12 @@ typedef struct {
    * @brief MAC address.
    */
   uint8_t               *mac_address;
+#if (MAC_SUPPORTS_BUFFER_REFERENCES == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief Transmitted buffers release callback.
+   */
+  macbufcb_t            txrelease_cb;
+#endif
   /* End of the mandatory fields.*/
 } MACConfig;
 
@@ -169,6 +180,11 @@ extern "C" {
                                             size_t *sizep);
   const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
                                                  size_t *sizep);
+  bool mac_lld_attach_transmit_buffer(MACTransmitDescriptor *tdp,
+                                      const uint8_t *buf,
+                                      size_t size,
+                                      void *ref);
+  void *mac_lld_reclaim_transmit_buffer(MACDriver *macp);
 #endif
 #ifdef __cplusplus
 }
@@ -259,6 +259,33 @@
 #define CAN_ENFORCE_USE_CALLBACKS           FALSE
 #endif
 
+/**
+ * @brief   Enables the software receive queues.
+ * @details If enabled the receive ISR moves the frames from the receive
+ *          mailboxes into a software ring for each mailbox, the frames are
+ *          checked against the software acceptance filters before being
+ *          queued.
+ */
+#if !defined(CAN_USE_RX_QUEUES) || defined(__DOXYGEN__)
+#define CAN_USE_RX_QUEUES                   FALSE
+#endif
+
+/**
+ * @brief   Size of each software receive ring.
+ * @note    Must be a power of two.
+ */
+#if !defined(CAN_RX_QUEUE_SIZE) || defined(__DOXYGEN__)
+#define CAN_RX_QUEUE_SIZE                   16
+#endif
+
+/**
+ * @brief   Size of the exact identifiers hash table of the software filters.
+ * @note    Must be a power of two.
+ */
+#if !defined(CAN_SW_FILTERS_HASH_SIZE) || defined(__DOXYGEN__)
+#define CAN_SW_FILTERS_HASH_SIZE            32
+#endif
+
 /*===========================================================================*/
 /* CRY driver related settings.                                              */
 /*===========================================================================*/
@@ -312,6 +339,14 @@
 #define I2C_USE_MUTUAL_EXCLUSION            TRUE
 #endif
 
+/**
+ * @brief   Enables the asynchronous batches queue APIs.
+ * @note    Requires support from the low level driver.
+ */
+#if !defined(I2C_USE_QUEUE) || defined(__DOXYGEN__)
+#define I2C_USE_QUEUE                       FALSE
+#endif
+
 /*===========================================================================*/
 /* MAC driver related settings.                                              */
 /*===========================================================================*/
@@ -494,6 +529,22 @@
 #define SPI_SELECT_MODE                     SPI_SELECT_MODE_PAD
 #endif
 
+/**
+ * @brief   Enables the transactions queue APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(SPI_USE_QUEUE) || defined(__DOXYGEN__)
+#define SPI_USE_QUEUE                       FALSE
+#endif
+
+/**
+ * @brief   Number of priority lanes of the transactions queue.
+ * @details Lane zero has the highest priority.
+ */
+#if !defined(SPI_QUEUE_LANES) || defined(__DOXYGEN__)
+#define SPI_QUEUE_LANES                     2
+#endif
+
 /*===========================================================================*/
 /* UART driver related settings.                                             */
 /*===========================================================================*/
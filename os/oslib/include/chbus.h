@@ -0,0 +1,238 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    oslib/include/chbus.h
+ * @brief   Messages bus macros and structures.
+ *
+ * @addtogroup oslib_bus
+ * @{
+ */
+
+#ifndef CHBUS_H
+#define CHBUS_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Subscriber queue policies
+ * @{
+ */
+/**
+ * @brief   The publisher waits for a free slot.
+ */
+#define BUS_POLICY_BLOCK                    0U
+
+/**
+ * @brief   The oldest queued frame is dropped.
+ */
+#define BUS_POLICY_DROP_OLDEST              1U
+
+/**
+ * @brief   The published frame is dropped.
+ */
+#define BUS_POLICY_DROP_NEWEST              2U
+/** @} */
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Messages bus APIs.
+ * @details If enabled then the publish/subscribe messages bus APIs are
+ *          included in the library.
+ */
+#if !defined(CH_CFG_USE_BUS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_BUS                      FALSE
+#endif
+
+#if (CH_CFG_USE_BUS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if CH_CFG_USE_REFBUFS == FALSE
+#error "CH_CFG_USE_BUS requires CH_CFG_USE_REFBUFS"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a messages bus.
+ */
+typedef struct ch_msg_bus msg_bus_t;
+
+/**
+ * @brief   Type of a bus subscriber.
+ */
+typedef struct ch_bus_subscriber bus_subscriber_t;
+
+/**
+ * @brief   Structure representing a bus subscriber.
+ * @details Each subscriber owns a queue of frame references, the queue
+ *          depth and the policy applied when it is full are chosen on
+ *          subscription.
+ */
+struct ch_bus_subscriber {
+  /**
+   * @brief   Next subscriber of the bus.
+   */
+  bus_subscriber_t          *next;
+  /**
+   * @brief   Bus the subscriber is attached to.
+   */
+  msg_bus_t                 *bus;
+  /**
+   * @brief   Pointer to the frames queue buffer.
+   */
+  refbuf_t                  **buffer;
+  /**
+   * @brief   Size of the frames queue.
+   */
+  size_t                    size;
+  /**
+   * @brief   Number of queued frames.
+   */
+  size_t                    cnt;
+  /**
+   * @brief   Read index.
+   */
+  size_t                    rdidx;
+  /**
+   * @brief   Queue full policy.
+   */
+  unsigned                  policy;
+  /**
+   * @brief   Number of frames dropped because the queue was full.
+   */
+  uint32_t                  dropped;
+  /**
+   * @brief   Queue of the waiting receivers.
+   */
+  threads_queue_t           rqueue;
+  /**
+   * @brief   Queue of the publishers waiting for a free slot.
+   */
+  threads_queue_t           wqueue;
+};
+
+/**
+ * @brief   Structure representing a messages bus.
+ */
+struct ch_msg_bus {
+  /**
+   * @brief   Pool of the frames.
+   */
+  refbuf_pool_t             *pool;
+  /**
+   * @brief   List of the subscribers.
+   */
+  bus_subscriber_t          *subscribers;
+};
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chBusObjectInit(msg_bus_t *busp, refbuf_pool_t *rbpp);
+  void chBusSubscribe(msg_bus_t *busp, bus_subscriber_t *sp,
+                      refbuf_t **buffer, size_t n, unsigned policy);
+  void chBusUnsubscribe(bus_subscriber_t *sp);
+  cnt_t chBusPublishI(msg_bus_t *busp, refbuf_t *bp);
+  cnt_t chBusPublishTimeout(msg_bus_t *busp, refbuf_t *bp,
+                            sysinterval_t timeout);
+  refbuf_t *chBusReceiveI(bus_subscriber_t *sp);
+  refbuf_t *chBusReceiveTimeout(bus_subscriber_t *sp, sysinterval_t timeout);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Acquires a frame from the bus pool.
+ * @details The frame is returned empty with one reference owned by the
+ *          caller, the reference is consumed by the publish operation.
+ *
+ * @param[in] busp      pointer to a @p msg_bus_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The pointer to the frame.
+ * @retval NULL         if the operation timed out.
+ *
+ * @api
+ */
+static inline refbuf_t *chBusAcquireFrameTimeout(msg_bus_t *busp,
+                                                 sysinterval_t timeout) {
+
+  return chRefBufAllocTimeout(busp->pool, timeout);
+}
+
+/**
+ * @brief   Returns the number of frames queued for a subscriber.
+ *
+ * @param[in] sp        pointer to a @p bus_subscriber_t structure
+ * @return              The number of queued frames.
+ *
+ * @iclass
+ */
+static inline size_t chBusGetPendingI(bus_subscriber_t *sp) {
+
+  chDbgCheckClassI();
+
+  return sp->cnt;
+}
+
+/**
+ * @brief   Returns the number of frames dropped for a subscriber.
+ *
+ * @param[in] sp        pointer to a @p bus_subscriber_t structure
+ * @return              The number of dropped frames.
+ *
+ * @xclass
+ */
+static inline uint32_t chBusGetDroppedX(bus_subscriber_t *sp) {
+
+  return sp->dropped;
+}
+
+#endif /* CH_CFG_USE_BUS == TRUE */
+
+#endif /* CHBUS_H */
+
+/** @} */
@@ -38,10 +38,26 @@
 /* Module constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @name    Asynchronous call states
+ * @{
+ */
+#define DELEGATE_CALL_QUEUED                0U
+#define DELEGATE_CALL_RUNNING               1U
+#define DELEGATE_CALL_DONE                  2U
+/** @} */
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Maximum number of asynchronous calls served on each wakeup.
+ */
+#if !defined(CH_CFG_DELEGATES_ASYNC_BATCH) || defined(__DOXYGEN__)
+#define CH_CFG_DELEGATES_ASYNC_BATCH        4
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -50,6 +66,21 @@
 #error "CH_CFG_USE_DELEGATES requires CH_CFG_USE_MESSAGES"
 #endif
 
+#if CH_CFG_DELEGATES_ASYNC_BATCH < 1
+#error "invalid CH_CFG_DELEGATES_ASYNC_BATCH value"
+#endif
+
+/**
+ * @brief   Asynchronous delegates availability.
+ * @note    Asynchronous calls are allocated from a guarded memory pool.
+ */
+#if ((CH_CFG_USE_MEMPOOLS == TRUE) && (CH_CFG_USE_SEMAPHORES == TRUE)) ||   \
+    defined(__DOXYGEN__)
+#define CH_DELEGATES_HAS_ASYNC              TRUE
+#else
+#define CH_DELEGATES_HAS_ASYNC              FALSE
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -84,6 +115,91 @@ typedef msg_t (*delegate_fn3_t)(msg_t p1, msg_t p2, msg_t p3);
  */
 typedef msg_t (*delegate_fn4_t)(msg_t p1, msg_t p2, msg_t p3, msg_t p4);
 
+#if (CH_DELEGATES_HAS_ASYNC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of an asynchronous delegate call.
+ * @details The call object is also the future returned to the caller,
+ *          the caller waits on it for the call outcome then releases it.
+ */
+typedef struct ch_delegate_call delegate_call_t;
+
+/**
+ * @brief   Structure representing an asynchronous delegate call.
+ */
+struct ch_delegate_call {
+  /**
+   * @brief   Next call in the queue.
+   */
+  delegate_call_t           *next;
+  /**
+   * @brief   The function to be called.
+   */
+  union {
+    delegate_fn0_t          fn0;
+    delegate_fn1_t          fn1;
+    delegate_fn2_t          fn2;
+    delegate_fn3_t          fn3;
+    delegate_fn4_t          fn4;
+  } func;
+  /**
+   * @brief   Number of function parameters.
+   */
+  unsigned                  argc;
+  /**
+   * @brief   Function parameters.
+   */
+  msg_t                     args[4];
+  /**
+   * @brief   Function return value, valid when the call is done.
+   */
+  msg_t                     ret;
+  /**
+   * @brief   Call state.
+   */
+  uint8_t                   state;
+  /**
+   * @brief   Call released by the caller before completion.
+   */
+  bool                      released;
+  /**
+   * @brief   Thread waiting for the call to complete.
+   */
+  thread_reference_t        waiter;
+#if (CH_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Thread to be signaled on completion or @p NULL.
+   */
+  thread_t                  *evtp;
+  /**
+   * @brief   Events to be signaled on completion.
+   */
+  eventmask_t               events;
+#endif
+};
+
+/**
+ * @brief   Type of an asynchronous delegate calls queue.
+ */
+typedef struct ch_delegate_async {
+  /**
+   * @brief   Pool of the free call objects.
+   */
+  guarded_memory_pool_t     free;
+  /**
+   * @brief   Counter of the queued calls.
+   */
+  semaphore_t               pending;
+  /**
+   * @brief   First queued call.
+   */
+  delegate_call_t           *head;
+  /**
+   * @brief   Last queued call.
+   */
+  delegate_call_t           *tail;
+} delegate_async_t;
+#endif /* CH_DELEGATES_HAS_ASYNC == TRUE */
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -103,6 +219,24 @@ extern "C" {
   void chDelegateDispatch(void);
   msg_t chDelegateDispatchTimeout(sysinterval_t timeout);
   msg_t chDelegateCallVeneer(thread_t *tp, delegate_veneer_t veneer, ...);
+#if CH_DELEGATES_HAS_ASYNC == TRUE
+  void chDelegateAsyncObjectInit(delegate_async_t *dap,
+                                 size_t callsn,
+                                 delegate_call_t *callsbuf);
+  void chDelegateAsyncPostI(delegate_async_t *dap, delegate_call_t *dcp);
+  void chDelegateAsyncPost(delegate_async_t *dap, delegate_call_t *dcp);
+  msg_t chDelegateAsyncDispatchTimeout(delegate_async_t *dap,
+                                       sysinterval_t timeout);
+  msg_t chDelegateFutureWaitTimeout(delegate_call_t *dcp,
+                                    msg_t *retp,
+                                    sysinterval_t timeout);
+  void chDelegateFutureRelease(delegate_async_t *dap, delegate_call_t *dcp);
+#if CH_CFG_USE_EVENTS == TRUE
+  void chDelegateFutureAttachEvent(delegate_call_t *dcp,
+                                   thread_t *tp,
+                                   eventmask_t events);
+#endif
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -201,6 +335,192 @@ static inline msg_t chDelegateCallDirect4(thread_t *tp, delegate_fn4_t func,
   return chDelegateCallVeneer(tp, __ch_delegate_fn4, func, p1, p2, p3, p4);
 }
 
+#if (CH_DELEGATES_HAS_ASYNC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Allocates a free asynchronous call object.
+ *
+ * @param[in] dap       pointer to a @p delegate_async_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The pointer to the allocated call object.
+ * @retval NULL         if a call object is not available within the
+ *                      specified timeout.
+ *
+ * @api
+ */
+static inline delegate_call_t *chDelegateAsyncGetTimeout(delegate_async_t *dap,
+                                                         sysinterval_t timeout) {
+
+  return (delegate_call_t *)chGuardedPoolAllocTimeout(&dap->free, timeout);
+}
+
+/**
+ * @brief   Asynchronous call to a function with no parameters.
+ *
+ * @param[in] dap       pointer to a @p delegate_async_t structure
+ * @param[in] func      pointer to the function to be called
+ * @return              The call future.
+ *
+ * @api
+ */
+static inline delegate_call_t *chDelegateCallAsync0(delegate_async_t *dap,
+                                                    delegate_fn0_t func) {
+  delegate_call_t *dcp = chDelegateAsyncGetTimeout(dap, TIME_INFINITE);
+
+  dcp->func.fn0 = func;
+  dcp->argc     = 0U;
+  chDelegateAsyncPost(dap, dcp);
+
+  return dcp;
+}
+
+/**
+ * @brief   Asynchronous call to a function with one parameter.
+ *
+ * @param[in] dap       pointer to a @p delegate_async_t structure
+ * @param[in] func      pointer to the function to be called
+ * @param[in] p1        parameter 1 passed as a @p msg_t
+ * @return              The call future.
+ *
+ * @api
+ */
+static inline delegate_call_t *chDelegateCallAsync1(delegate_async_t *dap,
+                                                    delegate_fn1_t func,
+                                                    msg_t p1) {
+  delegate_call_t *dcp = chDelegateAsyncGetTimeout(dap, TIME_INFINITE);
+
+  dcp->func.fn1 = func;
+  dcp->argc     = 1U;
+  dcp->args[0]  = p1;
+  chDelegateAsyncPost(dap, dcp);
+
+  return dcp;
+}
+
+/**
+ * @brief   Asynchronous call to a function with two parameters.
+ *
+ * @param[in] dap       pointer to a @p delegate_async_t structure
+ * @param[in] func      pointer to the function to be called
+ * @param[in] p1        parameter 1 passed as a @p msg_t
+ * @param[in] p2        parameter 2 passed as a @p msg_t
+ * @return              The call future.
+ *
+ * @api
+ */
+static inline delegate_call_t *chDelegateCallAsync2(delegate_async_t *dap,
+                                                    delegate_fn2_t func,
+                                                    msg_t p1, msg_t p2) {
+  delegate_call_t *dcp = chDelegateAsyncGetTimeout(dap, TIME_INFINITE);
+
+  dcp->func.fn2 = func;
+  dcp->argc     = 2U;
+  dcp->args[0]  = p1;
+  dcp->args[1]  = p2;
+  chDelegateAsyncPost(dap, dcp);
+
+  return dcp;
+}
+
+/**
+ * @brief   Asynchronous call to a function with three parameters.
+ *
+ * @param[in] dap       pointer to a @p delegate_async_t structure
+ * @param[in] func      pointer to the function to be called
+ * @param[in] p1        parameter 1 passed as a @p msg_t
+ * @param[in] p2        parameter 2 passed as a @p msg_t
+ * @param[in] p3        parameter 3 passed as a @p msg_t
+ * @return              The call future.
+ *
+ * @api
+ */
+static inline delegate_call_t *chDelegateCallAsync3(delegate_async_t *dap,
+                                                    delegate_fn3_t func,
+                                                    msg_t p1, msg_t p2,
+                                                    msg_t p3) {
+  delegate_call_t *dcp = chDelegateAsyncGetTimeout(dap, TIME_INFINITE);
+
+  dcp->func.fn3 = func;
+  dcp->argc     = 3U;
+  dcp->args[0]  = p1;
+  dcp->args[1]  = p2;
+  dcp->args[2]  = p3;
+  chDelegateAsyncPost(dap, dcp);
+
+  return dcp;
+}
+
+/**
+ * @brief   Asynchronous call to a function with four parameters.
+ *
+ * @param[in] dap       pointer to a @p delegate_async_t structure
+ * @param[in] func      pointer to the function to be called
+ * @param[in] p1        parameter 1 passed as a @p msg_t
+ * @param[in] p2        parameter 2 passed as a @p msg_t
+ * @param[in] p3        parameter 3 passed as a @p msg_t
+ * @param[in] p4        parameter 4 passed as a @p msg_t
+ * @return              The call future.
+ *
+ * @api
+ */
+static inline delegate_call_t *chDelegateCallAsync4(delegate_async_t *dap,
+                                                    delegate_fn4_t func,
+                                                    msg_t p1, msg_t p2,
+                                                    msg_t p3, msg_t p4) {
+  delegate_call_t *dcp = chDelegateAsyncGetTimeout(dap, TIME_INFINITE);
+
+  dcp->func.fn4 = func;
+  dcp->argc     = 4U;
+  dcp->args[0]  = p1;
+  dcp->args[1]  = p2;
+  dcp->args[2]  = p3;
+  dcp->args[3]  = p4;
+  chDelegateAsyncPost(dap, dcp);
+
+  return dcp;
+}
+
+/**
+ * @brief   Checks if an asynchronous call has been completed.
+ *
+ * @param[in] dcp       pointer to the call future
+ * @return              The call state.
+ * @retval false        if the call is still queued or running.
+ * @retval true         if the call has been completed.
+ *
+ * @iclass
+ */
+static inline bool chDelegateFutureIsDoneI(delegate_call_t *dcp) {
+
+  chDbgCheckClassI();
+
+  return (bool)(dcp->state == DELEGATE_CALL_DONE);
+}
+
+/**
+ * @brief   Checks if an asynchronous call has been completed.
+ *
+ * @param[in] dcp       pointer to the call future
+ * @return              The call state.
+ * @retval false        if the call is still queued or running.
+ * @retval true         if the call has been completed.
+ *
+ * @api
+ */
+static inline bool chDelegateFutureIsDone(delegate_call_t *dcp) {
+  bool done;
+
+  chSysLock();
+  done = chDelegateFutureIsDoneI(dcp);
+  chSysUnlock();
+
+  return done;
+}
+#endif /* CH_DELEGATES_HAS_ASYNC == TRUE */
+
 #endif /* CH_CFG_USE_DELEGATES == TRUE */
 
 #endif /* CHDELEGATES_H */
@@ -96,6 +96,18 @@
 #define CH_CFG_FACTORY_PIPES                TRUE
 #endif
 
+/**
+ * @brief   Number of hash buckets in the objects lists.
+ * @details If greater than zero then objects names are indexed using an
+ *          hash table of the specified size, find, create and release
+ *          operations become O(1) on average. If zero then objects are
+ *          kept in simple lists scanned linearly.
+ * @note    The value must be zero or a power of two.
+ */
+#if !defined(CH_CFG_FACTORY_HASH_BUCKETS) || defined(__DOXYGEN__)
+#define CH_CFG_FACTORY_HASH_BUCKETS         0
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -147,6 +159,21 @@
 #error "CH_CFG_USE_FACTORY requires CH_CFG_USE_MUTEXES and/or CH_CFG_USE_SEMAPHORES"
 #endif
 
+#if (CH_CFG_FACTORY_HASH_BUCKETS < 0) ||                                    \
+    ((CH_CFG_FACTORY_HASH_BUCKETS &                                         \
+      (CH_CFG_FACTORY_HASH_BUCKETS - 1)) != 0)
+#error "invalid CH_CFG_FACTORY_HASH_BUCKETS value"
+#endif
+
+/**
+ * @brief   Number of lists composing each objects list.
+ */
+#if (CH_CFG_FACTORY_HASH_BUCKETS > 0) || defined(__DOXYGEN__)
+#define CH_FACTORY_LISTS_NUM                CH_CFG_FACTORY_HASH_BUCKETS
+#else
+#define CH_FACTORY_LISTS_NUM                1
+#endif
+
 #if CH_CFG_USE_MEMCORE == FALSE
 #error "CH_CFG_USE_FACTORY requires CH_CFG_USE_MEMCORE"
 #endif
@@ -184,9 +211,14 @@ typedef struct ch_dyn_element {
 
 /**
  * @brief   Type of a dynamic object list.
+ * @details The list is composed of @p CH_FACTORY_LISTS_NUM circular lists,
+ *          objects are distributed among them using an hash of the name.
  */
 typedef struct ch_dyn_list {
-    dyn_element_t       *next;
+  /**
+   * @brief   Heads of the hash buckets.
+   */
+  dyn_element_t         *next[CH_FACTORY_LISTS_NUM];
 } dyn_list_t;
 
 #if (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE) || defined(__DOXYGEN__)
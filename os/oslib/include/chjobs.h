@@ -28,6 +28,9 @@
  *          - <b>Post</b>: A job is posted to the queue, it will be
  *            returned to the pool after execution.
  *          .
+ *          Jobs Executors are an higher level construct owning a set of
+ *          worker threads, jobs are posted on one of several priority
+ *          lanes and are dispatched in batches to the workers.
  *
  * @addtogroup oslib_jobs_queues
  * @{
@@ -51,6 +54,50 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Number of priority lanes in jobs executors.
+ * @note    Lane zero has the highest priority.
+ */
+#if !defined(CH_CFG_JOBS_EXEC_LANES) || defined(__DOXYGEN__)
+#define CH_CFG_JOBS_EXEC_LANES              3
+#endif
+
+/**
+ * @brief   Maximum number of worker threads in jobs executors.
+ */
+#if !defined(CH_CFG_JOBS_EXEC_MAX_WORKERS) || defined(__DOXYGEN__)
+#define CH_CFG_JOBS_EXEC_MAX_WORKERS        4
+#endif
+
+/**
+ * @brief   Maximum number of jobs taken by a worker on each wakeup.
+ * @note    Workers take more than one job only when all workers are
+ *          busy and jobs are accumulating.
+ */
+#if !defined(CH_CFG_JOBS_EXEC_BATCH) || defined(__DOXYGEN__)
+#define CH_CFG_JOBS_EXEC_BATCH              4
+#endif
+
+/**
+ * @brief   Jobs executors latency statistics.
+ * @details If enabled then jobs queueing and execution latencies are
+ *          measured using the realtime counter.
+ * @note    Requires a port supporting the realtime counter.
+ */
+#if !defined(CH_CFG_JOBS_EXEC_STATISTICS) || defined(__DOXYGEN__)
+#define CH_CFG_JOBS_EXEC_STATISTICS         FALSE
+#endif
+
+/**
+ * @brief   Maximum number of worker threads in work-stealing jobs groups.
+ * @note    Normally one worker is started on each OS instance, more
+ *          workers per instance can be used in order to emulate a
+ *          multi-core system.
+ */
+#if !defined(CH_CFG_JOBS_SMP_MAX_WORKERS) || defined(__DOXYGEN__)
+#define CH_CFG_JOBS_SMP_MAX_WORKERS         4
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -67,6 +114,33 @@
 #error "CH_CFG_USE_JOBS requires CH_CFG_USE_MAILBOXES"
 #endif
 
+#if CH_CFG_JOBS_EXEC_LANES < 1
+#error "invalid CH_CFG_JOBS_EXEC_LANES value"
+#endif
+
+#if CH_CFG_JOBS_EXEC_MAX_WORKERS < 1
+#error "invalid CH_CFG_JOBS_EXEC_MAX_WORKERS value"
+#endif
+
+#if CH_CFG_JOBS_EXEC_BATCH < 1
+#error "invalid CH_CFG_JOBS_EXEC_BATCH value"
+#endif
+
+#if CH_CFG_JOBS_SMP_MAX_WORKERS < 1
+#error "invalid CH_CFG_JOBS_SMP_MAX_WORKERS value"
+#endif
+
+/**
+ * @brief   Work-stealing jobs groups availability.
+ * @note    Work-stealing groups rely on RT OS instances.
+ */
+#if (defined(__CHIBIOS_RT__) && (CH_CFG_USE_WAITEXIT == TRUE)) ||           \
+    defined(__DOXYGEN__)
+#define CH_JOBS_HAS_SMP                     TRUE
+#else
+#define CH_JOBS_HAS_SMP                     FALSE
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -104,10 +178,208 @@ typedef struct ch_job_descriptor {
   void                      *jobarg;
 } job_descriptor_t;
 
+#if (CH_CFG_USE_WAITEXIT == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of an executor job descriptor.
+ */
+typedef struct ch_exec_job exec_job_t;
+
+/**
+ * @brief   Structure representing an executor job descriptor.
+ */
+struct ch_exec_job {
+  /**
+   * @brief   Next job in the lane.
+   */
+  exec_job_t                *next;
+  /**
+   * @brief   Job function.
+   */
+  job_function_t            jobfunc;
+  /**
+   * @brief   Argument to be passed to the job function.
+   */
+  void                      *jobarg;
+#if (CH_CFG_JOBS_EXEC_STATISTICS == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Realtime counter value when the job has been posted.
+   */
+  rtcnt_t                   posted;
+#endif
+};
+
+/**
+ * @brief   Type of a jobs executor lane.
+ */
+typedef struct ch_exec_lane {
+  /**
+   * @brief   First job in the lane.
+   */
+  exec_job_t                *head;
+  /**
+   * @brief   Last job in the lane.
+   */
+  exec_job_t                *tail;
+} exec_lane_t;
+
+#if (CH_CFG_JOBS_EXEC_STATISTICS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of jobs executor statistics.
+ * @note    Latencies are expressed in realtime counter cycles.
+ */
+typedef struct ch_exec_stats {
+  /**
+   * @brief   Number of executed jobs.
+   */
+  ucnt_t                    n;
+  /**
+   * @brief   Worst queueing latency.
+   */
+  rtcnt_t                   queue_worst;
+  /**
+   * @brief   Cumulative queueing latency.
+   */
+  uint64_t                  queue_cumulative;
+  /**
+   * @brief   Worst execution time.
+   */
+  rtcnt_t                   exec_worst;
+  /**
+   * @brief   Cumulative execution time.
+   */
+  uint64_t                  exec_cumulative;
+} exec_stats_t;
+#endif
+
+/**
+ * @brief   Type of a jobs executor.
+ */
+typedef struct ch_jobs_executor {
+  /**
+   * @brief   Pool of the free jobs.
+   */
+  guarded_memory_pool_t     free;
+  /**
+   * @brief   Counter of the queued jobs.
+   */
+  semaphore_t               pending;
+  /**
+   * @brief   Priority lanes.
+   */
+  exec_lane_t               lanes[CH_CFG_JOBS_EXEC_LANES];
+  /**
+   * @brief   Number of posted jobs not yet completed.
+   */
+  ucnt_t                    outstanding;
+  /**
+   * @brief   Threads waiting for the executor to become idle.
+   */
+  threads_queue_t           drainq;
+  /**
+   * @brief   Executor stopping.
+   */
+  bool                      stopping;
+  /**
+   * @brief   Number of worker threads.
+   */
+  ucnt_t                    nworkers;
+  /**
+   * @brief   Worker threads.
+   */
+  thread_t                  *workers[CH_CFG_JOBS_EXEC_MAX_WORKERS];
+#if (CH_CFG_JOBS_EXEC_STATISTICS == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Latency statistics.
+   */
+  exec_stats_t              stats;
+#endif
+} jobs_executor_t;
+#endif /* CH_CFG_USE_WAITEXIT == TRUE */
+
+#if (CH_JOBS_HAS_SMP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a work-stealing worker.
+ */
+typedef struct ch_smp_worker {
+  /**
+   * @brief   Group owning the worker.
+   */
+  struct ch_jobs_smp        *group;
+  /**
+   * @brief   Jobs queue owned by the worker.
+   */
+  exec_lane_t               queue;
+  /**
+   * @brief   Worker thread.
+   */
+  thread_t                  *thread;
+  /**
+   * @brief   Reference to the worker thread while idle.
+   */
+  thread_reference_t        idle;
+  /**
+   * @brief   Number of jobs executed by the worker.
+   */
+  ucnt_t                    executed;
+  /**
+   * @brief   Number of jobs stolen from other workers.
+   */
+  ucnt_t                    stolen;
+} smp_worker_t;
+
+/**
+ * @brief   Type of a work-stealing jobs group.
+ */
+typedef struct ch_jobs_smp {
+  /**
+   * @brief   Pool of the free jobs.
+   */
+  guarded_memory_pool_t     free;
+  /**
+   * @brief   Workers of the group.
+   */
+  smp_worker_t              workers[CH_CFG_JOBS_SMP_MAX_WORKERS];
+  /**
+   * @brief   Number of started workers.
+   */
+  ucnt_t                    nworkers;
+  /**
+   * @brief   Next worker for posts coming from outside the group.
+   */
+  ucnt_t                    next;
+  /**
+   * @brief   Jobs posted and not yet completed.
+   */
+  ucnt_t                    pending;
+  /**
+   * @brief   Threads waiting for the group to become idle.
+   */
+  threads_queue_t           drainq;
+  /**
+   * @brief   Group stopping flag.
+   */
+  bool                      stopping;
+} jobs_smp_t;
+#endif /* CH_JOBS_HAS_SMP == TRUE */
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @brief   Static working area allocation for jobs executor workers.
+ * @details This macro allocates a working area able to host @p n worker
+ *          threads each one with a stack of @p size bytes.
+ *
+ * @param[in] s         the name to be assigned to the working area array
+ * @param[in] n         the number of worker threads
+ * @param[in] size      the stack size of each worker thread
+ *
+ * @api
+ */
+#define JOBS_EXEC_WORKING_AREA(s, n, size)                                  \
+  THD_WORKING_AREA(s, (n) * THD_WORKING_AREA_SIZE(size))
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -115,7 +387,37 @@ typedef struct ch_job_descriptor {
 #ifdef __cplusplus
 extern "C" {
 #endif
-
+#if CH_CFG_USE_WAITEXIT == TRUE
+  void chJobExecObjectInit(jobs_executor_t *jep,
+                           size_t jobsn,
+                           exec_job_t *jobsbuf);
+  void chJobExecStart(jobs_executor_t *jep,
+                      void *wbase,
+                      ucnt_t n,
+                      size_t size,
+                      tprio_t prio);
+  void chJobExecPostI(jobs_executor_t *jep, exec_job_t *jp, unsigned lane);
+  void chJobExecPostS(jobs_executor_t *jep, exec_job_t *jp, unsigned lane);
+  void chJobExecPost(jobs_executor_t *jep, exec_job_t *jp, unsigned lane);
+  msg_t chJobExecDrainTimeout(jobs_executor_t *jep, sysinterval_t timeout);
+  void chJobExecShutdown(jobs_executor_t *jep);
+#if CH_CFG_JOBS_EXEC_STATISTICS == TRUE
+  void chJobExecGetStats(jobs_executor_t *jep, exec_stats_t *esp);
+#endif
+#endif
+#if CH_JOBS_HAS_SMP == TRUE
+  void chJobSmpObjectInit(jobs_smp_t *jsp, size_t jobsn, exec_job_t *jobsbuf);
+  void chJobSmpStart(jobs_smp_t *jsp,
+                     os_instance_t *oip,
+                     void *wbase,
+                     size_t size,
+                     tprio_t prio);
+  void chJobSmpPostI(jobs_smp_t *jsp, exec_job_t *jp);
+  void chJobSmpPostS(jobs_smp_t *jsp, exec_job_t *jp);
+  void chJobSmpPost(jobs_smp_t *jsp, exec_job_t *jp);
+  msg_t chJobSmpDrainTimeout(jobs_smp_t *jsp, sysinterval_t timeout);
+  void chJobSmpShutdown(jobs_smp_t *jsp);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -390,6 +692,109 @@ static inline msg_t chJobDispatchTimeout(jobs_queue_t *jqp,
   return msg;
 }
 
+#if (CH_CFG_USE_WAITEXIT == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Allocates a free executor job object.
+ *
+ * @param[in] jep       pointer to a @p jobs_executor_t structure
+ * @return              The pointer to the allocated job object.
+ *
+ * @api
+ */
+static inline exec_job_t *chJobExecGet(jobs_executor_t *jep) {
+
+  return (exec_job_t *)chGuardedPoolAllocTimeout(&jep->free, TIME_INFINITE);
+}
+
+/**
+ * @brief   Allocates a free executor job object.
+ *
+ * @param[in] jep       pointer to a @p jobs_executor_t structure
+ * @return              The pointer to the allocated job object.
+ * @retval NULL         if a job object is not immediately available.
+ *
+ * @iclass
+ */
+static inline exec_job_t *chJobExecGetI(jobs_executor_t *jep) {
+
+  return (exec_job_t *)chGuardedPoolAllocI(&jep->free);
+}
+
+/**
+ * @brief   Allocates a free executor job object.
+ *
+ * @param[in] jep       pointer to a @p jobs_executor_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The pointer to the allocated job object.
+ * @retval NULL         if a job object is not available within the specified
+ *                      timeout.
+ *
+ * @api
+ */
+static inline exec_job_t *chJobExecGetTimeout(jobs_executor_t *jep,
+                                              sysinterval_t timeout) {
+
+  return (exec_job_t *)chGuardedPoolAllocTimeout(&jep->free, timeout);
+}
+
+/**
+ * @brief   Waits for all the posted jobs to be executed.
+ *
+ * @param[in] jep       pointer to a @p jobs_executor_t structure
+ *
+ * @api
+ */
+static inline void chJobExecDrain(jobs_executor_t *jep) {
+
+  (void) chJobExecDrainTimeout(jep, TIME_INFINITE);
+}
+#endif /* CH_CFG_USE_WAITEXIT == TRUE */
+
+#if (CH_JOBS_HAS_SMP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Allocates a free job object for a work-stealing group.
+ *
+ * @param[in] jsp       pointer to a @p jobs_smp_t structure
+ * @return              The pointer to the allocated job object.
+ *
+ * @api
+ */
+static inline exec_job_t *chJobSmpGet(jobs_smp_t *jsp) {
+
+  return (exec_job_t *)chGuardedPoolAllocTimeout(&jsp->free, TIME_INFINITE);
+}
+
+/**
+ * @brief   Allocates a free job object for a work-stealing group.
+ *
+ * @param[in] jsp       pointer to a @p jobs_smp_t structure
+ * @return              The pointer to the allocated job object.
+ * @retval NULL         if a job object is not immediately available.
+ *
+ * @iclass
+ */
+static inline exec_job_t *chJobSmpGetI(jobs_smp_t *jsp) {
+
+  return (exec_job_t *)chGuardedPoolAllocI(&jsp->free);
+}
+
+/**
+ * @brief   Waits for all the posted jobs to be executed.
+ *
+ * @param[in] jsp       pointer to a @p jobs_smp_t structure
+ *
+ * @api
+ */
+static inline void chJobSmpDrain(jobs_smp_t *jsp) {
+
+  (void) chJobSmpDrainTimeout(jsp, TIME_INFINITE);
+}
+#endif /* CH_JOBS_HAS_SMP == TRUE */
+
 #endif /* CH_CFG_USE_JOBS == TRUE */
 
 #endif /* CHJOBS_H */
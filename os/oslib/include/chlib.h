@@ -183,17 +183,25 @@
 #undef CH_CFG_USE_MEMPOOLS
 #undef CH_CFG_USE_OBJ_FIFOS
 #undef CH_CFG_USE_PIPES
+#undef CH_CFG_USE_RINGS
+#undef CH_CFG_USE_REFBUFS
+#undef CH_CFG_USE_BUS
 #undef CH_CFG_USE_OBJ_CACHES
 #undef CH_CFG_USE_DELEGATES
 #undef CH_CFG_USE_JOBS
+#undef CH_CFG_USE_SWTIMERS
 
 #define CH_CFG_USE_HEAP                     FALSE
 #define CH_CFG_USE_MEMPOOLS                 FALSE
 #define CH_CFG_USE_OBJ_FIFOS                FALSE
 #define CH_CFG_USE_PIPES                    FALSE
+#define CH_CFG_USE_RINGS                    FALSE
+#define CH_CFG_USE_REFBUFS                  FALSE
+#define CH_CFG_USE_BUS                      FALSE
 #define CH_CFG_USE_OBJ_CACHES               FALSE
 #define CH_CFG_USE_DELEGATES                FALSE
 #define CH_CFG_USE_JOBS                     FALSE
+#define CH_CFG_USE_SWTIMERS                 FALSE
 
 #endif /* (CH_CUSTOMER_LIC_OSLIB == FALSE) ||
           (CH_LICENSE_FEATURES == CH_FEATURES_BASIC) */
@@ -232,9 +240,13 @@
 #include "chmempools.h"
 #include "chobjfifos.h"
 #include "chpipes.h"
+#include "chrings.h"
+#include "chrefbufs.h"
+#include "chbus.h"
 #include "chobjcaches.h"
 #include "chdelegates.h"
 #include "chjobs.h"
+#include "chswtimers.h"
 #include "chfactory.h"
 
 /*===========================================================================*/
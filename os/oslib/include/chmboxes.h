@@ -57,6 +57,8 @@ typedef struct {
   msg_t                 *wrptr;         /**< @brief Write pointer.          */
   msg_t                 *rdptr;         /**< @brief Read pointer.           */
   size_t                cnt;            /**< @brief Messages in queue.      */
+  size_t                wm;             /**< @brief Readers wakeup
+                                                    watermark.              */
   bool                  reset;          /**< @brief True in reset state.    */
   threads_queue_t       qw;             /**< @brief Queued writers.         */
   threads_queue_t       qr;             /**< @brief Queued readers.         */
@@ -81,6 +83,7 @@ typedef struct {
   (msg_t *)(buffer),                                                        \
   (msg_t *)(buffer),                                                        \
   (size_t)0,                                                                \
+  (size_t)1,                                                                \
   false,                                                                    \
   __THREADS_QUEUE_DATA(name.qw),                                            \
   __THREADS_QUEUE_DATA(name.qr),                                            \
@@ -117,6 +120,18 @@ extern "C" {
   msg_t chMBFetchTimeout(mailbox_t *mbp, msg_t *msgp, sysinterval_t timeout);
   msg_t chMBFetchTimeoutS(mailbox_t *mbp, msg_t *msgp, sysinterval_t timeout);
   msg_t chMBFetchI(mailbox_t *mbp, msg_t *msgp);
+  size_t chMBPostNTimeout(mailbox_t *mbp, const msg_t *msgp,
+                          size_t n, sysinterval_t timeout);
+  size_t chMBPostNTimeoutS(mailbox_t *mbp, const msg_t *msgp,
+                           size_t n, sysinterval_t timeout);
+  size_t chMBPostNI(mailbox_t *mbp, const msg_t *msgp, size_t n);
+  size_t chMBFetchNTimeout(mailbox_t *mbp, msg_t *msgp,
+                           size_t n, sysinterval_t timeout);
+  size_t chMBFetchNTimeoutS(mailbox_t *mbp, msg_t *msgp,
+                            size_t n, sysinterval_t timeout);
+  size_t chMBFetchNI(mailbox_t *mbp, msg_t *msgp, size_t n);
+  void chMBSetWatermark(mailbox_t *mbp, size_t wm);
+  void chMBSetWatermarkI(mailbox_t *mbp, size_t wm);
 #ifdef __cplusplus
 }
 #endif
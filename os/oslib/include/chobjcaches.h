@@ -44,12 +44,29 @@
 #define OC_FLAG_NOTSYNC                     0x00000008U
 #define OC_FLAG_LAZYWRITE                   0x00000010U
 #define OC_FLAG_FORGET                      0x00000020U
+#define OC_FLAG_PROTECTED                   0x00000040U
+#define OC_FLAG_MORE                        0x00000080U
+#define OC_FLAG_READAHEAD                   0x00000100U
 /** @} */
 
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Scan-resistant 2Q replacement policy.
+ * @details If enabled then the LRU list is split in a probationary and a
+ *          protected segment. Objects enter the cache in the probationary
+ *          segment and are promoted to the protected segment only when
+ *          referenced again while still cached, eviction happens from the
+ *          probationary segment first. A sequential scan of the backing
+ *          store is then unable to evict the working set.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_OBJ_CACHES_USE_2Q) || defined(__DOXYGEN__)
+#define CH_CFG_OBJ_CACHES_USE_2Q            FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -97,6 +114,10 @@ typedef bool (*oc_readf_t)(objects_cache_t *ocp,
 
 /**
  * @brief   Object write function.
+ * @note    During a flush @p OC_FLAG_MORE marks objects followed by the
+ *          next key of the same group, the function can defer the media
+ *          update until an object without the flag is written, all the
+ *          objects of the run stay owned until then.
  *
  * @param[in] ocp       pointer to the @p objects_cache_t structure
  * @param[in] async     requests an asynchronous operation if supported, the
@@ -213,8 +234,24 @@ struct ch_objects_cache {
   void                  *objvp;
   /**
    * @brief   LRU list header.
+   * @note    When @p CH_CFG_OBJ_CACHES_USE_2Q is enabled this is the
+   *          probationary segment.
    */
   oc_lru_header_t       lru;
+#if (CH_CFG_OBJ_CACHES_USE_2Q == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Protected segment LRU list header.
+   */
+  oc_lru_header_t       lru_prot;
+  /**
+   * @brief   Number of objects in the protected segment.
+   */
+  ucnt_t                protn;
+  /**
+   * @brief   Maximum number of objects in the protected segment.
+   */
+  ucnt_t                protmax;
+#endif
   /**
    * @brief   Semaphore for cache access.
    */
@@ -263,6 +300,11 @@ extern "C" {
   bool chCacheWriteObject(objects_cache_t *ocp,
                           oc_object_t *objp,
                           bool async);
+  bool chCacheFlush(objects_cache_t *ocp);
+  ucnt_t chCacheReadAhead(objects_cache_t *ocp,
+                          uint32_t group,
+                          uint32_t key,
+                          ucnt_t n);
 #ifdef __cplusplus
 }
 #endif
@@ -281,6 +323,9 @@ extern "C" {
  *            the LRU tail.
  *          - @p OC_FLAG_LAZYWRITE is ignored and kept, a write will occur
  *            when the object is removed from the LRU list (lazy write).
+ *          - @p OC_FLAG_PROTECTED is set by @p chCacheGetObject() on cache
+ *            hits, the object is then placed in the protected segment if
+ *            @p CH_CFG_OBJ_CACHES_USE_2Q is enabled.
  *          .
  *
  * @param[in] ocp       pointer to the @p objects_cache_t structure
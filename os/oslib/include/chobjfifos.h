@@ -36,6 +36,10 @@
  *          - <b>Receive</b>: An object is received from the mailbox,
  *            can be blocking.
  *          .
+ *          When @p CH_CFG_OBJ_FIFOS_LOCKFREE is enabled the pool and the
+ *          mailbox are replaced by lock-free structures, the operations
+ *          and their semantic are unchanged except that sending objects
+ *          ahead is not supported.
  *
  * @addtogroup oslib_objects_fifos
  * @{
@@ -50,10 +54,45 @@
 /* Module constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @name    Lock-free implementation calling classes
+ * @{
+ */
+#define __OFIFO_CLASS_I                     0U
+#define __OFIFO_CLASS_S                     1U
+#define __OFIFO_CLASS_API                   2U
+/** @} */
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Lock-free objects FIFOs.
+ * @details If enabled then the objects FIFOs use a lock-free free objects
+ *          stack and a lock-free multi-producer multi-consumer queue, the
+ *          kernel is entered only when a thread has to wait or has to be
+ *          woken up.
+ * @note    The lock-free structures require compare-and-swap support,
+ *          on cores without it the atomic operations are emulated using
+ *          short critical zones.
+ * @note    The number of objects in a FIFO is limited to 65534.
+ * @note    Free objects store the free stack link in their first word,
+ *          objects must be at least @p sizeof(msg_t) bytes.
+ * @note    The free objects stack is protected against the ABA problem
+ *          by a 16 bits tag incremented on each take and return. A take
+ *          preempted between reading the stack top and exchanging it,
+ *          while exactly a multiple of 65536 takes and returns complete
+ *          on the same FIFO, can link a taken object back in the stack.
+ *          Preemptions that long are not expected on FIFOs used in
+ *          real-time code but the mode is not suitable for threads that
+ *          can be suspended for unbounded times in the middle of an
+ *          operation.
+ */
+#if !defined(CH_CFG_OBJ_FIFOS_LOCKFREE) || defined(__DOXYGEN__)
+#define CH_CFG_OBJ_FIFOS_LOCKFREE           FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -77,6 +116,7 @@
 /**
  * @brief   Type of an objects FIFO.
  */
+#if (CH_CFG_OBJ_FIFOS_LOCKFREE == FALSE) || defined(__DOXYGEN__)
 typedef struct ch_objects_fifo {
   /**
    * @brief   Pool of the free objects.
@@ -87,6 +127,54 @@ typedef struct ch_objects_fifo {
    */
   mailbox_t                 mbx;
 } objects_fifo_t;
+#else
+typedef struct ch_objects_fifo {
+  /**
+   * @brief   Pointer to the objects buffer.
+   */
+  uint8_t                   *objbuf;
+  /**
+   * @brief   Size of the objects.
+   */
+  size_t                    objsize;
+  /**
+   * @brief   Number of objects.
+   */
+  size_t                    objn;
+  /**
+   * @brief   Top of the free objects stack, tag and index.
+   */
+  volatile msg_t            free_top;
+  /**
+   * @brief   Free objects counter, negative if threads are waiting.
+   */
+  volatile cnt_t            free_cnt;
+  /**
+   * @brief   Semaphore of the threads waiting for a free object.
+   */
+  semaphore_t               free_sem;
+  /**
+   * @brief   Cells of the sent objects queue.
+   */
+  volatile msg_t            *cells;
+  /**
+   * @brief   Queue write position, lap and index.
+   */
+  volatile msg_t            wrpos;
+  /**
+   * @brief   Queue read position, lap and index.
+   */
+  volatile msg_t            rdpos;
+  /**
+   * @brief   Sent objects counter, negative if threads are waiting.
+   */
+  volatile cnt_t            msg_cnt;
+  /**
+   * @brief   Semaphore of the threads waiting for a sent object.
+   */
+  semaphore_t               msg_sem;
+} objects_fifo_t;
+#endif
 
 /*===========================================================================*/
 /* Module macros.                                                            */
@@ -99,7 +187,16 @@ typedef struct ch_objects_fifo {
 #ifdef __cplusplus
 extern "C" {
 #endif
-
+#if CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE
+  void __ofifo_object_init(objects_fifo_t *ofp, size_t objsize, size_t objn,
+                           void *objbuf, msg_t *msgbuf);
+  void *__ofifo_take(objects_fifo_t *ofp, sysinterval_t timeout,
+                     unsigned cls);
+  void __ofifo_return(objects_fifo_t *ofp, void *objp, unsigned cls);
+  void __ofifo_send(objects_fifo_t *ofp, void *objp, unsigned cls);
+  msg_t __ofifo_receive(objects_fifo_t *ofp, void **objpp,
+                        sysinterval_t timeout, unsigned cls);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -112,6 +209,8 @@ extern "C" {
  * @brief   Initializes a FIFO object.
  * @pre     The messages size must be a multiple of the alignment
  *          requirement.
+ * @pre     When @p CH_CFG_OBJ_FIFOS_LOCKFREE is enabled the objects size
+ *          must be at least @p sizeof(msg_t).
  *
  * @param[out] ofp      pointer to a @p objects_fifo_t structure
  * @param[in] objsize   size of objects
@@ -131,15 +230,24 @@ static inline void chFifoObjectInitAligned(objects_fifo_t *ofp, size_t objsize,
 
   chDbgCheck((objsize >= objalign) && ((objsize % objalign) == 0U));
 
+#if CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE
+  chDbgCheck((objalign >= PORT_NATURAL_ALIGN) &&
+             MEM_IS_ALIGNED(objbuf, objalign));
+
+  __ofifo_object_init(ofp, objsize, objn, objbuf, msgbuf);
+#else
   chGuardedPoolObjectInitAligned(&ofp->free, objsize, objalign);
   chGuardedPoolLoadArray(&ofp->free, objbuf, objn);
   chMBObjectInit(&ofp->mbx, msgbuf, objn);
+#endif
 }
 
 /**
  * @brief   Initializes a FIFO object.
  * @pre     The messages size must be a multiple of the alignment
  *          requirement.
+ * @pre     When @p CH_CFG_OBJ_FIFOS_LOCKFREE is enabled the objects size
+ *          must be at least @p sizeof(msg_t).
  *
  * @param[out] ofp      pointer to a @p objects_fifo_t structure
  * @param[in] objsize   size of objects
@@ -171,7 +279,11 @@ static inline void chFifoObjectInit(objects_fifo_t *ofp, size_t objsize,
  */
 static inline void *chFifoTakeObjectI(objects_fifo_t *ofp) {
 
+#if CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE
+  return __ofifo_take(ofp, TIME_IMMEDIATE, __OFIFO_CLASS_I);
+#else
   return chGuardedPoolAllocI(&ofp->free);
+#endif
 }
 
 /**
@@ -192,7 +304,11 @@ static inline void *chFifoTakeObjectI(objects_fifo_t *ofp) {
 static inline void *chFifoTakeObjectTimeoutS(objects_fifo_t *ofp,
                                              sysinterval_t timeout) {
 
+#if CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE
+  return __ofifo_take(ofp, timeout, __OFIFO_CLASS_S);
+#else
   return chGuardedPoolAllocTimeoutS(&ofp->free, timeout);
+#endif
 }
 
 /**
@@ -213,7 +329,11 @@ static inline void *chFifoTakeObjectTimeoutS(objects_fifo_t *ofp,
 static inline void *chFifoTakeObjectTimeout(objects_fifo_t *ofp,
                                             sysinterval_t timeout) {
 
+#if CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE
+  return __ofifo_take(ofp, timeout, __OFIFO_CLASS_API);
+#else
   return chGuardedPoolAllocTimeout(&ofp->free, timeout);
+#endif
 }
 
 /**
@@ -227,7 +347,11 @@ static inline void *chFifoTakeObjectTimeout(objects_fifo_t *ofp,
 static inline void chFifoReturnObjectI(objects_fifo_t *ofp,
                                        void *objp) {
 
+#if CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE
+  __ofifo_return(ofp, objp, __OFIFO_CLASS_I);
+#else
   chGuardedPoolFreeI(&ofp->free, objp);
+#endif
 }
 
 /**
@@ -241,7 +365,11 @@ static inline void chFifoReturnObjectI(objects_fifo_t *ofp,
 static inline void chFifoReturnObjectS(objects_fifo_t *ofp,
                                        void *objp) {
 
+#if CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE
+  __ofifo_return(ofp, objp, __OFIFO_CLASS_S);
+#else
   chGuardedPoolFreeS(&ofp->free, objp);
+#endif
 }
 
 /**
@@ -255,7 +383,11 @@ static inline void chFifoReturnObjectS(objects_fifo_t *ofp,
 static inline void chFifoReturnObject(objects_fifo_t *ofp,
                                       void *objp) {
 
+#if CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE
+  __ofifo_return(ofp, objp, __OFIFO_CLASS_API);
+#else
   chGuardedPoolFree(&ofp->free, objp);
+#endif
 }
 
 /**
@@ -269,10 +401,14 @@ static inline void chFifoReturnObject(objects_fifo_t *ofp,
  */
 static inline void chFifoSendObjectI(objects_fifo_t *ofp,
                                      void *objp) {
+#if CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE
+  __ofifo_send(ofp, objp, __OFIFO_CLASS_I);
+#else
   msg_t msg;
 
   msg = chMBPostI(&ofp->mbx, (msg_t)objp);
   chDbgAssert(msg == MSG_OK, "post failed");
+#endif
 }
 
 /**
@@ -286,10 +422,14 @@ static inline void chFifoSendObjectI(objects_fifo_t *ofp,
  */
 static inline void chFifoSendObjectS(objects_fifo_t *ofp,
                                      void *objp) {
+#if CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE
+  __ofifo_send(ofp, objp, __OFIFO_CLASS_S);
+#else
   msg_t msg;
 
   msg = chMBPostTimeoutS(&ofp->mbx, (msg_t)objp, TIME_IMMEDIATE);
   chDbgAssert(msg == MSG_OK, "post failed");
+#endif
 }
 
 /**
@@ -302,16 +442,21 @@ static inline void chFifoSendObjectS(objects_fifo_t *ofp,
  * @api
  */
 static inline void chFifoSendObject(objects_fifo_t *ofp, void *objp) {
-
+#if CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE
+  __ofifo_send(ofp, objp, __OFIFO_CLASS_API);
+#else
   msg_t msg;
 
   msg = chMBPostTimeout(&ofp->mbx, (msg_t)objp, TIME_IMMEDIATE);
   chDbgAssert(msg == MSG_OK, "post failed");
+#endif
 }
 
+#if (CH_CFG_OBJ_FIFOS_LOCKFREE == FALSE) || defined(__DOXYGEN__)
 /**
  * @brief   Posts an high priority object.
  * @note    By design the object can be always immediately posted.
+ * @note    Not available when @p CH_CFG_OBJ_FIFOS_LOCKFREE is enabled.
  *
  * @param[in] ofp       pointer to a @p objects_fifo_t structure
  * @param[in] objp      pointer to the object to be posted
@@ -359,6 +504,24 @@ static inline void chFifoSendObjectAhead(objects_fifo_t *ofp, void *objp) {
   msg = chMBPostAheadTimeout(&ofp->mbx, (msg_t)objp, TIME_IMMEDIATE);
   chDbgAssert(msg == MSG_OK, "post failed");
 }
+#endif /* CH_CFG_OBJ_FIFOS_LOCKFREE == FALSE */
+
+/**
+ * @brief   Returns the size of the objects.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @return              The size of an object.
+ *
+ * @xclass
+ */
+static inline size_t chFifoGetObjectSizeX(objects_fifo_t *ofp) {
+
+#if CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE
+  return ofp->objsize;
+#else
+  return ofp->free.pool.object_size;
+#endif
+}
 
 /**
  * @brief   Fetches an object.
@@ -374,7 +537,11 @@ static inline void chFifoSendObjectAhead(objects_fifo_t *ofp, void *objp) {
 static inline msg_t chFifoReceiveObjectI(objects_fifo_t *ofp,
                                          void **objpp) {
 
+#if CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE
+  return __ofifo_receive(ofp, objpp, TIME_IMMEDIATE, __OFIFO_CLASS_I);
+#else
   return chMBFetchI(&ofp->mbx, (msg_t *)objpp);
+#endif
 }
 
 /**
@@ -397,7 +564,11 @@ static inline msg_t chFifoReceiveObjectTimeoutS(objects_fifo_t *ofp,
                                                 void **objpp,
                                                 sysinterval_t timeout) {
 
+#if CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE
+  return __ofifo_receive(ofp, objpp, timeout, __OFIFO_CLASS_S);
+#else
   return chMBFetchTimeoutS(&ofp->mbx, (msg_t *)objpp, timeout);
+#endif
 }
 
 /**
@@ -420,7 +591,11 @@ static inline msg_t chFifoReceiveObjectTimeout(objects_fifo_t *ofp,
                                                void **objpp,
                                                sysinterval_t timeout) {
 
+#if CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE
+  return __ofifo_receive(ofp, objpp, timeout, __OFIFO_CLASS_API);
+#else
   return chMBFetchTimeout(&ofp->mbx, (msg_t *)objpp, timeout);
+#endif
 }
 
 #endif /* CH_CFG_USE_OBJ_FIFOS == TRUE */
@@ -71,6 +71,18 @@ typedef struct {
 #endif
 } pipe_t;
 
+/**
+ * @brief   Structure representing a region of a pipe buffer.
+ * @details A region is made of up to two contiguous spans, the second span
+ *          is non-empty only when the region wraps around the buffer end.
+ */
+typedef struct {
+  uint8_t               *ptr1;          /**< @brief First span pointer.     */
+  size_t                n1;             /**< @brief First span size.        */
+  uint8_t               *ptr2;          /**< @brief Second span pointer.    */
+  size_t                n2;             /**< @brief Second span size.       */
+} pipe_region_t;
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -139,6 +151,12 @@ extern "C" {
                             size_t n, sysinterval_t timeout);
   size_t chPipeReadTimeout(pipe_t *pp, uint8_t *bp,
                            size_t n, sysinterval_t timeout);
+  size_t chPipeWriteReserve(pipe_t *pp, pipe_region_t *rp,
+                            size_t n, sysinterval_t timeout);
+  void chPipeWriteCommit(pipe_t *pp, size_t n);
+  size_t chPipeReadPeek(pipe_t *pp, pipe_region_t *rp,
+                        size_t n, sysinterval_t timeout);
+  void chPipeReadConsume(pipe_t *pp, size_t n);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,483 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    oslib/include/chrefbufs.h
+ * @brief   Reference-counted buffers macros and structures.
+ *
+ * @addtogroup oslib_refbufs
+ * @{
+ */
+
+#ifndef CHREFBUFS_H
+#define CHREFBUFS_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Reference-counted buffers APIs.
+ * @details If enabled then the reference-counted buffers APIs are included
+ *          in the library.
+ */
+#if !defined(CH_CFG_USE_REFBUFS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_REFBUFS                  FALSE
+#endif
+
+#if (CH_CFG_USE_REFBUFS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if CH_CFG_USE_MEMPOOLS == FALSE
+#error "CH_CFG_USE_REFBUFS requires CH_CFG_USE_MEMPOOLS"
+#endif
+
+#if CH_CFG_USE_SEMAPHORES == FALSE
+#error "CH_CFG_USE_REFBUFS requires CH_CFG_USE_SEMAPHORES"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a reference-counted buffers pool.
+ */
+typedef struct ch_refbuf_pool refbuf_pool_t;
+
+/**
+ * @brief   Type of a reference-counted buffer.
+ */
+typedef struct ch_refbuf refbuf_t;
+
+/**
+ * @brief   Structure representing a reference-counted buffer.
+ * @details The buffer storage follows the header, the payload is a window
+ *          inside the storage leaving room for headers in front and for
+ *          trailers after it.
+ */
+struct ch_refbuf {
+  /**
+   * @brief   Next buffer in the chain.
+   */
+  refbuf_t                  *next;
+  /**
+   * @brief   Pool owning the buffer.
+   */
+  refbuf_pool_t             *pool;
+  /**
+   * @brief   References counter.
+   */
+  cnt_t                     refs;
+  /**
+   * @brief   Pointer to the payload.
+   */
+  uint8_t                   *data;
+  /**
+   * @brief   Payload length.
+   */
+  size_t                    len;
+};
+
+/**
+ * @brief   Structure representing a reference-counted buffers pool.
+ */
+struct ch_refbuf_pool {
+  /**
+   * @brief   Pool of the free buffers.
+   */
+  guarded_memory_pool_t     free;
+  /**
+   * @brief   Storage size of each buffer.
+   */
+  size_t                    size;
+  /**
+   * @brief   Headroom reserved on allocation.
+   */
+  size_t                    headroom;
+};
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of the buffer header.
+ */
+#define REFBUF_HEADER_SIZE                                                  \
+  MEM_ALIGN_NEXT(sizeof (refbuf_t), PORT_NATURAL_ALIGN)
+
+/**
+ * @brief   Size of a buffer object including its storage.
+ * @details This macro can be used in order to size the memory area to be
+ *          passed to @p chRefBufPoolObjectInit().
+ *
+ * @param[in] size      storage size of each buffer
+ */
+#define REFBUF_OBJECT_SIZE(size)                                            \
+  (REFBUF_HEADER_SIZE + MEM_ALIGN_NEXT(size, PORT_NATURAL_ALIGN))
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chRefBufPoolObjectInit(refbuf_pool_t *rbpp, size_t size,
+                              size_t headroom, void *p, size_t n);
+  refbuf_t *chRefBufAllocI(refbuf_pool_t *rbpp);
+  refbuf_t *chRefBufAllocTimeout(refbuf_pool_t *rbpp, sysinterval_t timeout);
+  refbuf_t *chRefBufAddRefX(refbuf_t *bp);
+  void chRefBufReleaseI(refbuf_t *bp);
+  void chRefBufRelease(refbuf_t *bp);
+  void chRefBufChain(refbuf_t *head, refbuf_t *bp);
+  size_t chRefBufGetChainLength(const refbuf_t *bp);
+  size_t chRefBufCopyOut(const refbuf_t *bp, size_t offset,
+                         uint8_t *dp, size_t n);
+  size_t chRefBufCopyIn(refbuf_t *bp, const uint8_t *sp, size_t n);
+#if CH_CFG_USE_PIPES == TRUE
+  size_t chPipeWriteRefBufTimeout(pipe_t *pp, const refbuf_t *bp,
+                                  sysinterval_t timeout);
+  size_t chPipeReadRefBufTimeout(pipe_t *pp, refbuf_t *bp, size_t n,
+                                 sysinterval_t timeout);
+#endif
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the storage start of a buffer.
+ *
+ * @param[in] bp        pointer to the buffer
+ * @return              Pointer to the storage.
+ *
+ * @xclass
+ */
+static inline uint8_t *chRefBufGetStorageX(const refbuf_t *bp) {
+
+  return (uint8_t *)bp + REFBUF_HEADER_SIZE;
+}
+
+/**
+ * @brief   Returns the free space in front of the payload.
+ *
+ * @param[in] bp        pointer to the buffer
+ * @return              The headroom size.
+ *
+ * @xclass
+ */
+static inline size_t chRefBufGetHeadroomX(const refbuf_t *bp) {
+
+  return (size_t)(bp->data - chRefBufGetStorageX(bp));
+}
+
+/**
+ * @brief   Returns the free space after the payload.
+ *
+ * @param[in] bp        pointer to the buffer
+ * @return              The tailroom size.
+ *
+ * @xclass
+ */
+static inline size_t chRefBufGetTailroomX(const refbuf_t *bp) {
+
+  return bp->pool->size - chRefBufGetHeadroomX(bp) - bp->len;
+}
+
+/**
+ * @brief   Returns the payload pointer.
+ *
+ * @param[in] bp        pointer to the buffer
+ * @return              Pointer to the payload.
+ *
+ * @xclass
+ */
+static inline uint8_t *chRefBufGetDataX(const refbuf_t *bp) {
+
+  return bp->data;
+}
+
+/**
+ * @brief   Returns the payload length.
+ *
+ * @param[in] bp        pointer to the buffer
+ * @return              The payload length.
+ *
+ * @xclass
+ */
+static inline size_t chRefBufGetLengthX(const refbuf_t *bp) {
+
+  return bp->len;
+}
+
+/**
+ * @brief   Extends the payload in front using the headroom.
+ * @note    Used for prepending protocol headers.
+ *
+ * @param[in] bp        pointer to the buffer
+ * @param[in] n         number of bytes to be prepended
+ * @return              Pointer to the new payload start.
+ *
+ * @xclass
+ */
+static inline uint8_t *chRefBufPushX(refbuf_t *bp, size_t n) {
+
+  chDbgAssert(n <= chRefBufGetHeadroomX(bp), "no headroom");
+
+  bp->data -= n;
+  bp->len  += n;
+
+  return bp->data;
+}
+
+/**
+ * @brief   Removes bytes from the payload front.
+ * @note    Used for stripping protocol headers.
+ *
+ * @param[in] bp        pointer to the buffer
+ * @param[in] n         number of bytes to be removed
+ * @return              Pointer to the new payload start.
+ *
+ * @xclass
+ */
+static inline uint8_t *chRefBufPullX(refbuf_t *bp, size_t n) {
+
+  chDbgAssert(n <= bp->len, "out of payload");
+
+  bp->data += n;
+  bp->len  -= n;
+
+  return bp->data;
+}
+
+/**
+ * @brief   Extends the payload at the end using the tailroom.
+ *
+ * @param[in] bp        pointer to the buffer
+ * @param[in] n         number of bytes to be appended
+ * @return              Pointer to the appended area.
+ *
+ * @xclass
+ */
+static inline uint8_t *chRefBufPutX(refbuf_t *bp, size_t n) {
+  uint8_t *p = bp->data + bp->len;
+
+  chDbgAssert(n <= chRefBufGetTailroomX(bp), "no tailroom");
+
+  bp->len += n;
+
+  return p;
+}
+
+/**
+ * @brief   Truncates the payload.
+ *
+ * @param[in] bp        pointer to the buffer
+ * @param[in] len       new payload length
+ *
+ * @xclass
+ */
+static inline void chRefBufTrimX(refbuf_t *bp, size_t len) {
+
+  chDbgAssert(len <= bp->len, "out of payload");
+
+  bp->len = len;
+}
+
+/**
+ * @brief   Allocates a buffer.
+ *
+ * @param[in] rbpp      pointer to a @p refbuf_pool_t structure
+ * @return              The pointer to the allocated buffer.
+ *
+ * @api
+ */
+static inline refbuf_t *chRefBufAlloc(refbuf_pool_t *rbpp) {
+
+  return chRefBufAllocTimeout(rbpp, TIME_INFINITE);
+}
+
+#if (CH_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Posts a buffer reference into a mailbox.
+ * @details The caller reference is transferred to the receiver, the
+ *          payload is not copied.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] bp        pointer to the buffer chain
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the buffer has been posted.
+ * @retval MSG_RESET    if the mailbox has been reset.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+static inline msg_t chMBPostRefBufTimeout(mailbox_t *mbp, refbuf_t *bp,
+                                          sysinterval_t timeout) {
+
+  return chMBPostTimeout(mbp, (msg_t)bp, timeout);
+}
+
+/**
+ * @brief   Posts a buffer reference into a mailbox.
+ * @details The caller reference is transferred to the receiver, the
+ *          payload is not copied.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] bp        pointer to the buffer chain
+ * @return              The operation status.
+ * @retval MSG_OK       if the buffer has been posted.
+ * @retval MSG_RESET    if the mailbox has been reset.
+ * @retval MSG_TIMEOUT  if the mailbox is full.
+ *
+ * @iclass
+ */
+static inline msg_t chMBPostRefBufI(mailbox_t *mbp, refbuf_t *bp) {
+
+  return chMBPostI(mbp, (msg_t)bp);
+}
+
+/**
+ * @brief   Fetches a buffer reference from a mailbox.
+ * @details The reference is transferred to the caller which is
+ *          responsible for releasing it.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] bpp      pointer to the fetched buffer pointer
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a buffer has been fetched.
+ * @retval MSG_RESET    if the mailbox has been reset.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+static inline msg_t chMBFetchRefBufTimeout(mailbox_t *mbp, refbuf_t **bpp,
+                                           sysinterval_t timeout) {
+  msg_t msg, ref;
+
+  msg = chMBFetchTimeout(mbp, &ref, timeout);
+  if (msg == MSG_OK) {
+    *bpp = (refbuf_t *)ref;
+  }
+
+  return msg;
+}
+#endif /* CH_CFG_USE_MAILBOXES == TRUE */
+
+#if (CH_CFG_USE_OBJ_FIFOS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Sends a buffer reference through an objects FIFO.
+ * @details The objects FIFO is used as a channel of references, a free
+ *          object is taken, filled with the buffer pointer and sent. The
+ *          caller reference is transferred to the receiver, the payload
+ *          is not copied.
+ * @pre     The FIFO objects must be able to hold a pointer.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] bp        pointer to the buffer chain
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the buffer has been sent.
+ * @retval MSG_TIMEOUT  if a free object was not available in time.
+ *
+ * @api
+ */
+static inline msg_t chFifoSendRefBufTimeout(objects_fifo_t *ofp,
+                                            refbuf_t *bp,
+                                            sysinterval_t timeout) {
+  refbuf_t **objp;
+
+  objp = (refbuf_t **)chFifoTakeObjectTimeout(ofp, timeout);
+  if (objp == NULL) {
+    return MSG_TIMEOUT;
+  }
+  *objp = bp;
+  chFifoSendObject(ofp, (void *)objp);
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Receives a buffer reference from an objects FIFO.
+ * @details The FIFO object is returned immediately, the reference is
+ *          transferred to the caller which is responsible for releasing
+ *          it.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[out] bpp      pointer to the received buffer pointer
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a buffer has been received.
+ * @retval MSG_RESET    if the FIFO has been reset.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+static inline msg_t chFifoReceiveRefBufTimeout(objects_fifo_t *ofp,
+                                               refbuf_t **bpp,
+                                               sysinterval_t timeout) {
+  refbuf_t **objp;
+  msg_t msg;
+
+  msg = chFifoReceiveObjectTimeout(ofp, (void **)&objp, timeout);
+  if (msg == MSG_OK) {
+    *bpp = *objp;
+    chFifoReturnObject(ofp, (void *)objp);
+  }
+
+  return msg;
+}
+#endif /* CH_CFG_USE_OBJ_FIFOS == TRUE */
+
+#endif /* CH_CFG_USE_REFBUFS == TRUE */
+
+#endif /* CHREFBUFS_H */
+
+/** @} */
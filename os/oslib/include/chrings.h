@@ -0,0 +1,217 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    oslib/include/chrings.h
+ * @brief   SPSC rings macros and structures.
+ *
+ * @addtogroup oslib_rings
+ * @{
+ */
+
+#ifndef CHRINGS_H
+#define CHRINGS_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   SPSC rings APIs.
+ * @details If enabled then the single-producer single-consumer rings APIs
+ *          are included in the library.
+ */
+#if !defined(CH_CFG_USE_RINGS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_RINGS                    TRUE
+#endif
+
+#if (CH_CFG_USE_RINGS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Structure representing a single-producer single-consumer ring.
+ * @note    The counters are free-running, the index in the buffer is
+ *          obtained masking them. Each counter is only written by its
+ *          owner side.
+ */
+typedef struct {
+  uint8_t               *buffer;        /**< @brief Pointer to the ring
+                                                    buffer.                 */
+  size_t                esize;          /**< @brief Size of an element.     */
+  size_t                mask;           /**< @brief Elements number minus
+                                                    one.                    */
+  volatile size_t       wrcnt;          /**< @brief Written elements
+                                                    counter.                */
+  volatile size_t       rdcnt;          /**< @brief Read elements counter.  */
+  volatile size_t       threshold;      /**< @brief Elements awaited by the
+                                                    consumer, zero if not
+                                                    waiting.                */
+  thread_reference_t    waiter;         /**< @brief Waiting consumer.       */
+} spsc_ring_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @name    Memory ordering primitives
+ * @note    The fallback implementation assumes a single core and in-order
+ *          memory accesses.
+ * @{
+ */
+#if defined(__GNUC__) || defined(__clang__) || defined(__DOXYGEN__)
+/**
+ * @brief   Loads a ring counter with acquire semantic.
+ */
+#define __ring_load_acquire(p)      __atomic_load_n(p, __ATOMIC_ACQUIRE)
+
+/**
+ * @brief   Stores a ring counter with release semantic.
+ */
+#define __ring_store_release(p, v)  __atomic_store_n(p, v, __ATOMIC_RELEASE)
+
+/**
+ * @brief   Full memory barrier.
+ */
+#define __ring_full_barrier()       __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#define __ring_load_acquire(p)      (*(p))
+#define __ring_store_release(p, v)  (*(p) = (v))
+#define __ring_full_barrier()
+#endif
+/** @} */
+
+/**
+ * @brief   Data part of a static ring initializer.
+ * @details This macro should be used when statically initializing a
+ *          ring that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the ring variable
+ * @param[in] buffer    pointer to the ring buffer
+ * @param[in] esize     size of an element
+ * @param[in] n         number of elements in the buffer, must be a power
+ *                      of two
+ */
+#define __RING_DATA(name, buffer, esize, n) {                               \
+  (uint8_t *)(buffer),                                                      \
+  (size_t)(esize),                                                          \
+  (size_t)(n) - (size_t)1,                                                  \
+  (size_t)0,                                                                \
+  (size_t)0,                                                                \
+  (size_t)0,                                                                \
+  NULL                                                                      \
+}
+
+/**
+ * @brief   Static ring initializer.
+ * @details Statically initialized rings require no explicit
+ *          initialization using @p chRingObjectInit().
+ *
+ * @param[in] name      the name of the ring variable
+ * @param[in] buffer    pointer to the ring buffer
+ * @param[in] esize     size of an element
+ * @param[in] n         number of elements in the buffer, must be a power
+ *                      of two
+ */
+#define RING_DECL(name, buffer, esize, n)                                   \
+  spsc_ring_t name = __RING_DATA(name, buffer, esize, n)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chRingObjectInit(spsc_ring_t *rp, void *buffer, size_t esize, size_t n);
+  size_t chRingWriteX(spsc_ring_t *rp, const void *ep, size_t n);
+  size_t chRingReadX(spsc_ring_t *rp, void *ep, size_t n);
+  msg_t chRingWaitTimeout(spsc_ring_t *rp, size_t n, sysinterval_t timeout);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the ring size in elements.
+ *
+ * @param[in] rp        the pointer to an initialized @p spsc_ring_t object
+ * @return              The size of the ring.
+ *
+ * @xclass
+ */
+static inline size_t chRingGetSizeX(const spsc_ring_t *rp) {
+
+  return rp->mask + (size_t)1;
+}
+
+/**
+ * @brief   Returns the number of elements in the ring.
+ * @note    When called by the consumer the returned elements are all
+ *          available, more can be added meanwhile by the producer. When
+ *          called by the producer the value is an upper bound because
+ *          the consumer can only remove elements meanwhile.
+ *
+ * @param[in] rp        the pointer to an initialized @p spsc_ring_t object
+ * @return              The number of used elements.
+ *
+ * @xclass
+ */
+static inline size_t chRingGetUsedX(spsc_ring_t *rp) {
+
+  return __ring_load_acquire(&rp->wrcnt) - __ring_load_acquire(&rp->rdcnt);
+}
+
+/**
+ * @brief   Returns the number of free elements in the ring.
+ * @note    When called by the producer the returned elements are all
+ *          available, more can be freed meanwhile by the consumer. When
+ *          called by the consumer the value is an upper bound because
+ *          the producer can only fill elements meanwhile.
+ *
+ * @param[in] rp        the pointer to an initialized @p spsc_ring_t object
+ * @return              The number of free elements.
+ *
+ * @xclass
+ */
+static inline size_t chRingGetFreeX(spsc_ring_t *rp) {
+
+  return chRingGetSizeX(rp) - chRingGetUsedX(rp);
+}
+
+#endif /* CH_CFG_USE_RINGS == TRUE */
+
+#endif /* CHRINGS_H */
+
+/** @} */
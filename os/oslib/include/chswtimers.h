@@ -0,0 +1,239 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+/**
+ * @file    oslib/include/chswtimers.h
+ * @brief   Software timers macros and structures.
+ *
+ * @addtogroup oslib_swtimers
+ * @{
+ */
+
+#ifndef CHSWTIMERS_H
+#define CHSWTIMERS_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Software timers APIs.
+ * @details If enabled then the software timers service APIs are included
+ *          in the library.
+ */
+#if !defined(CH_CFG_USE_SWTIMERS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_SWTIMERS                 FALSE
+#endif
+
+/**
+ * @brief   Number of slots in the timers wheel.
+ * @note    Must be a power of two.
+ */
+#if !defined(CH_CFG_SWTIMERS_WHEEL_SIZE) || defined(__DOXYGEN__)
+#define CH_CFG_SWTIMERS_WHEEL_SIZE          64
+#endif
+
+#if (CH_CFG_USE_SWTIMERS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (CH_CFG_SWTIMERS_WHEEL_SIZE < 1) ||                                     \
+    ((CH_CFG_SWTIMERS_WHEEL_SIZE & (CH_CFG_SWTIMERS_WHEEL_SIZE - 1)) != 0)
+#error "CH_CFG_SWTIMERS_WHEEL_SIZE must be a power of two"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a software timers service.
+ */
+typedef struct ch_swtimers_service swtimers_service_t;
+
+/**
+ * @brief   Type of a software timer.
+ */
+typedef struct ch_swtimer swtimer_t;
+
+/**
+ * @brief   Type of a software timer callback function.
+ */
+typedef void (*swtfunc_t)(void *p);
+
+/**
+ * @brief   Structure representing a software timer.
+ */
+struct ch_swtimer {
+  /**
+   * @brief   Next timer in the same wheel slot.
+   */
+  swtimer_t                 *next;
+  /**
+   * @brief   Pointer to the link pointing to this timer.
+   * @note    It is @p NULL when the timer is not armed.
+   */
+  swtimer_t                 **prevp;
+  /**
+   * @brief   Wheel tick of the timer expiration.
+   */
+  uint32_t                  deadline;
+  /**
+   * @brief   Reload interval in wheel ticks, zero for one-shot timers.
+   */
+  uint32_t                  reload;
+  /**
+   * @brief   Timer callback function.
+   */
+  swtfunc_t                 func;
+  /**
+   * @brief   Timer callback parameter.
+   */
+  void                      *par;
+};
+
+/**
+ * @brief   Structure representing a software timers service.
+ * @details All the timers of a service share a single kernel timeout,
+ *          the one of the service thread waiting for the next wheel
+ *          tick.
+ */
+struct ch_swtimers_service {
+  /**
+   * @brief   Duration of a wheel tick.
+   */
+  sysinterval_t             resolution;
+  /**
+   * @brief   System time of the current wheel tick.
+   */
+  systime_t                 last;
+  /**
+   * @brief   Current wheel tick.
+   */
+  uint32_t                  now;
+  /**
+   * @brief   Number of armed timers.
+   */
+  uint32_t                  armed;
+  /**
+   * @brief   Reference to the waiting service thread.
+   */
+  thread_reference_t        thread;
+  /**
+   * @brief   Expired timers waiting for their callback.
+   */
+  swtimer_t                 *expired;
+  /**
+   * @brief   Wheel slots.
+   */
+  swtimer_t                 *slots[CH_CFG_SWTIMERS_WHEEL_SIZE];
+};
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chSwtServiceObjectInit(swtimers_service_t *ssp,
+                              sysinterval_t resolution);
+  void chSwtSetI(swtimers_service_t *ssp, swtimer_t *stp,
+                 sysinterval_t delay, sysinterval_t reload,
+                 swtfunc_t func, void *par);
+  void chSwtSet(swtimers_service_t *ssp, swtimer_t *stp,
+                sysinterval_t delay, sysinterval_t reload,
+                swtfunc_t func, void *par);
+  void chSwtResetI(swtimers_service_t *ssp, swtimer_t *stp);
+  void chSwtReset(swtimers_service_t *ssp, swtimer_t *stp);
+  cnt_t chSwtDispatch(swtimers_service_t *ssp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p swtimer_t object.
+ * @note    Timer objects must be initialized before use, the functions
+ *          @p chSwtSetI() and @p chSwtResetI() unlink armed timers and
+ *          rely on the object state.
+ *
+ * @param[out] stp      pointer to a @p swtimer_t object
+ *
+ * @init
+ */
+static inline void chSwtObjectInit(swtimer_t *stp) {
+
+  stp->prevp = NULL;
+}
+
+/**
+ * @brief   Returns @p true if the specified timer is armed.
+ * @note    A timer is still armed after expiration until its callback
+ *          has been invoked by the service thread.
+ *
+ * @param[in] stp       pointer to a @p swtimer_t object
+ * @return              The timer state.
+ * @retval false        if the timer is not armed.
+ * @retval true         if the timer is armed.
+ *
+ * @iclass
+ */
+static inline bool chSwtIsArmedI(const swtimer_t *stp) {
+
+  chDbgCheckClassI();
+
+  return (bool)(stp->prevp != NULL);
+}
+
+/**
+ * @brief   Returns the number of armed timers.
+ *
+ * @param[in] ssp       pointer to a @p swtimers_service_t structure
+ * @return              The number of armed timers.
+ *
+ * @iclass
+ */
+static inline uint32_t chSwtGetArmedI(swtimers_service_t *ssp) {
+
+  chDbgCheckClassI();
+
+  return ssp->armed;
+}
+
+#endif /* CH_CFG_USE_SWTIMERS == TRUE */
+
+#endif /* CHSWTIMERS_H */
+
+/** @} */
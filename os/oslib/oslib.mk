@@ -26,15 +26,33 @@ endif
 ifneq ($(findstring CH_CFG_USE_MEMPOOLS TRUE,$(CHLIBCONF)),)
 LIBSRC += $(CHIBIOS)/os/oslib/src/chmempools.c
 endif
+ifneq ($(findstring CH_CFG_USE_OBJ_FIFOS TRUE,$(CHLIBCONF)),)
+LIBSRC += $(CHIBIOS)/os/oslib/src/chobjfifos.c
+endif
 ifneq ($(findstring CH_CFG_USE_PIPES TRUE,$(CHLIBCONF)),)
 LIBSRC += $(CHIBIOS)/os/oslib/src/chpipes.c
 endif
+ifneq ($(findstring CH_CFG_USE_RINGS TRUE,$(CHLIBCONF)),)
+LIBSRC += $(CHIBIOS)/os/oslib/src/chrings.c
+endif
+ifneq ($(findstring CH_CFG_USE_REFBUFS TRUE,$(CHLIBCONF)),)
+LIBSRC += $(CHIBIOS)/os/oslib/src/chrefbufs.c
+endif
+ifneq ($(findstring CH_CFG_USE_BUS TRUE,$(CHLIBCONF)),)
+LIBSRC += $(CHIBIOS)/os/oslib/src/chbus.c
+endif
 ifneq ($(findstring CH_CFG_USE_OBJ_CACHES TRUE,$(CHLIBCONF)),)
 LIBSRC += $(CHIBIOS)/os/oslib/src/chobjcaches.c
 endif
 ifneq ($(findstring CH_CFG_USE_DELEGATES TRUE,$(CHLIBCONF)),)
 LIBSRC += $(CHIBIOS)/os/oslib/src/chdelegates.c
 endif
+ifneq ($(findstring CH_CFG_USE_JOBS TRUE,$(CHLIBCONF)),)
+LIBSRC += $(CHIBIOS)/os/oslib/src/chjobs.c
+endif
+ifneq ($(findstring CH_CFG_USE_SWTIMERS TRUE,$(CHLIBCONF)),)
+LIBSRC += $(CHIBIOS)/os/oslib/src/chswtimers.c
+endif
 ifneq ($(findstring CH_CFG_USE_FACTORY TRUE,$(CHLIBCONF)),)
 LIBSRC += $(CHIBIOS)/os/oslib/src/chfactory.c
 endif
@@ -43,9 +61,15 @@ LIBSRC := $(CHIBIOS)/os/oslib/src/chmboxes.c \
           $(CHIBIOS)/os/oslib/src/chmemcore.c \
           $(CHIBIOS)/os/oslib/src/chmemheaps.c \
           $(CHIBIOS)/os/oslib/src/chmempools.c \
+          $(CHIBIOS)/os/oslib/src/chobjfifos.c \
           $(CHIBIOS)/os/oslib/src/chpipes.c \
+          $(CHIBIOS)/os/oslib/src/chrings.c \
+          $(CHIBIOS)/os/oslib/src/chrefbufs.c \
+          $(CHIBIOS)/os/oslib/src/chbus.c \
           $(CHIBIOS)/os/oslib/src/chobjcaches.c \
           $(CHIBIOS)/os/oslib/src/chdelegates.c \
+          $(CHIBIOS)/os/oslib/src/chjobs.c \
+          $(CHIBIOS)/os/oslib/src/chswtimers.c \
           $(CHIBIOS)/os/oslib/src/chfactory.c
 endif
 
@@ -0,0 +1,371 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    oslib/src/chbus.c
+ * @brief   Messages bus code.
+ * @details Publish/subscribe messages bus.
+ *          <h2>Operation mode</h2>
+ *          A publisher acquires a frame from the bus pool, fills it and
+ *          publishes it once. Each subscriber receives a reference to the
+ *          same frame into its own queue, no copies are made. The frame
+ *          returns into the pool when the last subscriber releases it.<br>
+ *          When a subscriber queue is full the subscriber policy decides
+ *          if the publisher waits, the oldest queued frame is dropped or
+ *          the new frame is dropped for that subscriber.
+ * @pre     In order to use the messages bus APIs the @p CH_CFG_USE_BUS
+ *          option must be enabled in @p chconf.h.
+ * @note    Compatible with RT and NIL.
+ *
+ * @addtogroup oslib_bus
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_CFG_USE_BUS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Queues a frame reference for a subscriber.
+ * @pre     The subscriber queue is not full.
+ *
+ * @param[in] sp        pointer to a @p bus_subscriber_t structure
+ * @param[in] bp        pointer to the frame
+ *
+ * @notapi
+ */
+static void bus_enqueue_i(bus_subscriber_t *sp, refbuf_t *bp) {
+  size_t wridx;
+
+  wridx = sp->rdidx + sp->cnt;
+  if (wridx >= sp->size) {
+    wridx -= sp->size;
+  }
+  sp->buffer[wridx] = chRefBufAddRefX(bp);
+  sp->cnt++;
+  chThdDequeueNextI(&sp->rqueue, MSG_OK);
+}
+
+/**
+ * @brief   Removes the oldest frame reference from a subscriber queue.
+ * @pre     The subscriber queue is not empty.
+ *
+ * @param[in] sp        pointer to a @p bus_subscriber_t structure
+ * @return              The pointer to the frame.
+ *
+ * @notapi
+ */
+static refbuf_t *bus_dequeue_i(bus_subscriber_t *sp) {
+  refbuf_t *bp;
+
+  bp = sp->buffer[sp->rdidx];
+  if (++sp->rdidx >= sp->size) {
+    sp->rdidx = (size_t)0;
+  }
+  sp->cnt--;
+  chThdDequeueNextI(&sp->wqueue, MSG_OK);
+
+  return bp;
+}
+
+/**
+ * @brief   Handles a full subscriber queue without waiting.
+ *
+ * @param[in] sp        pointer to a @p bus_subscriber_t structure
+ * @return              The operation result.
+ * @retval true         if a slot has been made available.
+ * @retval false        if the frame must be dropped for this subscriber.
+ *
+ * @notapi
+ */
+static bool bus_make_room_i(bus_subscriber_t *sp) {
+
+  sp->dropped++;
+  if (sp->policy == BUS_POLICY_DROP_OLDEST) {
+    chRefBufReleaseI(bus_dequeue_i(sp));
+    return true;
+  }
+
+  return false;
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p msg_bus_t object.
+ *
+ * @param[out] busp     pointer to a @p msg_bus_t structure
+ * @param[in] rbpp      pointer to the pool of the bus frames
+ *
+ * @init
+ */
+void chBusObjectInit(msg_bus_t *busp, refbuf_pool_t *rbpp) {
+
+  chDbgCheck((busp != NULL) && (rbpp != NULL));
+
+  busp->pool        = rbpp;
+  busp->subscribers = NULL;
+}
+
+/**
+ * @brief   Attaches a subscriber to a bus.
+ *
+ * @param[in] busp      pointer to a @p msg_bus_t structure
+ * @param[out] sp       pointer to the @p bus_subscriber_t structure to be
+ *                      initialized
+ * @param[in] buffer    pointer to the frames queue buffer
+ * @param[in] n         number of frames the queue can hold
+ * @param[in] policy    policy applied when the queue is full:
+ *                      - @a BUS_POLICY_BLOCK the publisher waits.
+ *                      - @a BUS_POLICY_DROP_OLDEST the oldest frame is
+ *                        dropped.
+ *                      - @a BUS_POLICY_DROP_NEWEST the published frame is
+ *                        dropped.
+ *                      .
+ *
+ * @api
+ */
+void chBusSubscribe(msg_bus_t *busp, bus_subscriber_t *sp,
+                    refbuf_t **buffer, size_t n, unsigned policy) {
+
+  chDbgCheck((busp != NULL) && (sp != NULL) && (buffer != NULL) &&
+             (n > 0U) && (policy <= BUS_POLICY_DROP_NEWEST));
+
+  sp->bus     = busp;
+  sp->buffer  = buffer;
+  sp->size    = n;
+  sp->cnt     = (size_t)0;
+  sp->rdidx   = (size_t)0;
+  sp->policy  = policy;
+  sp->dropped = (uint32_t)0;
+  chThdQueueObjectInit(&sp->rqueue);
+  chThdQueueObjectInit(&sp->wqueue);
+
+  chSysLock();
+  sp->next          = busp->subscribers;
+  busp->subscribers = sp;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Detaches a subscriber from its bus.
+ * @details The queued frames are released, waiting receivers and
+ *          publishers are woken up with @p MSG_RESET.
+ *
+ * @param[in] sp        pointer to a @p bus_subscriber_t structure
+ *
+ * @api
+ */
+void chBusUnsubscribe(bus_subscriber_t *sp) {
+  bus_subscriber_t **spp;
+
+  chDbgCheck(sp != NULL);
+
+  chSysLock();
+  spp = &sp->bus->subscribers;
+  while (*spp != NULL) {
+    if (*spp == sp) {
+      *spp = sp->next;
+      break;
+    }
+    spp = &(*spp)->next;
+  }
+  while (sp->cnt > 0U) {
+    chRefBufReleaseI(bus_dequeue_i(sp));
+  }
+  chThdDequeueAllI(&sp->rqueue, MSG_RESET);
+  chThdDequeueAllI(&sp->wqueue, MSG_RESET);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Publishes a frame on a bus.
+ * @details A reference to the frame is queued for each subscriber, the
+ *          caller reference is consumed. The function never waits, full
+ *          subscribers with policy @p BUS_POLICY_BLOCK lose the frame.
+ *
+ * @param[in] busp      pointer to a @p msg_bus_t structure
+ * @param[in] bp        pointer to the frame
+ * @return              The number of subscribers the frame has been
+ *                      delivered to.
+ *
+ * @iclass
+ */
+cnt_t chBusPublishI(msg_bus_t *busp, refbuf_t *bp) {
+  bus_subscriber_t *sp;
+  cnt_t n = (cnt_t)0;
+
+  chDbgCheckClassI();
+  chDbgCheck((busp != NULL) && (bp != NULL));
+
+  for (sp = busp->subscribers; sp != NULL; sp = sp->next) {
+    if ((sp->cnt < sp->size) || bus_make_room_i(sp)) {
+      bus_enqueue_i(sp, bp);
+      n++;
+    }
+  }
+  chRefBufReleaseI(bp);
+
+  return n;
+}
+
+/**
+ * @brief   Publishes a frame on a bus.
+ * @details A reference to the frame is queued for each subscriber, the
+ *          caller reference is consumed. Full subscribers with policy
+ *          @p BUS_POLICY_BLOCK are waited for, the timeout applies to
+ *          each one of them.
+ * @note    Subscribers must not be attached or detached while a publisher
+ *          is waiting on the same bus.
+ *
+ * @param[in] busp      pointer to a @p msg_bus_t structure
+ * @param[in] bp        pointer to the frame
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of subscribers the frame has been
+ *                      delivered to.
+ *
+ * @api
+ */
+cnt_t chBusPublishTimeout(msg_bus_t *busp, refbuf_t *bp,
+                          sysinterval_t timeout) {
+  bus_subscriber_t *sp;
+  cnt_t n = (cnt_t)0;
+
+  chDbgCheck((busp != NULL) && (bp != NULL));
+
+  chSysLock();
+  for (sp = busp->subscribers; sp != NULL; sp = sp->next) {
+    msg_t msg = MSG_OK;
+
+    if (sp->policy == BUS_POLICY_BLOCK) {
+      while ((sp->cnt >= sp->size) && (msg == MSG_OK)) {
+        msg = chThdEnqueueTimeoutS(&sp->wqueue, timeout);
+      }
+      if (msg == MSG_TIMEOUT) {
+        sp->dropped++;
+      }
+    }
+    else if (sp->cnt >= sp->size) {
+      if (!bus_make_room_i(sp)) {
+        msg = MSG_TIMEOUT;
+      }
+    }
+
+    if (msg == MSG_OK) {
+      bus_enqueue_i(sp, bp);
+      n++;
+    }
+  }
+  chRefBufReleaseI(bp);
+  chSchRescheduleS();
+  chSysUnlock();
+
+  return n;
+}
+
+/**
+ * @brief   Receives a frame from a subscriber queue.
+ * @details The reference is transferred to the caller which is
+ *          responsible for releasing it.
+ *
+ * @param[in] sp        pointer to a @p bus_subscriber_t structure
+ * @return              The pointer to the frame.
+ * @retval NULL         if the queue is empty.
+ *
+ * @iclass
+ */
+refbuf_t *chBusReceiveI(bus_subscriber_t *sp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(sp != NULL);
+
+  if (sp->cnt == 0U) {
+    return NULL;
+  }
+
+  return bus_dequeue_i(sp);
+}
+
+/**
+ * @brief   Receives a frame from a subscriber queue.
+ * @details The reference is transferred to the caller which is
+ *          responsible for releasing it.
+ *
+ * @param[in] sp        pointer to a @p bus_subscriber_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The pointer to the frame.
+ * @retval NULL         if the operation timed out or the subscriber has
+ *                      been detached.
+ *
+ * @api
+ */
+refbuf_t *chBusReceiveTimeout(bus_subscriber_t *sp, sysinterval_t timeout) {
+  refbuf_t *bp = NULL;
+  msg_t msg = MSG_OK;
+
+  chDbgCheck(sp != NULL);
+
+  chSysLock();
+  while ((sp->cnt == 0U) && (msg == MSG_OK)) {
+    msg = chThdEnqueueTimeoutS(&sp->rqueue, timeout);
+  }
+  if (msg == MSG_OK) {
+    bp = bus_dequeue_i(sp);
+    chSchRescheduleS();
+  }
+  chSysUnlock();
+
+  return bp;
+}
+
+#endif /* CH_CFG_USE_BUS == TRUE */
+
+/** @} */
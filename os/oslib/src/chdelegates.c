@@ -27,6 +27,12 @@
  *          encapsulating a library not designed for threading into a
  *          delegate thread. Other threads have access to the library without
  *          having to worry about mutual exclusion.
+ *          <h2>Asynchronous calls</h2>
+ *          Asynchronous calls are queued on a calls queue and served by
+ *          one or more threads calling @p chDelegateAsyncDispatchTimeout().
+ *          The caller is not blocked, the returned call object is a
+ *          future that can be polled, waited with a timeout or configured
+ *          to signal an event on completion.
  * @pre     In order to use the pipes APIs the @p CH_CFG_USE_DELEGATES
  *          option must be enabled in @p chconf.h.
  * @note    Compatible with RT and NIL.
@@ -73,6 +79,63 @@ typedef struct {
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_DELEGATES_HAS_ASYNC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Invokes the function of an asynchronous call.
+ *
+ * @param[in] dcp       pointer to the call object
+ * @return              The function return value.
+ *
+ * @notapi
+ */
+static msg_t async_invoke(const delegate_call_t *dcp) {
+
+  switch (dcp->argc) {
+  case 0U:
+    return dcp->func.fn0();
+  case 1U:
+    return dcp->func.fn1(dcp->args[0]);
+  case 2U:
+    return dcp->func.fn2(dcp->args[0], dcp->args[1]);
+  case 3U:
+    return dcp->func.fn3(dcp->args[0], dcp->args[1], dcp->args[2]);
+  default:
+    return dcp->func.fn4(dcp->args[0], dcp->args[1], dcp->args[2],
+                         dcp->args[3]);
+  }
+}
+
+/**
+ * @brief   Marks an asynchronous call as completed.
+ *
+ * @param[in] dap       pointer to a @p delegate_async_t structure
+ * @param[in] dcp       pointer to the call object
+ * @param[in] ret       the function return value
+ *
+ * @notapi
+ */
+static void async_complete_i(delegate_async_t *dap,
+                             delegate_call_t *dcp,
+                             msg_t ret) {
+
+  dcp->ret   = ret;
+  dcp->state = DELEGATE_CALL_DONE;
+
+  /* Nobody is interested in a released call, returning it to the pool.*/
+  if (dcp->released) {
+    chGuardedPoolFreeI(&dap->free, (void *)dcp);
+    return;
+  }
+
+  chThdResumeI(&dcp->waiter, MSG_OK);
+#if CH_CFG_USE_EVENTS == TRUE
+  if (dcp->evtp != NULL) {
+    chEvtSignalI(dcp->evtp, dcp->events);
+  }
+#endif
+}
+#endif /* CH_DELEGATES_HAS_ASYNC == TRUE */
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -234,6 +297,249 @@ msg_t chDelegateDispatchTimeout(sysinterval_t timeout) {
   return MSG_OK;
 }
 
+#if (CH_DELEGATES_HAS_ASYNC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes an asynchronous delegate calls queue.
+ *
+ * @param[out] dap      pointer to a @p delegate_async_t structure
+ * @param[in] callsn    number of call objects available
+ * @param[in] callsbuf  pointer to the buffer of call objects, it must be
+ *                      able to hold @p callsn @p delegate_call_t structures
+ *
+ * @init
+ */
+void chDelegateAsyncObjectInit(delegate_async_t *dap,
+                               size_t callsn,
+                               delegate_call_t *callsbuf) {
+
+  chDbgCheck((dap != NULL) && (callsn > 0U) && (callsbuf != NULL));
+
+  chGuardedPoolObjectInit(&dap->free, sizeof (delegate_call_t));
+  chGuardedPoolLoadArray(&dap->free, (void *)callsbuf, callsn);
+  chSemObjectInit(&dap->pending, (cnt_t)0);
+  dap->head = NULL;
+  dap->tail = NULL;
+}
+
+/**
+ * @brief   Posts an asynchronous call.
+ * @pre     The function and parameters fields of the call object must
+ *          have been initialized.
+ *
+ * @param[in] dap       pointer to a @p delegate_async_t structure
+ * @param[in] dcp       pointer to the call object
+ *
+ * @iclass
+ */
+void chDelegateAsyncPostI(delegate_async_t *dap, delegate_call_t *dcp) {
+
+  chDbgCheckClassI();
+  chDbgCheck((dap != NULL) && (dcp != NULL) && (dcp->argc <= 4U));
+
+  dcp->next     = NULL;
+  dcp->state    = DELEGATE_CALL_QUEUED;
+  dcp->released = false;
+  dcp->waiter   = NULL;
+#if CH_CFG_USE_EVENTS == TRUE
+  dcp->evtp     = NULL;
+#endif
+
+  /* Appending the call on the queue tail.*/
+  if (dap->tail == NULL) {
+    dap->head = dcp;
+  }
+  else {
+    dap->tail->next = dcp;
+  }
+  dap->tail = dcp;
+
+  chSemSignalI(&dap->pending);
+}
+
+/**
+ * @brief   Posts an asynchronous call.
+ * @pre     The function and parameters fields of the call object must
+ *          have been initialized.
+ *
+ * @param[in] dap       pointer to a @p delegate_async_t structure
+ * @param[in] dcp       pointer to the call object
+ *
+ * @api
+ */
+void chDelegateAsyncPost(delegate_async_t *dap, delegate_call_t *dcp) {
+
+  chSysLock();
+  chDelegateAsyncPostI(dap, dcp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Asynchronous calls dispatching with timeout.
+ * @details The function awaits for queued calls then serves up to
+ *          @p CH_CFG_DELEGATES_ASYNC_BATCH of them before returning.
+ *
+ * @param[in] dap       pointer to a @p delegate_async_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The function outcome.
+ * @retval MSG_OK       if at least a function has been called.
+ * @retval MSG_TIMEOUT  if a timeout occurred.
+ *
+ * @api
+ */
+msg_t chDelegateAsyncDispatchTimeout(delegate_async_t *dap,
+                                     sysinterval_t timeout) {
+  delegate_call_t *dcp, *batch;
+  msg_t msg;
+  unsigned n;
+
+  chDbgCheck(dap != NULL);
+
+  chSysLock();
+
+  msg = chSemWaitTimeoutS(&dap->pending, timeout);
+  if (msg != MSG_OK) {
+    chSysUnlock();
+    return msg;
+  }
+
+  /* Detaching the first call and, if more are queued, up to a batch.*/
+  batch = dap->head;
+  dcp   = batch;
+  n     = 1U;
+  while ((n < (unsigned)CH_CFG_DELEGATES_ASYNC_BATCH) &&
+         (chSemGetCounterI(&dap->pending) > (cnt_t)0)) {
+    chSemFastWaitI(&dap->pending);
+    dcp = dcp->next;
+    n++;
+  }
+  dap->head = dcp->next;
+  if (dap->head == NULL) {
+    dap->tail = NULL;
+  }
+  dcp->next = NULL;
+
+  chSysUnlock();
+
+  /* Serving the detached calls.*/
+  while (batch != NULL) {
+    msg_t ret;
+
+    dcp   = batch;
+    batch = dcp->next;
+
+    dcp->state = DELEGATE_CALL_RUNNING;
+    ret = async_invoke(dcp);
+
+    chSysLock();
+    async_complete_i(dap, dcp, ret);
+    chSchRescheduleS();
+    chSysUnlock();
+  }
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Waits for an asynchronous call to complete.
+ * @note    Only one thread can wait on a call future.
+ *
+ * @param[in] dcp       pointer to the call future
+ * @param[out] retp     pointer to the returned value or @p NULL
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the call has been completed.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chDelegateFutureWaitTimeout(delegate_call_t *dcp,
+                                  msg_t *retp,
+                                  sysinterval_t timeout) {
+  msg_t msg = MSG_OK;
+
+  chDbgCheck(dcp != NULL);
+
+  chSysLock();
+  chDbgAssert(!dcp->released, "released future");
+  if (dcp->state != DELEGATE_CALL_DONE) {
+    msg = chThdSuspendTimeoutS(&dcp->waiter, timeout);
+  }
+  if ((msg == MSG_OK) && (retp != NULL)) {
+    *retp = dcp->ret;
+  }
+  chSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Releases an asynchronous call future.
+ * @details If the call has not been completed yet then the call object
+ *          is returned to the pool after completion.
+ * @note    The future must not be accessed after release.
+ *
+ * @param[in] dap       pointer to a @p delegate_async_t structure
+ * @param[in] dcp       pointer to the call future
+ *
+ * @api
+ */
+void chDelegateFutureRelease(delegate_async_t *dap, delegate_call_t *dcp) {
+
+  chDbgCheck((dap != NULL) && (dcp != NULL));
+
+  chSysLock();
+  chDbgAssert(dcp->waiter == NULL, "future has waiter");
+  if (dcp->state == DELEGATE_CALL_DONE) {
+    chGuardedPoolFreeI(&dap->free, (void *)dcp);
+    chSchRescheduleS();
+  }
+  else {
+    dcp->released = true;
+  }
+  chSysUnlock();
+}
+
+#if (CH_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Requests an events signal on asynchronous call completion.
+ * @note    If the call has already been completed then the events are
+ *          signaled immediately.
+ *
+ * @param[in] dcp       pointer to the call future
+ * @param[in] tp        the thread to be signaled
+ * @param[in] events    the events set to be signaled
+ *
+ * @api
+ */
+void chDelegateFutureAttachEvent(delegate_call_t *dcp,
+                                 thread_t *tp,
+                                 eventmask_t events) {
+
+  chDbgCheck((dcp != NULL) && (tp != NULL));
+
+  chSysLock();
+  if (dcp->state == DELEGATE_CALL_DONE) {
+    chEvtSignalI(tp, events);
+    chSchRescheduleS();
+  }
+  else {
+    dcp->evtp   = tp;
+    dcp->events = events;
+  }
+  chSysUnlock();
+}
+#endif /* CH_CFG_USE_EVENTS == TRUE */
+#endif /* CH_DELEGATES_HAS_ASYNC == TRUE */
+
 #endif /* CH_CFG_USE_DELEGATES == TRUE */
 
 /** @} */
@@ -95,15 +95,58 @@ static void copy_name(const char *sp, char *dp) {
   } while ((c != (char)0) && (i > 0U));
 }
 
-static inline void dyn_list_init(dyn_list_t *dlp) {
+#if (CH_CFG_FACTORY_HASH_BUCKETS > 0) || defined(__DOXYGEN__)
+static unsigned dyn_hash_name(const char *name) {
+  uint32_t h;
+  unsigned i;
+
+  /* FNV-1a hash of the name, only the stored part of the name is
+     considered.*/
+  h = 2166136261U;
+  for (i = 0U; i < (unsigned)CH_CFG_FACTORY_MAX_NAMES_LENGTH; i++) {
+    char c = name[i];
+
+    if (c == (char)0) {
+      break;
+    }
+    h = (h ^ (uint32_t)(uint8_t)c) * 16777619U;
+  }
+
+  return (unsigned)(h & ((uint32_t)CH_CFG_FACTORY_HASH_BUCKETS - 1U));
+}
+#endif
+
+static inline unsigned dyn_list_bucket(const char *name) {
 
-  dlp->next = (dyn_element_t *)dlp;
+#if CH_CFG_FACTORY_HASH_BUCKETS > 0
+  return dyn_hash_name(name);
+#else
+  (void)name;
+
+  return 0U;
+#endif
+}
+
+static void dyn_list_init(dyn_list_t *dlp) {
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)CH_FACTORY_LISTS_NUM; i++) {
+    dlp->next[i] = (dyn_element_t *)&dlp->next[i];
+  }
+}
+
+static void dyn_list_insert(dyn_element_t *element, dyn_list_t *dlp) {
+  unsigned i = dyn_list_bucket(element->name);
+
+  element->next = dlp->next[i];
+  dlp->next[i] = element;
 }
 
 static dyn_element_t *dyn_list_find(const char *name, dyn_list_t *dlp) {
-  dyn_element_t *p = dlp->next;
+  unsigned i = dyn_list_bucket(name);
+  dyn_element_t *p = dlp->next[i];
 
-  while (p != (dyn_element_t *)dlp) {
+  while (p != (dyn_element_t *)&dlp->next[i]) {
     if (strncmp(p->name, name, CH_CFG_FACTORY_MAX_NAMES_LENGTH) == 0) {
       return p;
     }
@@ -115,18 +158,19 @@ static dyn_element_t *dyn_list_find(const char *name, dyn_list_t *dlp) {
 
 static dyn_element_t *dyn_list_unlink(dyn_element_t *element,
                                       dyn_list_t *dlp) {
-  dyn_element_t *prev = (dyn_element_t *)dlp;
+  unsigned i = dyn_list_bucket(element->name);
+  dyn_element_t **pp = &dlp->next[i];
 
   /* Scanning the list.*/
-  while (prev->next != (dyn_element_t *)dlp) {
-    if (prev->next == element) {
+  while (*pp != (dyn_element_t *)&dlp->next[i]) {
+    if (*pp == element) {
       /* Found.*/
-      prev->next = element->next;
+      *pp = element->next;
       return element;
     }
 
     /* Next element in the list.*/
-    prev = prev->next;
+    pp = &(*pp)->next;
   }
 
   return NULL;
@@ -156,10 +200,9 @@ static dyn_element_t *dyn_create_object_heap(const char *name,
   /* Initializing object list element.*/
   copy_name(name, dep->name);
   dep->refs = (ucnt_t)1;
-  dep->next = dlp->next;
 
   /* Updating factory list.*/
-  dlp->next = dep;
+  dyn_list_insert(dep, dlp);
 
   return dep;
 }
@@ -201,10 +244,9 @@ static dyn_element_t *dyn_create_object_pool(const char *name,
   /* Initializing object list element.*/
   copy_name(name, dep->name);
   dep->refs = (ucnt_t)1;
-  dep->next = dlp->next;
 
   /* Updating factory list.*/
-  dlp->next = (dyn_element_t *)dep;
+  dyn_list_insert(dep, dlp);
 
   return dep;
 }
@@ -355,19 +397,26 @@ registered_object_t *chFactoryFindObject(const char *name) {
  * @api
  */
 registered_object_t *chFactoryFindObjectByPointer(void *objp) {
-  registered_object_t *rop = (registered_object_t *)ch_factory.obj_list.next;
+  unsigned i;
 
   F_LOCK();
 
-  while ((void *)rop != (void *)&ch_factory.obj_list) {
-    if (rop->objp == objp) {
-      rop->element.refs++;
+  /* Objects are not indexed by pointer, all lists must be scanned.*/
+  for (i = 0U; i < (unsigned)CH_FACTORY_LISTS_NUM; i++) {
+    dyn_element_t *dep = ch_factory.obj_list.next[i];
+
+    while (dep != (dyn_element_t *)&ch_factory.obj_list.next[i]) {
+      registered_object_t *rop = (registered_object_t *)dep;
+
+      if (rop->objp == objp) {
+        rop->element.refs++;
 
-      F_UNLOCK();
+        F_UNLOCK();
 
-      return rop;
+        return rop;
+      }
+      dep = dep->next;
     }
-    rop = (registered_object_t *)rop->element.next;
   }
 
   F_UNLOCK();
@@ -0,0 +1,796 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    oslib/src/chjobs.c
+ * @brief   Jobs Executors code.
+ * @details Jobs Executors.
+ *          <h2>Operation mode</h2>
+ *          A jobs executor owns a set of worker threads and a pool of job
+ *          objects. Jobs are posted on one of @p CH_CFG_JOBS_EXEC_LANES
+ *          priority lanes, workers always serve the highest priority lane
+ *          first. When all workers are busy and jobs accumulate a worker
+ *          takes up to @p CH_CFG_JOBS_EXEC_BATCH jobs on each wakeup.
+ *          <h2>Work stealing</h2>
+ *          A work-stealing group has one jobs queue for each worker,
+ *          normally one worker is started on each OS instance. Jobs
+ *          posted by a worker are queued on the worker own queue, other
+ *          jobs are queued on the workers of the current instance. An
+ *          idle worker steals the oldest job from the queues of the
+ *          other workers, idle workers on other instances are woken up
+ *          by the scheduler using @p chSysNotifyInstance().
+ * @pre     In order to use the jobs executors APIs the @p CH_CFG_USE_JOBS
+ *          and @p CH_CFG_USE_WAITEXIT options must be enabled in
+ *          @p chconf.h.
+ * @note    Compatible with RT and NIL.
+ *
+ * @addtogroup oslib_jobs_queues
+ * @{
+ */
+
+#include "ch.h"
+
+#if ((CH_CFG_USE_JOBS == TRUE) && (CH_CFG_USE_WAITEXIT == TRUE)) ||         \
+    defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Removes the highest priority job from the lanes.
+ * @pre     At least one job must be queued.
+ *
+ * @param[in] jep       pointer to a @p jobs_executor_t structure
+ * @return              The pointer to the job object.
+ *
+ * @notapi
+ */
+static exec_job_t *exec_take_s(jobs_executor_t *jep) {
+  exec_lane_t *lp = &jep->lanes[0];
+  exec_job_t *jp;
+
+  while (lp->head == NULL) {
+    lp++;
+    chDbgAssert(lp < &jep->lanes[CH_CFG_JOBS_EXEC_LANES], "lanes empty");
+  }
+
+  jp = lp->head;
+  lp->head = jp->next;
+  if (lp->head == NULL) {
+    lp->tail = NULL;
+  }
+
+  return jp;
+}
+
+/**
+ * @brief   Executes a job and returns it to the pool.
+ *
+ * @param[in] jep       pointer to a @p jobs_executor_t structure
+ * @param[in] jp        pointer to the job object
+ *
+ * @notapi
+ */
+static void exec_run(jobs_executor_t *jep, exec_job_t *jp) {
+#if CH_CFG_JOBS_EXEC_STATISTICS == TRUE
+  rtcnt_t start, queued, elapsed;
+
+  start = chSysGetRealtimeCounterX();
+#endif
+
+  /* Invoking the job function.*/
+  jp->jobfunc(jp->jobarg);
+
+#if CH_CFG_JOBS_EXEC_STATISTICS == TRUE
+  elapsed = chSysGetRealtimeCounterX() - start;
+  queued  = start - jp->posted;
+
+  chSysLock();
+  jep->stats.n++;
+  jep->stats.queue_cumulative += (uint64_t)queued;
+  if (queued > jep->stats.queue_worst) {
+    jep->stats.queue_worst = queued;
+  }
+  jep->stats.exec_cumulative += (uint64_t)elapsed;
+  if (elapsed > jep->stats.exec_worst) {
+    jep->stats.exec_worst = elapsed;
+  }
+  chSysUnlock();
+#endif
+
+  /* Returning the job descriptor object.*/
+  chGuardedPoolFree(&jep->free, (void *)jp);
+}
+
+/**
+ * @brief   Worker thread function.
+ *
+ * @param[in] arg       pointer to a @p jobs_executor_t structure
+ */
+static THD_FUNCTION(exec_worker, arg) {
+  jobs_executor_t *jep = (jobs_executor_t *)arg;
+  exec_job_t *batch[CH_CFG_JOBS_EXEC_BATCH];
+
+  while (true) {
+    ucnt_t i, n;
+
+    chSysLock();
+
+    /* Waiting for jobs, the semaphore is reset on shutdown.*/
+    if (jep->stopping || (chSemWaitS(&jep->pending) != MSG_OK)) {
+      chSysUnlock();
+      break;
+    }
+
+    /* Taking more jobs only if they are accumulating, if other workers
+       were waiting then the semaphore counter would not be positive.*/
+    batch[0] = exec_take_s(jep);
+    n = (ucnt_t)1;
+    while ((n < (ucnt_t)CH_CFG_JOBS_EXEC_BATCH) &&
+           (chSemGetCounterI(&jep->pending) > (cnt_t)0)) {
+      chSemFastWaitI(&jep->pending);
+      batch[n++] = exec_take_s(jep);
+    }
+
+    chSysUnlock();
+
+    for (i = (ucnt_t)0; i < n; i++) {
+      exec_run(jep, batch[i]);
+    }
+
+    chSysLock();
+
+    /* Waking up the threads waiting for the executor to become idle, the
+       count includes the jobs still queued in the lanes.*/
+    jep->outstanding -= n;
+    if (jep->outstanding == (ucnt_t)0) {
+      chThdDequeueAllI(&jep->drainq, MSG_OK);
+      chSchRescheduleS();
+    }
+
+    chSysUnlock();
+  }
+}
+
+#if (CH_JOBS_HAS_SMP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Removes the oldest job from a worker queue.
+ *
+ * @param[in] lp        pointer to the worker queue
+ * @return              The pointer to the job object.
+ * @retval NULL         if the queue is empty.
+ *
+ * @notapi
+ */
+static exec_job_t *smp_take_s(exec_lane_t *lp) {
+  exec_job_t *jp;
+
+  jp = lp->head;
+  if (jp != NULL) {
+    lp->head = jp->next;
+    if (lp->head == NULL) {
+      lp->tail = NULL;
+    }
+  }
+
+  return jp;
+}
+
+/**
+ * @brief   Steals a job from the other workers of a group.
+ *
+ * @param[in] jsp       pointer to a @p jobs_smp_t structure
+ * @param[in] wp        pointer to the stealing worker
+ * @return              The pointer to the job object.
+ * @retval NULL         if all queues are empty.
+ *
+ * @notapi
+ */
+static exec_job_t *smp_steal_s(jobs_smp_t *jsp, smp_worker_t *wp) {
+  ucnt_t i, n;
+
+  /* Scanning the other workers starting from the next one, this way
+     thieves do not all hit the same victim.*/
+  i = (ucnt_t)(wp - &jsp->workers[0]);
+  for (n = (ucnt_t)1; n < jsp->nworkers; n++) {
+    exec_job_t *jp;
+
+    i = (i + (ucnt_t)1) % jsp->nworkers;
+    jp = smp_take_s(&jsp->workers[i].queue);
+    if (jp != NULL) {
+      wp->stolen++;
+      return jp;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief   Selects the worker receiving a posted job.
+ *
+ * @param[in] jsp       pointer to a @p jobs_smp_t structure
+ * @return              The pointer to the selected worker.
+ *
+ * @notapi
+ */
+static smp_worker_t *smp_target_s(jobs_smp_t *jsp) {
+  thread_t *tp = chThdGetSelfX();
+  smp_worker_t *wp;
+  ucnt_t n;
+
+  /* Jobs posted by a worker are queued on its own queue.*/
+  for (n = (ucnt_t)0; n < jsp->nworkers; n++) {
+    wp = &jsp->workers[n];
+    if (wp->thread == tp) {
+      return wp;
+    }
+  }
+
+  /* Other jobs are distributed among the workers of the current instance,
+     any worker if none is running on this instance.*/
+  for (n = (ucnt_t)0; n <= jsp->nworkers; n++) {
+    wp = &jsp->workers[jsp->next];
+    jsp->next = (jsp->next + (ucnt_t)1) % jsp->nworkers;
+    if ((wp->thread->owner == currcore) || (n == jsp->nworkers)) {
+      break;
+    }
+  }
+
+  return wp;
+}
+
+/**
+ * @brief   Work-stealing worker thread function.
+ *
+ * @param[in] arg       pointer to a @p smp_worker_t structure
+ */
+static THD_FUNCTION(smp_worker, arg) {
+  smp_worker_t *wp = (smp_worker_t *)arg;
+  jobs_smp_t *jsp = wp->group;
+
+  chSysLock();
+
+  wp->thread = chThdGetSelfX();
+  while (!jsp->stopping) {
+    exec_job_t *jp;
+
+    /* Own jobs first then stealing, waiting if there is nothing to do.*/
+    jp = smp_take_s(&wp->queue);
+    if (jp == NULL) {
+      jp = smp_steal_s(jsp, wp);
+      if (jp == NULL) {
+        (void) chThdSuspendTimeoutS(&wp->idle, TIME_INFINITE);
+        continue;
+      }
+    }
+
+    chSysUnlock();
+
+    /* Invoking the job function then returning the job descriptor.*/
+    jp->jobfunc(jp->jobarg);
+    chGuardedPoolFree(&jsp->free, (void *)jp);
+
+    chSysLock();
+
+    /* Waking up the threads waiting for the group to become idle.*/
+    wp->executed++;
+    jsp->pending--;
+    if (jsp->pending == (ucnt_t)0) {
+      chThdDequeueAllI(&jsp->drainq, MSG_OK);
+      chSchRescheduleS();
+    }
+  }
+
+  chSysUnlock();
+}
+#endif /* CH_JOBS_HAS_SMP == TRUE */
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a jobs executor object.
+ *
+ * @param[out] jep      pointer to a @p jobs_executor_t structure
+ * @param[in] jobsn     number of jobs available
+ * @param[in] jobsbuf   pointer to the buffer of jobs, it must be able
+ *                      to hold @p jobsn @p exec_job_t structures
+ *
+ * @init
+ */
+void chJobExecObjectInit(jobs_executor_t *jep,
+                         size_t jobsn,
+                         exec_job_t *jobsbuf) {
+  unsigned i;
+
+  chDbgCheck((jep != NULL) && (jobsn > 0U) && (jobsbuf != NULL));
+
+  chGuardedPoolObjectInit(&jep->free, sizeof (exec_job_t));
+  chGuardedPoolLoadArray(&jep->free, (void *)jobsbuf, jobsn);
+  chSemObjectInit(&jep->pending, (cnt_t)0);
+  for (i = 0U; i < (unsigned)CH_CFG_JOBS_EXEC_LANES; i++) {
+    jep->lanes[i].head = NULL;
+    jep->lanes[i].tail = NULL;
+  }
+  jep->outstanding = (ucnt_t)0;
+  chThdQueueObjectInit(&jep->drainq);
+  jep->stopping    = false;
+  jep->nworkers    = (ucnt_t)0;
+#if CH_CFG_JOBS_EXEC_STATISTICS == TRUE
+  jep->stats.n                = (ucnt_t)0;
+  jep->stats.queue_worst      = (rtcnt_t)0;
+  jep->stats.queue_cumulative = (uint64_t)0;
+  jep->stats.exec_worst       = (rtcnt_t)0;
+  jep->stats.exec_cumulative  = (uint64_t)0;
+#endif
+}
+
+/**
+ * @brief   Starts the worker threads of a jobs executor.
+ * @note    The working area should be allocated using
+ *          @p JOBS_EXEC_WORKING_AREA() with the same @p n and @p size
+ *          values.
+ *
+ * @param[in] jep       pointer to a @p jobs_executor_t structure
+ * @param[in] wbase     pointer to the workers working area
+ * @param[in] n         number of worker threads to be started
+ * @param[in] size      stack size of each worker thread
+ * @param[in] prio      priority of the worker threads
+ *
+ * @api
+ */
+void chJobExecStart(jobs_executor_t *jep,
+                    void *wbase,
+                    ucnt_t n,
+                    size_t size,
+                    tprio_t prio) {
+  stkalign_t *wp = (stkalign_t *)wbase;
+  size_t wsize = THD_WORKING_AREA_SIZE(size) / sizeof (stkalign_t);
+
+  chDbgCheck((jep != NULL) && (wbase != NULL) && (n > (ucnt_t)0) &&
+             ((jep->nworkers + n) <= (ucnt_t)CH_CFG_JOBS_EXEC_MAX_WORKERS));
+
+  jep->stopping = false;
+  while (n > (ucnt_t)0) {
+    thread_descriptor_t td = {
+      .name     = "worker",
+      .wbase    = wp,
+      .wend     = wp + wsize,
+      .prio     = prio,
+      .funcp    = exec_worker,
+      .arg      = (void *)jep
+    };
+
+    jep->workers[jep->nworkers++] = chThdCreate(&td);
+    wp += wsize;
+    n--;
+  }
+}
+
+/**
+ * @brief   Posts a job object on a priority lane.
+ * @note    By design the object can be always immediately posted.
+ *
+ * @param[in] jep       pointer to a @p jobs_executor_t structure
+ * @param[in] jp        pointer to the job object to be posted
+ * @param[in] lane      the priority lane, zero is the highest priority
+ *
+ * @iclass
+ */
+void chJobExecPostI(jobs_executor_t *jep, exec_job_t *jp, unsigned lane) {
+  exec_lane_t *lp;
+
+  chDbgCheckClassI();
+  chDbgCheck((jep != NULL) && (jp != NULL) && (jp->jobfunc != NULL) &&
+             (lane < (unsigned)CH_CFG_JOBS_EXEC_LANES));
+  chDbgAssert(!jep->stopping, "executor stopping");
+
+#if CH_CFG_JOBS_EXEC_STATISTICS == TRUE
+  jp->posted = chSysGetRealtimeCounterX();
+#endif
+
+  /* Appending the job on the lane tail.*/
+  jp->next = NULL;
+  lp = &jep->lanes[lane];
+  if (lp->tail == NULL) {
+    lp->head = jp;
+  }
+  else {
+    lp->tail->next = jp;
+  }
+  lp->tail = jp;
+  jep->outstanding++;
+
+  /* Waking up a worker, if present.*/
+  chSemSignalI(&jep->pending);
+}
+
+/**
+ * @brief   Posts a job object on a priority lane.
+ * @note    By design the object can be always immediately posted.
+ *
+ * @param[in] jep       pointer to a @p jobs_executor_t structure
+ * @param[in] jp        pointer to the job object to be posted
+ * @param[in] lane      the priority lane, zero is the highest priority
+ *
+ * @sclass
+ */
+void chJobExecPostS(jobs_executor_t *jep, exec_job_t *jp, unsigned lane) {
+
+  chDbgCheckClassS();
+
+  chJobExecPostI(jep, jp, lane);
+  chSchRescheduleS();
+}
+
+/**
+ * @brief   Posts a job object on a priority lane.
+ * @note    By design the object can be always immediately posted.
+ *
+ * @param[in] jep       pointer to a @p jobs_executor_t structure
+ * @param[in] jp        pointer to the job object to be posted
+ * @param[in] lane      the priority lane, zero is the highest priority
+ *
+ * @api
+ */
+void chJobExecPost(jobs_executor_t *jep, exec_job_t *jp, unsigned lane) {
+
+  chSysLock();
+  chJobExecPostS(jep, jp, lane);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Waits for all the posted jobs to be executed.
+ * @note    This function must not be called from a job function.
+ *
+ * @param[in] jep       pointer to a @p jobs_executor_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the executor is idle.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chJobExecDrainTimeout(jobs_executor_t *jep, sysinterval_t timeout) {
+  msg_t msg = MSG_OK;
+
+  chDbgCheck(jep != NULL);
+
+  chSysLock();
+  while (jep->outstanding > (ucnt_t)0) {
+    msg = chThdEnqueueTimeoutS(&jep->drainq, timeout);
+    if (msg != MSG_OK) {
+      break;
+    }
+  }
+  chSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Stops a jobs executor.
+ * @details The posted jobs are executed then the worker threads are
+ *          terminated, the executor can be restarted using
+ *          @p chJobExecStart().
+ * @note    No jobs must be posted while the executor is stopping.
+ * @note    This function must not be called from a job function.
+ *
+ * @param[in] jep       pointer to a @p jobs_executor_t structure
+ *
+ * @api
+ */
+void chJobExecShutdown(jobs_executor_t *jep) {
+  ucnt_t i;
+
+  chJobExecDrain(jep);
+
+  /* Releasing the waiting workers, the others will find the stop
+     condition before waiting again.*/
+  chSysLock();
+  jep->stopping = true;
+  chSemResetI(&jep->pending, (cnt_t)0);
+  chSchRescheduleS();
+  chSysUnlock();
+
+  for (i = (ucnt_t)0; i < jep->nworkers; i++) {
+    (void) chThdWait(jep->workers[i]);
+  }
+  jep->nworkers = (ucnt_t)0;
+}
+
+#if (CH_CFG_JOBS_EXEC_STATISTICS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a snapshot of the executor latency statistics.
+ *
+ * @param[in] jep       pointer to a @p jobs_executor_t structure
+ * @param[out] esp      pointer to a @p exec_stats_t structure
+ *
+ * @api
+ */
+void chJobExecGetStats(jobs_executor_t *jep, exec_stats_t *esp) {
+
+  chDbgCheck((jep != NULL) && (esp != NULL));
+
+  chSysLock();
+  *esp = jep->stats;
+  chSysUnlock();
+}
+#endif
+
+#if (CH_JOBS_HAS_SMP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a work-stealing jobs group object.
+ *
+ * @param[out] jsp      pointer to a @p jobs_smp_t structure
+ * @param[in] jobsn     number of jobs available
+ * @param[in] jobsbuf   pointer to the buffer of jobs, it must be able
+ *                      to hold @p jobsn @p exec_job_t structures
+ *
+ * @init
+ */
+void chJobSmpObjectInit(jobs_smp_t *jsp, size_t jobsn, exec_job_t *jobsbuf) {
+
+  chDbgCheck((jsp != NULL) && (jobsn > 0U) && (jobsbuf != NULL));
+
+  chGuardedPoolObjectInit(&jsp->free, sizeof (exec_job_t));
+  chGuardedPoolLoadArray(&jsp->free, (void *)jobsbuf, jobsn);
+  jsp->nworkers = (ucnt_t)0;
+  jsp->next     = (ucnt_t)0;
+  jsp->pending  = (ucnt_t)0;
+  chThdQueueObjectInit(&jsp->drainq);
+  jsp->stopping = false;
+}
+
+/**
+ * @brief   Starts a worker thread of a work-stealing jobs group.
+ *
+ * @param[in] jsp       pointer to a @p jobs_smp_t structure
+ * @param[in] oip       OS instance running the worker or @p NULL for
+ *                      the current one
+ * @param[in] wbase     pointer to the worker working area, it must be
+ *                      @p THD_WORKING_AREA_SIZE(size) bytes large
+ * @param[in] size      stack size of the worker thread
+ * @param[in] prio      priority of the worker thread
+ *
+ * @api
+ */
+void chJobSmpStart(jobs_smp_t *jsp,
+                   os_instance_t *oip,
+                   void *wbase,
+                   size_t size,
+                   tprio_t prio) {
+  smp_worker_t *wp;
+
+  chDbgCheck((jsp != NULL) && (wbase != NULL) &&
+             (jsp->nworkers < (ucnt_t)CH_CFG_JOBS_SMP_MAX_WORKERS));
+#if CH_CFG_SMP_MODE == FALSE
+  chDbgCheck((oip == NULL) || (oip == currcore));
+#endif
+
+  chSysLock();
+  jsp->stopping = false;
+  wp = &jsp->workers[jsp->nworkers];
+  wp->group      = jsp;
+  wp->queue.head = NULL;
+  wp->queue.tail = NULL;
+  wp->thread     = NULL;
+  wp->idle       = NULL;
+  wp->executed   = (ucnt_t)0;
+  wp->stolen     = (ucnt_t)0;
+  chSysUnlock();
+
+  {
+    thread_descriptor_t td = {
+      .name     = "worker",
+      .wbase    = (stkalign_t *)wbase,
+      .wend     = (stkalign_t *)wbase +
+                  (THD_WORKING_AREA_SIZE(size) / sizeof (stkalign_t)),
+      .prio     = prio,
+      .funcp    = smp_worker,
+      .arg      = (void *)wp,
+#if CH_CFG_SMP_MODE != FALSE
+      .instance = oip
+#endif
+    };
+
+#if CH_CFG_SMP_MODE == FALSE
+    (void)oip;
+#endif
+
+    wp->thread = chThdCreate(&td);
+  }
+
+  /* The worker becomes visible to posters and thieves only now.*/
+  chSysLock();
+  jsp->nworkers++;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Posts a job object on a work-stealing jobs group.
+ * @note    By design the object can be always immediately posted.
+ *
+ * @param[in] jsp       pointer to a @p jobs_smp_t structure
+ * @param[in] jp        pointer to the job object to be posted
+ *
+ * @iclass
+ */
+void chJobSmpPostI(jobs_smp_t *jsp, exec_job_t *jp) {
+  smp_worker_t *wp;
+  ucnt_t i;
+
+  chDbgCheckClassI();
+  chDbgCheck((jsp != NULL) && (jp != NULL) && (jp->jobfunc != NULL));
+  chDbgAssert(jsp->nworkers > (ucnt_t)0, "no workers");
+  chDbgAssert(!jsp->stopping, "group stopping");
+
+  /* Appending the job on the selected worker queue.*/
+  wp = smp_target_s(jsp);
+  jp->next = NULL;
+  if (wp->queue.tail == NULL) {
+    wp->queue.head = jp;
+  }
+  else {
+    wp->queue.tail->next = jp;
+  }
+  wp->queue.tail = jp;
+  jsp->pending++;
+
+  /* Waking up the selected worker if idle, else an idle worker is woken
+     up in order to steal the job.*/
+  if (wp->idle != NULL) {
+    chThdResumeI(&wp->idle, MSG_OK);
+    return;
+  }
+  for (i = (ucnt_t)0; i < jsp->nworkers; i++) {
+    if (jsp->workers[i].idle != NULL) {
+      chThdResumeI(&jsp->workers[i].idle, MSG_OK);
+      return;
+    }
+  }
+}
+
+/**
+ * @brief   Posts a job object on a work-stealing jobs group.
+ * @note    By design the object can be always immediately posted.
+ *
+ * @param[in] jsp       pointer to a @p jobs_smp_t structure
+ * @param[in] jp        pointer to the job object to be posted
+ *
+ * @sclass
+ */
+void chJobSmpPostS(jobs_smp_t *jsp, exec_job_t *jp) {
+
+  chDbgCheckClassS();
+
+  chJobSmpPostI(jsp, jp);
+  chSchRescheduleS();
+}
+
+/**
+ * @brief   Posts a job object on a work-stealing jobs group.
+ * @note    By design the object can be always immediately posted.
+ *
+ * @param[in] jsp       pointer to a @p jobs_smp_t structure
+ * @param[in] jp        pointer to the job object to be posted
+ *
+ * @api
+ */
+void chJobSmpPost(jobs_smp_t *jsp, exec_job_t *jp) {
+
+  chSysLock();
+  chJobSmpPostS(jsp, jp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Waits for all the posted jobs to be executed.
+ * @note    This function must not be called from a job function.
+ *
+ * @param[in] jsp       pointer to a @p jobs_smp_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the group is idle.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chJobSmpDrainTimeout(jobs_smp_t *jsp, sysinterval_t timeout) {
+  msg_t msg = MSG_OK;
+
+  chDbgCheck(jsp != NULL);
+
+  chSysLock();
+  while (jsp->pending > (ucnt_t)0) {
+    msg = chThdEnqueueTimeoutS(&jsp->drainq, timeout);
+    if (msg != MSG_OK) {
+      break;
+    }
+  }
+  chSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Stops a work-stealing jobs group.
+ * @details The posted jobs are executed then the worker threads are
+ *          terminated, the group can be restarted using
+ *          @p chJobSmpStart().
+ * @note    No jobs must be posted while the group is stopping.
+ * @note    This function must not be called from a job function.
+ *
+ * @param[in] jsp       pointer to a @p jobs_smp_t structure
+ *
+ * @api
+ */
+void chJobSmpShutdown(jobs_smp_t *jsp) {
+  ucnt_t i;
+
+  chJobSmpDrain(jsp);
+
+  chSysLock();
+  jsp->stopping = true;
+  for (i = (ucnt_t)0; i < jsp->nworkers; i++) {
+    chThdResumeI(&jsp->workers[i].idle, MSG_OK);
+  }
+  chSchRescheduleS();
+  chSysUnlock();
+
+  for (i = (ucnt_t)0; i < jsp->nworkers; i++) {
+    (void) chThdWait(jsp->workers[i].thread);
+  }
+  jsp->nworkers = (ucnt_t)0;
+  jsp->next     = (ucnt_t)0;
+}
+#endif /* CH_JOBS_HAS_SMP == TRUE */
+
+#endif /* (CH_CFG_USE_JOBS == TRUE) && (CH_CFG_USE_WAITEXIT == TRUE) */
+
+/** @} */
@@ -70,6 +70,83 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Wakes up a waiting reader if the watermark has been reached.
+ * @note    A single reader is woken by each operation, the reader wakes
+ *          the next one after fetching if the watermark is still reached.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ *
+ * @notapi
+ */
+static void mb_wakeup_reader_i(mailbox_t *mbp) {
+
+  if (mbp->cnt >= mbp->wm) {
+    chThdDequeueNextI(&mbp->qr, MSG_OK);
+  }
+}
+
+/**
+ * @brief   Wakes up waiting writers.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] n         maximum number of writers to be woken
+ *
+ * @notapi
+ */
+static void mb_wakeup_writers_i(mailbox_t *mbp, size_t n) {
+  threads_queue_t *tqp = &mbp->qw;
+
+  while ((n > (size_t)0) && !chThdQueueIsEmptyI(tqp)) {
+    chThdDequeueNextI(tqp, MSG_OK);
+    n--;
+  }
+}
+
+/**
+ * @brief   Moves messages into the mailbox buffer.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msgp      pointer to the messages array
+ * @param[in] n         number of messages to be moved, it must not exceed
+ *                      the free slots
+ *
+ * @notapi
+ */
+static void mb_write_i(mailbox_t *mbp, const msg_t *msgp, size_t n) {
+
+  mbp->cnt += n;
+  while (n > (size_t)0) {
+    *mbp->wrptr++ = *msgp++;
+    if (mbp->wrptr >= mbp->top) {
+      mbp->wrptr = mbp->buffer;
+    }
+    n--;
+  }
+}
+
+/**
+ * @brief   Moves messages out of the mailbox buffer.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to the messages array
+ * @param[in] n         number of messages to be moved, it must not exceed
+ *                      the used slots
+ *
+ * @notapi
+ */
+static void mb_read_i(mailbox_t *mbp, msg_t *msgp, size_t n) {
+
+  mbp->cnt -= n;
+  while (n > (size_t)0) {
+    *msgp++ = *mbp->rdptr++;
+    if (mbp->rdptr >= mbp->top) {
+      mbp->rdptr = mbp->buffer;
+    }
+    n--;
+  }
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -93,6 +170,7 @@ void chMBObjectInit(mailbox_t *mbp, msg_t *buf, size_t n) {
   mbp->wrptr  = buf;
   mbp->top    = &buf[n];
   mbp->cnt    = (size_t)0;
+  mbp->wm     = (size_t)1;
   mbp->reset  = false;
   chThdQueueObjectInit(&mbp->qw);
   chThdQueueObjectInit(&mbp->qr);
@@ -212,7 +290,7 @@ msg_t chMBPostTimeoutS(mailbox_t *mbp, msg_t msg, sysinterval_t timeout) {
       mbp->cnt++;
 
       /* If there is a reader waiting then makes it ready.*/
-      chThdDequeueNextI(&mbp->qr, MSG_OK);
+      mb_wakeup_reader_i(mbp);
       chSchRescheduleS();
 
       return MSG_OK;
@@ -259,7 +337,7 @@ msg_t chMBPostI(mailbox_t *mbp, msg_t msg) {
     mbp->cnt++;
 
     /* If there is a reader waiting then makes it ready.*/
-    chThdDequeueNextI(&mbp->qr, MSG_OK);
+    mb_wakeup_reader_i(mbp);
 
     return MSG_OK;
   }
@@ -337,7 +415,7 @@ msg_t chMBPostAheadTimeoutS(mailbox_t *mbp, msg_t msg, sysinterval_t timeout) {
       mbp->cnt++;
 
       /* If there is a reader waiting then makes it ready.*/
-      chThdDequeueNextI(&mbp->qr, MSG_OK);
+      mb_wakeup_reader_i(mbp);
       chSchRescheduleS();
 
       return MSG_OK;
@@ -384,7 +462,7 @@ msg_t chMBPostAheadI(mailbox_t *mbp, msg_t msg) {
     mbp->cnt++;
 
     /* If there is a reader waiting then makes it ready.*/
-    chThdDequeueNextI(&mbp->qr, MSG_OK);
+    mb_wakeup_reader_i(mbp);
 
     return MSG_OK;
   }
@@ -461,8 +539,10 @@ msg_t chMBFetchTimeoutS(mailbox_t *mbp, msg_t *msgp, sysinterval_t timeout) {
       }
       mbp->cnt--;
 
-      /* If there is a writer waiting then makes it ready.*/
+      /* If there is a writer waiting then makes it ready, the next reader
+         is woken if there are still enough messages.*/
       chThdDequeueNextI(&mbp->qw, MSG_OK);
+      mb_wakeup_reader_i(mbp);
       chSchRescheduleS();
 
       return MSG_OK;
@@ -508,8 +588,10 @@ msg_t chMBFetchI(mailbox_t *mbp, msg_t *msgp) {
     }
     mbp->cnt--;
 
-    /* If there is a writer waiting then makes it ready.*/
+    /* If there is a writer waiting then makes it ready, the next reader
+       is woken if there are still enough messages.*/
     chThdDequeueNextI(&mbp->qw, MSG_OK);
+    mb_wakeup_reader_i(mbp);
 
     return MSG_OK;
   }
@@ -517,6 +599,312 @@ msg_t chMBFetchI(mailbox_t *mbp, msg_t *msgp) {
   /* No message, immediate timeout.*/
   return MSG_TIMEOUT;
 }
+
+/**
+ * @brief   Posts a sequence of messages into a mailbox.
+ * @details The messages are moved in as few critical sections as possible,
+ *          the invoking thread waits for free slots until all messages have
+ *          been posted or the specified time runs out. A single waiting
+ *          reader is woken for each group of posted messages, further
+ *          readers are woken in turn as the messages are fetched.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msgp      pointer to the array of messages to be posted
+ * @param[in] n         the number of messages to be posted, the value 0 is
+ *                      reserved
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of messages effectively posted. A number
+ *                      lower than @p n means that a timeout occurred or the
+ *                      mailbox went in reset state.
+ *
+ * @api
+ */
+size_t chMBPostNTimeout(mailbox_t *mbp, const msg_t *msgp,
+                        size_t n, sysinterval_t timeout) {
+  size_t done;
+
+  chSysLock();
+  done = chMBPostNTimeoutS(mbp, msgp, n, timeout);
+  chSysUnlock();
+
+  return done;
+}
+
+/**
+ * @brief   Posts a sequence of messages into a mailbox.
+ * @details The messages are moved in as few critical sections as possible,
+ *          the invoking thread waits for free slots until all messages have
+ *          been posted or the specified time runs out. A single waiting
+ *          reader is woken for each group of posted messages, further
+ *          readers are woken in turn as the messages are fetched.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msgp      pointer to the array of messages to be posted
+ * @param[in] n         the number of messages to be posted, the value 0 is
+ *                      reserved
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of messages effectively posted. A number
+ *                      lower than @p n means that a timeout occurred or the
+ *                      mailbox went in reset state.
+ *
+ * @sclass
+ */
+size_t chMBPostNTimeoutS(mailbox_t *mbp, const msg_t *msgp,
+                         size_t n, sysinterval_t timeout) {
+  size_t max = n;
+
+  chDbgCheckClassS();
+  chDbgCheck((mbp != NULL) && (msgp != NULL) && (n > (size_t)0));
+
+  do {
+    size_t done;
+
+    /* Posting as many messages as possible.*/
+    done = chMBPostNI(mbp, msgp, n);
+    if (done > (size_t)0) {
+      msgp += done;
+      n    -= done;
+      chSchRescheduleS();
+    }
+    else if (mbp->reset) {
+      break;
+    }
+
+    if (n == (size_t)0) {
+      break;
+    }
+
+    /* No space in the queue, waiting for a slot to become available.*/
+  } while (chThdEnqueueTimeoutS(&mbp->qw, timeout) == MSG_OK);
+
+  return max - n;
+}
+
+/**
+ * @brief   Posts a sequence of messages into a mailbox.
+ * @details This variant is non-blocking, the function posts as many
+ *          messages as the free slots allow.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msgp      pointer to the array of messages to be posted
+ * @param[in] n         the maximum number of messages to be posted
+ * @return              The number of messages effectively posted, zero if
+ *                      the mailbox is full or in reset state.
+ *
+ * @iclass
+ */
+size_t chMBPostNI(mailbox_t *mbp, const msg_t *msgp, size_t n) {
+
+  chDbgCheckClassI();
+  chDbgCheck((mbp != NULL) && (msgp != NULL));
+
+  /* If the mailbox is in reset state then returns immediately.*/
+  if (mbp->reset) {
+    return (size_t)0;
+  }
+
+  if (n > chMBGetFreeCountI(mbp)) {
+    n = chMBGetFreeCountI(mbp);
+  }
+
+  if (n > (size_t)0) {
+    mb_write_i(mbp, msgp, n);
+
+    /* If there is a reader waiting then makes it ready.*/
+    mb_wakeup_reader_i(mbp);
+  }
+
+  return n;
+}
+
+/**
+ * @brief   Retrieves a sequence of messages from a mailbox.
+ * @details The invoking thread waits until the number of queued messages
+ *          reaches the mailbox watermark or the specified time runs out,
+ *          then all the available messages, up to @p n, are fetched in a
+ *          single critical section. Waiting writers are woken at most once
+ *          for each fetched group of messages.
+ * @note    Waiting readers are woken only when the watermark is reached,
+ *          so @p n must not be lower than the mailbox watermark.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to an array receiving the messages
+ * @param[in] n         the maximum number of messages to be fetched, it
+ *                      must be greater than or equal to the watermark
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of messages effectively fetched, zero if
+ *                      a timeout occurred with an empty mailbox or if the
+ *                      mailbox went in reset state.
+ *
+ * @api
+ */
+size_t chMBFetchNTimeout(mailbox_t *mbp, msg_t *msgp,
+                         size_t n, sysinterval_t timeout) {
+  size_t done;
+
+  chSysLock();
+  done = chMBFetchNTimeoutS(mbp, msgp, n, timeout);
+  chSysUnlock();
+
+  return done;
+}
+
+/**
+ * @brief   Retrieves a sequence of messages from a mailbox.
+ * @details The invoking thread waits until the number of queued messages
+ *          reaches the mailbox watermark or the specified time runs out,
+ *          then all the available messages, up to @p n, are fetched in a
+ *          single critical section. Waiting writers are woken at most once
+ *          for each fetched group of messages.
+ * @note    Waiting readers are woken only when the watermark is reached,
+ *          so @p n must not be lower than the mailbox watermark.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to an array receiving the messages
+ * @param[in] n         the maximum number of messages to be fetched, it
+ *                      must be greater than or equal to the watermark
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of messages effectively fetched, zero if
+ *                      a timeout occurred with an empty mailbox or if the
+ *                      mailbox went in reset state.
+ *
+ * @sclass
+ */
+size_t chMBFetchNTimeoutS(mailbox_t *mbp, msg_t *msgp,
+                          size_t n, sysinterval_t timeout) {
+  msg_t rdymsg = MSG_OK;
+  size_t done;
+
+  chDbgCheckClassS();
+  chDbgCheck((mbp != NULL) && (msgp != NULL) && (n >= mbp->wm));
+
+  /* Waiting for the watermark, on timeout the available messages are
+     fetched anyway.*/
+  while (!mbp->reset &&
+         (chMBGetUsedCountI(mbp) < mbp->wm) &&
+         (rdymsg == MSG_OK)) {
+    rdymsg = chThdEnqueueTimeoutS(&mbp->qr, timeout);
+  }
+
+  done = chMBFetchNI(mbp, msgp, n);
+  if (done > (size_t)0) {
+    chSchRescheduleS();
+  }
+
+  return done;
+}
+
+/**
+ * @brief   Retrieves a sequence of messages from a mailbox.
+ * @details This variant is non-blocking, the function fetches all the
+ *          available messages up to @p n.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to an array receiving the messages
+ * @param[in] n         the maximum number of messages to be fetched
+ * @return              The number of messages effectively fetched, zero if
+ *                      the mailbox is empty or in reset state.
+ *
+ * @iclass
+ */
+size_t chMBFetchNI(mailbox_t *mbp, msg_t *msgp, size_t n) {
+
+  chDbgCheckClassI();
+  chDbgCheck((mbp != NULL) && (msgp != NULL));
+
+  /* If the mailbox is in reset state then returns immediately.*/
+  if (mbp->reset) {
+    return (size_t)0;
+  }
+
+  if (n > chMBGetUsedCountI(mbp)) {
+    n = chMBGetUsedCountI(mbp);
+  }
+
+  if (n > (size_t)0) {
+    mb_read_i(mbp, msgp, n);
+
+    /* If there are writers waiting then makes them ready, the next reader
+       is woken if there are still enough messages.*/
+    mb_wakeup_writers_i(mbp, n);
+    mb_wakeup_reader_i(mbp);
+  }
+
+  return n;
+}
+
+/**
+ * @brief   Sets the readers wakeup watermark of a mailbox.
+ * @details Threads waiting for messages are woken only when the number of
+ *          queued messages reaches the watermark or when their timeout
+ *          expires, this allows readers to process messages in batches
+ *          using @p chMBFetchNTimeout().
+ * @note    The default watermark is one, a waiting reader is woken on each
+ *          posted message.
+ * @note    Readers waiting in @p chMBFetchTimeout() are also subject to the
+ *          watermark, on timeout they return @p MSG_TIMEOUT even if some
+ *          messages are queued.
+ * @note    Readers using @p chMBFetchNTimeout() must fetch at least
+ *          @p wm messages per call.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] wm        the new watermark, from one to the mailbox size
+ *
+ * @api
+ */
+void chMBSetWatermark(mailbox_t *mbp, size_t wm) {
+
+  chSysLock();
+  chMBSetWatermarkI(mbp, wm);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Sets the readers wakeup watermark of a mailbox.
+ * @details Threads waiting for messages are woken only when the number of
+ *          queued messages reaches the watermark or when their timeout
+ *          expires, this allows readers to process messages in batches
+ *          using @p chMBFetchNTimeout().
+ * @note    The default watermark is one, a waiting reader is woken on each
+ *          posted message.
+ * @note    Readers waiting in @p chMBFetchTimeout() are also subject to the
+ *          watermark, on timeout they return @p MSG_TIMEOUT even if some
+ *          messages are queued.
+ * @note    Readers using @p chMBFetchNTimeout() must fetch at least
+ *          @p wm messages per call.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] wm        the new watermark, from one to the mailbox size
+ *
+ * @iclass
+ */
+void chMBSetWatermarkI(mailbox_t *mbp, size_t wm) {
+
+  chDbgCheckClassI();
+  chDbgCheck((mbp != NULL) && (wm > (size_t)0) && (wm <= chMBGetSizeI(mbp)));
+
+  mbp->wm = wm;
+
+  /* Lowering the watermark could make the waiting readers eligible.*/
+  mb_wakeup_reader_i(mbp);
+}
 #endif /* CH_CFG_USE_MAILBOXES == TRUE */
 
 /** @} */
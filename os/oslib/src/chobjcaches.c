@@ -82,19 +82,19 @@
 }
 
 /* Insertion on LRU list head (newer objects).*/
-#define LRU_INSERT_HEAD(ocp, objp) {                                        \
-  (objp)->lru_next = (ocp)->lru.lru_next;                                   \
-  (objp)->lru_prev = (oc_object_t *)&(ocp)->lru;                            \
-  (ocp)->lru.lru_next->lru_prev = (objp);                                   \
-  (ocp)->lru.lru_next = (objp);                                             \
+#define LRU_INSERT_HEAD(lhp, objp) {                                        \
+  (objp)->lru_next = (lhp)->lru_next;                                       \
+  (objp)->lru_prev = (oc_object_t *)(lhp);                                  \
+  (lhp)->lru_next->lru_prev = (objp);                                       \
+  (lhp)->lru_next = (objp);                                                 \
 }
 
-/* Insertion on LRU list head (newer objects).*/
-#define LRU_INSERT_TAIL(ocp, objp) {                                        \
-  (objp)->lru_prev = (ocp)->lru.lru_prev;                                   \
-  (objp)->lru_next = (oc_object_t *)&(ocp)->lru;                            \
-  (ocp)->lru.lru_prev->lru_next = (objp);                                   \
-  (ocp)->lru.lru_prev = (objp);                                             \
+/* Insertion on LRU list tail (older objects).*/
+#define LRU_INSERT_TAIL(lhp, objp) {                                        \
+  (objp)->lru_prev = (lhp)->lru_prev;                                       \
+  (objp)->lru_next = (oc_object_t *)(lhp);                                  \
+  (lhp)->lru_prev->lru_next = (objp);                                       \
+  (lhp)->lru_prev = (objp);                                                 \
 }
 
 /* Removal of an object from the LRU list.*/
@@ -154,8 +154,142 @@ static oc_object_t *hash_get_s(objects_cache_t *ocp,
   return NULL;
 }
 
+/**
+ * @brief   Inserts a released object in the LRU list.
+ * @note    With @p CH_CFG_OBJ_CACHES_USE_2Q enabled objects marked as
+ *          @p OC_FLAG_PROTECTED are placed in the protected segment, if
+ *          the segment is full then its least recently used object is
+ *          demoted to the head of the probationary segment.
+ *
+ * @param[in] ocp       pointer to the @p objects_cache_t structure
+ * @param[in] objp      pointer to the @p oc_object_t structure
+ *
+ * @notapi
+ */
+static void lru_insert_i(objects_cache_t *ocp, oc_object_t *objp) {
+
+#if CH_CFG_OBJ_CACHES_USE_2Q == TRUE
+  if ((objp->obj_flags & (OC_FLAG_PROTECTED | OC_FLAG_FORGET)) ==
+      OC_FLAG_PROTECTED) {
+
+    if (ocp->protn >= ocp->protmax) {
+      oc_object_t *lrup = ocp->lru_prot.lru_prev;
+
+      LRU_REMOVE(lrup);
+      lrup->obj_flags &= ~OC_FLAG_PROTECTED;
+      LRU_INSERT_HEAD(&ocp->lru, lrup);
+    }
+    else {
+      ocp->protn++;
+    }
+    LRU_INSERT_HEAD(&ocp->lru_prot, objp);
+    objp->obj_flags &= OC_FLAG_INHASH | OC_FLAG_LAZYWRITE | OC_FLAG_PROTECTED;
+    return;
+  }
+#endif
+
+  /* LRU insertion point depends on the OC_FLAG_FORGET flag.*/
+  if ((objp->obj_flags & OC_FLAG_FORGET) == 0U) {
+    /* Placing it on head.*/
+    LRU_INSERT_HEAD(&ocp->lru, objp);
+  }
+  else {
+    /* Low priority data, placing it on tail.*/
+    LRU_INSERT_TAIL(&ocp->lru, objp);
+  }
+  objp->obj_flags &= OC_FLAG_INHASH | OC_FLAG_LAZYWRITE;
+}
+
+/**
+ * @brief   Removes an object from the LRU list.
+ *
+ * @param[in] ocp       pointer to the @p objects_cache_t structure
+ * @param[in] objp      pointer to the @p oc_object_t structure
+ *
+ * @notapi
+ */
+static void lru_remove_s(objects_cache_t *ocp, oc_object_t *objp) {
+
+  chDbgAssert((objp->obj_flags & OC_FLAG_INLRU) == OC_FLAG_INLRU,
+              "not in LRU");
+
+  LRU_REMOVE(objp);
+  objp->obj_flags &= ~OC_FLAG_INLRU;
+#if CH_CFG_OBJ_CACHES_USE_2Q == TRUE
+  if ((objp->obj_flags & OC_FLAG_PROTECTED) != 0U) {
+    ocp->protn--;
+  }
+#else
+  (void)ocp;
+#endif
+}
+
+/**
+ * @brief   Removes a not owned object from the LRU list and takes it.
+ * @note    The LRU counter semaphore is decreased, an object available
+ *          in the LRU list guarantees that there is no wait.
+ *
+ * @param[in] ocp       pointer to the @p objects_cache_t structure
+ * @param[in] objp      pointer to the @p oc_object_t structure
+ *
+ * @notapi
+ */
+static void lru_take_s(objects_cache_t *ocp, oc_object_t *objp) {
+
+  chDbgAssert(chSemGetCounterI(&objp->obj_sem) == (cnt_t)1,
+              "semaphore counter not 1");
+
+  /* Removing the object from LRU, now it is "owned".*/
+  lru_remove_s(ocp, objp);
+  chSemFastWaitI(&ocp->lru_sem);
+
+  /* Getting the object semaphore, we know there is no wait so
+     using the "fast" variant.*/
+  chSemFastWaitI(&objp->obj_sem);
+}
+
+/**
+ * @brief   Returns the least recently used object not owned by a thread.
+ * @note    With @p CH_CFG_OBJ_CACHES_USE_2Q enabled the probationary
+ *          segment is searched first.
+ * @note    Objects being written by @p chCacheFlush() are owned while
+ *          they stay in the LRU list, they are skipped.
+ *
+ * @param[in] ocp       pointer to the @p objects_cache_t structure
+ * @return              The pointer to the object.
+ * @retval NULL         if there are no available objects.
+ *
+ * @notapi
+ */
+static oc_object_t *lru_find_last_s(objects_cache_t *ocp) {
+  oc_object_t *objp;
+
+  objp = ocp->lru.lru_prev;
+  while (objp != (oc_object_t *)&ocp->lru) {
+    if (chSemGetCounterI(&objp->obj_sem) > (cnt_t)0) {
+      return objp;
+    }
+    objp = objp->lru_prev;
+  }
+
+#if CH_CFG_OBJ_CACHES_USE_2Q == TRUE
+  /* Probationary segment exhausted, evicting from the protected one.*/
+  objp = ocp->lru_prot.lru_prev;
+  while (objp != (oc_object_t *)&ocp->lru_prot) {
+    if (chSemGetCounterI(&objp->obj_sem) > (cnt_t)0) {
+      return objp;
+    }
+    objp = objp->lru_prev;
+  }
+#endif
+
+  return NULL;
+}
+
 /**
  * @brief   Gets the least recently used object buffer from the LRU list.
+ * @note    With @p CH_CFG_OBJ_CACHES_USE_2Q enabled the probationary
+ *          segment is searched first.
  *
  * @param[out] ocp      pointer to the @p objects_cache_t structure to be
  * @return              The pointer to the retrieved object.
@@ -169,17 +303,14 @@ static oc_object_t *lru_get_last_s(objects_cache_t *ocp) {
     /* Waiting for an object buffer to become available in the LRU.*/
     (void) chSemWaitS(&ocp->lru_sem);
 
-    /* Now an object buffer is in the LRU for sure, taking it from the
-       LRU tail.*/
-    objp = ocp->lru.lru_prev;
+    /* Now an object buffer is in the LRU for sure, taking the least
+       recently used one.*/
+    objp = lru_find_last_s(ocp);
 
-    chDbgAssert((objp->obj_flags & OC_FLAG_INLRU) == OC_FLAG_INLRU,
-                "not in LRU");
-    chDbgAssert(chSemGetCounterI(&objp->obj_sem) == (cnt_t)1,
-                "semaphore counter not 1");
+    chDbgAssert(objp != NULL, "LRU empty");
 
-    LRU_REMOVE(objp);
-    objp->obj_flags &= ~OC_FLAG_INLRU;
+    /* The counter has already been decreased by the wait.*/
+    lru_remove_s(ocp, objp);
 
     /* Getting the object semaphore, we know there is no wait so
        using the "fast" variant.*/
@@ -215,6 +346,116 @@ static oc_object_t *lru_get_last_s(objects_cache_t *ocp) {
   }
 }
 
+/**
+ * @brief   Searches the dirty object following a position.
+ * @details The critical section is entered for each object in order to
+ *          keep it short.
+ *
+ * @param[in] ocp       pointer to the @p objects_cache_t structure
+ * @param[in,out] groupp on entry the group of the last written object, on
+ *                      exit the group of the found object
+ * @param[in,out] keyp  on entry the key of the last written object, on exit
+ *                      the key of the found object
+ * @param[in] first     the search starts from the first position
+ * @return              The search result.
+ * @retval false        if there are no more dirty objects.
+ * @retval true         if an object has been found.
+ *
+ * @notapi
+ */
+static bool flush_find_next(objects_cache_t *ocp,
+                            uint32_t *groupp,
+                            uint32_t *keyp,
+                            bool first) {
+  uint32_t mingroup = 0U, minkey = 0U;
+  bool found = false;
+  uint8_t *p;
+  ucnt_t i;
+
+  p = (uint8_t *)ocp->objvp;
+  for (i = (ucnt_t)0; i < ocp->objn; i++) {
+    oc_object_t *objp = (oc_object_t *)p;
+
+    p += ocp->objsz;
+
+    chSysLock();
+    if (((objp->obj_flags & (OC_FLAG_INLRU | OC_FLAG_LAZYWRITE)) ==
+         (OC_FLAG_INLRU | OC_FLAG_LAZYWRITE)) &&
+        (first ||
+         (objp->obj_group > *groupp) ||
+         ((objp->obj_group == *groupp) && (objp->obj_key > *keyp))) &&
+        (!found ||
+         (objp->obj_group < mingroup) ||
+         ((objp->obj_group == mingroup) && (objp->obj_key < minkey)))) {
+      mingroup = objp->obj_group;
+      minkey   = objp->obj_key;
+      found    = true;
+    }
+    chSysUnlock();
+  }
+
+  *groupp = mingroup;
+  *keyp   = minkey;
+
+  return found;
+}
+
+/**
+ * @brief   Takes a dirty object for a flush.
+ * @note    The object is owned during the write but it is left in place in
+ *          the LRU list, it is skipped by evictions meanwhile.
+ *
+ * @param[in] ocp       pointer to the @p objects_cache_t structure
+ * @param[in] group     object group identifier
+ * @param[in] key       object identifier within the group
+ * @return              The pointer to the taken object.
+ * @retval NULL         if the object is not cached, not dirty or owned.
+ *
+ * @notapi
+ */
+static oc_object_t *flush_take_s(objects_cache_t *ocp,
+                                 uint32_t group,
+                                 uint32_t key) {
+  oc_object_t *objp;
+
+  objp = hash_get_s(ocp, group, key);
+  if ((objp == NULL) ||
+      ((objp->obj_flags & (OC_FLAG_INLRU | OC_FLAG_LAZYWRITE)) !=
+       (OC_FLAG_INLRU | OC_FLAG_LAZYWRITE)) ||
+      (chSemGetCounterI(&objp->obj_sem) <= (cnt_t)0)) {
+    return NULL;
+  }
+
+  chSemFastWaitI(&ocp->lru_sem);
+  chSemFastWaitI(&objp->obj_sem);
+  objp->obj_flags &= ~OC_FLAG_LAZYWRITE;
+
+  return objp;
+}
+
+/**
+ * @brief   Releases an object taken by @p flush_take_s().
+ *
+ * @param[in] ocp       pointer to the @p objects_cache_t structure
+ * @param[in] objp      pointer to the @p oc_object_t structure
+ *
+ * @notapi
+ */
+static void flush_release_s(objects_cache_t *ocp, oc_object_t *objp) {
+
+  if (chSemGetCounterI(&objp->obj_sem) < (cnt_t)0) {
+    /* Some thread is waiting for this specific object, it is removed
+       from the LRU list and handed directly.*/
+    lru_remove_s(ocp, objp);
+    objp->obj_flags &= OC_FLAG_INHASH | OC_FLAG_NOTSYNC | OC_FLAG_LAZYWRITE;
+    chSemSignalI(&objp->obj_sem);
+  }
+  else {
+    chSemSignalI(&ocp->lru_sem);
+    chSemFastSignalI(&objp->obj_sem);
+  }
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -258,6 +499,7 @@ void chCacheObjectInit(objects_cache_t *ocp,
   ocp->hashn            = hashn;
   ocp->hashp            = hashp;
   ocp->objn             = objn;
+  ocp->objsz            = objsz;
   ocp->objvp            = objvp;
   ocp->readf            = readf;
   ocp->writef           = writef;
@@ -265,6 +507,14 @@ void chCacheObjectInit(objects_cache_t *ocp,
   ocp->lru.hash_prev    = NULL;
   ocp->lru.lru_next     = (oc_object_t *)&ocp->lru;
   ocp->lru.lru_prev     = (oc_object_t *)&ocp->lru;
+#if CH_CFG_OBJ_CACHES_USE_2Q == TRUE
+  ocp->lru_prot.hash_next = NULL;
+  ocp->lru_prot.hash_prev = NULL;
+  ocp->lru_prot.lru_next  = (oc_object_t *)&ocp->lru_prot;
+  ocp->lru_prot.lru_prev  = (oc_object_t *)&ocp->lru_prot;
+  ocp->protn              = (ucnt_t)0;
+  ocp->protmax            = objn - (objn / (ucnt_t)4);
+#endif
 
   /* Hash headers initialization.*/
   do {
@@ -278,7 +528,7 @@ void chCacheObjectInit(objects_cache_t *ocp,
     oc_object_t *objp = (oc_object_t *)objvp;
 
     chSemObjectInit(&objp->obj_sem, (cnt_t)1);
-    LRU_INSERT_HEAD(ocp, objp);
+    LRU_INSERT_HEAD(&ocp->lru, objp);
     objp->obj_group = 0U;
     objp->obj_key   = 0U;
     objp->obj_flags = OC_FLAG_INLRU;
@@ -320,27 +570,18 @@ oc_object_t *chCacheGetObject(objects_cache_t *ocp,
        other thread.*/
     if (chSemGetCounterI(&objp->obj_sem) > (cnt_t)0) {
       /* Not owned case, it is in the LRU list.*/
-
-      chDbgAssert((objp->obj_flags & OC_FLAG_INLRU) == OC_FLAG_INLRU,
-                  "not in LRU");
-
-      /* Removing the object from LRU, now it is "owned".*/
-      LRU_REMOVE(objp);
-      objp->obj_flags &= ~OC_FLAG_INLRU;
-
-      /* Getting the object semaphore, we know there is no wait so
-         using the "fast" variant.*/
-      chSemFastWaitI(&objp->obj_sem);
+      lru_take_s(ocp, objp);
     }
     else {
-      /* Owned case, some other thread is playing with this object, we
-         need to wait.*/
-
-      chDbgAssert((objp->obj_flags & OC_FLAG_INLRU) == 0U, "in LRU");
+      /* Owned case, some other thread is playing with this object or it
+         is being flushed, we need to wait.*/
 
       /* Waiting on the buffer semaphore.*/
       (void) chSemWaitS(&objp->obj_sem);
     }
+
+    /* Referenced again while cached, it will be protected on release.*/
+    objp->obj_flags |= OC_FLAG_PROTECTED;
   }
   else {
     /* Cache miss, getting an object buffer from the LRU list.*/
@@ -369,6 +610,9 @@ oc_object_t *chCacheGetObject(objects_cache_t *ocp,
  *            the LRU tail.
  *          - @p OC_FLAG_LAZYWRITE is ignored and kept, a write will occur
  *            when the object is removed from the LRU list (lazy write).
+ *          - @p OC_FLAG_PROTECTED is set by @p chCacheGetObject() on cache
+ *            hits, the object is then placed in the protected segment if
+ *            @p CH_CFG_OBJ_CACHES_USE_2Q is enabled.
  *          .
  *
  * @param[in] ocp       pointer to the @p objects_cache_t structure
@@ -402,22 +646,13 @@ void chCacheReleaseObjectI(objects_cache_t *ocp,
      and removed from the hash table.*/
   if ((objp->obj_flags & OC_FLAG_NOTSYNC) != 0U) {
     HASH_REMOVE(objp);
-    LRU_INSERT_TAIL(ocp, objp);
+    LRU_INSERT_TAIL(&ocp->lru, objp);
     objp->obj_group = 0U;
     objp->obj_key   = 0U;
     objp->obj_flags = OC_FLAG_INLRU;
   }
   else {
-    /* LRU insertion point depends on the OC_FLAG_FORGET flag.*/
-    if ((objp->obj_flags & OC_FLAG_FORGET) == 0U) {
-      /* Placing it on head.*/
-      LRU_INSERT_HEAD(ocp, objp);
-    }
-    else {
-      /* Low priority data, placing it on tail.*/
-      LRU_INSERT_TAIL(ocp, objp);
-    }
-    objp->obj_flags &= OC_FLAG_INHASH | OC_FLAG_LAZYWRITE;
+    lru_insert_i(ocp, objp);
     objp->obj_flags |= OC_FLAG_INLRU;
   }
 
@@ -486,6 +721,173 @@ bool chCacheWriteObject(objects_cache_t *ocp,
   return ocp->writef(ocp, objp, async);
 }
 
+/**
+ * @brief   Writes back all the dirty objects in the cache.
+ * @details Objects marked as @p OC_FLAG_LAZYWRITE and not owned by other
+ *          threads are written synchronously in ascending group and key
+ *          order. Dirty objects with contiguous keys are taken together
+ *          and written as a run, all but the last object of a run are
+ *          marked as @p OC_FLAG_MORE so that the write function can
+ *          coalesce the run in a single media access. Objects remain
+ *          cached after the write and keep their position in the LRU
+ *          list, the recency order is not altered by the flush.
+ * @note    The write-behind is performed by calling this function
+ *          periodically from a low priority flusher thread owned by the
+ *          application, this way objects are found clean when evicted and
+ *          the eviction does not require a write.
+ * @note    Objects failing the write operation are marked again as
+ *          @p OC_FLAG_LAZYWRITE and are retried on the next flush.
+ * @note    A thread getting an object while it is written waits for the
+ *          write completion.
+ *
+ * @param[in] ocp       pointer to the @p objects_cache_t structure
+ * @return              The operation status.
+ * @retval false        if the operation succeeded.
+ * @retval true         if one or more write operations failed.
+ *
+ * @api
+ */
+bool chCacheFlush(objects_cache_t *ocp) {
+  uint32_t group = 0U, key = 0U;
+  bool first = true, error = false;
+
+  while (flush_find_next(ocp, &group, &key, first)) {
+    oc_object_t *objp;
+    uint32_t i, n;
+
+    /* Taking the run of dirty objects with contiguous keys starting from
+       the found one, the objects could have been taken or renamed since
+       the search.*/
+    n = 0U;
+    do {
+      chSysLock();
+      objp = flush_take_s(ocp, group, key + n);
+      chSysUnlock();
+      if (objp == NULL) {
+        break;
+      }
+      n++;
+    } while (key + n != 0U);
+
+    /* Writing the run, the objects are owned so their position in the
+       hash table cannot change.*/
+    for (i = 0U; i < n; i++) {
+      chSysLock();
+      objp = hash_get_s(ocp, group, key + i);
+      chSysUnlock();
+
+      if (i < n - 1U) {
+        objp->obj_flags |= OC_FLAG_MORE;
+      }
+      if (ocp->writef(ocp, objp, false)) {
+        objp->obj_flags |= OC_FLAG_LAZYWRITE;
+        error = true;
+      }
+      objp->obj_flags &= ~OC_FLAG_MORE;
+    }
+
+    /* Releasing the run.*/
+    for (i = 0U; i < n; i++) {
+      chSysLock();
+      flush_release_s(ocp, hash_get_s(ocp, group, key + i));
+      chSchRescheduleS();
+      chSysUnlock();
+    }
+
+    /* Next search resumes after the run.*/
+    if (n > 0U) {
+      key += n - 1U;
+    }
+    first = false;
+  }
+
+  return error;
+}
+
+/**
+ * @brief   Starts asynchronous reads of the objects following a key.
+ * @details Objects from <tt>key + 1</tt> to <tt>key + n</tt> not already
+ *          in cache are taken from the LRU list and an asynchronous read
+ *          is started for each of them, a thread consuming objects
+ *          sequentially then finds them in cache.
+ * @note    This is only an hint and the function never waits, the
+ *          operation stops if the least recently used object is not
+ *          available or it requires a write.
+ * @note    The read function should support asynchronous operations for
+ *          this function to be effective. A read function completing
+ *          synchronously, clearing @p OC_FLAG_NOTSYNC or returning
+ *          @p true without releasing the object, is detected and the
+ *          object is released by this function.
+ * @note    An asynchronous read function must clear @p OC_FLAG_NOTSYNC
+ *          and release the object in the same critical zone using
+ *          @p chCacheReleaseObjectI().
+ *
+ * @param[in] ocp       pointer to the @p objects_cache_t structure
+ * @param[in] group     object group identifier
+ * @param[in] key       key of the last object read
+ * @param[in] n         number of objects to be read ahead
+ * @return              The number of started read operations.
+ *
+ * @api
+ */
+ucnt_t chCacheReadAhead(objects_cache_t *ocp,
+                        uint32_t group,
+                        uint32_t key,
+                        ucnt_t n) {
+  ucnt_t started = (ucnt_t)0;
+
+  while (n > (ucnt_t)0) {
+    oc_object_t *objp;
+    bool error;
+
+    key++;
+    n--;
+
+    chSysLock();
+
+    /* Objects already in cache are skipped.*/
+    if (hash_get_s(ocp, group, key) != NULL) {
+      chSysUnlock();
+      continue;
+    }
+
+    /* No clean object immediately available, giving up.*/
+    objp = lru_find_last_s(ocp);
+    if ((objp == NULL) || ((objp->obj_flags & OC_FLAG_LAZYWRITE) != 0U)) {
+      chSysUnlock();
+      break;
+    }
+    lru_take_s(ocp, objp);
+    if ((objp->obj_flags & OC_FLAG_INHASH) != 0U) {
+      HASH_REMOVE(objp);
+    }
+
+    /* Naming this object and publishing it in the hash table, there has
+       been no wait since the hash check.*/
+    objp->obj_group = group;
+    objp->obj_key   = key;
+    objp->obj_flags = OC_FLAG_INHASH | OC_FLAG_NOTSYNC | OC_FLAG_READAHEAD;
+    HASH_INSERT(ocp, objp, group, key);
+    chSysUnlock();
+
+    /* An asynchronous read function releases the object when done, this
+       clears OC_FLAG_READAHEAD. A synchronous one returns with the object
+       still owned and the read completed.*/
+    error = chCacheReadObject(ocp, objp, true);
+
+    chSysLock();
+    if (((objp->obj_flags & OC_FLAG_READAHEAD) != 0U) &&
+        (error || ((objp->obj_flags & OC_FLAG_NOTSYNC) == 0U))) {
+      chCacheReleaseObjectI(ocp, objp);
+      chSchRescheduleS();
+    }
+    chSysUnlock();
+    started++;
+  }
+
+  return started;
+}
+
 #endif /* CH_CFG_USE_OBJ_CACHES == TRUE */
 
 /** @} */
@@ -0,0 +1,505 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    oslib/src/chobjfifos.c
+ * @brief   Lock-free objects FIFO code.
+ * @details Lock-free implementation of the objects FIFOs.
+ *          <h2>Operation mode</h2>
+ *          The free objects are kept in a stack linked through the
+ *          objects themselves, the sent objects are kept in a bounded
+ *          multi-producer multi-consumer queue using the FIFO messages
+ *          buffer as cells. Both structures are updated using
+ *          compare-and-swap operations only.<br>
+ *          Each side has an atomic counter of the available objects, a
+ *          counter going negative means that a thread must wait, only in
+ *          that case the side semaphore is used so the kernel is entered
+ *          only by threads that actually need to wait or to wake up a
+ *          waiting thread.
+ * @pre     In order to use this implementation the
+ *          @p CH_CFG_OBJ_FIFOS_LOCKFREE option must be enabled in
+ *          @p chconf.h.
+ * @note    Compatible with RT and NIL.
+ *
+ * @addtogroup oslib_objects_fifos
+ * @{
+ */
+
+#include "ch.h"
+
+#if ((CH_CFG_USE_OBJ_FIFOS == TRUE) &&                                      \
+     (CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE)) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Index marking the end of the free objects stack.
+ */
+#define OFIFO_NONE                  0xFFFFU
+
+/**
+ * @brief   Index part of a packed word.
+ */
+#define OFIFO_IDX(w)                ((uint32_t)(w) & 0xFFFFU)
+
+/**
+ * @brief   Tag, lap or sequence part of a packed word.
+ */
+#define OFIFO_TAG(w)                (((uint32_t)(w) >> 16) & 0xFFFFU)
+
+/**
+ * @brief   Packs a tag and an index.
+ */
+#define OFIFO_PACK(t, i)                                                    \
+  ((msg_t)((((uint32_t)(t) & 0xFFFFU) << 16) | ((uint32_t)(i) & 0xFFFFU)))
+
+/**
+ * @brief   Signed distance between two 16 bits sequence numbers.
+ */
+#define OFIFO_DIFF(s, e)            ((int16_t)(uint16_t)((s) - (e)))
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4) || defined(__DOXYGEN__)
+static inline msg_t ofifo_load(volatile msg_t *p) {
+
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline bool ofifo_cas(volatile msg_t *p, msg_t *expp, msg_t v) {
+
+  return __atomic_compare_exchange_n(p, expp, v, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline cnt_t ofifo_cnt_load(volatile cnt_t *p) {
+
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline bool ofifo_cnt_cas(volatile cnt_t *p, cnt_t *expp, cnt_t v) {
+
+  return __atomic_compare_exchange_n(p, expp, v, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline cnt_t ofifo_cnt_add(volatile cnt_t *p, cnt_t v) {
+
+  return __atomic_fetch_add(p, v, __ATOMIC_ACQ_REL);
+}
+#else
+/* Cores without compare-and-swap, the atomic primitives are emulated
+   using short critical zones.*/
+static inline msg_t ofifo_load(volatile msg_t *p) {
+
+  return *p;
+}
+
+static inline bool ofifo_cas(volatile msg_t *p, msg_t *expp, msg_t v) {
+  syssts_t sts = chSysGetStatusAndLockX();
+  bool ok = (bool)(*p == *expp);
+
+  if (ok) {
+    *p = v;
+  }
+  else {
+    *expp = *p;
+  }
+  chSysRestoreStatusX(sts);
+
+  return ok;
+}
+
+static inline cnt_t ofifo_cnt_load(volatile cnt_t *p) {
+
+  return *p;
+}
+
+static inline bool ofifo_cnt_cas(volatile cnt_t *p, cnt_t *expp, cnt_t v) {
+  syssts_t sts = chSysGetStatusAndLockX();
+  bool ok = (bool)(*p == *expp);
+
+  if (ok) {
+    *p = v;
+  }
+  else {
+    *expp = *p;
+  }
+  chSysRestoreStatusX(sts);
+
+  return ok;
+}
+
+static inline cnt_t ofifo_cnt_add(volatile cnt_t *p, cnt_t v) {
+  syssts_t sts = chSysGetStatusAndLockX();
+  cnt_t prev = *p;
+
+  *p = prev + v;
+  chSysRestoreStatusX(sts);
+
+  return prev;
+}
+#endif
+
+static inline uint8_t *ofifo_obj(objects_fifo_t *ofp, uint32_t idx) {
+
+  return ofp->objbuf + ((size_t)idx * ofp->objsize);
+}
+
+static inline msg_t ofifo_next(objects_fifo_t *ofp, msg_t pos) {
+
+  if ((size_t)OFIFO_IDX(pos) + 1U < ofp->objn) {
+    return OFIFO_PACK(OFIFO_TAG(pos), OFIFO_IDX(pos) + 1U);
+  }
+  return OFIFO_PACK(OFIFO_TAG(pos) + 1U, 0U);
+}
+
+/* Pushes an object on the free stack, the link is stored in the object
+   itself, the tag in the top word prevents ABA on concurrent pops.*/
+static void ofifo_push(objects_fifo_t *ofp, void *objp) {
+  uint32_t idx;
+  msg_t top;
+
+  idx = (uint32_t)(((uint8_t *)objp - ofp->objbuf) / ofp->objsize);
+  chDbgAssert((size_t)idx < ofp->objn, "not a FIFO object");
+
+  top = ofifo_load(&ofp->free_top);
+  do {
+    *(volatile msg_t *)objp = (msg_t)OFIFO_IDX(top);
+  } while (!ofifo_cas(&ofp->free_top, &top,
+                      OFIFO_PACK(OFIFO_TAG(top) + 1U, idx)));
+}
+
+/* Pops an object from the free stack, the link read from an object
+   just taken by another thread can be garbage, in that case the tag has
+   changed and the exchange fails.*/
+static void *ofifo_pop(objects_fifo_t *ofp) {
+  msg_t top, next;
+
+  top = ofifo_load(&ofp->free_top);
+  do {
+    if (OFIFO_IDX(top) == OFIFO_NONE) {
+      return NULL;
+    }
+    next = *(volatile msg_t *)ofifo_obj(ofp, OFIFO_IDX(top));
+  } while (!ofifo_cas(&ofp->free_top, &top,
+                      OFIFO_PACK(OFIFO_TAG(top) + 1U, OFIFO_IDX(next))));
+
+  return (void *)ofifo_obj(ofp, OFIFO_IDX(top));
+}
+
+/* Appends an object index to the sent queue. A cell of lap L holds the
+   sequence 2L when free and 2L+1 when full, filling the cell is the
+   linearization point, the position is advanced afterward by the
+   producer or by any thread finding the cell already filled.*/
+static bool ofifo_enqueue(objects_fifo_t *ofp, uint32_t v) {
+
+  while (true) {
+    msg_t pos, c, exp;
+    uint32_t seq;
+    int16_t d;
+
+    pos = ofifo_load(&ofp->wrpos);
+    c   = ofifo_load(&ofp->cells[OFIFO_IDX(pos)]);
+    seq = OFIFO_TAG(pos) * 2U;
+    d   = OFIFO_DIFF(OFIFO_TAG(c), seq);
+    if (d == 0) {
+      if (ofifo_cas(&ofp->cells[OFIFO_IDX(pos)], &c,
+                    OFIFO_PACK(seq + 1U, v))) {
+        exp = pos;
+        (void) ofifo_cas(&ofp->wrpos, &exp, ofifo_next(ofp, pos));
+        return true;
+      }
+    }
+    else if (d > 0) {
+      exp = pos;
+      (void) ofifo_cas(&ofp->wrpos, &exp, ofifo_next(ofp, pos));
+    }
+    else if (ofifo_load(&ofp->wrpos) == pos) {
+      return false;
+    }
+  }
+}
+
+/* Removes an object index from the sent queue, emptying the cell marks
+   it free for the next lap.*/
+static bool ofifo_dequeue(objects_fifo_t *ofp, uint32_t *vp) {
+
+  while (true) {
+    msg_t pos, c, exp;
+    uint32_t seq;
+    int16_t d;
+
+    pos = ofifo_load(&ofp->rdpos);
+    c   = ofifo_load(&ofp->cells[OFIFO_IDX(pos)]);
+    seq = (OFIFO_TAG(pos) * 2U) + 1U;
+    d   = OFIFO_DIFF(OFIFO_TAG(c), seq);
+    if (d == 0) {
+      if (ofifo_cas(&ofp->cells[OFIFO_IDX(pos)], &c,
+                    OFIFO_PACK(seq + 1U, 0U))) {
+        *vp = OFIFO_IDX(c);
+        exp = pos;
+        (void) ofifo_cas(&ofp->rdpos, &exp, ofifo_next(ofp, pos));
+        return true;
+      }
+    }
+    else if (d > 0) {
+      exp = pos;
+      (void) ofifo_cas(&ofp->rdpos, &exp, ofifo_next(ofp, pos));
+    }
+    else if (ofifo_load(&ofp->rdpos) == pos) {
+      return false;
+    }
+  }
+}
+
+/* Reserves an available object without waiting.*/
+static bool ofifo_try_reserve(volatile cnt_t *cntp) {
+  cnt_t cnt = ofifo_cnt_load(cntp);
+
+  while (cnt > (cnt_t)0) {
+    if (ofifo_cnt_cas(cntp, &cnt, cnt - (cnt_t)1)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/* Reserves an available object, waiting on the semaphore only if the
+   counter goes negative. On timeout the reservation is canceled unless
+   a wakeup is already on its way, in that case it is consumed.*/
+static msg_t ofifo_reserve(volatile cnt_t *cntp, semaphore_t *sp,
+                           sysinterval_t timeout, unsigned cls) {
+  cnt_t cnt;
+  msg_t msg;
+
+  if (ofifo_try_reserve(cntp)) {
+    return MSG_OK;
+  }
+  if ((cls == __OFIFO_CLASS_I) || (timeout == TIME_IMMEDIATE)) {
+    return MSG_TIMEOUT;
+  }
+  if (ofifo_cnt_add(cntp, (cnt_t)-1) > (cnt_t)0) {
+    return MSG_OK;
+  }
+
+  if (cls == __OFIFO_CLASS_API) {
+    msg = chSemWaitTimeout(sp, timeout);
+  }
+  else {
+    msg = chSemWaitTimeoutS(sp, timeout);
+  }
+  if (msg == MSG_OK) {
+    return MSG_OK;
+  }
+
+  cnt = ofifo_cnt_load(cntp);
+  while (cnt < (cnt_t)0) {
+    if (ofifo_cnt_cas(cntp, &cnt, cnt + (cnt_t)1)) {
+      return MSG_TIMEOUT;
+    }
+  }
+  if (cls == __OFIFO_CLASS_API) {
+    (void) chSemWait(sp);
+  }
+  else {
+    (void) chSemWaitS(sp);
+  }
+
+  return MSG_OK;
+}
+
+/* Makes an object available, the semaphore is signaled only if there
+   is a waiting thread.*/
+static void ofifo_release(volatile cnt_t *cntp, semaphore_t *sp,
+                          unsigned cls) {
+
+  if (ofifo_cnt_add(cntp, (cnt_t)1) < (cnt_t)0) {
+    if (cls == __OFIFO_CLASS_API) {
+      chSemSignal(sp);
+    }
+    else {
+      chSemSignalI(sp);
+      if (cls == __OFIFO_CLASS_S) {
+        chSchRescheduleS();
+      }
+    }
+  }
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a lock-free FIFO object.
+ *
+ * @param[out] ofp      pointer to a @p objects_fifo_t structure
+ * @param[in] objsize   size of objects
+ * @param[in] objn      number of objects available
+ * @param[in] objbuf    pointer to the buffer of objects
+ * @param[in] msgbuf    pointer to the buffer of messages
+ *
+ * @notapi
+ */
+void __ofifo_object_init(objects_fifo_t *ofp, size_t objsize, size_t objn,
+                         void *objbuf, msg_t *msgbuf) {
+  size_t i;
+
+  chDbgCheck((ofp != NULL) && (objsize >= sizeof (msg_t)) &&
+             (objn > 0U) && (objn < (size_t)OFIFO_NONE) &&
+             (objbuf != NULL) && (msgbuf != NULL));
+
+  ofp->objbuf   = (uint8_t *)objbuf;
+  ofp->objsize  = objsize;
+  ofp->objn     = objn;
+  ofp->free_top = OFIFO_PACK(0U, OFIFO_NONE);
+  ofp->free_cnt = (cnt_t)objn;
+  chSemObjectInit(&ofp->free_sem, (cnt_t)0);
+  ofp->cells    = msgbuf;
+  ofp->wrpos    = OFIFO_PACK(0U, 0U);
+  ofp->rdpos    = OFIFO_PACK(0U, 0U);
+  ofp->msg_cnt  = (cnt_t)0;
+  chSemObjectInit(&ofp->msg_sem, (cnt_t)0);
+
+  for (i = 0U; i < objn; i++) {
+    ofp->cells[i] = OFIFO_PACK(0U, 0U);
+    ofifo_push(ofp, (void *)ofifo_obj(ofp, (uint32_t)(objn - 1U - i)));
+  }
+}
+
+/**
+ * @brief   Takes a free object.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ * @param[in] cls       calling function class
+ * @return              The pointer to the object.
+ * @retval NULL         if an object is not available in time.
+ *
+ * @notapi
+ */
+void *__ofifo_take(objects_fifo_t *ofp, sysinterval_t timeout,
+                   unsigned cls) {
+  void *objp;
+
+  if (ofifo_reserve(&ofp->free_cnt, &ofp->free_sem,
+                    timeout, cls) != MSG_OK) {
+    return NULL;
+  }
+
+  /* The reservation guarantees an object on the stack.*/
+  do {
+    objp = ofifo_pop(ofp);
+  } while (objp == NULL);
+
+  return objp;
+}
+
+/**
+ * @brief   Returns an object to the free stack.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] objp      pointer to the object
+ * @param[in] cls       calling function class
+ *
+ * @notapi
+ */
+void __ofifo_return(objects_fifo_t *ofp, void *objp, unsigned cls) {
+
+  ofifo_push(ofp, objp);
+  ofifo_release(&ofp->free_cnt, &ofp->free_sem, cls);
+}
+
+/**
+ * @brief   Sends an object.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] objp      pointer to the object
+ * @param[in] cls       calling function class
+ *
+ * @notapi
+ */
+void __ofifo_send(objects_fifo_t *ofp, void *objp, unsigned cls) {
+  uint32_t idx;
+  bool ok;
+
+  idx = (uint32_t)(((uint8_t *)objp - ofp->objbuf) / ofp->objsize);
+  chDbgAssert((size_t)idx < ofp->objn, "not a FIFO object");
+
+  /* The queue has a cell for each object, it cannot be full.*/
+  ok = ofifo_enqueue(ofp, idx);
+  chDbgAssert(ok, "queue full");
+  (void)ok;
+
+  ofifo_release(&ofp->msg_cnt, &ofp->msg_sem, cls);
+}
+
+/**
+ * @brief   Receives an object.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[out] objpp    pointer to the received object pointer
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ * @param[in] cls       calling function class
+ * @return              The operation status.
+ * @retval MSG_OK       if an object has been received.
+ * @retval MSG_TIMEOUT  if an object is not available in time.
+ *
+ * @notapi
+ */
+msg_t __ofifo_receive(objects_fifo_t *ofp, void **objpp,
+                      sysinterval_t timeout, unsigned cls) {
+  uint32_t idx;
+  msg_t msg;
+
+  msg = ofifo_reserve(&ofp->msg_cnt, &ofp->msg_sem, timeout, cls);
+  if (msg != MSG_OK) {
+    return msg;
+  }
+
+  /* The reservation guarantees a filled cell.*/
+  while (!ofifo_dequeue(ofp, &idx)) {
+  }
+  *objpp = (void *)ofifo_obj(ofp, idx);
+
+  return MSG_OK;
+}
+
+#endif /* CH_CFG_OBJ_FIFOS_LOCKFREE == TRUE */
+
+/** @} */
@@ -190,6 +190,62 @@ static size_t pipe_read(pipe_t *pp, uint8_t *bp, size_t n) {
   return n;
 }
 
+/**
+ * @brief   Describes a region of the pipe buffer.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[out] rp       pointer to the @p pipe_region_t to be filled
+ * @param[in] p         pointer to the region start
+ * @param[in] n         size of the region
+ *
+ * @notapi
+ */
+static void pipe_region(pipe_t *pp, pipe_region_t *rp,
+                        uint8_t *p, size_t n) {
+  size_t s1;
+
+  /* Number of bytes before buffer limit.*/
+  /*lint -save -e9033 [10.8] Checked to be safe.*/
+  s1 = (size_t)(pp->top - p);
+  /*lint -restore*/
+
+  rp->ptr1 = p;
+  if (n <= s1) {
+    rp->n1   = n;
+    rp->ptr2 = NULL;
+    rp->n2   = (size_t)0;
+  }
+  else {
+    rp->n1   = s1;
+    rp->ptr2 = pp->buffer;
+    rp->n2   = n - s1;
+  }
+}
+
+/**
+ * @brief   Advances a pipe pointer.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[in] p         pointer to be advanced
+ * @param[in] n         number of bytes
+ * @return              The advanced pointer.
+ *
+ * @notapi
+ */
+static uint8_t *pipe_advance(pipe_t *pp, uint8_t *p, size_t n) {
+  size_t s1;
+
+  /*lint -save -e9033 [10.8] Checked to be safe.*/
+  s1 = (size_t)(pp->top - p);
+  /*lint -restore*/
+
+  if (n < s1) {
+    return p + n;
+  }
+
+  return pp->buffer + (n - s1);
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -383,6 +439,211 @@ size_t chPipeReadTimeout(pipe_t *pp, uint8_t *bp,
   return max - n;
 }
 
+/**
+ * @brief   Reserves space in a pipe for direct writing.
+ * @details The function waits for @p n bytes to be free in the pipe buffer
+ *          then returns the free region, the caller can then write the
+ *          data directly into the buffer and make it available to readers
+ *          using @p chPipeWriteCommit().
+ * @note    If the function returns a non-zero value then the pipe write
+ *          side is kept locked and @p chPipeWriteCommit() must be called in
+ *          order to unlock it, other writers are blocked meanwhile.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[out] rp       pointer to a @p pipe_region_t receiving the reserved
+ *                      region, up to two spans if the region wraps around
+ *                      the buffer end
+ * @param[in] n         the number of bytes to be reserved, the value 0 is
+ *                      reserved
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes effectively reserved. A number
+ *                      lower than @p n means that a timeout occurred or the
+ *                      pipe went in reset state, in that case the available
+ *                      space is reserved.
+ * @retval 0            if no space has been reserved, in this case the
+ *                      write side is not locked.
+ *
+ * @api
+ */
+size_t chPipeWriteReserve(pipe_t *pp, pipe_region_t *rp,
+                          size_t n, sysinterval_t timeout) {
+
+  chDbgCheck((rp != NULL) && (n > 0U) && (n <= chPipeGetSize(pp)));
+
+  /* If the pipe is in reset state then returns immediately.*/
+  if (pp->reset) {
+    return (size_t)0;
+  }
+
+  PW_LOCK(pp);
+
+  /* Waiting for enough space, the counter is checked again inside the
+     critical zone in order to not miss a reader wakeup.*/
+  chSysLock();
+  while (chPipeGetFreeCount(pp) < n) {
+    if (chThdSuspendTimeoutS(&pp->wtr, timeout) != MSG_OK) {
+      break;
+    }
+  }
+  chSysUnlock();
+
+  PC_LOCK(pp);
+  if (pp->reset) {
+    n = (size_t)0;
+  }
+  else if (n > chPipeGetFreeCount(pp)) {
+    n = chPipeGetFreeCount(pp);
+  }
+  pipe_region(pp, rp, pp->wrptr, n);
+  PC_UNLOCK(pp);
+
+  if (n == (size_t)0) {
+    PW_UNLOCK(pp);
+  }
+
+  return n;
+}
+
+/**
+ * @brief   Commits data written directly into a pipe.
+ * @details The first @p n bytes of the region previously returned by
+ *          @p chPipeWriteReserve() are made available to readers and the
+ *          write side is unlocked.
+ * @note    Data is discarded if the pipe has been reset in the meantime.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[in] n         the number of bytes to be committed, it can be lower
+ *                      than the reserved amount, including zero
+ *
+ * @api
+ */
+void chPipeWriteCommit(pipe_t *pp, size_t n) {
+
+  PC_LOCK(pp);
+
+  chDbgAssert(n <= chPipeGetFreeCount(pp), "not reserved");
+
+  if (!pp->reset) {
+    pp->cnt  += n;
+    pp->wrptr = pipe_advance(pp, pp->wrptr, n);
+  }
+
+  PC_UNLOCK(pp);
+
+  /* Resuming the reader, if present.*/
+  if (n > (size_t)0) {
+    chThdResume(&pp->rtr, MSG_OK);
+  }
+
+  PW_UNLOCK(pp);
+}
+
+/**
+ * @brief   Accesses data in a pipe without copying it.
+ * @details The function waits for @p n bytes to be available in the pipe
+ *          buffer then returns the region containing them, the caller can
+ *          then process the data directly from the buffer and release it
+ *          using @p chPipeReadConsume().
+ * @note    If the function returns a non-zero value then the pipe read
+ *          side is kept locked and @p chPipeReadConsume() must be called in
+ *          order to unlock it, other readers are blocked meanwhile.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[out] rp       pointer to a @p pipe_region_t receiving the data
+ *                      region, up to two spans if the region wraps around
+ *                      the buffer end
+ * @param[in] n         the number of bytes to be accessed, the value 0 is
+ *                      reserved
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes effectively accessible. A number
+ *                      lower than @p n means that a timeout occurred or the
+ *                      pipe went in reset state, in that case the available
+ *                      data is returned.
+ * @retval 0            if no data is available, in this case the read side
+ *                      is not locked.
+ *
+ * @api
+ */
+size_t chPipeReadPeek(pipe_t *pp, pipe_region_t *rp,
+                      size_t n, sysinterval_t timeout) {
+
+  chDbgCheck((rp != NULL) && (n > 0U) && (n <= chPipeGetSize(pp)));
+
+  /* If the pipe is in reset state then returns immediately.*/
+  if (pp->reset) {
+    return (size_t)0;
+  }
+
+  PR_LOCK(pp);
+
+  /* Waiting for enough data, the counter is checked again inside the
+     critical zone in order to not miss a writer wakeup.*/
+  chSysLock();
+  while (chPipeGetUsedCount(pp) < n) {
+    if (chThdSuspendTimeoutS(&pp->rtr, timeout) != MSG_OK) {
+      break;
+    }
+  }
+  chSysUnlock();
+
+  PC_LOCK(pp);
+  if (pp->reset) {
+    n = (size_t)0;
+  }
+  else if (n > chPipeGetUsedCount(pp)) {
+    n = chPipeGetUsedCount(pp);
+  }
+  pipe_region(pp, rp, pp->rdptr, n);
+  PC_UNLOCK(pp);
+
+  if (n == (size_t)0) {
+    PR_UNLOCK(pp);
+  }
+
+  return n;
+}
+
+/**
+ * @brief   Releases data accessed directly in a pipe.
+ * @details The first @p n bytes of the region previously returned by
+ *          @p chPipeReadPeek() are removed from the pipe and the read side
+ *          is unlocked.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[in] n         the number of bytes to be consumed, it can be lower
+ *                      than the accessed amount, including zero
+ *
+ * @api
+ */
+void chPipeReadConsume(pipe_t *pp, size_t n) {
+
+  PC_LOCK(pp);
+
+  if (!pp->reset) {
+    chDbgAssert(n <= chPipeGetUsedCount(pp), "not available");
+
+    pp->cnt  -= n;
+    pp->rdptr = pipe_advance(pp, pp->rdptr, n);
+  }
+
+  PC_UNLOCK(pp);
+
+  /* Resuming the writer, if present.*/
+  if (n > (size_t)0) {
+    chThdResume(&pp->wtr, MSG_OK);
+  }
+
+  PR_UNLOCK(pp);
+}
+
 #endif /* CH_CFG_USE_PIPES == TRUE */
 
 /** @} */
@@ -0,0 +1,411 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    oslib/src/chrefbufs.c
+ * @brief   Reference-counted buffers code.
+ * @details Reference-counted buffers.
+ *          <h2>Operation mode</h2>
+ *          Buffers are allocated from a pool and carry a references
+ *          counter, passing a buffer between subsystems means passing a
+ *          pointer and, optionally, an additional reference instead of
+ *          copying the payload.<br>
+ *          Buffers can be linked in chains representing a single message,
+ *          the payload is a window inside the buffer storage so headers
+ *          can be prepended into the headroom and trailers appended into
+ *          the tailroom without moving data.<br>
+ *          A buffer returns into its pool when its last reference is
+ *          released.
+ * @pre     In order to use the reference-counted buffers APIs the
+ *          @p CH_CFG_USE_REFBUFS option must be enabled in @p chconf.h.
+ * @note    Compatible with RT and NIL.
+ *
+ * @addtogroup oslib_refbufs
+ * @{
+ */
+
+#include <string.h>
+
+#include "ch.h"
+
+#if (CH_CFG_USE_REFBUFS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+static refbuf_t *refbuf_init(refbuf_pool_t *rbpp, refbuf_t *bp) {
+
+  if (bp != NULL) {
+    bp->next = NULL;
+    bp->pool = rbpp;
+    bp->refs = (cnt_t)1;
+    bp->data = chRefBufGetStorageX(bp) + rbpp->headroom;
+    bp->len  = (size_t)0;
+  }
+
+  return bp;
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p refbuf_pool_t object.
+ *
+ * @param[out] rbpp     pointer to a @p refbuf_pool_t structure
+ * @param[in] size      storage size of each buffer
+ * @param[in] headroom  space reserved in front of the payload on
+ *                      allocation, must be lower or equal to @p size
+ * @param[in] p         pointer to the buffers area, the area must be
+ *                      large enough for @p n buffers of size
+ *                      @p REFBUF_OBJECT_SIZE(size)
+ * @param[in] n         number of buffers in the area
+ *
+ * @init
+ */
+void chRefBufPoolObjectInit(refbuf_pool_t *rbpp, size_t size,
+                            size_t headroom, void *p, size_t n) {
+
+  chDbgCheck((rbpp != NULL) && (size > 0U) && (headroom <= size) &&
+             (p != NULL) && (n > 0U));
+
+  rbpp->size     = size;
+  rbpp->headroom = headroom;
+  chGuardedPoolObjectInitAligned(&rbpp->free, REFBUF_OBJECT_SIZE(size),
+                                 PORT_NATURAL_ALIGN);
+  chGuardedPoolLoadArray(&rbpp->free, p, n);
+}
+
+/**
+ * @brief   Allocates a buffer.
+ * @details The buffer is returned with one reference, an empty payload
+ *          and the pool headroom reserved.
+ *
+ * @param[in] rbpp      pointer to a @p refbuf_pool_t structure
+ * @return              The pointer to the allocated buffer.
+ * @retval NULL         if the pool is empty.
+ *
+ * @iclass
+ */
+refbuf_t *chRefBufAllocI(refbuf_pool_t *rbpp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(rbpp != NULL);
+
+  return refbuf_init(rbpp, (refbuf_t *)chGuardedPoolAllocI(&rbpp->free));
+}
+
+/**
+ * @brief   Allocates a buffer.
+ * @details The buffer is returned with one reference, an empty payload
+ *          and the pool headroom reserved.
+ *
+ * @param[in] rbpp      pointer to a @p refbuf_pool_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The pointer to the allocated buffer.
+ * @retval NULL         if the operation timed out.
+ *
+ * @api
+ */
+refbuf_t *chRefBufAllocTimeout(refbuf_pool_t *rbpp, sysinterval_t timeout) {
+
+  chDbgCheck(rbpp != NULL);
+
+  return refbuf_init(rbpp, (refbuf_t *)chGuardedPoolAllocTimeout(&rbpp->free,
+                                                                 timeout));
+}
+
+/**
+ * @brief   Adds a reference to a buffer chain.
+ * @details Only the chain head is referenced, the rest of the chain is
+ *          owned by the head.
+ *
+ * @param[in] bp        pointer to the buffer chain
+ * @return              The buffer pointer, for convenience.
+ *
+ * @xclass
+ */
+refbuf_t *chRefBufAddRefX(refbuf_t *bp) {
+  syssts_t sts;
+
+  chDbgCheck(bp != NULL);
+
+  sts = chSysGetStatusAndLockX();
+  chDbgAssert(bp->refs > (cnt_t)0, "released buffer");
+  bp->refs++;
+  chSysRestoreStatusX(sts);
+
+  return bp;
+}
+
+/**
+ * @brief   Releases a reference to a buffer chain.
+ * @details When the last reference is released the buffer returns into
+ *          its pool and the release continues along the chain, the walk
+ *          stops at the first buffer still referenced elsewhere.
+ *
+ * @param[in] bp        pointer to the buffer chain
+ *
+ * @iclass
+ */
+void chRefBufReleaseI(refbuf_t *bp) {
+
+  chDbgCheckClassI();
+
+  while (bp != NULL) {
+    refbuf_t *next = bp->next;
+
+    chDbgAssert(bp->refs > (cnt_t)0, "released buffer");
+
+    if (--bp->refs > (cnt_t)0) {
+      break;
+    }
+    chGuardedPoolFreeI(&bp->pool->free, (void *)bp);
+    bp = next;
+  }
+}
+
+/**
+ * @brief   Releases a reference to a buffer chain.
+ * @details When the last reference is released the buffer returns into
+ *          its pool and the release continues along the chain, the walk
+ *          stops at the first buffer still referenced elsewhere.
+ *
+ * @param[in] bp        pointer to the buffer chain
+ *
+ * @api
+ */
+void chRefBufRelease(refbuf_t *bp) {
+
+  chDbgCheck(bp != NULL);
+
+  chSysLock();
+  chRefBufReleaseI(bp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Appends a buffer chain to another chain.
+ * @details The reference held by the caller on @p bp is transferred to
+ *          the chain.
+ *
+ * @param[in] head      pointer to the destination chain
+ * @param[in] bp        pointer to the chain to be appended
+ *
+ * @xclass
+ */
+void chRefBufChain(refbuf_t *head, refbuf_t *bp) {
+
+  chDbgCheck((head != NULL) && (bp != NULL));
+
+  while (head->next != NULL) {
+    head = head->next;
+  }
+  head->next = bp;
+}
+
+/**
+ * @brief   Returns the total payload length of a buffer chain.
+ *
+ * @param[in] bp        pointer to the buffer chain
+ * @return              The total payload length.
+ *
+ * @xclass
+ */
+size_t chRefBufGetChainLength(const refbuf_t *bp) {
+  size_t n = (size_t)0;
+
+  while (bp != NULL) {
+    n += bp->len;
+    bp = bp->next;
+  }
+
+  return n;
+}
+
+/**
+ * @brief   Copies data out of a buffer chain.
+ * @details The chain payloads are treated as a single contiguous area.
+ *
+ * @param[in] bp        pointer to the buffer chain
+ * @param[in] offset    offset of the first byte to be copied
+ * @param[out] dp       pointer to the destination area
+ * @param[in] n         maximum number of bytes to be copied
+ * @return              The number of bytes effectively copied.
+ *
+ * @xclass
+ */
+size_t chRefBufCopyOut(const refbuf_t *bp, size_t offset,
+                       uint8_t *dp, size_t n) {
+  size_t done = (size_t)0;
+
+  chDbgCheck(dp != NULL);
+
+  while ((bp != NULL) && (done < n)) {
+    if (offset >= bp->len) {
+      offset -= bp->len;
+    }
+    else {
+      size_t chunk = bp->len - offset;
+
+      if (chunk > n - done) {
+        chunk = n - done;
+      }
+      memcpy((void *)(dp + done), (const void *)(bp->data + offset), chunk);
+      done  += chunk;
+      offset = (size_t)0;
+    }
+    bp = bp->next;
+  }
+
+  return done;
+}
+
+/**
+ * @brief   Appends data into a buffer tailroom.
+ *
+ * @param[in] bp        pointer to the buffer
+ * @param[in] sp        pointer to the source area
+ * @param[in] n         maximum number of bytes to be copied
+ * @return              The number of bytes effectively copied, it can
+ *                      be less than @p n if the tailroom is exhausted.
+ *
+ * @xclass
+ */
+size_t chRefBufCopyIn(refbuf_t *bp, const uint8_t *sp, size_t n) {
+  size_t room;
+
+  chDbgCheck((bp != NULL) && (sp != NULL));
+
+  room = chRefBufGetTailroomX(bp);
+  if (n > room) {
+    n = room;
+  }
+  memcpy((void *)chRefBufPutX(bp, n), (const void *)sp, n);
+
+  return n;
+}
+
+#if (CH_CFG_USE_PIPES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Writes a buffer chain into a pipe.
+ * @details The chain payloads are written in sequence, pipes are byte
+ *          streams so the data is copied into the pipe buffer. The chain
+ *          is not released.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[in] bp        pointer to the buffer chain
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes effectively transferred.
+ *
+ * @api
+ */
+size_t chPipeWriteRefBufTimeout(pipe_t *pp, const refbuf_t *bp,
+                                sysinterval_t timeout) {
+  size_t done = (size_t)0;
+
+  chDbgCheck(pp != NULL);
+
+  while (bp != NULL) {
+    size_t n;
+
+    /* Empty links are skipped, the pipe does not accept zero sized
+       writes.*/
+    if (bp->len > (size_t)0) {
+      n = chPipeWriteTimeout(pp, bp->data, bp->len, timeout);
+      done += n;
+      if (n < bp->len) {
+        break;
+      }
+    }
+    bp = bp->next;
+  }
+
+  return done;
+}
+
+/**
+ * @brief   Reads from a pipe into a buffer tailroom.
+ * @details The data is read directly into the buffer storage after the
+ *          current payload, the payload is extended accordingly.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[in] bp        pointer to the buffer
+ * @param[in] n         maximum number of bytes to be read, it is limited
+ *                      to the buffer tailroom
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes effectively transferred.
+ *
+ * @api
+ */
+size_t chPipeReadRefBufTimeout(pipe_t *pp, refbuf_t *bp, size_t n,
+                               sysinterval_t timeout) {
+  size_t room;
+
+  chDbgCheck((pp != NULL) && (bp != NULL));
+
+  room = chRefBufGetTailroomX(bp);
+  if (n > room) {
+    n = room;
+  }
+  if (n == (size_t)0) {
+    return (size_t)0;
+  }
+  n = chPipeReadTimeout(pp, bp->data + bp->len, n, timeout);
+  bp->len += n;
+
+  return n;
+}
+#endif /* CH_CFG_USE_PIPES == TRUE */
+
+#endif /* CH_CFG_USE_REFBUFS == TRUE */
+
+/** @} */
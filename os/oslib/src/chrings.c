@@ -0,0 +1,250 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    oslib/src/chrings.c
+ * @brief   SPSC rings code.
+ * @details SPSC rings.
+ *          <h2>Operation mode</h2>
+ *          A ring is a circular buffer of fixed-size elements shared by
+ *          exactly one producer and one consumer, the producer can be an
+ *          ISR. The data path requires no critical sections, each side
+ *          publishes its own counter with release semantic and reads the
+ *          other counter with acquire semantic.<br>
+ *          The consumer can wait for a number of elements to become
+ *          available, in that case the producer enters the kernel lock
+ *          only when the awaited threshold is reached.
+ * @pre     In order to use the rings APIs the @p CH_CFG_USE_RINGS
+ *          option must be enabled in @p chconf.h.
+ * @note    Compatible with RT and NIL.
+ *
+ * @addtogroup oslib_rings
+ * @{
+ */
+
+#include <string.h>
+
+#include "ch.h"
+
+#if (CH_CFG_USE_RINGS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p spsc_ring_t object.
+ *
+ * @param[out] rp       the pointer to the @p spsc_ring_t object
+ * @param[in] buffer    pointer to the ring buffer, it must be able to
+ *                      hold @p n elements of @p esize bytes
+ * @param[in] esize     size of an element, one for byte rings
+ * @param[in] n         number of elements in the buffer, must be a power
+ *                      of two
+ *
+ * @init
+ */
+void chRingObjectInit(spsc_ring_t *rp, void *buffer, size_t esize, size_t n) {
+
+  chDbgCheck((rp != NULL) && (buffer != NULL) && (esize > 0U) &&
+             (n > 0U) && ((n & (n - 1U)) == 0U));
+
+  rp->buffer    = (uint8_t *)buffer;
+  rp->esize     = esize;
+  rp->mask      = n - 1U;
+  rp->wrcnt     = (size_t)0;
+  rp->rdcnt     = (size_t)0;
+  rp->threshold = (size_t)0;
+  rp->waiter    = NULL;
+}
+
+/**
+ * @brief   Ring write.
+ * @details Writes up to @p n elements, the function never blocks and can
+ *          be called from any context, a waiting consumer is woken up
+ *          when the awaited number of elements is available.
+ * @note    Only one producer is allowed.
+ *
+ * @param[in] rp        the pointer to an initialized @p spsc_ring_t object
+ * @param[in] ep        pointer to the elements to be written
+ * @param[in] n         number of elements to be written
+ * @return              The number of elements effectively written.
+ *
+ * @xclass
+ */
+size_t chRingWriteX(spsc_ring_t *rp, const void *ep, size_t n) {
+  size_t wrcnt, used, i, n1;
+
+  chDbgCheck((rp != NULL) && (ep != NULL));
+
+  /* The producer owns the write counter, the read counter is acquired in
+     order to see the consumer releasing the slots.*/
+  wrcnt = rp->wrcnt;
+  used  = wrcnt - __ring_load_acquire(&rp->rdcnt);
+  if (n > (rp->mask + 1U) - used) {
+    n = (rp->mask + 1U) - used;
+  }
+  if (n == 0U) {
+    return 0U;
+  }
+
+  /* Copying in up to two spans.*/
+  i  = wrcnt & rp->mask;
+  n1 = (rp->mask + 1U) - i;
+  if (n1 >= n) {
+    memcpy((void *)(rp->buffer + (i * rp->esize)), ep, n * rp->esize);
+  }
+  else {
+    memcpy((void *)(rp->buffer + (i * rp->esize)), ep, n1 * rp->esize);
+    memcpy((void *)rp->buffer, (const void *)((const uint8_t *)ep +
+                                              (n1 * rp->esize)),
+           (n - n1) * rp->esize);
+  }
+
+  /* Publishing the elements.*/
+  __ring_store_release(&rp->wrcnt, wrcnt + n);
+
+  /* The barrier orders the counter publication with the threshold check,
+     the consumer does the opposite under lock before suspending.*/
+  __ring_full_barrier();
+  if ((rp->threshold > 0U) && (used + n >= rp->threshold)) {
+    syssts_t sts = chSysGetStatusAndLockX();
+
+    if ((rp->waiter != NULL) && (chRingGetUsedX(rp) >= rp->threshold)) {
+      rp->threshold = (size_t)0;
+      chThdResumeI(&rp->waiter, MSG_OK);
+    }
+
+    chSysRestoreStatusX(sts);
+  }
+
+  return n;
+}
+
+/**
+ * @brief   Ring read.
+ * @details Reads up to @p n elements, the function never blocks and can
+ *          be called from any context.
+ * @note    Only one consumer is allowed.
+ *
+ * @param[in] rp        the pointer to an initialized @p spsc_ring_t object
+ * @param[out] ep       pointer to the elements buffer
+ * @param[in] n         number of elements to be read
+ * @return              The number of elements effectively read.
+ *
+ * @xclass
+ */
+size_t chRingReadX(spsc_ring_t *rp, void *ep, size_t n) {
+  size_t rdcnt, used, i, n1;
+
+  chDbgCheck((rp != NULL) && (ep != NULL));
+
+  /* The consumer owns the read counter, the write counter is acquired in
+     order to see the elements published by the producer.*/
+  rdcnt = rp->rdcnt;
+  used  = __ring_load_acquire(&rp->wrcnt) - rdcnt;
+  if (n > used) {
+    n = used;
+  }
+  if (n == 0U) {
+    return 0U;
+  }
+
+  /* Copying out up to two spans.*/
+  i  = rdcnt & rp->mask;
+  n1 = (rp->mask + 1U) - i;
+  if (n1 >= n) {
+    memcpy(ep, (const void *)(rp->buffer + (i * rp->esize)), n * rp->esize);
+  }
+  else {
+    memcpy(ep, (const void *)(rp->buffer + (i * rp->esize)), n1 * rp->esize);
+    memcpy((void *)((uint8_t *)ep + (n1 * rp->esize)),
+           (const void *)rp->buffer, (n - n1) * rp->esize);
+  }
+
+  /* Releasing the slots to the producer.*/
+  __ring_store_release(&rp->rdcnt, rdcnt + n);
+
+  return n;
+}
+
+/**
+ * @brief   Waits for elements to become available.
+ * @details The consumer is suspended until at least @p n elements are
+ *          in the ring, the producer wakes it up once when the threshold
+ *          is reached so notifications are naturally batched.
+ * @note    Only the consumer can call this function.
+ *
+ * @param[in] rp        the pointer to an initialized @p spsc_ring_t object
+ * @param[in] n         number of elements to be awaited
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the elements are available.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chRingWaitTimeout(spsc_ring_t *rp, size_t n, sysinterval_t timeout) {
+  msg_t msg = MSG_OK;
+
+  chDbgCheck((rp != NULL) && (n > 0U) && (n <= chRingGetSizeX(rp)));
+
+  chSysLock();
+
+  /* Announcing the threshold before checking, see chRingWriteX().*/
+  rp->threshold = n;
+  __ring_full_barrier();
+  if (chRingGetUsedX(rp) < n) {
+    msg = chThdSuspendTimeoutS(&rp->waiter, timeout);
+  }
+  rp->threshold = (size_t)0;
+
+  chSysUnlock();
+
+  return msg;
+}
+
+#endif /* CH_CFG_USE_RINGS == TRUE */
+
+/** @} */
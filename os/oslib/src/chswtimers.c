@@ -0,0 +1,411 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+/**
+ * @file    oslib/src/chswtimers.c
+ * @brief   Software timers code.
+ * @details Software timers service.
+ *          <h2>Operation mode</h2>
+ *          A software timers service multiplexes any number of timers on
+ *          a single kernel timeout. Timers are hashed by expiration tick
+ *          into the slots of a timers wheel, so starting and stopping a
+ *          timer are O(1) operations.<br>
+ *          A service thread calls @p chSwtDispatch() in a loop, on each
+ *          wheel tick the expired timers of the current slot are moved
+ *          in a batch into the expired list and then their callbacks are
+ *          invoked from the service thread context, outside the critical
+ *          zone. The service thread only wakes up on wheel ticks while at
+ *          least one timer is armed.
+ * @pre     In order to use the software timers APIs the
+ *          @p CH_CFG_USE_SWTIMERS option must be enabled in @p chconf.h.
+ * @note    Compatible with RT and NIL.
+ *
+ * @addtogroup oslib_swtimers
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_CFG_USE_SWTIMERS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Wheel slot mask.
+ */
+#define SWT_WHEEL_MASK          ((uint32_t)CH_CFG_SWTIMERS_WHEEL_SIZE - 1U)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Converts an interval in wheel ticks rounding up.
+ *
+ * @param[in] ssp       pointer to a @p swtimers_service_t structure
+ * @param[in] interval  the interval to be converted
+ * @return              The number of wheel ticks.
+ *
+ * @notapi
+ */
+static uint32_t swt_ticks(swtimers_service_t *ssp, sysinterval_t interval) {
+  uint32_t ticks;
+
+  ticks = (uint32_t)(interval / ssp->resolution);
+  if ((interval % ssp->resolution) != (sysinterval_t)0) {
+    ticks++;
+  }
+
+  return ticks;
+}
+
+/**
+ * @brief   Links a timer at the head of a list.
+ *
+ * @param[in] headp     pointer to the list head
+ * @param[in] stp       pointer to a @p swtimer_t object
+ *
+ * @notapi
+ */
+static void swt_link(swtimer_t **headp, swtimer_t *stp) {
+
+  stp->next = *headp;
+  if (stp->next != NULL) {
+    stp->next->prevp = &stp->next;
+  }
+  stp->prevp = headp;
+  *headp = stp;
+}
+
+/**
+ * @brief   Unlinks a timer from the list it belongs to.
+ *
+ * @param[in] stp       pointer to a @p swtimer_t object
+ *
+ * @notapi
+ */
+static void swt_unlink(swtimer_t *stp) {
+
+  *stp->prevp = stp->next;
+  if (stp->next != NULL) {
+    stp->next->prevp = stp->prevp;
+  }
+  stp->prevp = NULL;
+}
+
+/**
+ * @brief   Inserts a timer in the wheel.
+ *
+ * @param[in] ssp       pointer to a @p swtimers_service_t structure
+ * @param[in] stp       pointer to a @p swtimer_t object
+ * @param[in] ticks     wheel ticks from the current one, must be non-zero
+ *
+ * @notapi
+ */
+static void swt_insert(swtimers_service_t *ssp, swtimer_t *stp,
+                       uint32_t ticks) {
+
+  stp->deadline = ssp->now + ticks;
+  swt_link(&ssp->slots[stp->deadline & SWT_WHEEL_MASK], stp);
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p swtimers_service_t object.
+ *
+ * @param[out] ssp      pointer to a @p swtimers_service_t structure
+ * @param[in] resolution duration of a wheel tick, timers expire on wheel
+ *                      tick boundaries
+ *
+ * @init
+ */
+void chSwtServiceObjectInit(swtimers_service_t *ssp,
+                            sysinterval_t resolution) {
+  unsigned i;
+
+  chDbgCheck((ssp != NULL) && (resolution > (sysinterval_t)0) &&
+             (resolution != TIME_INFINITE));
+
+  ssp->resolution = resolution;
+  ssp->last       = chVTGetSystemTimeX();
+  ssp->now        = 0U;
+  ssp->armed      = 0U;
+  ssp->thread     = NULL;
+  ssp->expired    = NULL;
+  for (i = 0U; i < (unsigned)CH_CFG_SWTIMERS_WHEEL_SIZE; i++) {
+    ssp->slots[i] = NULL;
+  }
+}
+
+/**
+ * @brief   Starts or restarts a software timer.
+ * @note    The timer expires on the first wheel tick following the
+ *          specified delay.
+ * @pre     The timer must have been initialized using @p chSwtObjectInit()
+ *          or have been used at least once.
+ * @note    Restarting an armed timer is allowed, the previous expiration
+ *          is cancelled.
+ * @post    The service thread could have been made ready but there is no
+ *          reschedule.
+ *
+ * @param[in] ssp       pointer to a @p swtimers_service_t structure
+ * @param[out] stp      pointer to a @p swtimer_t object
+ * @param[in] delay     the number of ticks before the first expiration,
+ *                      the special value @p TIME_INFINITE is not allowed
+ * @param[in] reload    the number of ticks between subsequent expirations,
+ *                      zero for a one-shot timer
+ * @param[in] func      the timer callback function, invoked from the
+ *                      service thread
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @iclass
+ */
+void chSwtSetI(swtimers_service_t *ssp, swtimer_t *stp,
+               sysinterval_t delay, sysinterval_t reload,
+               swtfunc_t func, void *par) {
+  sysinterval_t elapsed;
+  uint32_t ticks;
+
+  chDbgCheckClassI();
+  chDbgCheck((ssp != NULL) && (stp != NULL) && (func != NULL) &&
+             (delay != TIME_INFINITE) && (reload != TIME_INFINITE));
+
+  if (stp->prevp != NULL) {
+    /* Restarting an armed timer, the wheel is not idle.*/
+    chDbgAssert(*stp->prevp == stp, "not initialized or corrupted");
+    swt_unlink(stp);
+  }
+  else {
+    ssp->armed++;
+    if (ssp->armed == 1U) {
+      /* The wheel was idle, it restarts from the current time and the
+         service thread is woken up in order to wait for the next wheel
+         tick.*/
+      ssp->last = chVTGetSystemTimeX();
+      chThdResumeI(&ssp->thread, MSG_OK);
+    }
+  }
+
+  /* The current wheel tick is partially elapsed, the sum is saturated.*/
+  elapsed = chTimeDiffX(ssp->last, chVTGetSystemTimeX());
+  if (delay > TIME_MAX_INTERVAL - elapsed) {
+    delay = TIME_MAX_INTERVAL;
+  }
+  else {
+    delay += elapsed;
+  }
+
+  ticks = swt_ticks(ssp, delay);
+  if (ticks == 0U) {
+    ticks = 1U;
+  }
+
+  stp->reload = swt_ticks(ssp, reload);
+  stp->func   = func;
+  stp->par    = par;
+  swt_insert(ssp, stp, ticks);
+}
+
+/**
+ * @brief   Starts or restarts a software timer.
+ * @note    The timer expires on the first wheel tick following the
+ *          specified delay.
+ * @pre     The timer must have been initialized using @p chSwtObjectInit()
+ *          or have been used at least once.
+ * @note    Restarting an armed timer is allowed, the previous expiration
+ *          is cancelled.
+ *
+ * @param[in] ssp       pointer to a @p swtimers_service_t structure
+ * @param[out] stp      pointer to a @p swtimer_t object
+ * @param[in] delay     the number of ticks before the first expiration,
+ *                      the special value @p TIME_INFINITE is not allowed
+ * @param[in] reload    the number of ticks between subsequent expirations,
+ *                      zero for a one-shot timer
+ * @param[in] func      the timer callback function, invoked from the
+ *                      service thread
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @api
+ */
+void chSwtSet(swtimers_service_t *ssp, swtimer_t *stp,
+              sysinterval_t delay, sysinterval_t reload,
+              swtfunc_t func, void *par) {
+
+  chSysLock();
+  chSwtSetI(ssp, stp, delay, reload, func, par);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Stops a software timer.
+ * @pre     The timer must have been initialized using @p chSwtObjectInit()
+ *          or have been used at least once.
+ * @note    Stopping a timer which is not armed is allowed, the function
+ *          has no effect.
+ * @note    A timer stopped after its expiration but before the invocation
+ *          of its callback is not invoked.
+ *
+ * @param[in] ssp       pointer to a @p swtimers_service_t structure
+ * @param[in] stp       pointer to a @p swtimer_t object
+ *
+ * @iclass
+ */
+void chSwtResetI(swtimers_service_t *ssp, swtimer_t *stp) {
+
+  chDbgCheckClassI();
+  chDbgCheck((ssp != NULL) && (stp != NULL));
+
+  if (stp->prevp != NULL) {
+    chDbgAssert(*stp->prevp == stp, "not initialized or corrupted");
+    swt_unlink(stp);
+    ssp->armed--;
+  }
+}
+
+/**
+ * @brief   Stops a software timer.
+ * @pre     The timer must have been initialized using @p chSwtObjectInit()
+ *          or have been used at least once.
+ * @note    Stopping a timer which is not armed is allowed, the function
+ *          has no effect.
+ * @note    A timer stopped after its expiration but before the invocation
+ *          of its callback is not invoked.
+ *
+ * @param[in] ssp       pointer to a @p swtimers_service_t structure
+ * @param[in] stp       pointer to a @p swtimer_t object
+ *
+ * @api
+ */
+void chSwtReset(swtimers_service_t *ssp, swtimer_t *stp) {
+
+  chSysLock();
+  chSwtResetI(ssp, stp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Waits for the next wheel tick and invokes the expired timers.
+ * @details This function is meant to be called in a loop by the service
+ *          thread, only one thread can serve a software timers service.
+ *          The expired timers are invoked in the order they were started,
+ *          periodic timers are re-armed before invoking their callback.
+ *
+ * @param[in] ssp       pointer to a @p swtimers_service_t structure
+ * @return              The number of invoked callbacks.
+ *
+ * @api
+ */
+cnt_t chSwtDispatch(swtimers_service_t *ssp) {
+  swtimer_t *stp;
+  cnt_t n = (cnt_t)0;
+
+  chDbgCheck(ssp != NULL);
+
+  chSysLock();
+
+  /* Waiting for the next wheel tick, the wheel is not advanced while there
+     are no armed timers.*/
+  while (true) {
+    sysinterval_t elapsed;
+
+    if (ssp->armed == 0U) {
+      (void) chThdSuspendTimeoutS(&ssp->thread, TIME_INFINITE);
+      continue;
+    }
+
+    elapsed = chTimeDiffX(ssp->last, chVTGetSystemTimeX());
+    if (elapsed >= ssp->resolution) {
+      break;
+    }
+
+    (void) chThdSuspendTimeoutS(&ssp->thread, ssp->resolution - elapsed);
+  }
+
+  /* Advancing the wheel, if the service thread is late then the missed
+     wheel ticks are served on the next calls.*/
+  ssp->last = chTimeAddX(ssp->last, ssp->resolution);
+  ssp->now++;
+
+  /* Moving the expired timers of the current slot in the expired list,
+     timers of the slot belonging to later wheel rounds are left there.*/
+  stp = ssp->slots[ssp->now & SWT_WHEEL_MASK];
+  while (stp != NULL) {
+    swtimer_t *next = stp->next;
+
+    if ((int32_t)(stp->deadline - ssp->now) <= (int32_t)0) {
+      swt_unlink(stp);
+      swt_link(&ssp->expired, stp);
+    }
+    stp = next;
+  }
+
+  /* Invoking the callbacks outside the critical zone, the timers are
+     fetched one at time because they could be stopped or restarted by
+     other callbacks.*/
+  while (ssp->expired != NULL) {
+    swtfunc_t func;
+    void *par;
+
+    stp = ssp->expired;
+    swt_unlink(stp);
+    if (stp->reload > 0U) {
+      swt_insert(ssp, stp, stp->reload);
+    }
+    else {
+      ssp->armed--;
+    }
+    func = stp->func;
+    par  = stp->par;
+
+    chSysUnlock();
+    func(par);
+    n++;
+    chSysLock();
+  }
+
+  chSysUnlock();
+
+  return n;
+}
+
+#endif /* CH_CFG_USE_SWTIMERS == TRUE */
+
+/** @} */
@@ -423,6 +423,20 @@
 #define CH_CFG_USE_OBJ_FIFOS                TRUE
 #endif
 
+/**
+ * @brief   Lock-free objects FIFOs.
+ * @details If enabled then the objects FIFOs use lock-free structures,
+ *          the kernel is entered only when a thread has to wait or has
+ *          to be woken up.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Sending objects ahead is not supported in this mode.
+ * @note    Objects must be at least @p sizeof(msg_t) bytes in this mode.
+ */
+#if !defined(CH_CFG_OBJ_FIFOS_LOCKFREE)
+#define CH_CFG_OBJ_FIFOS_LOCKFREE           FALSE
+#endif
+
 /**
  * @brief   Pipes APIs.
  * @details If enabled then the pipes APIs are included
@@ -434,6 +448,41 @@
 #define CH_CFG_USE_PIPES                    TRUE
 #endif
 
+/**
+ * @brief   SPSC rings APIs.
+ * @details If enabled then the single-producer single-consumer rings APIs
+ *          are included in the kernel.
+ *
+ * @note    The default is @p TRUE.
+ */
+#if !defined(CH_CFG_USE_RINGS)
+#define CH_CFG_USE_RINGS                    TRUE
+#endif
+
+/**
+ * @brief   Reference-counted buffers APIs.
+ * @details If enabled then the reference-counted buffers APIs are included
+ *          in the kernel.
+ *
+ * @note    The default is @p TRUE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS and @p CH_CFG_USE_SEMAPHORES.
+ */
+#if !defined(CH_CFG_USE_REFBUFS)
+#define CH_CFG_USE_REFBUFS                  TRUE
+#endif
+
+/**
+ * @brief   Messages bus APIs.
+ * @details If enabled then the publish/subscribe messages bus APIs are
+ *          included in the kernel.
+ *
+ * @note    The default is @p TRUE.
+ * @note    Requires @p CH_CFG_USE_REFBUFS.
+ */
+#if !defined(CH_CFG_USE_BUS)
+#define CH_CFG_USE_BUS                      TRUE
+#endif
+
 /**
  * @brief   Objects Caches APIs.
  * @details If enabled then the objects caches APIs are included
@@ -445,6 +494,17 @@
 #define CH_CFG_USE_OBJ_CACHES               TRUE
 #endif
 
+/**
+ * @brief   Objects Caches 2Q replacement policy.
+ * @details If enabled then the objects caches use a scan-resistant 2Q
+ *          replacement policy instead of a plain LRU.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_OBJ_CACHES_USE_2Q)
+#define CH_CFG_OBJ_CACHES_USE_2Q            FALSE
+#endif
+
 /**
  * @brief   Delegate threads APIs.
  * @details If enabled then the delegate threads APIs are included
@@ -456,6 +516,16 @@
 #define CH_CFG_USE_DELEGATES                TRUE
 #endif
 
+/**
+ * @brief   Maximum number of asynchronous delegate calls served on each
+ *          dispatcher wakeup.
+ *
+ * @note    The default is @p 4.
+ */
+#if !defined(CH_CFG_DELEGATES_ASYNC_BATCH)
+#define CH_CFG_DELEGATES_ASYNC_BATCH        4
+#endif
+
 /**
  * @brief   Jobs Queues APIs.
  * @details If enabled then the jobs queues APIs are included
@@ -467,6 +537,74 @@
 #define CH_CFG_USE_JOBS                     TRUE
 #endif
 
+/**
+ * @brief   Number of priority lanes in jobs executors.
+ *
+ * @note    The default is @p 3.
+ */
+#if !defined(CH_CFG_JOBS_EXEC_LANES)
+#define CH_CFG_JOBS_EXEC_LANES              3
+#endif
+
+/**
+ * @brief   Maximum number of worker threads in jobs executors.
+ *
+ * @note    The default is @p 4.
+ */
+#if !defined(CH_CFG_JOBS_EXEC_MAX_WORKERS)
+#define CH_CFG_JOBS_EXEC_MAX_WORKERS        4
+#endif
+
+/**
+ * @brief   Maximum number of jobs taken by a worker on each wakeup.
+ *
+ * @note    The default is @p 4.
+ */
+#if !defined(CH_CFG_JOBS_EXEC_BATCH)
+#define CH_CFG_JOBS_EXEC_BATCH              4
+#endif
+
+/**
+ * @brief   Jobs executors latency statistics.
+ * @details If enabled then jobs queueing and execution latencies are
+ *          measured using the realtime counter.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_JOBS_EXEC_STATISTICS)
+#define CH_CFG_JOBS_EXEC_STATISTICS         FALSE
+#endif
+
+/**
+ * @brief   Maximum number of worker threads in work-stealing jobs groups.
+ *
+ * @note    The default is @p 4.
+ */
+#if !defined(CH_CFG_JOBS_SMP_MAX_WORKERS)
+#define CH_CFG_JOBS_SMP_MAX_WORKERS         4
+#endif
+
+/**
+ * @brief   Software Timers APIs.
+ * @details If enabled then the software timers service APIs are included
+ *          in the kernel.
+ *
+ * @note    The default is @p TRUE.
+ */
+#if !defined(CH_CFG_USE_SWTIMERS)
+#define CH_CFG_USE_SWTIMERS                 TRUE
+#endif
+
+/**
+ * @brief   Number of slots in the software timers wheel.
+ * @note    Must be a power of two.
+ *
+ * @note    The default is @p 64.
+ */
+#if !defined(CH_CFG_SWTIMERS_WHEEL_SIZE)
+#define CH_CFG_SWTIMERS_WHEEL_SIZE          64
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -538,6 +676,17 @@
 #define CH_CFG_FACTORY_PIPES                TRUE
 #endif
 
+/**
+ * @brief   Number of hash buckets in the objects lists.
+ * @details If greater than zero then objects names are indexed using an
+ *          hash table of the specified size. If zero then objects are
+ *          kept in simple lists scanned linearly.
+ * @note    The value must be zero or a power of two.
+ */
+#if !defined(CH_CFG_FACTORY_HASH_BUCKETS)
+#define CH_CFG_FACTORY_HASH_BUCKETS         0
+#endif
+
 /** @} */
 
 /*===========================================================================*/
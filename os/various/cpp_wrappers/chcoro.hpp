@@ -0,0 +1,956 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    chcoro.hpp
+ * @brief   C++20 coroutines executor classes and definitions.
+ * @details Many coroutine tasks are run by a single ChibiOS thread, a task
+ *          only needs its coroutine frame, allocated from the default heap,
+ *          instead of its own stack. Tasks suspend on awaitables instead of
+ *          blocking the executor thread:
+ *          - Timed waits are kept into a list ordered by deadline.
+ *          - Events are signaled to the executor thread, waiting tasks are
+ *            resumed as soon as the executor thread is woken up.
+ *          - Semaphores, mailboxes and HAL channels are polled without
+ *            blocking on each executor wakeup, while tasks are waiting on
+ *            them the executor wakes up at least once every poll interval.
+ *            Producers can shorten the latency by kicking the executor.
+ *            Polled tasks are checked in the order they started waiting.
+ *          .
+ * @note    Threads waiting on a semaphore or mailbox are always served
+ *          before the polled tasks, a task only succeeds when no thread is
+ *          waiting on the same object. Objects shared between threads and
+ *          tasks under constant load can starve the tasks.
+ * @note    Tasks are started only by @p CoroutineExecutor::spawn() and
+ *          can @p co_await only the awaitables defined here, there is no
+ *          support for awaiting other tasks.
+ * @note    All the executor methods, except the kick methods, must be
+ *          invoked from the executor thread or before the executor is
+ *          started.
+ *
+ * @addtogroup cpp_library
+ * @{
+ */
+
+#include <coroutine>
+#include <new>
+
+#include <ch.h>
+
+#ifndef _CHCORO_HPP_
+#define _CHCORO_HPP_
+
+/**
+ * @brief   ChibiOS-RT kernel-related classes and interfaces.
+ */
+namespace chibios_rt {
+
+  /* Forward declaration of some classes.*/
+  class CoroutineExecutor;
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineWaiter                                            *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Suspended coroutine descriptor.
+   * @details Waiters are embedded in the awaitables, so they live in the
+   *          frame of the suspended coroutine.
+   */
+  struct CoroutineWaiter {
+    /**
+     * @brief   Next waiter in the executor list.
+     */
+    CoroutineWaiter             *next;
+    /**
+     * @brief   Handle of the suspended coroutine.
+     */
+    std::coroutine_handle<>     handle;
+    /**
+     * @brief   Non-blocking completion check, @p nullptr for timed waits.
+     */
+    bool                        (*poll)(void *obj, CoroutineExecutor *exp);
+    /**
+     * @brief   Object passed to the completion check.
+     */
+    void                        *obj;
+    /**
+     * @brief   The waiter needs periodic polling.
+     */
+    bool                        polled;
+    /**
+     * @brief   Wait start time.
+     */
+    systime_t                   start;
+    /**
+     * @brief   Wait timeout.
+     */
+    sysinterval_t               timeout;
+    /**
+     * @brief   Wait result.
+     */
+    msg_t                       result;
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineTask                                              *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Coroutine task.
+   * @details Return type of the coroutines run by a @p CoroutineExecutor.
+   *          The coroutine is created suspended, the executor takes its
+   *          ownership on spawn and destroys it on completion.
+   */
+  class CoroutineTask {
+  public:
+    /**
+     * @brief   Coroutine promise.
+     */
+    struct promise_type {
+      /**
+       * @brief   Waiter used to start the coroutine.
+       */
+      CoroutineWaiter           start;
+      /**
+       * @brief   Executor running the coroutine.
+       */
+      CoroutineExecutor         *executor = nullptr;
+
+      CoroutineTask get_return_object(void) noexcept {
+
+        return CoroutineTask(handle_type::from_promise(*this));
+      }
+
+      static CoroutineTask get_return_object_on_allocation_failure(void) noexcept {
+
+        return CoroutineTask(nullptr);
+      }
+
+      std::suspend_always initial_suspend(void) noexcept {
+
+        return {};
+      }
+
+      std::suspend_always final_suspend(void) noexcept {
+
+        return {};
+      }
+
+      void return_void(void) noexcept {
+
+      }
+
+      void unhandled_exception(void) noexcept {
+
+        chSysHalt("coroutine exception");
+      }
+
+      /**
+       * @brief   Coroutine frame allocator.
+       * @details Frames are allocated from the default heap with the
+       *          alignment expected by the plain @p new operator.
+       */
+      static void *operator new(size_t size) noexcept {
+
+#if CH_CFG_USE_HEAP == TRUE
+        return chHeapAllocAligned(nullptr, size,
+                                  (unsigned)__STDCPP_DEFAULT_NEW_ALIGNMENT__);
+#else
+        return ::operator new(size, std::nothrow);
+#endif
+      }
+
+      /**
+       * @brief   Coroutine frame deallocator.
+       */
+      static void operator delete(void *p) noexcept {
+
+#if CH_CFG_USE_HEAP == TRUE
+        chHeapFree(p);
+#else
+        ::operator delete(p);
+#endif
+      }
+    };
+
+    /**
+     * @brief   Type of the coroutine handle.
+     */
+    typedef std::coroutine_handle<promise_type> handle_type;
+
+    /* Prohibit copy construction and assignment.*/
+    CoroutineTask(const CoroutineTask &) = delete;
+    CoroutineTask &operator=(const CoroutineTask &) = delete;
+
+    /**
+     * @brief   Move constructor.
+     */
+    CoroutineTask(CoroutineTask &&other) noexcept : handle(other.handle) {
+
+      other.handle = nullptr;
+    }
+
+    /**
+     * @brief   Destroys a coroutine not spawned in an executor.
+     */
+    ~CoroutineTask() {
+
+      if (handle) {
+        handle.destroy();
+      }
+    }
+
+    /**
+     * @brief   Returns @p false if the coroutine frame allocation failed.
+     *
+     * @xclass
+     */
+    bool isValid(void) const {
+
+      return (bool)handle;
+    }
+
+  private:
+    friend class CoroutineExecutor;
+
+    explicit CoroutineTask(handle_type h) noexcept : handle(h) {
+
+    }
+
+    /**
+     * @brief   Handle of the owned coroutine.
+     */
+    handle_type                 handle;
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineExecutor                                          *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Coroutines executor.
+   * @details The executor runs on the thread invoking @p run().
+   */
+  class CoroutineExecutor {
+  public:
+    /**
+     * @brief   Event used to kick the executor.
+     * @note    This event cannot be used by the tasks.
+     */
+    static constexpr eventmask_t kickEvent = EVENT_MASK(sizeof (eventmask_t) * 8U - 1U);
+
+    /**
+     * @brief   Default interval between polls.
+     * @note    Shorter intervals reduce the latency of the polled waits but
+     *          wake up the executor thread more often while they are
+     *          pending, producers kicking the executor get both.
+     */
+    static constexpr sysinterval_t defaultPollInterval = TIME_MS2I(10);
+
+    /**
+     * @brief   Executor constructor.
+     *
+     * @param[in] interval  maximum interval between polls of the tasks
+     *                      waiting on semaphores, mailboxes or channels
+     *
+     * @init
+     */
+    CoroutineExecutor(sysinterval_t interval = defaultPollInterval) :
+        poll_interval(interval) {
+
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    CoroutineExecutor(const CoroutineExecutor &) = delete;
+    CoroutineExecutor &operator=(const CoroutineExecutor &) = delete;
+
+    /**
+     * @brief   Spawns a task.
+     * @details The executor takes the ownership of the coroutine, the task
+     *          starts on the next executor cycle.
+     *
+     * @param[in] task      the task to be spawned
+     * @return              The operation result.
+     * @retval false        if the coroutine frame allocation failed.
+     *
+     * @api
+     */
+    bool spawn(CoroutineTask &&task) {
+      CoroutineTask::handle_type h = task.handle;
+
+      if (!h) {
+        return false;
+      }
+      task.handle = nullptr;
+
+      h.promise().executor   = this;
+      h.promise().start.handle = h;
+      schedule(&h.promise().start);
+      tasks++;
+
+      return true;
+    }
+
+    /**
+     * @brief   Runs the tasks.
+     * @details The function returns when all the spawned tasks terminated.
+     *
+     * @api
+     */
+    void run(void) {
+
+      thread = chThdGetSelfX();
+      while (tasks > 0) {
+        CoroutineWaiter *wp = ready_head;
+
+        /* Resuming the coroutines ready at the start of the cycle, the
+           coroutines yielding are resumed on the next cycle. A coroutine
+           terminating is destroyed immediately.*/
+        ready_head = nullptr;
+        ready_tail = nullptr;
+        while (wp != nullptr) {
+          std::coroutine_handle<> h = wp->handle;
+
+          wp = wp->next;
+          h.resume();
+          if (h.done()) {
+            h.destroy();
+            tasks--;
+          }
+        }
+
+        /* Collecting events and expired waits, if nothing is ready then
+           the thread sleeps until the next deadline or event.*/
+        sysinterval_t next = serve();
+        if ((ready_head == nullptr) && (tasks > 0)) {
+          events |= chEvtWaitAnyTimeout(ALL_EVENTS, next);
+        }
+      }
+      thread = nullptr;
+    }
+
+    /**
+     * @brief   Kicks the executor.
+     * @details The executor polls the waiting tasks as soon as possible.
+     *
+     * @iclass
+     */
+    void kickI(void) {
+
+      chDbgCheckClassI();
+
+      if (thread != nullptr) {
+        chEvtSignalI(thread, kickEvent);
+      }
+    }
+
+    /**
+     * @brief   Kicks the executor.
+     * @details The executor polls the waiting tasks as soon as possible.
+     *
+     * @api
+     */
+    void kick(void) {
+
+      chSysLock();
+      kickI();
+      chSchRescheduleS();
+      chSysUnlock();
+    }
+
+    /**
+     * @brief   Returns the executor thread.
+     * @details Events for the tasks must be signaled to this thread.
+     *
+     * @return              The executor thread or @p nullptr if the
+     *                      executor is not running.
+     *
+     * @xclass
+     */
+    thread_t *getThreadX(void) const {
+
+      return thread;
+    }
+
+    /**
+     * @brief   Returns the number of running tasks.
+     *
+     * @xclass
+     */
+    cnt_t getTasksX(void) const {
+
+      return tasks;
+    }
+
+    /**
+     * @brief   Makes a waiter ready.
+     *
+     * @notapi
+     */
+    void schedule(CoroutineWaiter *wp) {
+
+      wp->next = nullptr;
+      if (ready_tail == nullptr) {
+        ready_head = wp;
+      }
+      else {
+        ready_tail->next = wp;
+      }
+      ready_tail = wp;
+    }
+
+    /**
+     * @brief   Enqueues a timed wait.
+     * @details The list is ordered by deadline, waits of equal length are
+     *          appended in constant time.
+     *
+     * @notapi
+     */
+    void sleep(CoroutineWaiter *wp) {
+      systime_t now = chVTGetSystemTimeX();
+      sysinterval_t rem = remaining(wp, now);
+      CoroutineWaiter **pp;
+
+      wp->next = nullptr;
+      if ((sleep_tail == nullptr) || (remaining(sleep_tail, now) <= rem)) {
+        pp = (sleep_tail == nullptr) ? &sleep_head : &sleep_tail->next;
+        sleep_tail = wp;
+      }
+      else {
+        pp = &sleep_head;
+        while (remaining(*pp, now) <= rem) {
+          pp = &(*pp)->next;
+        }
+        wp->next = *pp;
+      }
+      *pp = wp;
+    }
+
+    /**
+     * @brief   Enqueues a wait on a completion check.
+     * @details Waits are appended, older waits are checked first.
+     *
+     * @notapi
+     */
+    void wait(CoroutineWaiter *wp) {
+
+      wp->next    = nullptr;
+      *wait_tailp = wp;
+      wait_tailp  = &wp->next;
+    }
+
+    /**
+     * @brief   Fetches pending events matching a mask.
+     *
+     * @notapi
+     */
+    eventmask_t fetchEvents(eventmask_t mask) {
+      eventmask_t m = events & mask;
+
+      events &= ~m;
+      return m;
+    }
+
+  private:
+    /**
+     * @brief   Remaining time of a wait.
+     */
+    static sysinterval_t remaining(const CoroutineWaiter *wp, systime_t now) {
+      sysinterval_t elapsed = chTimeDiffX(wp->start, now);
+
+      return elapsed >= wp->timeout ? (sysinterval_t)0 : wp->timeout - elapsed;
+    }
+
+    /**
+     * @brief   Makes ready the completed and expired waiters.
+     *
+     * @return              The interval before the next executor cycle.
+     */
+    sysinterval_t serve(void) {
+      sysinterval_t next = TIME_INFINITE;
+      systime_t now;
+      CoroutineWaiter **pp;
+
+      events |= chEvtGetAndClearEvents(ALL_EVENTS);
+      now = chVTGetSystemTimeX();
+
+      /* Expired timed waits.*/
+      while ((sleep_head != nullptr) && (remaining(sleep_head, now) == (sysinterval_t)0)) {
+        CoroutineWaiter *wp = sleep_head;
+
+        sleep_head = wp->next;
+        if (sleep_head == nullptr) {
+          sleep_tail = nullptr;
+        }
+        wp->result = MSG_TIMEOUT;
+        schedule(wp);
+      }
+      if (sleep_head != nullptr) {
+        next = remaining(sleep_head, now);
+      }
+
+      /* Completion checks.*/
+      pp = &wait_head;
+      while (*pp != nullptr) {
+        CoroutineWaiter *wp = *pp;
+        sysinterval_t rem = TIME_INFINITE;
+        bool done;
+
+        done = wp->poll(wp->obj, this);
+        if (done) {
+          wp->result = MSG_OK;
+        }
+        else if (wp->timeout != TIME_INFINITE) {
+          rem = remaining(wp, now);
+          if (rem == (sysinterval_t)0) {
+            wp->result = MSG_TIMEOUT;
+            done = true;
+          }
+        }
+
+        if (done) {
+          *pp = wp->next;
+          if (wait_tailp == &wp->next) {
+            wait_tailp = pp;
+          }
+          schedule(wp);
+          continue;
+        }
+
+        if (wp->polled && (poll_interval < rem)) {
+          rem = poll_interval;
+        }
+        if (rem < next) {
+          next = rem;
+        }
+        pp = &wp->next;
+      }
+
+      events &= ~kickEvent;
+
+      return next;
+    }
+
+    /**
+     * @brief   Executor thread.
+     */
+    thread_t                    *thread = nullptr;
+    /**
+     * @brief   Interval between polls.
+     */
+    sysinterval_t               poll_interval;
+    /**
+     * @brief   Number of running tasks.
+     */
+    cnt_t                       tasks = (cnt_t)0;
+    /**
+     * @brief   Events received and not yet fetched.
+     */
+    eventmask_t                 events = (eventmask_t)0;
+    /**
+     * @brief   Ready waiters list.
+     */
+    CoroutineWaiter             *ready_head = nullptr;
+    CoroutineWaiter             *ready_tail = nullptr;
+    /**
+     * @brief   Timed waits list.
+     */
+    CoroutineWaiter             *sleep_head = nullptr;
+    CoroutineWaiter             *sleep_tail = nullptr;
+    /**
+     * @brief   Completion checks list.
+     */
+    CoroutineWaiter             *wait_head = nullptr;
+    CoroutineWaiter             **wait_tailp = &wait_head;
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineAwaitable                                         *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Base class of the polled awaitables.
+   * @details The derived class implements @p tryNow(), a non-blocking
+   *          attempt, the coroutine is suspended only if the first attempt
+   *          fails and the timeout is not @p TIME_IMMEDIATE.
+   */
+  template <typename T>
+  class CoroutineAwaitable {
+  public:
+    CoroutineAwaitable(sysinterval_t timeout, bool polled) {
+
+      waiter.timeout = timeout;
+      waiter.polled  = polled;
+      waiter.result  = MSG_TIMEOUT;
+    }
+
+    bool await_ready(void) {
+
+      if (static_cast<T *>(this)->tryNow(nullptr)) {
+        waiter.result = MSG_OK;
+        return true;
+      }
+      return waiter.timeout == TIME_IMMEDIATE;
+    }
+
+    void await_suspend(CoroutineTask::handle_type h) {
+
+      waiter.handle = h;
+      waiter.poll   = check;
+      waiter.obj    = static_cast<T *>(this);
+      waiter.start  = chVTGetSystemTimeX();
+      h.promise().executor->wait(&waiter);
+    }
+
+  protected:
+    /**
+     * @brief   Waiter of the suspended coroutine.
+     */
+    CoroutineWaiter             waiter;
+
+  private:
+    static bool check(void *obj, CoroutineExecutor *exp) {
+
+      return static_cast<T *>(obj)->tryNow(exp);
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineSleep                                             *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Awaitable suspending a coroutine for an interval.
+   * @details A zero interval just yields to the other ready coroutines.
+   */
+  class CoroutineSleep {
+  public:
+    explicit CoroutineSleep(sysinterval_t interval) {
+
+      waiter.timeout = interval;
+    }
+
+    bool await_ready(void) {
+
+      return false;
+    }
+
+    void await_suspend(CoroutineTask::handle_type h) {
+      CoroutineExecutor *exp = h.promise().executor;
+
+      waiter.handle = h;
+      if (waiter.timeout == (sysinterval_t)0) {
+        exp->schedule(&waiter);
+      }
+      else {
+        waiter.start = chVTGetSystemTimeX();
+        exp->sleep(&waiter);
+      }
+    }
+
+    void await_resume(void) {
+
+    }
+
+  private:
+    CoroutineWaiter             waiter;
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineSemaphoreWait                                     *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Awaitable waiting on a counter semaphore.
+   * @details The result is @p MSG_OK or @p MSG_TIMEOUT.
+   */
+  class CoroutineSemaphoreWait :
+      public CoroutineAwaitable<CoroutineSemaphoreWait> {
+  public:
+    CoroutineSemaphoreWait(semaphore_t *sp, sysinterval_t timeout) :
+        CoroutineAwaitable(timeout, true), sem(sp) {
+
+    }
+
+    bool tryNow(CoroutineExecutor *exp) {
+
+      (void)exp;
+
+      return chSemWaitTimeout(sem, TIME_IMMEDIATE) == MSG_OK;
+    }
+
+    msg_t await_resume(void) {
+
+      return waiter.result;
+    }
+
+  private:
+    semaphore_t                 *sem;
+  };
+
+#if (CH_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineMailboxFetch                                      *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Awaitable fetching a message from a mailbox.
+   * @details The result is @p MSG_OK, @p MSG_RESET or @p MSG_TIMEOUT.
+   */
+  class CoroutineMailboxFetch :
+      public CoroutineAwaitable<CoroutineMailboxFetch> {
+  public:
+    CoroutineMailboxFetch(mailbox_t *mbp, msg_t *msgp, sysinterval_t timeout) :
+        CoroutineAwaitable(timeout, true), mbx(mbp), msgp(msgp) {
+
+    }
+
+    bool tryNow(CoroutineExecutor *exp) {
+
+      (void)exp;
+
+      msg_t msg = chMBFetchTimeout(mbx, msgp, TIME_IMMEDIATE);
+      if (msg == MSG_RESET) {
+        reset = true;
+        return true;
+      }
+      return msg == MSG_OK;
+    }
+
+    msg_t await_resume(void) {
+
+      return reset ? MSG_RESET : waiter.result;
+    }
+
+  private:
+    mailbox_t                   *mbx;
+    msg_t                       *msgp;
+    bool                        reset = false;
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineMailboxPost                                       *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Awaitable posting a message into a mailbox.
+   * @details The result is @p MSG_OK, @p MSG_RESET or @p MSG_TIMEOUT.
+   */
+  class CoroutineMailboxPost :
+      public CoroutineAwaitable<CoroutineMailboxPost> {
+  public:
+    CoroutineMailboxPost(mailbox_t *mbp, msg_t msg, sysinterval_t timeout) :
+        CoroutineAwaitable(timeout, true), mbx(mbp), msg(msg) {
+
+    }
+
+    bool tryNow(CoroutineExecutor *exp) {
+
+      (void)exp;
+
+      msg_t res = chMBPostTimeout(mbx, msg, TIME_IMMEDIATE);
+      if (res == MSG_RESET) {
+        reset = true;
+        return true;
+      }
+      return res == MSG_OK;
+    }
+
+    msg_t await_resume(void) {
+
+      return reset ? MSG_RESET : waiter.result;
+    }
+
+  private:
+    mailbox_t                   *mbx;
+    msg_t                       msg;
+    bool                        reset = false;
+  };
+#endif /* CH_CFG_USE_MAILBOXES == TRUE */
+
+#if (CH_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineEventsWait                                        *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Awaitable waiting for events signaled to the executor thread.
+   * @details The result is the mask of the fetched events, zero on timeout.
+   */
+  class CoroutineEventsWait :
+      public CoroutineAwaitable<CoroutineEventsWait> {
+  public:
+    CoroutineEventsWait(eventmask_t events, sysinterval_t timeout) :
+        CoroutineAwaitable(timeout, false), mask(events) {
+
+    }
+
+    bool tryNow(CoroutineExecutor *exp) {
+
+      /* The first attempt happens before suspension, the executor is
+         not known yet.*/
+      if (exp == nullptr) {
+        return false;
+      }
+      fetched = exp->fetchEvents(mask);
+      return fetched != (eventmask_t)0;
+    }
+
+    eventmask_t await_resume(void) {
+
+      return fetched;
+    }
+
+  private:
+    eventmask_t                 mask;
+    eventmask_t                 fetched = (eventmask_t)0;
+  };
+#endif /* CH_CFG_USE_EVENTS == TRUE */
+
+#if defined(HAL_CHANNELS_H) || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineChannelRead                                       *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Awaitable reading from a HAL channel.
+   * @details The result is the number of bytes read, less than requested
+   *          on timeout.
+   */
+  class CoroutineChannelRead :
+      public CoroutineAwaitable<CoroutineChannelRead> {
+  public:
+    CoroutineChannelRead(BaseChannel *chp, uint8_t *bp, size_t n,
+                         sysinterval_t timeout) :
+        CoroutineAwaitable(timeout, true), chp(chp), bp(bp), n(n) {
+
+    }
+
+    bool tryNow(CoroutineExecutor *exp) {
+
+      (void)exp;
+
+      cnt += chnReadTimeout(chp, bp + cnt, n - cnt, TIME_IMMEDIATE);
+      return cnt >= n;
+    }
+
+    size_t await_resume(void) {
+
+      return cnt;
+    }
+
+  private:
+    BaseChannel                 *chp;
+    uint8_t                     *bp;
+    size_t                      n;
+    size_t                      cnt = 0U;
+  };
+#endif /* defined(HAL_CHANNELS_H) */
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::Coroutine                                                  *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Class encapsulating the awaitables factory.
+   */
+  class Coroutine {
+  public:
+
+    /**
+     * @brief   Suspends the invoking coroutine for an interval.
+     *
+     * @param[in] interval  the sleep interval, zero just yields
+     */
+    static CoroutineSleep sleep(sysinterval_t interval) {
+
+      return CoroutineSleep(interval);
+    }
+
+    /**
+     * @brief   Yields to the other ready coroutines.
+     */
+    static CoroutineSleep yield(void) {
+
+      return CoroutineSleep((sysinterval_t)0);
+    }
+
+    /**
+     * @brief   Waits on a counter semaphore.
+     *
+     * @param[in] sp        pointer to a @p semaphore_t object
+     * @param[in] timeout   the number of ticks before the operation timeouts
+     */
+    static CoroutineSemaphoreWait wait(semaphore_t *sp,
+                                              sysinterval_t timeout = TIME_INFINITE) {
+
+      return CoroutineSemaphoreWait(sp, timeout);
+    }
+
+#if (CH_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+    /**
+     * @brief   Fetches a message from a mailbox.
+     *
+     * @param[in] mbp       pointer to a @p mailbox_t object
+     * @param[out] msgp     pointer to the fetched message
+     * @param[in] timeout   the number of ticks before the operation timeouts
+     */
+    static CoroutineMailboxFetch fetch(mailbox_t *mbp, msg_t *msgp,
+                                              sysinterval_t timeout = TIME_INFINITE) {
+
+      return CoroutineMailboxFetch(mbp, msgp, timeout);
+    }
+
+    /**
+     * @brief   Posts a message into a mailbox.
+     *
+     * @param[in] mbp       pointer to a @p mailbox_t object
+     * @param[in] msg       the message to be posted
+     * @param[in] timeout   the number of ticks before the operation timeouts
+     */
+    static CoroutineMailboxPost post(mailbox_t *mbp, msg_t msg,
+                                            sysinterval_t timeout = TIME_INFINITE) {
+
+      return CoroutineMailboxPost(mbp, msg, timeout);
+    }
+#endif
+
+#if (CH_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
+    /**
+     * @brief   Waits for events signaled to the executor thread.
+     *
+     * @param[in] events    events to be waited for
+     * @param[in] timeout   the number of ticks before the operation timeouts
+     */
+    static CoroutineEventsWait waitEvents(eventmask_t events,
+                                                 sysinterval_t timeout = TIME_INFINITE) {
+
+      return CoroutineEventsWait(events, timeout);
+    }
+#endif
+
+#if defined(HAL_CHANNELS_H) || defined(__DOXYGEN__)
+    /**
+     * @brief   Reads from a HAL channel.
+     *
+     * @param[in] chp       pointer to a @p BaseChannel object
+     * @param[out] bp       pointer to the data buffer
+     * @param[in] n         the number of bytes to be read
+     * @param[in] timeout   the number of ticks before the operation timeouts
+     */
+    static CoroutineChannelRead read(BaseChannel *chp, uint8_t *bp,
+                                            size_t n,
+                                            sysinterval_t timeout = TIME_INFINITE) {
+
+      return CoroutineChannelRead(chp, bp, n, timeout);
+    }
+#endif
+  };
+}
+
+#endif /* _CHCORO_HPP_ */
+
+/** @} */
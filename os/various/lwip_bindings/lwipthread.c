@@ -63,6 +63,7 @@
 #include <lwip/opt.h>
 #include <lwip/def.h>
 #include <lwip/mem.h>
+#include <lwip/memp.h>
 #include <lwip/pbuf.h>
 #include <lwip/sys.h>
 #include <lwip/stats.h>
@@ -82,6 +83,18 @@
 #define PERIODIC_TIMER_ID       1
 #define FRAME_RECEIVED_ID       2
 
+#if LWIP_MAC_ZERO_COPY
+#if (MAC_USE_ZERO_COPY != TRUE) || (MAC_SUPPORTS_BUFFER_REFERENCES != TRUE)
+#error "LWIP_MAC_ZERO_COPY requires MAC_USE_ZERO_COPY and buffer references"
+#endif
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#error "LWIP_MAC_ZERO_COPY requires LWIP_SUPPORT_CUSTOM_PBUF"
+#endif
+#if ETH_PAD_SIZE
+#error "LWIP_MAC_ZERO_COPY does not support ETH_PAD_SIZE"
+#endif
+#endif
+
 /*
  * Suspension point for initialization procedure.
  */
@@ -92,6 +105,64 @@ thread_reference_t lwip_trp = NULL;
  */
 static THD_WORKING_AREA(wa_lwip_thread, LWIP_THREAD_STACK_SIZE);
 
+#if LWIP_MAC_ZERO_COPY
+/*
+ * Custom pbuf wrapping a MAC receive buffer.
+ */
+typedef struct {
+  struct pbuf_custom    pc;
+  MACReceiveDescriptor  rd;
+} rx_pbuf_t;
+
+LWIP_MEMPOOL_DECLARE(RX_PBUF, LWIP_MAC_RX_PBUFS, sizeof (rx_pbuf_t),
+                     "MAC RX pbufs");
+
+/*
+ * Gives the receive buffer back to the MAC when the pbuf is freed.
+ */
+static void rx_pbuf_free(struct pbuf *p) {
+  rx_pbuf_t *rpp = (rx_pbuf_t *)p;
+
+  macReleaseReceiveDescriptor(&rpp->rd);
+  LWIP_MEMPOOL_FREE(RX_PBUF, rpp);
+}
+
+/*
+ * Wraps a received frame in a custom pbuf. Returns NULL, leaving the
+ * descriptor untouched, if there are no free wrappers or if the frame
+ * is not contained in a single buffer.
+ */
+static struct pbuf *rx_pbuf_wrap(const MACReceiveDescriptor *rdp) {
+  rx_pbuf_t *rpp;
+  const uint8_t *buf;
+  size_t size;
+
+  rpp = (rx_pbuf_t *)LWIP_MEMPOOL_ALLOC(RX_PBUF);
+  if (rpp == NULL)
+    return NULL;
+
+  rpp->rd = *rdp;
+  buf = macGetNextReceiveBuffer(&rpp->rd, &size);
+  if ((buf == NULL) || (size != rdp->size)) {
+    LWIP_MEMPOOL_FREE(RX_PBUF, rpp);
+    return NULL;
+  }
+
+  rpp->pc.custom_free_function = rx_pbuf_free;
+  return pbuf_alloced_custom(PBUF_RAW, (u16_t)size, PBUF_REF, &rpp->pc,
+                             (void *)buf, (u16_t)size);
+}
+
+/*
+ * Frees a transmitted pbuf chain when the MAC gives it back.
+ */
+static void tx_pbuf_release(MACDriver *macp, void *ref) {
+
+  (void)macp;
+  pbuf_free((struct pbuf *)ref);
+}
+#endif
+
 /*
  * Initialization.
  */
@@ -129,6 +200,10 @@ static err_t low_level_output(struct netif *netif, struct pbuf *p) {
   MACTransmitDescriptor td;
 
   (void)netif;
+#if LWIP_MAC_ZERO_COPY
+  /* Frees the frames already transmitted.*/
+  macReclaimTransmitBuffers(&ETHD1);
+#endif
   if (macWaitTransmitDescriptor(&ETHD1, &td, TIME_MS2I(LWIP_SEND_TIMEOUT)) != MSG_OK)
     return ERR_TIMEOUT;
 
@@ -136,9 +211,24 @@ static err_t low_level_output(struct netif *netif, struct pbuf *p) {
   pbuf_header(p, -ETH_PAD_SIZE);        /* drop the padding word */
 #endif
 
-  /* Iterates through the pbuf chain. */
-  for(q = p; q != NULL; q = q->next)
-    macWriteTransmitDescriptor(&td, (uint8_t *)q->payload, (size_t)q->len);
+#if LWIP_MAC_ZERO_COPY
+  /* The pbuf chain is transmitted in place and kept until the MAC gives
+     it back, chains with too many buffers are copied instead.*/
+  for(q = p; q != NULL; q = q->next) {
+    if (!macAttachTransmitBuffer(&td, (const uint8_t *)q->payload,
+                                 (size_t)q->len,
+                                 q->next == NULL ? (void *)p : NULL))
+      break;
+  }
+  if (q == NULL)
+    pbuf_ref(p);
+  else
+#endif
+  {
+    /* Iterates through the pbuf chain. */
+    for(q = p; q != NULL; q = q->next)
+      macWriteTransmitDescriptor(&td, (uint8_t *)q->payload, (size_t)q->len);
+  }
   macReleaseTransmitDescriptor(&td);
 
   MIB2_STATS_NETIF_ADD(netif, ifoutoctets, p->tot_len);
@@ -188,19 +278,29 @@ static bool low_level_input(struct netif *netif, struct pbuf **pbuf) {
   len += ETH_PAD_SIZE;        /* allow room for Ethernet padding */
 #endif
 
-  /* We allocate a pbuf chain of pbufs from the pool. */
-  *pbuf = pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
+#if LWIP_MAC_ZERO_COPY
+  /* The frame is passed in place if possible, the descriptor is released
+     when the pbuf is freed.*/
+  *pbuf = rx_pbuf_wrap(&rd);
+  if (*pbuf == NULL)
+#endif
+  {
+    /* We allocate a pbuf chain of pbufs from the pool. */
+    *pbuf = pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
 
-  if (*pbuf != NULL) {
+    if (*pbuf != NULL) {
 #if ETH_PAD_SIZE
-    pbuf_header(*pbuf, -ETH_PAD_SIZE); /* drop the padding word */
+      pbuf_header(*pbuf, -ETH_PAD_SIZE); /* drop the padding word */
 #endif
 
-    /* Iterates through the pbuf chain. */
-    for(q = *pbuf; q != NULL; q = q->next)
-      macReadReceiveDescriptor(&rd, (uint8_t *)q->payload, (size_t)q->len);
-    macReleaseReceiveDescriptor(&rd);
+      /* Iterates through the pbuf chain. */
+      for(q = *pbuf; q != NULL; q = q->next)
+        macReadReceiveDescriptor(&rd, (uint8_t *)q->payload, (size_t)q->len);
+      macReleaseReceiveDescriptor(&rd);
+    }
+  }
 
+  if (*pbuf != NULL) {
     MIB2_STATS_NETIF_ADD(netif, ifinoctets, (*pbuf)->tot_len);
 
     if (*(uint8_t *)((*pbuf)->payload) & 1) {
@@ -307,7 +407,16 @@ void lwipDefaultLinkDownCB(void *p)
 static THD_FUNCTION(lwip_thread, p) {
   event_timer_t evt;
   event_listener_t el0, el1;
-  static const MACConfig mac_config = {thisif.hwaddr};
+#if LWIP_MAC_ZERO_COPY
+  static const MACConfig mac_config = {
+    .mac_address  = thisif.hwaddr,
+    .txrelease_cb = tx_pbuf_release
+  };
+#else
+  static const MACConfig mac_config = {
+    .mac_address  = thisif.hwaddr
+  };
+#endif
   err_t result;
   tcpip_callback_fn link_up_cb = NULL;
   tcpip_callback_fn link_down_cb = NULL;
@@ -366,6 +475,9 @@ static THD_FUNCTION(lwip_thread, p) {
     thisif.hostname = LWIP_NETIF_HOSTNAME_STRING;
 #endif
 
+#if LWIP_MAC_ZERO_COPY
+  LWIP_MEMPOOL_INIT(RX_PBUF);
+#endif
   macStart(&ETHD1, &mac_config);
 
   MIB2_INIT_NETIF(&thisif, snmp_ifType_ethernet_csmacd, 0);
@@ -396,6 +508,10 @@ static THD_FUNCTION(lwip_thread, p) {
     eventmask_t mask = chEvtWaitAny(ALL_EVENTS);
     if (mask & PERIODIC_TIMER_ID) {
       bool current_link_status = macPollLinkStatus(&ETHD1);
+#if LWIP_MAC_ZERO_COPY
+      /* Frees the transmitted frames if the interface went idle.*/
+      macReclaimTransmitBuffers(&ETHD1);
+#endif
       if (current_link_status != netif_is_link_up(&thisif)) {
         if (current_link_status) {
           tcpip_callback_with_block((tcpip_callback_fn) netif_set_link_up,
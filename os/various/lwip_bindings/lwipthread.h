@@ -96,6 +96,27 @@
 #define LWIP_SEND_TIMEOUT                   50
 #endif
 
+/**
+ * @brief   Zero-copy frames exchange with the MAC driver.
+ * @details If enabled then received frames are passed to the stack in place,
+ *          wrapped in custom pbufs which give the MAC buffers back when
+ *          freed, and transmitted pbufs are handed to the MAC by reference.
+ * @note    Requires @p MAC_USE_ZERO_COPY, a MAC driver supporting buffer
+ *          references and @p LWIP_SUPPORT_CUSTOM_PBUF in lwipopts.h.
+ */
+#if !defined(LWIP_MAC_ZERO_COPY) || defined(__DOXYGEN__)
+#define LWIP_MAC_ZERO_COPY                  FALSE
+#endif
+
+/**
+ * @brief   Maximum number of received frames held by the stack in place.
+ * @details Frames received when all the wrappers are in use are copied
+ *          into pool pbufs.
+ */
+#if !defined(LWIP_MAC_RX_PBUFS) || defined(__DOXYGEN__)
+#define LWIP_MAC_RX_PBUFS                   4
+#endif
+
 /**
  * @brief   Link speed.
  */
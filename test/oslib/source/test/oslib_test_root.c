@@ -30,6 +30,12 @@
  * - @subpage oslib_test_sequence_007
  * - @subpage oslib_test_sequence_008
  * - @subpage oslib_test_sequence_009
+ * - @subpage oslib_test_sequence_010
+ * - @subpage oslib_test_sequence_011
+ * - @subpage oslib_test_sequence_012
+ * - @subpage oslib_test_sequence_013
+ * - @subpage oslib_test_sequence_014
+ * - @subpage oslib_test_sequence_015
  * .
  */
 
@@ -76,6 +82,22 @@ const testsequence_t * const oslib_test_suite_array[] = {
 #if ((CH_CFG_USE_FACTORY == TRUE) && (CH_CFG_USE_MEMPOOLS == TRUE) && (CH_CFG_USE_HEAP == TRUE)) || defined(__DOXYGEN__)
   &oslib_test_sequence_009,
 #endif
+#if (CH_CFG_USE_RINGS == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_sequence_010,
+#endif
+#if (CH_CFG_USE_REFBUFS == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_sequence_011,
+#endif
+#if (CH_CFG_USE_BUS == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_sequence_012,
+#endif
+#if (CH_CFG_USE_OBJ_FIFOS == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_sequence_013,
+#endif
+#if ((CH_CFG_USE_SWTIMERS == TRUE) && (CH_CFG_USE_WAITEXIT == TRUE)) || defined(__DOXYGEN__)
+  &oslib_test_sequence_014,
+#endif
+  &oslib_test_sequence_015,
   NULL
 };
 
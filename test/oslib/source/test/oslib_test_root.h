@@ -33,6 +33,12 @@
 #include "oslib_test_sequence_007.h"
 #include "oslib_test_sequence_008.h"
 #include "oslib_test_sequence_009.h"
+#include "oslib_test_sequence_010.h"
+#include "oslib_test_sequence_011.h"
+#include "oslib_test_sequence_012.h"
+#include "oslib_test_sequence_013.h"
+#include "oslib_test_sequence_014.h"
+#include "oslib_test_sequence_015.h"
 
 #if !defined(__DOXYGEN__)
 
@@ -53,6 +59,14 @@ extern "C" {
 /* Shared definitions.                                                       */
 /*===========================================================================*/
 
+/*
+ * Test cases using the HAL streams library, the library must be part
+ * of the build when enabled.
+ */
+#if !defined(OSLIB_TEST_CFG_USE_STREAMS)
+#define OSLIB_TEST_CFG_USE_STREAMS  FALSE
+#endif
+
 #endif /* !defined(__DOXYGEN__) */
 
 #endif /* OSLIB_TEST_ROOT_H */
@@ -177,15 +177,33 @@ static void oslib_test_001_003_execute(void) {
     test_print("--- CH_CFG_USE_OBJ_FIFOS:               ");
     test_printn(CH_CFG_USE_OBJ_FIFOS);
     test_println("");
+    test_print("--- CH_CFG_OBJ_FIFOS_LOCKFREE:          ");
+    test_printn(CH_CFG_OBJ_FIFOS_LOCKFREE);
+    test_println("");
     test_print("--- CH_CFG_USE_PIPES:                   ");
     test_printn(CH_CFG_USE_PIPES);
     test_println("");
+    test_print("--- CH_CFG_USE_RINGS:                   ");
+    test_printn(CH_CFG_USE_RINGS);
+    test_println("");
+    test_print("--- CH_CFG_USE_REFBUFS:                 ");
+    test_printn(CH_CFG_USE_REFBUFS);
+    test_println("");
+    test_print("--- CH_CFG_USE_BUS:                     ");
+    test_printn(CH_CFG_USE_BUS);
+    test_println("");
     test_print("--- CH_CFG_USE_OBJ_CACHES:              ");
     test_printn(CH_CFG_USE_OBJ_CACHES);
     test_println("");
     test_print("--- CH_CFG_USE_DELEGATES:               ");
     test_printn(CH_CFG_USE_DELEGATES);
     test_println("");
+    test_print("--- CH_CFG_USE_SWTIMERS:                ");
+    test_printn(CH_CFG_USE_SWTIMERS);
+    test_println("");
+    test_print("--- CH_CFG_SWTIMERS_WHEEL_SIZE:         ");
+    test_printn(CH_CFG_SWTIMERS_WHEEL_SIZE);
+    test_println("");
     test_print("--- CH_CFG_USE_FACTORY:                 ");
     test_printn(CH_CFG_USE_FACTORY);
     test_println("");
@@ -39,6 +39,8 @@
  * - @subpage oslib_test_002_001
  * - @subpage oslib_test_002_002
  * - @subpage oslib_test_002_003
+ * - @subpage oslib_test_002_004
+ * - @subpage oslib_test_002_005
  * .
  */
 
@@ -53,6 +55,20 @@
 static msg_t mb_buffer[MB_SIZE];
 static MAILBOX_DECL(mb1, mb_buffer, MB_SIZE);
 
+#if CH_CFG_USE_WAITEXIT == TRUE
+static THD_WORKING_AREA(waReader1, 256);
+static THD_WORKING_AREA(waReader2, 256);
+static THD_FUNCTION(Reader, arg) {
+  msg_t msg;
+
+  (void)arg;
+
+  if (chMBFetchTimeout(&mb1, &msg, TIME_MS2I(100)) == MSG_OK) {
+    test_emit_token((char)msg);
+  }
+}
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -410,6 +426,196 @@ static const testcase_t oslib_test_002_003 = {
   oslib_test_002_003_execute
 };
 
+/**
+ * @page oslib_test_002_004 [2.4] Mailbox batched API
+ *
+ * <h2>Description</h2>
+ * The batched post and fetch functions are tested, partial transfers
+ * and the readers watermark are checked.
+ *
+ * <h2>Test Steps</h2>
+ * - [2.4.1] Posting messages using the I-Class API, the second post
+ *   must be partial.
+ * - [2.4.2] Fetching messages in two batches, the order must be
+ *   preserved.
+ * - [2.4.3] Testing timeouts, the number of transferred messages is
+ *   checked.
+ * - [2.4.4] Setting a watermark of three messages then posting two
+ *   messages, the fetch operation must wait for the timeout then
+ *   return the available messages.
+ * .
+ */
+
+static void oslib_test_002_004_setup(void) {
+  chMBObjectInit(&mb1, mb_buffer, MB_SIZE);
+}
+
+static void oslib_test_002_004_teardown(void) {
+  chMBReset(&mb1);
+}
+
+static void oslib_test_002_004_execute(void) {
+  static const msg_t msgs[] = {'A', 'B', 'C', 'D', 'E', 'F'};
+  msg_t buf[8];
+  size_t n;
+
+  /* [2.4.1] Posting messages using the I-Class API, the second post
+     must be partial.*/
+  test_set_step(1);
+  {
+    chSysLock();
+    n = chMBPostNI(&mb1, msgs, 3);
+    chSysUnlock();
+    test_assert(n == 3, "wrong count");
+
+    chSysLock();
+    n = chMBPostNI(&mb1, msgs + 3, 3);
+    chSysUnlock();
+    test_assert(n == 1, "wrong count");
+
+    chSysLock();
+    n = chMBGetUsedCountI(&mb1);
+    chSysUnlock();
+    test_assert(n == MB_SIZE, "not full");
+  }
+  test_end_step(1);
+
+  /* [2.4.2] Fetching messages in two batches, the order must be
+     preserved.*/
+  test_set_step(2);
+  {
+    chSysLock();
+    n = chMBFetchNI(&mb1, buf, 2);
+    chSysUnlock();
+    test_assert(n == 2, "wrong count");
+    test_assert((buf[0] == 'A') && (buf[1] == 'B'), "wrong messages");
+
+    n = chMBFetchNTimeout(&mb1, buf, 8, TIME_IMMEDIATE);
+    test_assert(n == 2, "wrong count");
+    test_assert((buf[0] == 'C') && (buf[1] == 'D'), "wrong messages");
+  }
+  test_end_step(2);
+
+  /* [2.4.3] Testing timeouts, the number of transferred messages is
+     checked.*/
+  test_set_step(3);
+  {
+    n = chMBFetchNTimeout(&mb1, buf, 8, TIME_IMMEDIATE);
+    test_assert(n == 0, "not empty");
+
+    n = chMBPostNTimeout(&mb1, msgs, 6, TIME_IMMEDIATE);
+    test_assert(n == MB_SIZE, "wrong count");
+
+    n = chMBFetchNTimeout(&mb1, buf, 8, TIME_IMMEDIATE);
+    test_assert(n == MB_SIZE, "wrong count");
+    test_assert((buf[0] == 'A') && (buf[3] == 'D'), "wrong messages");
+  }
+  test_end_step(3);
+
+  /* [2.4.4] Setting a watermark of three messages then posting two
+     messages, the fetch operation must wait for the timeout then
+     return the available messages.*/
+  test_set_step(4);
+  {
+    systime_t time;
+
+    chMBSetWatermark(&mb1, 3);
+    n = chMBPostNTimeout(&mb1, msgs, 2, TIME_IMMEDIATE);
+    test_assert(n == 2, "wrong count");
+
+    time = chVTGetSystemTimeX();
+    n = chMBFetchNTimeout(&mb1, buf, 8, 100);
+    test_assert_time_window(chTimeAddX(time, 100),
+                            chTimeAddX(time, 100 + CH_CFG_ST_TIMEDELTA + 1),
+                            "out of time window");
+    test_assert(n == 2, "wrong count");
+    test_assert((buf[0] == 'A') && (buf[1] == 'B'), "wrong messages");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t oslib_test_002_004 = {
+  "Mailbox batched API",
+  oslib_test_002_004_setup,
+  oslib_test_002_004_teardown,
+  oslib_test_002_004_execute
+};
+
+#if (CH_CFG_USE_WAITEXIT == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_002_005 [2.5] Mailbox readers wakeup
+ *
+ * <h2>Description</h2>
+ * Two readers wait for messages then two messages are posted with a
+ * single batched operation, only one reader is woken by the post and
+ * it wakes the other one after fetching.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_WAITEXIT == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.5.1] Starting two reader threads with higher priority, both
+ *   wait for a message.
+ * - [2.5.2] Posting two messages in a single operation, only one
+ *   reader must be woken and both readers must receive a message.
+ * .
+ */
+
+static void oslib_test_002_005_setup(void) {
+  chMBObjectInit(&mb1, mb_buffer, MB_SIZE);
+}
+
+static void oslib_test_002_005_teardown(void) {
+  chMBReset(&mb1);
+}
+
+static void oslib_test_002_005_execute(void) {
+  static const msg_t msgs[] = {'A', 'B'};
+  thread_t *tp1, *tp2;
+
+  /* [2.5.1] Starting two reader threads with higher priority, both
+     wait for a message.*/
+  test_set_step(1);
+  {
+    tp1 = chThdCreateStatic(waReader1, sizeof (waReader1),
+                            chThdGetPriorityX() + 1, Reader, NULL);
+    tp2 = chThdCreateStatic(waReader2, sizeof (waReader2),
+                            chThdGetPriorityX() + 1, Reader, NULL);
+  }
+  test_end_step(1);
+
+  /* [2.5.2] Posting two messages in a single operation, only one
+     reader must be woken and both readers must receive a message.*/
+  test_set_step(2);
+  {
+    size_t n;
+    bool empty;
+
+    chSysLock();
+    n = chMBPostNI(&mb1, msgs, 2);
+    empty = chThdQueueIsEmptyI(&mb1.qr);
+    chSchRescheduleS();
+    chSysUnlock();
+    test_assert(n == 2, "wrong count");
+    test_assert(!empty, "more than one reader woken");
+    chThdWait(tp1);
+    chThdWait(tp2);
+    test_assert_sequence("AB", "unexpected tokens");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t oslib_test_002_005 = {
+  "Mailbox readers wakeup",
+  oslib_test_002_005_setup,
+  oslib_test_002_005_teardown,
+  oslib_test_002_005_execute
+};
+#endif /* CH_CFG_USE_WAITEXIT == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -421,6 +627,10 @@ const testcase_t * const oslib_test_sequence_002_array[] = {
   &oslib_test_002_001,
   &oslib_test_002_002,
   &oslib_test_002_003,
+  &oslib_test_002_004,
+#if (CH_CFG_USE_WAITEXIT == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_002_005,
+#endif
   NULL
 };
 
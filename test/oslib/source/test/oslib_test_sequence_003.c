@@ -38,6 +38,7 @@
  * <h2>Test Cases</h2>
  * - @subpage oslib_test_003_001
  * - @subpage oslib_test_003_002
+ * - @subpage oslib_test_003_003
  * .
  */
 
@@ -356,6 +357,117 @@ static const testcase_t oslib_test_003_002 = {
   oslib_test_003_002_execute
 };
 
+/**
+ * @page oslib_test_003_003 [3.3] Pipes zero-copy API
+ *
+ * <h2>Description</h2>
+ * The reserve/commit and peek/consume functions are tested, regions
+ * wrapping the buffer boundary and timeouts are checked.
+ *
+ * <h2>Test Steps</h2>
+ * - [3.3.1] Reserving and committing contiguous space.
+ * - [3.3.2] Peeking and consuming contiguous data.
+ * - [3.3.3] Reserving and committing space wrapping the buffer
+ *   boundary.
+ * - [3.3.4] Peeking and consuming data wrapping the buffer boundary.
+ * - [3.3.5] Requests exceeding the available space or data, the
+ *   available amount must be returned.
+ * .
+ */
+
+static void oslib_test_003_003_setup(void) {
+  chPipeObjectInit(&pipe1, buffer, PIPE_SIZE);
+}
+
+static void oslib_test_003_003_execute(void) {
+  pipe_region_t r;
+  size_t n;
+
+  /* [3.3.1] Reserving and committing contiguous space.*/
+  test_set_step(1);
+  {
+    n = chPipeWriteReserve(&pipe1, &r, 10, TIME_IMMEDIATE);
+    test_assert(n == 10, "wrong size");
+    test_assert((r.ptr1 == pipe1.buffer) && (r.n1 == 10) && (r.n2 == 0),
+                "wrong region");
+    memcpy(r.ptr1, pipe_pattern, r.n1);
+    chPipeWriteCommit(&pipe1, n);
+    test_assert(chPipeGetUsedCount(&pipe1) == 10, "wrong count");
+  }
+  test_end_step(1);
+
+  /* [3.3.2] Peeking and consuming contiguous data.*/
+  test_set_step(2);
+  {
+    n = chPipeReadPeek(&pipe1, &r, 6, TIME_IMMEDIATE);
+    test_assert(n == 6, "wrong size");
+    test_assert((r.ptr1 == pipe1.buffer) && (r.n1 == 6) && (r.n2 == 0),
+                "wrong region");
+    test_assert(memcmp(r.ptr1, pipe_pattern, 6) == 0, "content mismatch");
+    chPipeReadConsume(&pipe1, n);
+    test_assert(chPipeGetUsedCount(&pipe1) == 4, "wrong count");
+  }
+  test_end_step(2);
+
+  /* [3.3.3] Reserving and committing space wrapping the buffer
+     boundary.*/
+  test_set_step(3);
+  {
+    n = chPipeWriteReserve(&pipe1, &r, 10, TIME_IMMEDIATE);
+    test_assert(n == 10, "wrong size");
+    test_assert((r.n1 == 6) && (r.ptr2 == pipe1.buffer) && (r.n2 == 4),
+                "wrong region");
+    memcpy(r.ptr1, pipe_pattern, r.n1);
+    memcpy(r.ptr2, pipe_pattern + r.n1, r.n2);
+    chPipeWriteCommit(&pipe1, n);
+    test_assert(chPipeGetUsedCount(&pipe1) == 14, "wrong count");
+  }
+  test_end_step(3);
+
+  /* [3.3.4] Peeking and consuming data wrapping the buffer boundary.*/
+  test_set_step(4);
+  {
+    n = chPipeReadPeek(&pipe1, &r, 14, TIME_IMMEDIATE);
+    test_assert(n == 14, "wrong size");
+    test_assert((r.n1 == 10) && (r.ptr2 == pipe1.buffer) && (r.n2 == 4),
+                "wrong region");
+    test_assert(memcmp(r.ptr1, "6789012345", 10) == 0, "content mismatch");
+    test_assert(memcmp(r.ptr2, "6789", 4) == 0, "content mismatch");
+    chPipeReadConsume(&pipe1, n);
+    test_assert(chPipeGetUsedCount(&pipe1) == 0, "not empty");
+  }
+  test_end_step(4);
+
+  /* [3.3.5] Requests exceeding the available space or data, the
+     available amount must be returned.*/
+  test_set_step(5);
+  {
+    n = chPipeReadPeek(&pipe1, &r, 1, TIME_IMMEDIATE);
+    test_assert(n == 0, "not empty");
+
+    n = chPipeWriteTimeout(&pipe1, pipe_pattern, 10, TIME_IMMEDIATE);
+    test_assert(n == 10, "wrong size");
+
+    n = chPipeWriteReserve(&pipe1, &r, PIPE_SIZE, TIME_IMMEDIATE);
+    test_assert(n == 6, "wrong size");
+    chPipeWriteCommit(&pipe1, 0);
+    test_assert(chPipeGetUsedCount(&pipe1) == 10, "wrong count");
+
+    n = chPipeReadPeek(&pipe1, &r, PIPE_SIZE, TIME_IMMEDIATE);
+    test_assert(n == 10, "wrong size");
+    chPipeReadConsume(&pipe1, n);
+    test_assert(chPipeGetUsedCount(&pipe1) == 0, "wrong count");
+  }
+  test_end_step(5);
+}
+
+static const testcase_t oslib_test_003_003 = {
+  "Pipes zero-copy API",
+  oslib_test_003_003_setup,
+  NULL,
+  oslib_test_003_003_execute
+};
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -366,6 +478,7 @@ static const testcase_t oslib_test_003_002 = {
 const testcase_t * const oslib_test_sequence_003_array[] = {
   &oslib_test_003_001,
   &oslib_test_003_002,
+  &oslib_test_003_003,
   NULL
 };
 
@@ -37,6 +37,8 @@
  *
  * <h2>Test Cases</h2>
  * - @subpage oslib_test_004_001
+ * - @subpage oslib_test_004_002
+ * - @subpage oslib_test_004_003
  * .
  */
 
@@ -70,6 +72,56 @@ static THD_FUNCTION(Thread1, arg) {
   } while (msg == MSG_OK);
 }
 
+#if CH_CFG_USE_WAITEXIT == TRUE
+#define JOBS_EXEC_SIZE 8
+
+static jobs_executor_t je;
+static exec_job_t exec_jobs[JOBS_EXEC_SIZE];
+static JOBS_EXEC_WORKING_AREA(waExec, 2, 256);
+static volatile uint32_t exec_count;
+
+static void job_token(void *arg) {
+
+  test_emit_token((int)arg);
+}
+
+static void job_count(void *arg) {
+
+  (void)arg;
+
+  exec_count++;
+}
+
+#if CH_JOBS_HAS_SMP == TRUE
+static jobs_smp_t js;
+static THD_WORKING_AREA(waSmp1, 256);
+static THD_WORKING_AREA(waSmp2, 256);
+
+static void job_child(void *arg) {
+
+  (void)arg;
+
+  chSysLock();
+  exec_count++;
+  chSysUnlock();
+  chThdSleepMilliseconds(2);
+}
+
+static void job_spawner(void *arg) {
+  unsigned i;
+
+  (void)arg;
+
+  for (i = 0U; i < 8U; i++) {
+    exec_job_t *jp = chJobSmpGet(&js);
+    jp->jobfunc = job_child;
+    jp->jobarg  = NULL;
+    chJobSmpPost(&js, jp);
+  }
+}
+#endif
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -165,6 +217,205 @@ static const testcase_t oslib_test_004_001 = {
   oslib_test_004_001_execute
 };
 
+#if ((CH_CFG_USE_WAITEXIT == TRUE) && (CH_CFG_JOBS_EXEC_LANES >= 3)) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_004_002 [4.2] Jobs Executor test
+ *
+ * <h2>Description</h2>
+ * The jobs executor API is tested for functionality, jobs posted on
+ * different lanes must be executed in priority order, the executor
+ * must be able to drain and shut down.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_CFG_USE_WAITEXIT == TRUE) && (CH_CFG_JOBS_EXEC_LANES >= 3)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [4.2.1] Initializing the executor and starting a single worker at
+ *   lower priority.
+ * - [4.2.2] Posting jobs on lanes in reverse priority order then
+ *   draining the executor, the jobs must be executed in lane priority
+ *   order.
+ * - [4.2.3] Posting a job while the worker is waiting, the executor
+ *   must not be reported idle until the job has been executed.
+ * - [4.2.4] Starting a second worker, posting a burst of jobs then
+ *   shutting down the executor, all jobs must be executed and
+ *   accounted in the statistics.
+ * .
+ */
+
+static void oslib_test_004_002_execute(void) {
+
+  /* [4.2.1] Initializing the executor and starting a single worker at
+     lower priority.*/
+  test_set_step(1);
+  {
+    chJobExecObjectInit(&je, JOBS_EXEC_SIZE, exec_jobs);
+    chJobExecStart(&je, waExec, 1, 256, chThdGetPriorityX() - 1);
+  }
+  test_end_step(1);
+
+  /* [4.2.2] Posting jobs on lanes in reverse priority order then
+     draining the executor, the jobs must be executed in lane priority
+     order.*/
+  test_set_step(2);
+  {
+    static const unsigned lanes[] = {2U, 1U, 0U, 2U, 0U};
+    static const char tokens[] = "DCAEB";
+    unsigned i;
+    msg_t msg;
+
+    for (i = 0U; i < 5U; i++) {
+      exec_job_t *jp = chJobExecGet(&je);
+      jp->jobfunc = job_token;
+      jp->jobarg  = (void *)(int)tokens[i];
+      chJobExecPost(&je, jp, lanes[i]);
+    }
+    msg = chJobExecDrainTimeout(&je, TIME_MS2I(100));
+    test_assert(msg == MSG_OK, "drain failed");
+    test_assert_sequence("ABCDE", "unexpected tokens");
+  }
+  test_end_step(2);
+
+  /* [4.2.3] Posting a job while the worker is waiting, the executor
+     must not be reported idle until the job has been executed.*/
+  test_set_step(3);
+  {
+    exec_job_t *jp;
+    msg_t msg;
+
+    chThdSleepMilliseconds(10);
+    jp = chJobExecGet(&je);
+    jp->jobfunc = job_token;
+    jp->jobarg  = (void *)(int)'F';
+    chJobExecPost(&je, jp, 0U);
+    msg = chJobExecDrainTimeout(&je, TIME_IMMEDIATE);
+    test_assert(msg == MSG_TIMEOUT, "idle with a queued job");
+    msg = chJobExecDrainTimeout(&je, TIME_MS2I(100));
+    test_assert(msg == MSG_OK, "drain failed");
+    test_assert_sequence("F", "unexpected tokens");
+  }
+  test_end_step(3);
+
+  /* [4.2.4] Starting a second worker, posting a burst of jobs then
+     shutting down the executor, all jobs must be executed and
+     accounted in the statistics.*/
+  test_set_step(4);
+  {
+    unsigned i;
+
+    chJobExecStart(&je, (void *)((uint8_t *)waExec + THD_WORKING_AREA_SIZE(256)),
+                   1, 256, chThdGetPriorityX() - 1);
+    exec_count = 0U;
+    for (i = 0U; i < 20U; i++) {
+      exec_job_t *jp = chJobExecGet(&je);
+      jp->jobfunc = job_count;
+      jp->jobarg  = NULL;
+      chJobExecPost(&je, jp, 0U);
+    }
+    chJobExecShutdown(&je);
+    test_assert(exec_count == 20U, "jobs lost");
+    test_assert(je.nworkers == 0U, "workers still running");
+#if CH_CFG_JOBS_EXEC_STATISTICS == TRUE
+    {
+      exec_stats_t es;
+
+      chJobExecGetStats(&je, &es);
+      test_assert(es.n == 26U, "wrong jobs count");
+      test_assert((uint64_t)es.exec_worst <= es.exec_cumulative,
+                  "inconsistent statistics");
+    }
+#endif
+  }
+  test_end_step(4);
+}
+
+static const testcase_t oslib_test_004_002 = {
+  "Jobs Executor test",
+  NULL,
+  NULL,
+  oslib_test_004_002_execute
+};
+#endif /* (CH_CFG_USE_WAITEXIT == TRUE) && (CH_CFG_JOBS_EXEC_LANES >= 3) */
+
+#if (CH_JOBS_HAS_SMP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_004_003 [4.3] Work-stealing test
+ *
+ * <h2>Description</h2>
+ * A work-stealing jobs group with two workers is tested, a job spawns
+ * children jobs on its worker queue and the other worker must steal
+ * some of them.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_JOBS_HAS_SMP == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [4.3.1] Initializing the group and starting two workers on the
+ *   current instance.
+ * - [4.3.2] Posting a job spawning children jobs then draining the
+ *   group, all jobs must be executed and some must have been stolen.
+ * - [4.3.3] Shutting down the group, the workers must terminate.
+ * .
+ */
+
+static void oslib_test_004_003_execute(void) {
+
+  /* [4.3.1] Initializing the group and starting two workers on the
+     current instance.*/
+  test_set_step(1);
+  {
+    chJobSmpObjectInit(&js, JOBS_EXEC_SIZE, exec_jobs);
+    chJobSmpStart(&js, NULL, waSmp1, 256, chThdGetPriorityX() - 1);
+    chJobSmpStart(&js, NULL, waSmp2, 256, chThdGetPriorityX() - 1);
+    test_assert(js.nworkers == 2U, "workers not started");
+  }
+  test_end_step(1);
+
+  /* [4.3.2] Posting a job spawning children jobs then draining the
+     group, all jobs must be executed and some must have been stolen.*/
+  test_set_step(2);
+  {
+    exec_job_t *jp;
+    msg_t msg;
+
+    exec_count = 0U;
+    jp = chJobSmpGet(&js);
+    jp->jobfunc = job_spawner;
+    jp->jobarg  = NULL;
+    chJobSmpPost(&js, jp);
+    msg = chJobSmpDrainTimeout(&js, TIME_MS2I(1000));
+    test_assert(msg == MSG_OK, "drain failed");
+    test_assert(exec_count == 8U, "jobs lost");
+    test_assert(js.workers[0].executed + js.workers[1].executed == 9U,
+                "wrong executed count");
+    test_assert(js.workers[0].stolen + js.workers[1].stolen > 0U,
+                "no jobs stolen");
+  }
+  test_end_step(2);
+
+  /* [4.3.3] Shutting down the group, the workers must terminate.*/
+  test_set_step(3);
+  {
+    chJobSmpShutdown(&js);
+    test_assert(js.nworkers == 0U, "workers still running");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t oslib_test_004_003 = {
+  "Work-stealing test",
+  NULL,
+  NULL,
+  oslib_test_004_003_execute
+};
+#endif /* CH_JOBS_HAS_SMP == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -174,6 +425,12 @@ static const testcase_t oslib_test_004_001 = {
  */
 const testcase_t * const oslib_test_sequence_004_array[] = {
   &oslib_test_004_001,
+#if ((CH_CFG_USE_WAITEXIT == TRUE) && (CH_CFG_JOBS_EXEC_LANES >= 3)) || defined(__DOXYGEN__)
+  &oslib_test_004_002,
+#endif
+#if (CH_JOBS_HAS_SMP == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_004_003,
+#endif
   NULL
 };
 
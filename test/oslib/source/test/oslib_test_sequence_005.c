@@ -37,6 +37,7 @@
  *
  * <h2>Test Cases</h2>
  * - @subpage oslib_test_005_001
+ * - @subpage oslib_test_005_002
  * .
  */
 
@@ -110,6 +111,24 @@ static THD_FUNCTION(Thread1, arg) {
   chThdExit(0x0FA5);
 }
 
+#if CH_DELEGATES_HAS_ASYNC == TRUE
+#define ASYNC_CALLS 8
+
+static delegate_async_t dq;
+static delegate_call_t calls[ASYNC_CALLS];
+
+static THD_WORKING_AREA(waThread2, 256);
+static THD_FUNCTION(Thread2, arg) {
+
+  (void)arg;
+
+  exit_flag = false;
+  do {
+    (void) chDelegateAsyncDispatchTimeout(&dq, TIME_INFINITE);
+  } while (!exit_flag);
+}
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -190,6 +209,132 @@ static const testcase_t oslib_test_005_001 = {
   oslib_test_005_001_execute
 };
 
+#if (CH_DELEGATES_HAS_ASYNC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_005_002 [5.2] Asynchronous dispatcher test
+ *
+ * <h2>Description</h2>
+ * The asynchronous calls API is tested for functionality, calls are
+ * queued while the dispatcher is not running then the futures are
+ * polled and waited.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_DELEGATES_HAS_ASYNC == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [5.2.1] Starting the dispatcher thread at lower priority.
+ * - [5.2.2] Posting calls using the typed wrappers, the calls must not
+ *   be completed before the dispatcher runs.
+ * - [5.2.3] Waiting on the futures, checking the results and the
+ *   emitted tokens.
+ * - [5.2.4] Releasing the futures, posting a terminating call and
+ *   releasing it before completion, the dispatcher must terminate.
+ * - [5.2.5] Checking that all call objects have been returned to the
+ *   pool.
+ * .
+ */
+
+static void oslib_test_005_002_setup(void) {
+  chDelegateAsyncObjectInit(&dq, ASYNC_CALLS, calls);
+}
+
+static void oslib_test_005_002_execute(void) {
+  thread_t *tp;
+  delegate_call_t *fp[5];
+
+  /* [5.2.1] Starting the dispatcher thread at lower priority.*/
+  test_set_step(1);
+  {
+    thread_descriptor_t td = {
+      .name  = "dispatcher",
+      .wbase = waThread2,
+      .wend  = THD_WORKING_AREA_END(waThread2),
+      .prio  = chThdGetPriorityX() - 1,
+      .funcp = Thread2,
+      .arg   = NULL
+    };
+    tp = chThdCreate(&td);
+  }
+  test_end_step(1);
+
+  /* [5.2.2] Posting calls using the typed wrappers, the calls must not
+     be completed before the dispatcher runs.*/
+  test_set_step(2);
+  {
+    fp[0] = chDelegateCallAsync0(&dq, (delegate_fn0_t)dis_func0);
+    fp[1] = chDelegateCallAsync1(&dq, (delegate_fn1_t)dis_func1, 'A');
+    fp[2] = chDelegateCallAsync2(&dq, (delegate_fn2_t)dis_func2, 'B', 'C');
+    fp[3] = chDelegateCallAsync3(&dq, (delegate_fn3_t)dis_func3, 'D', 'E', 'F');
+    fp[4] = chDelegateCallAsync4(&dq, (delegate_fn4_t)dis_func4, 'G', 'H', 'I', 'J');
+    test_assert(!chDelegateFutureIsDone(fp[0]), "already done");
+    test_assert(!chDelegateFutureIsDone(fp[4]), "already done");
+#if CH_CFG_USE_EVENTS == TRUE
+    chDelegateFutureAttachEvent(fp[4], chThdGetSelfX(), (eventmask_t)1);
+#endif
+  }
+  test_end_step(2);
+
+  /* [5.2.3] Waiting on the futures, checking the results and the
+     emitted tokens.*/
+  test_set_step(3);
+  {
+    msg_t msg, ret;
+
+    msg = chDelegateFutureWaitTimeout(fp[4], &ret, TIME_MS2I(100));
+    test_assert(msg == MSG_OK, "wait failed");
+    test_assert(ret == (msg_t)'G', "invalid return value");
+    msg = chDelegateFutureWaitTimeout(fp[0], &ret, TIME_IMMEDIATE);
+    test_assert(msg == MSG_OK, "not done");
+    test_assert(ret == (msg_t)0x55AA, "invalid return value");
+    msg = chDelegateFutureWaitTimeout(fp[2], &ret, TIME_IMMEDIATE);
+    test_assert(msg == MSG_OK, "not done");
+    test_assert(ret == (msg_t)'B', "invalid return value");
+    test_assert(chDelegateFutureIsDone(fp[1]) && chDelegateFutureIsDone(fp[3]),
+                "not done");
+    test_assert_sequence("0ABCDEFGHIJ", "unexpected tokens");
+#if CH_CFG_USE_EVENTS == TRUE
+    test_assert(chEvtWaitAnyTimeout((eventmask_t)1, TIME_IMMEDIATE) == (eventmask_t)1,
+                "event not signaled");
+#endif
+  }
+  test_end_step(3);
+
+  /* [5.2.4] Releasing the futures, posting a terminating call and
+     releasing it before completion, the dispatcher must terminate.*/
+  test_set_step(4);
+  {
+    unsigned i;
+
+    for (i = 0U; i < 5U; i++) {
+      chDelegateFutureRelease(&dq, fp[i]);
+    }
+    chDelegateFutureRelease(&dq, chDelegateCallAsync0(&dq, (delegate_fn0_t)dis_func_end));
+    (void) chThdWait(tp);
+    test_assert_sequence("Z", "unexpected tokens");
+  }
+  test_end_step(4);
+
+  /* [5.2.5] Checking that all call objects have been returned to the
+     pool.*/
+  test_set_step(5);
+  {
+    test_assert_lock(chSemGetCounterI(&dq.free.sem) == (cnt_t)ASYNC_CALLS,
+                     "call objects lost");
+  }
+  test_end_step(5);
+}
+
+static const testcase_t oslib_test_005_002 = {
+  "Asynchronous dispatcher test",
+  oslib_test_005_002_setup,
+  NULL,
+  oslib_test_005_002_execute
+};
+#endif /* CH_DELEGATES_HAS_ASYNC == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -199,6 +344,9 @@ static const testcase_t oslib_test_005_001 = {
  */
 const testcase_t * const oslib_test_sequence_005_array[] = {
   &oslib_test_005_001,
+#if (CH_DELEGATES_HAS_ASYNC == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_005_002,
+#endif
   NULL
 };
 
@@ -37,6 +37,8 @@
  *
  * <h2>Test Cases</h2>
  * - @subpage oslib_test_006_001
+ * - @subpage oslib_test_006_002
+ * - @subpage oslib_test_006_003
  * .
  */
 
@@ -61,6 +63,7 @@ typedef struct {
 static oc_hash_header_t hash_headers[NUM_HASH_ENTRIES];
 static cached_object_t objects[NUM_OBJECTS];
 static objects_cache_t cache1;
+static bool read_sync_only;
 
 static bool obj_read(objects_cache_t *ocp,
                      oc_object_t *objp,
@@ -70,7 +73,7 @@ static bool obj_read(objects_cache_t *ocp,
 
   objp->obj_flags &= ~OC_FLAG_NOTSYNC;
 
-  if (async) {
+  if (async && !read_sync_only) {
     chCacheReleaseObject(ocp, objp);
   }
 
@@ -84,6 +87,9 @@ static bool obj_write(objects_cache_t *ocp,
   (void)async;
 
   test_emit_token('A' + objp->obj_key);
+  if ((objp->obj_flags & OC_FLAG_MORE) != 0U) {
+    test_emit_token('+');
+  }
 
   return false;
 }
@@ -243,6 +249,264 @@ static const testcase_t oslib_test_006_001 = {
   oslib_test_006_001_execute
 };
 
+#if (CH_CFG_OBJ_CACHES_USE_2Q == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_006_002 [6.2] Scan resistance
+ *
+ * <h2>Description</h2>
+ * A working set of objects is referenced twice then a long sequential
+ * scan is performed, the working set must still be cached after the
+ * scan.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_OBJ_CACHES_USE_2Q == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [6.2.1] Cache initialization.
+ * - [6.2.2] Loading the working set and referencing it again, the
+ *   objects are promoted to the protected segment.
+ * - [6.2.3] Scanning a range of objects much larger than the cache,
+ *   each object is referenced once.
+ * - [6.2.4] Checking that the working set is still cached.
+ * .
+ */
+
+static void oslib_test_006_002_execute(void) {
+  uint32_t i;
+  oc_object_t *objp;
+
+  /* [6.2.1] Cache initialization.*/
+  test_set_step(1);
+  {
+    chCacheObjectInit(&cache1,
+                      NUM_HASH_ENTRIES,
+                      hash_headers,
+                      NUM_OBJECTS,
+                      sizeof (cached_object_t),
+                      objects,
+                      obj_read,
+                      obj_write);
+  }
+  test_end_step(1);
+
+  /* [6.2.2] Loading the working set and referencing it again, the
+     objects are promoted to the protected segment.*/
+  test_set_step(2);
+  {
+    for (i = 0; i < (NUM_OBJECTS / 2); i++) {
+      objp = chCacheGetObject(&cache1, 0U, i);
+      (void) chCacheReadObject(&cache1, objp, false);
+      chCacheReleaseObject(&cache1, objp);
+
+      objp = chCacheGetObject(&cache1, 0U, i);
+      test_assert((objp->obj_flags & OC_FLAG_NOTSYNC) == 0U, "not in sync");
+      chCacheReleaseObject(&cache1, objp);
+    }
+
+    test_assert_sequence("ab", "unexpected tokens");
+  }
+  test_end_step(2);
+
+  /* [6.2.3] Scanning a range of objects much larger than the cache,
+     each object is referenced once.*/
+  test_set_step(3);
+  {
+    for (i = 8; i < 24; i++) {
+      objp = chCacheGetObject(&cache1, 0U, i);
+      test_assert((objp->obj_flags & OC_FLAG_NOTSYNC) != 0U, "in sync");
+      (void) chCacheReadObject(&cache1, objp, false);
+      chCacheReleaseObject(&cache1, objp);
+    }
+
+    test_assert_sequence("ijklmnopqrstuvwx", "unexpected tokens");
+  }
+  test_end_step(3);
+
+  /* [6.2.4] Checking that the working set is still cached.*/
+  test_set_step(4);
+  {
+    for (i = 0; i < (NUM_OBJECTS / 2); i++) {
+      objp = chCacheGetObject(&cache1, 0U, i);
+      test_assert((objp->obj_flags & OC_FLAG_NOTSYNC) == 0U, "evicted");
+      chCacheReleaseObject(&cache1, objp);
+    }
+
+    test_assert_sequence("", "unexpected tokens");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t oslib_test_006_002 = {
+  "Scan resistance",
+  NULL,
+  NULL,
+  oslib_test_006_002_execute
+};
+#endif /* CH_CFG_OBJ_CACHES_USE_2Q == TRUE */
+
+/**
+ * @page oslib_test_006_003 [6.3] Write-behind and read-ahead
+ *
+ * <h2>Description</h2>
+ * Dirty objects are flushed in key order and must be written once
+ * without altering the LRU order, contiguous keys are written as runs.
+ * Then objects are read ahead and must be found in cache, read-ahead
+ * must not evict dirty objects or leak objects read synchronously.
+ *
+ * <h2>Test Steps</h2>
+ * - [6.3.1] Cache initialization.
+ * - [6.3.2] Reading objects out of order and marking them for lazy
+ *   write.
+ * - [6.3.3] Flushing the cache, objects must be written only once and
+ *   keep their LRU position.
+ * - [6.3.4] Reading ahead two objects, the objects must be read
+ *   asynchronously and then found in cache.
+ * - [6.3.5] Marking all objects for lazy write, read-ahead must not
+ *   start any read or write, then the objects are flushed.
+ * - [6.3.6] Reading ahead with a synchronous read function, the objects
+ *   must be released.
+ * .
+ */
+
+static void oslib_test_006_003_execute(void) {
+  oc_object_t *objp;
+
+  /* [6.3.1] Cache initialization.*/
+  test_set_step(1);
+  {
+    chCacheObjectInit(&cache1,
+                      NUM_HASH_ENTRIES,
+                      hash_headers,
+                      NUM_OBJECTS,
+                      sizeof (cached_object_t),
+                      objects,
+                      obj_read,
+                      obj_write);
+  }
+  test_end_step(1);
+
+  /* [6.3.2] Reading objects out of order and marking them for lazy
+     write.*/
+  test_set_step(2);
+  {
+    static const uint32_t keys[] = {3, 1, 2};
+    unsigned i;
+
+    for (i = 0; i < 3; i++) {
+      objp = chCacheGetObject(&cache1, 0U, keys[i]);
+      (void) chCacheReadObject(&cache1, objp, false);
+      objp->obj_flags |= OC_FLAG_LAZYWRITE;
+      chCacheReleaseObject(&cache1, objp);
+    }
+
+    test_assert_sequence("dbc", "unexpected tokens");
+  }
+  test_end_step(2);
+
+  /* [6.3.3] Flushing the cache, objects must be written only once and
+     keep their LRU position.*/
+  test_set_step(3);
+  {
+    bool error;
+
+    error = chCacheFlush(&cache1);
+    test_assert(error == false, "returned error");
+    test_assert_sequence("B+C+D", "unexpected tokens");
+    test_assert(cache1.lru.lru_next->obj_key == 2U, "LRU order changed");
+    test_assert(cache1.lru.lru_next->lru_next->obj_key == 1U, "LRU order changed");
+    test_assert(cache1.lru.lru_next->lru_next->lru_next->obj_key == 3U,
+                "LRU order changed");
+
+    error = chCacheFlush(&cache1);
+    test_assert(error == false, "returned error");
+    test_assert_sequence("", "unexpected tokens");
+  }
+  test_end_step(3);
+
+  /* [6.3.4] Reading ahead two objects, the objects must be read
+     asynchronously and then found in cache.*/
+  test_set_step(4);
+  {
+    ucnt_t n;
+
+    n = chCacheReadAhead(&cache1, 0U, 3U, 2U);
+    test_assert(n == 2U, "unexpected number of reads");
+    test_assert_sequence("ef", "unexpected tokens");
+
+    objp = chCacheGetObject(&cache1, 0U, 4U);
+    test_assert((objp->obj_flags & OC_FLAG_NOTSYNC) == 0U, "not in sync");
+    chCacheReleaseObject(&cache1, objp);
+
+    objp = chCacheGetObject(&cache1, 0U, 5U);
+    test_assert((objp->obj_flags & OC_FLAG_NOTSYNC) == 0U, "not in sync");
+    chCacheReleaseObject(&cache1, objp);
+
+    n = chCacheReadAhead(&cache1, 0U, 3U, 2U);
+    test_assert(n == 0U, "objects not in cache");
+    test_assert_sequence("", "unexpected tokens");
+  }
+  test_end_step(4);
+
+  /* [6.3.5] Marking all objects for lazy write, read-ahead must not
+     start any read or write, then the objects are flushed.*/
+  test_set_step(5);
+  {
+    static const uint32_t keys[] = {1, 2, 4, 5};
+    unsigned i;
+    ucnt_t n;
+    bool error;
+
+    for (i = 0; i < 4; i++) {
+      objp = chCacheGetObject(&cache1, 0U, keys[i]);
+      objp->obj_flags |= OC_FLAG_LAZYWRITE;
+      chCacheReleaseObject(&cache1, objp);
+    }
+
+    n = chCacheReadAhead(&cache1, 0U, 5U, 1U);
+    test_assert(n == 0U, "dirty object evicted");
+    test_assert_sequence("", "unexpected tokens");
+
+    error = chCacheFlush(&cache1);
+    test_assert(error == false, "returned error");
+    test_assert_sequence("B+CE+F", "unexpected tokens");
+  }
+  test_end_step(5);
+
+  /* [6.3.6] Reading ahead with a synchronous read function, the objects
+     must be released.*/
+  test_set_step(6);
+  {
+    ucnt_t n;
+    cnt_t cnt;
+
+    read_sync_only = true;
+    n = chCacheReadAhead(&cache1, 0U, 7U, 2U);
+    read_sync_only = false;
+    test_assert(n == 2U, "unexpected number of reads");
+    test_assert_sequence("ij", "unexpected tokens");
+
+    chSysLock();
+    cnt = chSemGetCounterI(&cache1.lru_sem);
+    chSysUnlock();
+    test_assert(cnt == (cnt_t)NUM_OBJECTS, "objects not released");
+
+    objp = chCacheGetObject(&cache1, 0U, 9U);
+    test_assert((objp->obj_flags & OC_FLAG_NOTSYNC) == 0U, "not in sync");
+    chCacheReleaseObject(&cache1, objp);
+  }
+  test_end_step(6);
+}
+
+static const testcase_t oslib_test_006_003 = {
+  "Write-behind and read-ahead",
+  NULL,
+  NULL,
+  oslib_test_006_003_execute
+};
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -252,6 +516,10 @@ static const testcase_t oslib_test_006_001 = {
  */
 const testcase_t * const oslib_test_sequence_006_array[] = {
   &oslib_test_006_001,
+#if (CH_CFG_OBJ_CACHES_USE_2Q == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_006_002,
+#endif
+  &oslib_test_006_003,
   NULL
 };
 
@@ -0,0 +1,203 @@
+/*
+    ChibiOS - Copyright (C) 2006..2017 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "oslib_test_root.h"
+
+/**
+ * @file    oslib_test_sequence_010.c
+ * @brief   Test Sequence 010 code.
+ *
+ * @page oslib_test_sequence_010 [10] SPSC Rings
+ *
+ * File: @ref oslib_test_sequence_010.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS library functionalities related to
+ * lock-free single producer single consumer rings.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_RINGS == TRUE
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage oslib_test_010_001
+ * .
+ */
+
+#if (CH_CFG_USE_RINGS == TRUE) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define RING_SIZE 8
+
+static uint16_t ring_buffer[RING_SIZE];
+static RING_DECL(ring1, ring_buffer, sizeof (uint16_t), RING_SIZE);
+static THD_WORKING_AREA(waRingProducer, 256);
+
+static THD_FUNCTION(ring_producer, arg) {
+  uint16_t i;
+
+  (void)arg;
+
+  for (i = 0U; i < 4U; i++) {
+    chThdSleepMilliseconds(1);
+    (void) chRingWriteX(&ring1, &i, 1U);
+  }
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page oslib_test_010_001 [10.1] SPSC rings
+ *
+ * <h2>Description</h2>
+ * The SPSC rings API is tested, elements are written and read across
+ * the buffer boundary then the consumer waits for a threshold reached
+ * by a producer thread.
+ *
+ * <h2>Test Steps</h2>
+ * - [10.1.1] Writing five elements and reading three, the counters must
+ *   be consistent.
+ * - [10.1.2] Filling the ring across the buffer boundary, the write
+ *   must be truncated to the free space then all elements are read
+ *   back in order.
+ * - [10.1.3] Waiting on an empty ring with immediate timeout, the wait
+ *   must fail.
+ * - [10.1.4] Starting a producer thread writing one element each
+ *   millisecond, the consumer waits for four elements, the wait must
+ *   succeed once all elements are available.
+ * .
+ */
+
+static void oslib_test_010_001_setup(void) {
+  chRingObjectInit(&ring1, ring_buffer, sizeof (uint16_t), RING_SIZE);
+}
+
+static void oslib_test_010_001_execute(void) {
+  uint16_t in[RING_SIZE], out[RING_SIZE];
+  unsigned i;
+  size_t n;
+
+  /* [10.1.1] Writing five elements and reading three, the counters must
+     be consistent.*/
+  test_set_step(1);
+  {
+    for (i = 0U; i < RING_SIZE; i++) {
+      in[i] = (uint16_t)(0x1000U + i);
+    }
+    n = chRingWriteX(&ring1, in, 5U);
+    test_assert(n == 5U, "wrong written count");
+    n = chRingReadX(&ring1, out, 3U);
+    test_assert(n == 3U, "wrong read count");
+    test_assert((out[0] == 0x1000U) && (out[2] == 0x1002U), "wrong data");
+    test_assert(chRingGetUsedX(&ring1) == 2U, "wrong used count");
+    test_assert(chRingGetFreeX(&ring1) == RING_SIZE - 2U, "wrong free count");
+  }
+  test_end_step(1);
+
+  /* [10.1.2] Filling the ring across the buffer boundary, the write
+     must be truncated to the free space then all elements are read
+     back in order.*/
+  test_set_step(2);
+  {
+    n = chRingWriteX(&ring1, in, RING_SIZE);
+    test_assert(n == RING_SIZE - 2U, "wrong written count");
+    n = chRingWriteX(&ring1, in, 1U);
+    test_assert(n == 0U, "ring not full");
+    n = chRingReadX(&ring1, out, RING_SIZE);
+    test_assert(n == RING_SIZE, "wrong read count");
+    test_assert((out[0] == 0x1003U) && (out[1] == 0x1004U), "wrong data");
+    for (i = 2U; i < RING_SIZE; i++) {
+      test_assert(out[i] == in[i - 2U], "wrong data");
+    }
+    n = chRingReadX(&ring1, out, 1U);
+    test_assert(n == 0U, "ring not empty");
+  }
+  test_end_step(2);
+
+  /* [10.1.3] Waiting on an empty ring with immediate timeout, the wait
+     must fail.*/
+  test_set_step(3);
+  {
+    msg_t msg;
+
+    msg = chRingWaitTimeout(&ring1, 1U, TIME_IMMEDIATE);
+    test_assert(msg == MSG_TIMEOUT, "wrong wait result");
+  }
+  test_end_step(3);
+
+  /* [10.1.4] Starting a producer thread writing one element each
+     millisecond, the consumer waits for four elements, the wait must
+     succeed once all elements are available.*/
+  test_set_step(4);
+  {
+    thread_t *tp;
+    msg_t msg;
+
+    thread_descriptor_t td = {
+      .name  = "producer",
+      .wbase = waRingProducer,
+      .wend  = THD_WORKING_AREA_END(waRingProducer),
+      .prio  = chThdGetPriorityX() - 1,
+      .funcp = ring_producer,
+      .arg   = NULL
+    };
+    tp = chThdCreate(&td);
+    msg = chRingWaitTimeout(&ring1, 4U, TIME_MS2I(100));
+    test_assert(msg == MSG_OK, "wrong wait result");
+    test_assert(chRingGetUsedX(&ring1) == 4U, "wrong used count");
+    n = chRingReadX(&ring1, out, 4U);
+    test_assert((n == 4U) && (out[0] == 0U) && (out[3] == 3U), "wrong data");
+    (void) chThdWait(tp);
+  }
+  test_end_step(4);
+}
+
+static const testcase_t oslib_test_010_001 = {
+  "SPSC rings",
+  oslib_test_010_001_setup,
+  NULL,
+  oslib_test_010_001_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const oslib_test_sequence_010_array[] = {
+  &oslib_test_010_001,
+  NULL
+};
+
+/**
+ * @brief   SPSC Rings.
+ */
+const testsequence_t oslib_test_sequence_010 = {
+  "SPSC Rings",
+  oslib_test_sequence_010_array
+};
+
+#endif /* CH_CFG_USE_RINGS */
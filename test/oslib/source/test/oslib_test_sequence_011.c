@@ -0,0 +1,482 @@
+/*
+    ChibiOS - Copyright (C) 2006..2017 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "oslib_test_root.h"
+
+/**
+ * @file    oslib_test_sequence_011.c
+ * @brief   Test Sequence 011 code.
+ *
+ * @page oslib_test_sequence_011 [11] Reference-counted Buffers
+ *
+ * File: @ref oslib_test_sequence_011.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS library functionalities related to
+ * reference-counted buffers and their adapters.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_REFBUFS == TRUE
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage oslib_test_011_001
+ * - @subpage oslib_test_011_002
+ * - @subpage oslib_test_011_003
+ * .
+ */
+
+#if (CH_CFG_USE_REFBUFS == TRUE) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#include <string.h>
+
+#if OSLIB_TEST_CFG_USE_STREAMS == TRUE
+#include "refstreams.h"
+#endif
+
+#define REFBUF_SIZE     16
+#define REFBUF_HEADROOM 4
+#define REFBUF_NUM      4
+
+static refbuf_pool_t refbufs1;
+static stkalign_t refbuf_area[((REFBUF_NUM * REFBUF_OBJECT_SIZE(REFBUF_SIZE)) +
+                               sizeof (stkalign_t) - 1U) / sizeof (stkalign_t)];
+
+static const uint8_t refbuf_pattern[] = "0123456789ABCDEF";
+
+static cnt_t refbuf_get_free(void) {
+  cnt_t cnt;
+
+  chSysLock();
+  cnt = chGuardedPoolGetCounterI(&refbufs1.free);
+  chSysUnlock();
+
+  return cnt;
+}
+
+#if CH_CFG_USE_PIPES == TRUE
+#define PIPE_SIZE 16
+
+static uint8_t pipe_buffer[PIPE_SIZE];
+static PIPE_DECL(pipe1, pipe_buffer, PIPE_SIZE);
+#endif
+
+#if CH_CFG_USE_OBJ_FIFOS == TRUE
+static objects_fifo_t fifo1;
+static refbuf_t *fifo_objects[2];
+static msg_t fifo_msgs[2];
+#endif
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page oslib_test_011_001 [11.1] Reference-counted buffers
+ *
+ * <h2>Description</h2>
+ * Buffers are allocated from a pool, their payload window is moved
+ * inside the storage, chained, shared and passed through a mailbox.
+ * The pool must be full again after the last references are released.
+ *
+ * <h2>Test Steps</h2>
+ * - [11.1.1] Allocating a buffer, the payload must be empty with the
+ *   headroom reserved.
+ * - [11.1.2] Appending a payload then prepending and stripping a
+ *   header, the payload must not move.
+ * - [11.1.3] Chaining a second buffer, the chain must be read as a
+ *   single contiguous payload.
+ * - [11.1.4] Sharing the chain, the first release must keep the
+ *   buffers, the second one must return them to the pool.
+ * - [11.1.5] Passing a buffer reference through a mailbox, the same
+ *   buffer must be received.
+ * .
+ */
+
+static void oslib_test_011_001_setup(void) {
+  chRefBufPoolObjectInit(&refbufs1, REFBUF_SIZE, REFBUF_HEADROOM,
+                         (void *)refbuf_area, REFBUF_NUM);
+}
+
+static void oslib_test_011_001_execute(void) {
+  refbuf_t *bp1, *bp2;
+  uint8_t out[REFBUF_SIZE];
+  size_t n;
+
+  /* [11.1.1] Allocating a buffer, the payload must be empty with the
+     headroom reserved.*/
+  test_set_step(1);
+  {
+    bp1 = chRefBufAllocTimeout(&refbufs1, TIME_IMMEDIATE);
+    test_assert(bp1 != NULL, "allocation failed");
+    test_assert(chRefBufGetLengthX(bp1) == 0U, "not empty");
+    test_assert(chRefBufGetHeadroomX(bp1) == REFBUF_HEADROOM, "wrong headroom");
+    test_assert(chRefBufGetTailroomX(bp1) == REFBUF_SIZE - REFBUF_HEADROOM,
+                "wrong tailroom");
+  }
+  test_end_step(1);
+
+  /* [11.1.2] Appending a payload then prepending and stripping a
+     header, the payload must not move.*/
+  test_set_step(2);
+  {
+    uint8_t *p;
+
+    n = chRefBufCopyIn(bp1, refbuf_pattern, 8U);
+    test_assert(n == 8U, "wrong copied size");
+    p = chRefBufPushX(bp1, 2U);
+    p[0] = 'h';
+    p[1] = 'h';
+    test_assert(chRefBufGetLengthX(bp1) == 10U, "wrong length");
+    test_assert(chRefBufGetHeadroomX(bp1) == REFBUF_HEADROOM - 2U,
+                "wrong headroom");
+    p = chRefBufPullX(bp1, 2U);
+    test_assert(memcmp(p, refbuf_pattern, 8U) == 0, "payload moved");
+    chRefBufTrimX(bp1, 4U);
+    test_assert(chRefBufGetLengthX(bp1) == 4U, "wrong length");
+  }
+  test_end_step(2);
+
+  /* [11.1.3] Chaining a second buffer, the chain must be read as a
+     single contiguous payload.*/
+  test_set_step(3);
+  {
+    bp2 = chRefBufAllocTimeout(&refbufs1, TIME_IMMEDIATE);
+    test_assert(bp2 != NULL, "allocation failed");
+    (void) chRefBufCopyIn(bp2, &refbuf_pattern[4], 4U);
+    chRefBufChain(bp1, bp2);
+    test_assert(chRefBufGetChainLength(bp1) == 8U, "wrong chain length");
+    n = chRefBufCopyOut(bp1, 2U, out, sizeof (out));
+    test_assert(n == 6U, "wrong copied size");
+    test_assert(memcmp(out, &refbuf_pattern[2], 6U) == 0, "wrong data");
+  }
+  test_end_step(3);
+
+  /* [11.1.4] Sharing the chain, the first release must keep the
+     buffers, the second one must return them to the pool.*/
+  test_set_step(4);
+  {
+    (void) chRefBufAddRefX(bp1);
+    chRefBufRelease(bp1);
+    test_assert(refbuf_get_free() == (cnt_t)(REFBUF_NUM - 2), "buffers released");
+    test_assert(chRefBufGetChainLength(bp1) == 8U, "chain modified");
+    chRefBufRelease(bp1);
+    test_assert(refbuf_get_free() == (cnt_t)REFBUF_NUM, "buffers not released");
+  }
+  test_end_step(4);
+
+  /* [11.1.5] Passing a buffer reference through a mailbox, the same
+     buffer must be received.*/
+  test_set_step(5);
+  {
+#if CH_CFG_USE_MAILBOXES == TRUE
+    mailbox_t mb;
+    msg_t mb_buffer[1];
+    msg_t msg;
+
+    chMBObjectInit(&mb, mb_buffer, 1);
+    bp1 = chRefBufAllocTimeout(&refbufs1, TIME_IMMEDIATE);
+    test_assert(bp1 != NULL, "allocation failed");
+    msg = chMBPostRefBufTimeout(&mb, bp1, TIME_IMMEDIATE);
+    test_assert(msg == MSG_OK, "wrong post result");
+    msg = chMBFetchRefBufTimeout(&mb, &bp2, TIME_IMMEDIATE);
+    test_assert((msg == MSG_OK) && (bp2 == bp1), "wrong buffer");
+    chRefBufRelease(bp2);
+#endif
+  }
+  test_end_step(5);
+}
+
+static const testcase_t oslib_test_011_001 = {
+  "Reference-counted buffers",
+  oslib_test_011_001_setup,
+  NULL,
+  oslib_test_011_001_execute
+};
+
+#if (CH_CFG_USE_PIPES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_011_002 [11.2] Pipes and objects FIFOs adapters
+ *
+ * <h2>Description</h2>
+ * Buffer chains are written into a pipe and read back into the
+ * tailroom of other buffers, empty links and full buffers must be
+ * handled without transferring anything. Buffer references are passed
+ * through an objects FIFO.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_PIPES == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [11.2.1] Writing a chain into a pipe and reading it back into the
+ *   tailroom of another buffer, the data must match.
+ * - [11.2.2] Writing an empty buffer and a chain starting with an
+ *   empty link, empty links must be skipped.
+ * - [11.2.3] Reading into a buffer without tailroom, nothing must be
+ *   read, then the data is read into an empty buffer.
+ * - [11.2.4] Passing a buffer reference through an objects FIFO, the
+ *   same buffer must be received.
+ * .
+ */
+
+static void oslib_test_011_002_setup(void) {
+  chRefBufPoolObjectInit(&refbufs1, REFBUF_SIZE, REFBUF_HEADROOM,
+                         (void *)refbuf_area, REFBUF_NUM);
+  chPipeObjectInit(&pipe1, pipe_buffer, PIPE_SIZE);
+}
+
+static void oslib_test_011_002_execute(void) {
+  refbuf_t *bp1, *bp2, *bp3;
+  size_t n;
+
+  /* [11.2.1] Writing a chain into a pipe and reading it back into the
+     tailroom of another buffer, the data must match.*/
+  test_set_step(1);
+  {
+    bp1 = chRefBufAllocTimeout(&refbufs1, TIME_IMMEDIATE);
+    bp2 = chRefBufAllocTimeout(&refbufs1, TIME_IMMEDIATE);
+    bp3 = chRefBufAllocTimeout(&refbufs1, TIME_IMMEDIATE);
+    test_assert((bp1 != NULL) && (bp2 != NULL) && (bp3 != NULL),
+                "allocation failed");
+    (void) chRefBufCopyIn(bp1, refbuf_pattern, 3U);
+    (void) chRefBufCopyIn(bp2, &refbuf_pattern[3], 5U);
+    chRefBufChain(bp1, bp2);
+    n = chPipeWriteRefBufTimeout(&pipe1, bp1, TIME_IMMEDIATE);
+    test_assert(n == 8U, "wrong written size");
+    chRefBufRelease(bp1);
+    n = chPipeReadRefBufTimeout(&pipe1, bp3, 8U, TIME_IMMEDIATE);
+    test_assert(n == 8U, "wrong read size");
+    test_assert(memcmp(chRefBufGetDataX(bp3), refbuf_pattern, 8U) == 0,
+                "wrong data");
+    chRefBufRelease(bp3);
+  }
+  test_end_step(1);
+
+  /* [11.2.2] Writing an empty buffer and a chain starting with an
+     empty link, empty links must be skipped.*/
+  test_set_step(2);
+  {
+    bp1 = chRefBufAllocTimeout(&refbufs1, TIME_IMMEDIATE);
+    bp2 = chRefBufAllocTimeout(&refbufs1, TIME_IMMEDIATE);
+    test_assert((bp1 != NULL) && (bp2 != NULL), "allocation failed");
+    n = chPipeWriteRefBufTimeout(&pipe1, bp1, TIME_IMMEDIATE);
+    test_assert(n == 0U, "wrong written size");
+    (void) chRefBufCopyIn(bp2, refbuf_pattern, 4U);
+    chRefBufChain(bp1, bp2);
+    n = chPipeWriteRefBufTimeout(&pipe1, bp1, TIME_IMMEDIATE);
+    test_assert(n == 4U, "wrong written size");
+    test_assert(chPipeGetUsedCount(&pipe1) == 4U, "wrong pipe count");
+    chRefBufRelease(bp1);
+  }
+  test_end_step(2);
+
+  /* [11.2.3] Reading into a buffer without tailroom, nothing must be
+     read, then the data is read into an empty buffer.*/
+  test_set_step(3);
+  {
+    bp1 = chRefBufAllocTimeout(&refbufs1, TIME_IMMEDIATE);
+    test_assert(bp1 != NULL, "allocation failed");
+    (void) chRefBufCopyIn(bp1, refbuf_pattern, REFBUF_SIZE - REFBUF_HEADROOM);
+    test_assert(chRefBufGetTailroomX(bp1) == 0U, "tailroom left");
+    n = chPipeReadRefBufTimeout(&pipe1, bp1, 4U, TIME_IMMEDIATE);
+    test_assert(n == 0U, "wrong read size");
+    chRefBufRelease(bp1);
+    bp1 = chRefBufAllocTimeout(&refbufs1, TIME_IMMEDIATE);
+    test_assert(bp1 != NULL, "allocation failed");
+    n = chPipeReadRefBufTimeout(&pipe1, bp1, 8U, TIME_IMMEDIATE);
+    test_assert(n == 4U, "wrong read size");
+    test_assert(memcmp(chRefBufGetDataX(bp1), refbuf_pattern, 4U) == 0,
+                "wrong data");
+    chRefBufRelease(bp1);
+    test_assert(refbuf_get_free() == (cnt_t)REFBUF_NUM, "buffers not released");
+  }
+  test_end_step(3);
+
+  /* [11.2.4] Passing a buffer reference through an objects FIFO, the
+     same buffer must be received.*/
+  test_set_step(4);
+  {
+#if CH_CFG_USE_OBJ_FIFOS == TRUE
+    msg_t msg;
+
+    chFifoObjectInit(&fifo1, sizeof (refbuf_t *), 2U,
+                     (void *)fifo_objects, fifo_msgs);
+    bp1 = chRefBufAllocTimeout(&refbufs1, TIME_IMMEDIATE);
+    test_assert(bp1 != NULL, "allocation failed");
+    msg = chFifoSendRefBufTimeout(&fifo1, bp1, TIME_IMMEDIATE);
+    test_assert(msg == MSG_OK, "wrong send result");
+    msg = chFifoReceiveRefBufTimeout(&fifo1, &bp2, TIME_IMMEDIATE);
+    test_assert((msg == MSG_OK) && (bp2 == bp1), "wrong buffer");
+    chRefBufRelease(bp2);
+#endif
+  }
+  test_end_step(4);
+}
+
+static const testcase_t oslib_test_011_002 = {
+  "Pipes and objects FIFOs adapters",
+  oslib_test_011_002_setup,
+  NULL,
+  oslib_test_011_002_execute
+};
+#endif /* CH_CFG_USE_PIPES == TRUE */
+
+#if (OSLIB_TEST_CFG_USE_STREAMS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_011_003 [11.3] Buffers streams
+ *
+ * <h2>Description</h2>
+ * A buffer chain is read through a stream, reads crossing the links
+ * boundaries must return the payload in order and release the consumed
+ * buffers. Writes must extend the chain from the pool.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - OSLIB_TEST_CFG_USE_STREAMS == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [11.3.1] Attaching a chain of three buffers to a read-only stream.
+ * - [11.3.2] Reading across the first link boundary, the data must
+ *   match and the first buffer must be released.
+ * - [11.3.3] Reading more than the available data, the rest of the
+ *   chain must be returned and the last buffer kept because it has
+ *   tailroom.
+ * - [11.3.4] Writing into a stream backed by the pool, the chain must
+ *   be extended and detached without copies.
+ * .
+ */
+
+static void oslib_test_011_003_setup(void) {
+  chRefBufPoolObjectInit(&refbufs1, REFBUF_SIZE, REFBUF_HEADROOM,
+                         (void *)refbuf_area, REFBUF_NUM);
+}
+
+static void oslib_test_011_003_execute(void) {
+  RefStream rs;
+  refbuf_t *bp1, *bp2, *bp3;
+  uint8_t out[REFBUF_SIZE];
+  size_t n;
+
+  /* [11.3.1] Attaching a chain of three buffers to a read-only
+     stream.*/
+  test_set_step(1);
+  {
+    bp1 = chRefBufAllocTimeout(&refbufs1, TIME_IMMEDIATE);
+    bp2 = chRefBufAllocTimeout(&refbufs1, TIME_IMMEDIATE);
+    bp3 = chRefBufAllocTimeout(&refbufs1, TIME_IMMEDIATE);
+    test_assert((bp1 != NULL) && (bp2 != NULL) && (bp3 != NULL),
+                "allocation failed");
+    (void) chRefBufCopyIn(bp1, refbuf_pattern, 3U);
+    (void) chRefBufCopyIn(bp2, &refbuf_pattern[3], 5U);
+    (void) chRefBufCopyIn(bp3, &refbuf_pattern[8], 4U);
+    chRefBufChain(bp1, bp2);
+    chRefBufChain(bp1, bp3);
+    rsObjectInit(&rs, NULL);
+    rsAttach(&rs, bp1);
+  }
+  test_end_step(1);
+
+  /* [11.3.2] Reading across the first link boundary, the data must
+     match and the first buffer must be released.*/
+  test_set_step(2);
+  {
+    n = streamRead(&rs, out, 5U);
+    test_assert(n == 5U, "wrong read size");
+    test_assert(memcmp(out, refbuf_pattern, 5U) == 0, "wrong data");
+    test_assert(refbuf_get_free() == (cnt_t)(REFBUF_NUM - 2), "wrong free count");
+  }
+  test_end_step(2);
+
+  /* [11.3.3] Reading more than the available data, the rest of the
+     chain must be returned and the last buffer kept because it has
+     tailroom.*/
+  test_set_step(3);
+  {
+    n = streamRead(&rs, out, sizeof (out));
+    test_assert(n == 7U, "wrong read size");
+    test_assert(memcmp(out, &refbuf_pattern[5], 7U) == 0, "wrong data");
+    test_assert(streamGet(&rs) == MSG_RESET, "not empty");
+    test_assert(refbuf_get_free() == (cnt_t)(REFBUF_NUM - 1), "wrong free count");
+    chRefBufRelease(rsDetach(&rs));
+  }
+  test_end_step(3);
+
+  /* [11.3.4] Writing into a stream backed by the pool, the chain must
+     be extended and detached without copies.*/
+  test_set_step(4);
+  {
+    rsObjectInit(&rs, &refbufs1);
+    n = streamWrite(&rs, refbuf_pattern, 16U);
+    test_assert(n == 16U, "wrong written size");
+    bp1 = rsDetach(&rs);
+    test_assert((bp1 != NULL) && (bp1->next != NULL), "not chained");
+    test_assert(chRefBufGetChainLength(bp1) == 16U, "wrong chain length");
+    n = chRefBufCopyOut(bp1, 0U, out, sizeof (out));
+    test_assert((n == 16U) && (memcmp(out, refbuf_pattern, 16U) == 0),
+                "wrong data");
+    chRefBufRelease(bp1);
+    test_assert(refbuf_get_free() == (cnt_t)REFBUF_NUM, "buffers not released");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t oslib_test_011_003 = {
+  "Buffers streams",
+  oslib_test_011_003_setup,
+  NULL,
+  oslib_test_011_003_execute
+};
+#endif /* OSLIB_TEST_CFG_USE_STREAMS == TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const oslib_test_sequence_011_array[] = {
+  &oslib_test_011_001,
+#if (CH_CFG_USE_PIPES == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_011_002,
+#endif
+#if (OSLIB_TEST_CFG_USE_STREAMS == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_011_003,
+#endif
+  NULL
+};
+
+/**
+ * @brief   Reference-counted Buffers.
+ */
+const testsequence_t oslib_test_sequence_011 = {
+  "Reference-counted Buffers",
+  oslib_test_sequence_011_array
+};
+
+#endif /* CH_CFG_USE_REFBUFS */
@@ -0,0 +1,237 @@
+/*
+    ChibiOS - Copyright (C) 2006..2017 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "oslib_test_root.h"
+
+/**
+ * @file    oslib_test_sequence_012.c
+ * @brief   Test Sequence 012 code.
+ *
+ * @page oslib_test_sequence_012 [12] Messages Bus
+ *
+ * File: @ref oslib_test_sequence_012.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS library functionalities related to
+ * the messages bus.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_BUS == TRUE
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage oslib_test_012_001
+ * .
+ */
+
+#if (CH_CFG_USE_BUS == TRUE) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define REFBUF_SIZE     16
+#define REFBUF_HEADROOM 4
+#define REFBUF_NUM      4
+
+static refbuf_pool_t refbufs1;
+static stkalign_t refbuf_area[((REFBUF_NUM * REFBUF_OBJECT_SIZE(REFBUF_SIZE)) +
+                               sizeof (stkalign_t) - 1U) / sizeof (stkalign_t)];
+
+static msg_bus_t bus1;
+static bus_subscriber_t bus_sub1, bus_sub2;
+static refbuf_t *bus_queue1[2], *bus_queue2[2];
+static THD_WORKING_AREA(waBusConsumer, 256);
+
+static THD_FUNCTION(bus_consumer, arg) {
+
+  (void)arg;
+
+  chThdSleepMilliseconds(1);
+  chRefBufRelease(chBusReceiveTimeout(&bus_sub1, TIME_INFINITE));
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page oslib_test_012_001 [12.1] Messages bus
+ *
+ * <h2>Description</h2>
+ * Frames are published to subscribers with different queue policies,
+ * the delivered and dropped frames are checked and the pool must be
+ * full again after the last references are released.
+ *
+ * <h2>Test Steps</h2>
+ * - [12.1.1] Attaching a drop-oldest and a drop-newest subscriber with
+ *   two slots each then publishing three frames, the last frame must
+ *   reach only the drop-oldest subscriber.
+ * - [12.1.2] Receiving from both subscribers, the drop-oldest one must
+ *   get the last two frames and the drop-newest one the first two, the
+ *   same frame must be shared.
+ * - [12.1.3] Detaching the subscribers then attaching a blocking
+ *   subscriber with one slot, a publish on the full queue with
+ *   immediate timeout must drop the frame.
+ * - [12.1.4] Starting a consumer thread releasing a frame after one
+ *   millisecond, the blocked publisher must deliver its frame once the
+ *   slot is free.
+ * - [12.1.5] Detaching the subscriber, the queued frames must return to
+ *   the pool.
+ * .
+ */
+
+static void oslib_test_012_001_setup(void) {
+  chRefBufPoolObjectInit(&refbufs1, REFBUF_SIZE, REFBUF_HEADROOM,
+                         (void *)refbuf_area, REFBUF_NUM);
+  chBusObjectInit(&bus1, &refbufs1);
+}
+
+static void oslib_test_012_001_execute(void) {
+  refbuf_t *bp;
+  cnt_t n;
+  unsigned i;
+
+  /* [12.1.1] Attaching a drop-oldest and a drop-newest subscriber with
+     two slots each then publishing three frames, the last frame must
+     reach only the drop-oldest subscriber.*/
+  test_set_step(1);
+  {
+    chBusSubscribe(&bus1, &bus_sub1, bus_queue1, 2U, BUS_POLICY_DROP_OLDEST);
+    chBusSubscribe(&bus1, &bus_sub2, bus_queue2, 2U, BUS_POLICY_DROP_NEWEST);
+    for (i = 0U; i < 3U; i++) {
+      bp = chBusAcquireFrameTimeout(&bus1, TIME_IMMEDIATE);
+      test_assert(bp != NULL, "acquire failed");
+      *chRefBufPutX(bp, 1U) = (uint8_t)i;
+      n = chBusPublishTimeout(&bus1, bp, TIME_IMMEDIATE);
+      test_assert(n == (i < 2U ? (cnt_t)2 : (cnt_t)1), "wrong delivery count");
+    }
+    test_assert(chBusGetDroppedX(&bus_sub1) == 1U, "wrong dropped count");
+    test_assert(chBusGetDroppedX(&bus_sub2) == 1U, "wrong dropped count");
+  }
+  test_end_step(1);
+
+  /* [12.1.2] Receiving from both subscribers, the drop-oldest one must
+     get the last two frames and the drop-newest one the first two, the
+     same frame must be shared.*/
+  test_set_step(2);
+  {
+    refbuf_t *bp1, *bp2;
+
+    bp1 = chBusReceiveTimeout(&bus_sub1, TIME_IMMEDIATE);
+    test_assert((bp1 != NULL) && (*chRefBufGetDataX(bp1) == 1U), "wrong frame");
+    bp2 = chBusReceiveTimeout(&bus_sub2, TIME_IMMEDIATE);
+    test_assert((bp2 != NULL) && (*chRefBufGetDataX(bp2) == 0U), "wrong frame");
+    chRefBufRelease(bp2);
+    bp2 = chBusReceiveTimeout(&bus_sub2, TIME_IMMEDIATE);
+    test_assert(bp2 == bp1, "frame not shared");
+    chRefBufRelease(bp1);
+    chRefBufRelease(bp2);
+    bp1 = chBusReceiveTimeout(&bus_sub1, TIME_IMMEDIATE);
+    test_assert((bp1 != NULL) && (*chRefBufGetDataX(bp1) == 2U), "wrong frame");
+    chRefBufRelease(bp1);
+    bp1 = chBusReceiveTimeout(&bus_sub1, TIME_IMMEDIATE);
+    test_assert(bp1 == NULL, "queue not empty");
+  }
+  test_end_step(2);
+
+  /* [12.1.3] Detaching the subscribers then attaching a blocking
+     subscriber with one slot, a publish on the full queue with
+     immediate timeout must drop the frame.*/
+  test_set_step(3);
+  {
+    chBusUnsubscribe(&bus_sub1);
+    chBusUnsubscribe(&bus_sub2);
+    chBusSubscribe(&bus1, &bus_sub1, bus_queue1, 1U, BUS_POLICY_BLOCK);
+    bp = chBusAcquireFrameTimeout(&bus1, TIME_IMMEDIATE);
+    n = chBusPublishTimeout(&bus1, bp, TIME_IMMEDIATE);
+    test_assert(n == (cnt_t)1, "wrong delivery count");
+    bp = chBusAcquireFrameTimeout(&bus1, TIME_IMMEDIATE);
+    n = chBusPublishTimeout(&bus1, bp, TIME_IMMEDIATE);
+    test_assert(n == (cnt_t)0, "wrong delivery count");
+    test_assert(chBusGetDroppedX(&bus_sub1) == 1U, "wrong dropped count");
+  }
+  test_end_step(3);
+
+  /* [12.1.4] Starting a consumer thread releasing a frame after one
+     millisecond, the blocked publisher must deliver its frame once the
+     slot is free.*/
+  test_set_step(4);
+  {
+    thread_t *tp;
+
+    thread_descriptor_t td = {
+      .name  = "consumer",
+      .wbase = waBusConsumer,
+      .wend  = THD_WORKING_AREA_END(waBusConsumer),
+      .prio  = chThdGetPriorityX() - 1,
+      .funcp = bus_consumer,
+      .arg   = NULL
+    };
+    tp = chThdCreate(&td);
+    bp = chBusAcquireFrameTimeout(&bus1, TIME_IMMEDIATE);
+    n = chBusPublishTimeout(&bus1, bp, TIME_MS2I(100));
+    test_assert(n == (cnt_t)1, "wrong delivery count");
+    (void) chThdWait(tp);
+  }
+  test_end_step(4);
+
+  /* [12.1.5] Detaching the subscriber, the queued frames must return to
+     the pool.*/
+  test_set_step(5);
+  {
+    cnt_t cnt;
+
+    chBusUnsubscribe(&bus_sub1);
+    chSysLock();
+    cnt = chGuardedPoolGetCounterI(&refbufs1.free);
+    chSysUnlock();
+    test_assert(cnt == (cnt_t)REFBUF_NUM, "frames not released");
+  }
+  test_end_step(5);
+}
+
+static const testcase_t oslib_test_012_001 = {
+  "Messages bus",
+  oslib_test_012_001_setup,
+  NULL,
+  oslib_test_012_001_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const oslib_test_sequence_012_array[] = {
+  &oslib_test_012_001,
+  NULL
+};
+
+/**
+ * @brief   Messages Bus.
+ */
+const testsequence_t oslib_test_sequence_012 = {
+  "Messages Bus",
+  oslib_test_sequence_012_array
+};
+
+#endif /* CH_CFG_USE_BUS */
@@ -0,0 +1,367 @@
+/*
+    ChibiOS - Copyright (C) 2006..2017 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "oslib_test_root.h"
+
+/**
+ * @file    oslib_test_sequence_013.c
+ * @brief   Test Sequence 013 code.
+ *
+ * @page oslib_test_sequence_013 [13] Objects FIFOs
+ *
+ * File: @ref oslib_test_sequence_013.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS library functionalities related to
+ * the objects FIFOs, in both the mailbox-based and the lock-free
+ * implementations.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_OBJ_FIFOS == TRUE
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage oslib_test_013_001
+ * - @subpage oslib_test_013_002
+ * - @subpage oslib_test_013_003
+ * .
+ */
+
+#if (CH_CFG_USE_OBJ_FIFOS == TRUE) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define OF_SIZE         4
+#define OF_ITERATIONS   1000U
+
+static objects_fifo_t of1;
+static uintptr_t of_objects[OF_SIZE];
+static msg_t of_msgs[OF_SIZE];
+static THD_WORKING_AREA(waOF1, 256);
+static THD_WORKING_AREA(waOF2, 256);
+static THD_WORKING_AREA(waOF3, 256);
+static THD_WORKING_AREA(waOF4, 256);
+
+static THD_FUNCTION(of_producer, arg) {
+  uintptr_t i, *objp;
+
+  (void)arg;
+
+  for (i = 1U; i <= OF_ITERATIONS; i++) {
+    objp = chFifoTakeObjectTimeout(&of1, TIME_INFINITE);
+    *objp = i;
+    chFifoSendObject(&of1, objp);
+  }
+}
+
+static THD_FUNCTION(of_consumer, arg) {
+  uint32_t *sump = (uint32_t *)arg;
+  unsigned i;
+  void *objp;
+
+  for (i = 0U; i < OF_ITERATIONS; i++) {
+    (void) chFifoReceiveObjectTimeout(&of1, &objp, TIME_INFINITE);
+    *sump += (uint32_t)*(uintptr_t *)objp;
+    chFifoReturnObject(&of1, objp);
+  }
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page oslib_test_013_001 [13.1] Objects take and return
+ *
+ * <h2>Description</h2>
+ * The objects of a FIFO are taken until the FIFO is exhausted, further
+ * takes must fail, then the objects are returned and taken again.
+ *
+ * <h2>Test Steps</h2>
+ * - [13.1.1] Taking all the objects, no errors expected.
+ * - [13.1.2] Taking one more object using chFifoTakeObjectI() and
+ *   chFifoTakeObjectTimeout(), both must fail.
+ * - [13.1.3] Returning all the objects then taking them again, no
+ *   errors expected.
+ * .
+ */
+
+static void oslib_test_013_001_setup(void) {
+  chFifoObjectInit(&of1, sizeof (uintptr_t), OF_SIZE,
+                   (void *)of_objects, of_msgs);
+}
+
+static void oslib_test_013_001_execute(void) {
+  uintptr_t *objs[OF_SIZE];
+  void *objp;
+  unsigned i;
+
+  /* [13.1.1] Taking all the objects, no errors expected.*/
+  test_set_step(1);
+  {
+    for (i = 0U; i < OF_SIZE; i++) {
+      objs[i] = chFifoTakeObjectTimeout(&of1, TIME_IMMEDIATE);
+      test_assert(objs[i] != NULL, "take failed");
+    }
+  }
+  test_end_step(1);
+
+  /* [13.1.2] Taking one more object using chFifoTakeObjectI() and
+     chFifoTakeObjectTimeout(), both must fail.*/
+  test_set_step(2);
+  {
+    chSysLock();
+    objp = chFifoTakeObjectI(&of1);
+    chSysUnlock();
+    test_assert(objp == NULL, "take succeeded");
+    objp = chFifoTakeObjectTimeout(&of1, TIME_MS2I(1));
+    test_assert(objp == NULL, "take succeeded");
+  }
+  test_end_step(2);
+
+  /* [13.1.3] Returning all the objects then taking them again, no
+     errors expected.*/
+  test_set_step(3);
+  {
+    for (i = 0U; i < OF_SIZE; i++) {
+      chFifoReturnObject(&of1, objs[i]);
+    }
+    for (i = 0U; i < OF_SIZE; i++) {
+      objs[i] = chFifoTakeObjectTimeout(&of1, TIME_IMMEDIATE);
+      test_assert(objs[i] != NULL, "object lost");
+    }
+  }
+  test_end_step(3);
+}
+
+static const testcase_t oslib_test_013_001 = {
+  "Objects take and return",
+  oslib_test_013_001_setup,
+  NULL,
+  oslib_test_013_001_execute
+};
+
+/**
+ * @page oslib_test_013_002 [13.2] Objects send and receive
+ *
+ * <h2>Description</h2>
+ * Objects are sent through the FIFO and received back, the order and
+ * the content of the objects are checked.
+ *
+ * <h2>Test Steps</h2>
+ * - [13.2.1] Sending three objects, no errors expected.
+ * - [13.2.2] Receiving the three objects, they must be received in
+ *   order and with their content.
+ * - [13.2.3] Receiving from the empty FIFO using
+ *   chFifoReceiveObjectI() and chFifoReceiveObjectTimeout(), both must
+ *   time out.
+ * .
+ */
+
+static void oslib_test_013_002_setup(void) {
+  chFifoObjectInit(&of1, sizeof (uintptr_t), OF_SIZE,
+                   (void *)of_objects, of_msgs);
+}
+
+static void oslib_test_013_002_execute(void) {
+  uintptr_t *objs[OF_SIZE];
+  void *objp;
+  msg_t msg;
+  unsigned i;
+
+  /* [13.2.1] Sending three objects, no errors expected.*/
+  test_set_step(1);
+  {
+    for (i = 0U; i < 3U; i++) {
+      objs[i] = chFifoTakeObjectTimeout(&of1, TIME_IMMEDIATE);
+      *objs[i] = (uintptr_t)i;
+      chFifoSendObject(&of1, objs[i]);
+    }
+  }
+  test_end_step(1);
+
+  /* [13.2.2] Receiving the three objects, they must be received in
+     order and with their content.*/
+  test_set_step(2);
+  {
+    for (i = 0U; i < 3U; i++) {
+      msg = chFifoReceiveObjectTimeout(&of1, &objp, TIME_IMMEDIATE);
+      test_assert(msg == MSG_OK, "receive failed");
+      test_assert((objp == objs[i]) && (*(uintptr_t *)objp == i), "wrong order");
+      chFifoReturnObject(&of1, objp);
+    }
+  }
+  test_end_step(2);
+
+  /* [13.2.3] Receiving from the empty FIFO using
+     chFifoReceiveObjectI() and chFifoReceiveObjectTimeout(), both must
+     time out.*/
+  test_set_step(3);
+  {
+    chSysLock();
+    msg = chFifoReceiveObjectI(&of1, &objp);
+    chSysUnlock();
+    test_assert(msg == MSG_TIMEOUT, "not empty");
+    msg = chFifoReceiveObjectTimeout(&of1, &objp, TIME_MS2I(1));
+    test_assert(msg == MSG_TIMEOUT, "not empty");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t oslib_test_013_002 = {
+  "Objects send and receive",
+  oslib_test_013_002_setup,
+  NULL,
+  oslib_test_013_002_execute
+};
+
+/**
+ * @page oslib_test_013_003 [13.3] Concurrent producers and consumers
+ *
+ * <h2>Description</h2>
+ * Two producers and two consumers at different priorities exchange
+ * objects through the FIFO, all the sent values must be received and
+ * no object must be lost.
+ *
+ * <h2>Test Steps</h2>
+ * - [13.3.1] Starting the producer threads.
+ * - [13.3.2] Starting the consumer threads.
+ * - [13.3.3] Waiting for the threads to terminate, all the sent values
+ *   must have been received.
+ * - [13.3.4] Taking all the objects, no object must be lost.
+ * .
+ */
+
+static void oslib_test_013_003_setup(void) {
+  chFifoObjectInit(&of1, sizeof (uintptr_t), OF_SIZE,
+                   (void *)of_objects, of_msgs);
+}
+
+static void oslib_test_013_003_execute(void) {
+  thread_t *tp1, *tp2, *tp3, *tp4;
+  uint32_t sum1 = 0U, sum2 = 0U;
+
+  /* [13.3.1] Starting the producer threads.*/
+  test_set_step(1);
+  {
+    thread_descriptor_t td1 = {
+      .name  = "producer1",
+      .wbase = waOF1,
+      .wend  = THD_WORKING_AREA_END(waOF1),
+      .prio  = chThdGetPriorityX() - 1,
+      .funcp = of_producer,
+      .arg   = NULL
+    };
+    tp1 = chThdCreate(&td1);
+
+    thread_descriptor_t td2 = {
+      .name  = "producer2",
+      .wbase = waOF2,
+      .wend  = THD_WORKING_AREA_END(waOF2),
+      .prio  = chThdGetPriorityX() - 2,
+      .funcp = of_producer,
+      .arg   = NULL
+    };
+    tp2 = chThdCreate(&td2);
+  }
+  test_end_step(1);
+
+  /* [13.3.2] Starting the consumer threads.*/
+  test_set_step(2);
+  {
+    thread_descriptor_t td3 = {
+      .name  = "consumer1",
+      .wbase = waOF3,
+      .wend  = THD_WORKING_AREA_END(waOF3),
+      .prio  = chThdGetPriorityX() - 2,
+      .funcp = of_consumer,
+      .arg   = &sum1
+    };
+    tp3 = chThdCreate(&td3);
+
+    thread_descriptor_t td4 = {
+      .name  = "consumer2",
+      .wbase = waOF4,
+      .wend  = THD_WORKING_AREA_END(waOF4),
+      .prio  = chThdGetPriorityX() - 1,
+      .funcp = of_consumer,
+      .arg   = &sum2
+    };
+    tp4 = chThdCreate(&td4);
+  }
+  test_end_step(2);
+
+  /* [13.3.3] Waiting for the threads to terminate, all the sent values
+     must have been received.*/
+  test_set_step(3);
+  {
+    (void) chThdWait(tp1);
+    (void) chThdWait(tp2);
+    (void) chThdWait(tp3);
+    (void) chThdWait(tp4);
+    test_assert(sum1 + sum2 == OF_ITERATIONS * (OF_ITERATIONS + 1U),
+                "wrong sum");
+  }
+  test_end_step(3);
+
+  /* [13.3.4] Taking all the objects, no object must be lost.*/
+  test_set_step(4);
+  {
+    unsigned i;
+
+    for (i = 0U; i < OF_SIZE; i++) {
+      test_assert(chFifoTakeObjectTimeout(&of1, TIME_IMMEDIATE) != NULL,
+                  "object lost");
+    }
+  }
+  test_end_step(4);
+}
+
+static const testcase_t oslib_test_013_003 = {
+  "Concurrent producers and consumers",
+  oslib_test_013_003_setup,
+  NULL,
+  oslib_test_013_003_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const oslib_test_sequence_013_array[] = {
+  &oslib_test_013_001,
+  &oslib_test_013_002,
+  &oslib_test_013_003,
+  NULL
+};
+
+/**
+ * @brief   Objects FIFOs.
+ */
+const testsequence_t oslib_test_sequence_013 = {
+  "Objects FIFOs",
+  oslib_test_sequence_013_array
+};
+
+#endif /* CH_CFG_USE_OBJ_FIFOS == TRUE */
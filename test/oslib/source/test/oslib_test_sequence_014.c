@@ -0,0 +1,373 @@
+/*
+    ChibiOS - Copyright (C) 2006..2017 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "oslib_test_root.h"
+
+/**
+ * @file    oslib_test_sequence_014.c
+ * @brief   Test Sequence 014 code.
+ *
+ * @page oslib_test_sequence_014 [14] Software Timers
+ *
+ * File: @ref oslib_test_sequence_014.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS library functionalities related to
+ * the software timers service.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_CFG_USE_SWTIMERS == TRUE) && (CH_CFG_USE_WAITEXIT == TRUE)
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage oslib_test_014_001
+ * - @subpage oslib_test_014_002
+ * - @subpage oslib_test_014_003
+ * .
+ */
+
+#if ((CH_CFG_USE_SWTIMERS == TRUE) && (CH_CFG_USE_WAITEXIT == TRUE)) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define SWT_TIMERS      16U
+#define SWT_RESOLUTION  TIME_MS2I(2)
+
+static swtimers_service_t swts;
+static swtimer_t swt[SWT_TIMERS];
+static swtimer_t swt_periodic;
+static swtimer_t swt_stop;
+static unsigned swt_fired[SWT_TIMERS];
+static systime_t swt_time[SWT_TIMERS];
+static unsigned swt_periodic_cnt;
+static bool swt_exit;
+static thread_t *swt_tp;
+static THD_WORKING_AREA(waSwtService, 256);
+
+static void swt_oneshot_cb(void *p) {
+  unsigned i = (unsigned)((swtimer_t *)p - &swt[0]);
+
+  swt_fired[i]++;
+  swt_time[i] = chVTGetSystemTime();
+}
+
+static void swt_periodic_cb(void *p) {
+
+  (void)p;
+
+  swt_periodic_cnt++;
+}
+
+static void swt_stop_cb(void *p) {
+
+  (void)p;
+
+  swt_exit = true;
+}
+
+static THD_FUNCTION(SwtService, arg) {
+
+  (void)arg;
+
+  while (!swt_exit) {
+    (void) chSwtDispatch(&swts);
+  }
+}
+
+static void swt_service_start(void) {
+  unsigned i;
+  thread_descriptor_t td = {
+    .name  = "swtimers",
+    .wbase = waSwtService,
+    .wend  = THD_WORKING_AREA_END(waSwtService),
+    .prio  = chThdGetPriorityX() + 1,
+    .funcp = SwtService,
+    .arg   = NULL
+  };
+
+  chSwtServiceObjectInit(&swts, SWT_RESOLUTION);
+  for (i = 0U; i < SWT_TIMERS; i++) {
+    chSwtObjectInit(&swt[i]);
+    swt_fired[i] = 0U;
+  }
+  chSwtObjectInit(&swt_periodic);
+  chSwtObjectInit(&swt_stop);
+  swt_periodic_cnt = 0U;
+  swt_exit = false;
+  swt_tp = chThdCreate(&td);
+}
+
+/* Terminates the service thread using a timer, the timers left armed by
+   a failed test are not invoked anymore.*/
+static void swt_service_stop(void) {
+
+  chSwtSet(&swts, &swt_stop, SWT_RESOLUTION, 0, swt_stop_cb, NULL);
+  (void) chThdWait(swt_tp);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page oslib_test_014_001 [14.1] One-shot timers
+ *
+ * <h2>Description</h2>
+ * A set of one-shot timers is armed with increasing delays then half
+ * of them are stopped, the remaining timers must expire once and not
+ * before their delay, stopped timers must not expire.
+ *
+ * <h2>Test Steps</h2>
+ * - [14.1.1] Arming the timers then stopping half of them, the armed
+ *   timers are counted.
+ * - [14.1.2] Waiting for all the timers to expire, stopped timers must
+ *   not have been invoked, the others must have been invoked once and
+ *   not before their delay.
+ * .
+ */
+
+static void oslib_test_014_001_setup(void) {
+  swt_service_start();
+}
+
+static void oslib_test_014_001_teardown(void) {
+  swt_service_stop();
+}
+
+static void oslib_test_014_001_execute(void) {
+  systime_t start;
+
+  /* [14.1.1] Arming the timers then stopping half of them, the armed
+     timers are counted.*/
+  test_set_step(1);
+  {
+    unsigned i;
+
+    start = chVTGetSystemTime();
+    for (i = 0U; i < SWT_TIMERS; i++) {
+      chSwtSet(&swts, &swt[i], (sysinterval_t)(i + 1U) * SWT_RESOLUTION, 0,
+               swt_oneshot_cb, (void *)&swt[i]);
+    }
+    for (i = 1U; i < SWT_TIMERS; i += 2U) {
+      chSwtReset(&swts, &swt[i]);
+    }
+    test_assert_lock(chSwtGetArmedI(&swts) == SWT_TIMERS / 2U,
+                     "wrong armed count");
+    test_assert_lock(!chSwtIsArmedI(&swt[1]), "still armed");
+  }
+  test_end_step(1);
+
+  /* [14.1.2] Waiting for all the timers to expire, stopped timers must
+     not have been invoked, the others must have been invoked once and
+     not before their delay.*/
+  test_set_step(2);
+  {
+    unsigned i;
+
+    chThdSleep((sysinterval_t)(SWT_TIMERS + 2U) * SWT_RESOLUTION);
+    for (i = 0U; i < SWT_TIMERS; i++) {
+      if ((i & 1U) != 0U) {
+        test_assert(swt_fired[i] == 0U, "stopped timer invoked");
+      }
+      else {
+        test_assert(swt_fired[i] == 1U, "timer not invoked once");
+        test_assert(chTimeDiffX(start, swt_time[i]) >=
+                    (sysinterval_t)(i + 1U) * SWT_RESOLUTION,
+                    "timer expired early");
+      }
+    }
+    test_assert_lock(chSwtGetArmedI(&swts) == 0U, "timers still armed");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t oslib_test_014_001 = {
+  "One-shot timers",
+  oslib_test_014_001_setup,
+  oslib_test_014_001_teardown,
+  oslib_test_014_001_execute
+};
+
+/**
+ * @page oslib_test_014_002 [14.2] Periodic timers
+ *
+ * <h2>Description</h2>
+ * A periodic timer is armed, it must expire repeatedly until stopped
+ * and must not expire after being stopped.
+ *
+ * <h2>Test Steps</h2>
+ * - [14.2.1] Arming the periodic timer and waiting, it must have been
+ *   invoked repeatedly.
+ * - [14.2.2] Stopping the periodic timer and waiting, it must not have
+ *   been invoked anymore.
+ * .
+ */
+
+static void oslib_test_014_002_setup(void) {
+  swt_service_start();
+}
+
+static void oslib_test_014_002_teardown(void) {
+  swt_service_stop();
+}
+
+static void oslib_test_014_002_execute(void) {
+
+  /* [14.2.1] Arming the periodic timer and waiting, it must have been
+     invoked repeatedly.*/
+  test_set_step(1);
+  {
+    chSwtSet(&swts, &swt_periodic, SWT_RESOLUTION, SWT_RESOLUTION,
+             swt_periodic_cb, NULL);
+    chThdSleep((sysinterval_t)(SWT_TIMERS + 2U) * SWT_RESOLUTION);
+    test_assert(swt_periodic_cnt >= SWT_TIMERS, "periodic timer not invoked");
+  }
+  test_end_step(1);
+
+  /* [14.2.2] Stopping the periodic timer and waiting, it must not have
+     been invoked anymore.*/
+  test_set_step(2);
+  {
+    unsigned n;
+
+    chSwtReset(&swts, &swt_periodic);
+    n = swt_periodic_cnt;
+    chThdSleep(4U * SWT_RESOLUTION);
+    test_assert(swt_periodic_cnt == n, "stopped timer invoked");
+    test_assert_lock(chSwtGetArmedI(&swts) == 0U, "timers still armed");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t oslib_test_014_002 = {
+  "Periodic timers",
+  oslib_test_014_002_setup,
+  oslib_test_014_002_teardown,
+  oslib_test_014_002_execute
+};
+
+/**
+ * @page oslib_test_014_003 [14.3] Timers restart
+ *
+ * <h2>Description</h2>
+ * An armed timer is restarted before its expiration, the previous
+ * expiration must be cancelled and the timer must expire once after
+ * the new delay.
+ *
+ * <h2>Test Steps</h2>
+ * - [14.3.1] Arming a timer then restarting it half way, the armed
+ *   timers count must not change.
+ * - [14.3.2] Restarting the only armed timer in the middle of a wheel
+ *   tick, the wheel must keep its phase and the timer must expire on a
+ *   wheel tick boundary.
+ * .
+ */
+
+static void oslib_test_014_003_setup(void) {
+  swt_service_start();
+}
+
+static void oslib_test_014_003_teardown(void) {
+  swt_service_stop();
+}
+
+static void oslib_test_014_003_execute(void) {
+
+  /* [14.3.1] Arming a timer then restarting it half way, the armed
+     timers count must not change.*/
+  test_set_step(1);
+  {
+    systime_t start;
+
+    chSwtSet(&swts, &swt[0], 4U * SWT_RESOLUTION, 0,
+             swt_oneshot_cb, (void *)&swt[0]);
+    chThdSleep(2U * SWT_RESOLUTION);
+    start = chVTGetSystemTime();
+    chSwtSet(&swts, &swt[0], 4U * SWT_RESOLUTION, 0,
+             swt_oneshot_cb, (void *)&swt[0]);
+    test_assert_lock(chSwtGetArmedI(&swts) == 1U, "wrong armed count");
+    chThdSleep(8U * SWT_RESOLUTION);
+    test_assert(swt_fired[0] == 1U, "timer not invoked once");
+    test_assert(chTimeDiffX(start, swt_time[0]) >= 4U * SWT_RESOLUTION,
+                "timer expired early");
+  }
+  test_end_step(1);
+
+  /* [14.3.2] Restarting the only armed timer in the middle of a wheel
+     tick, the wheel must keep its phase and the timer must expire on a
+     wheel tick boundary.*/
+  test_set_step(2);
+  {
+    systime_t base, start;
+
+    chSysLock();
+    base = chVTGetSystemTimeX();
+    chSwtSetI(&swts, &swt[1], 4U * SWT_RESOLUTION, 0,
+              swt_oneshot_cb, (void *)&swt[1]);
+    chSchRescheduleS();
+    chSysUnlock();
+    chThdSleep(SWT_RESOLUTION + (SWT_RESOLUTION / 2U));
+    chSysLock();
+    start = chVTGetSystemTimeX();
+    chSwtSetI(&swts, &swt[1], SWT_RESOLUTION, 0,
+              swt_oneshot_cb, (void *)&swt[1]);
+    chSchRescheduleS();
+    chSysUnlock();
+    chThdSleep(4U * SWT_RESOLUTION);
+    test_assert(swt_fired[1] == 1U, "timer not invoked once");
+    test_assert(chTimeDiffX(start, swt_time[1]) >= SWT_RESOLUTION,
+                "timer expired early");
+    test_assert((chTimeDiffX(base, swt_time[1]) % SWT_RESOLUTION) == 0U,
+                "wheel tick lost");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t oslib_test_014_003 = {
+  "Timers restart",
+  oslib_test_014_003_setup,
+  oslib_test_014_003_teardown,
+  oslib_test_014_003_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const oslib_test_sequence_014_array[] = {
+  &oslib_test_014_001,
+  &oslib_test_014_002,
+  &oslib_test_014_003,
+  NULL
+};
+
+/**
+ * @brief   Software Timers.
+ */
+const testsequence_t oslib_test_sequence_014 = {
+  "Software Timers",
+  oslib_test_sequence_014_array
+};
+
+#endif /* (CH_CFG_USE_SWTIMERS == TRUE) && (CH_CFG_USE_WAITEXIT == TRUE) */
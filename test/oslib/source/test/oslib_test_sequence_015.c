@@ -0,0 +1,722 @@
+/*
+    ChibiOS - Copyright (C) 2006..2017 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "oslib_test_root.h"
+
+/**
+ * @file    oslib_test_sequence_015.c
+ * @brief   Test Sequence 015 code.
+ *
+ * @page oslib_test_sequence_015 [15] Benchmarks
+ *
+ * File: @ref oslib_test_sequence_015.c
+ *
+ * <h2>Description</h2>
+ * This module implements a series of OS library benchmarks. The
+ * benchmarks are useful as a stress test and as a reference when
+ * comparing different configurations of the library modules. The
+ * performance numbers allow to discover performance regressions
+ * between successive releases.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage oslib_test_015_001
+ * - @subpage oslib_test_015_002
+ * - @subpage oslib_test_015_003
+ * - @subpage oslib_test_015_004
+ * - @subpage oslib_test_015_005
+ * - @subpage oslib_test_015_006
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+static systime_t bmk_wait_tick(void) {
+
+  chThdSleep(1);
+  return chVTGetSystemTime();
+}
+
+static void bmk_print_score(uint32_t n, const char *unitp) {
+
+  test_print("--- Score : ");
+  test_printn(n);
+  test_println(unitp);
+}
+
+#if (CH_CFG_USE_FACTORY == TRUE) && (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE)
+#define BMK_FACTORY_OBJECTS     64
+
+static registered_object_t *bmk_rops[BMK_FACTORY_OBJECTS];
+static char bmk_names[BMK_FACTORY_OBJECTS][8];
+
+static void bmk_factory_names(void) {
+  static const char hex[] = "0123456789abcdef";
+  unsigned i;
+
+  for (i = 0U; i < BMK_FACTORY_OBJECTS; i++) {
+    bmk_names[i][0] = 'b';
+    bmk_names[i][1] = 'm';
+    bmk_names[i][2] = 'k';
+    bmk_names[i][3] = hex[(i >> 4) & 15U];
+    bmk_names[i][4] = hex[i & 15U];
+    bmk_names[i][5] = '\0';
+  }
+}
+#endif
+
+static THD_WORKING_AREA(bmk_wa, 256);
+
+#if CH_CFG_USE_MAILBOXES == TRUE
+#define BMK_MB_SIZE             16
+#define BMK_MB_BATCH            8
+
+static msg_t bmk_mb_buffer[BMK_MB_SIZE];
+static mailbox_t bmk_mb;
+
+static THD_FUNCTION(bmk_mb_consumer, arg) {
+  msg_t msg;
+
+  (void)arg;
+
+  while (chMBFetchTimeout(&bmk_mb, &msg, TIME_INFINITE) == MSG_OK) {
+  }
+}
+
+static THD_FUNCTION(bmk_mb_batch_consumer, arg) {
+  msg_t msgs[BMK_MB_BATCH];
+
+  (void)arg;
+
+  while (chMBFetchNTimeout(&bmk_mb, msgs, BMK_MB_BATCH, TIME_INFINITE) > 0U) {
+  }
+}
+#endif
+
+#if (CH_CFG_USE_JOBS == TRUE) && (CH_CFG_USE_WAITEXIT == TRUE)
+#define BMK_EXEC_JOBS           16
+#define BMK_EXEC_WORKERS        2
+
+static jobs_executor_t bmk_je;
+static exec_job_t bmk_exec_jobs[BMK_EXEC_JOBS];
+static JOBS_EXEC_WORKING_AREA(bmk_exec_wa, BMK_EXEC_WORKERS, 256);
+static uint32_t bmk_exec_count;
+
+static void bmk_exec_job(void *arg) {
+
+  (void)arg;
+
+  chSysLock();
+  bmk_exec_count++;
+  chSysUnlock();
+}
+#endif
+
+#define BMK_STREAM_BATCH        8
+
+static volatile bool bmk_stop;
+
+#if CH_CFG_USE_RINGS == TRUE
+static msg_t bmk_ring_buffer[BMK_STREAM_BATCH * 2];
+static spsc_ring_t bmk_ring;
+
+static THD_FUNCTION(bmk_ring_consumer, arg) {
+  msg_t msgs[BMK_STREAM_BATCH];
+
+  (void)arg;
+
+  while (!bmk_stop) {
+    (void) chRingWaitTimeout(&bmk_ring, BMK_STREAM_BATCH, TIME_MS2I(10));
+    (void) chRingReadX(&bmk_ring, msgs, BMK_STREAM_BATCH);
+  }
+}
+#endif
+
+#if CH_CFG_USE_PIPES == TRUE
+static uint8_t bmk_pipe_buffer[sizeof (msg_t) * BMK_STREAM_BATCH * 2];
+static pipe_t bmk_pipe;
+
+static THD_FUNCTION(bmk_pipe_consumer, arg) {
+  msg_t msgs[BMK_STREAM_BATCH];
+
+  (void)arg;
+
+  while (chPipeReadTimeout(&bmk_pipe, (uint8_t *)msgs, sizeof msgs,
+                           TIME_INFINITE) > 0U) {
+  }
+}
+#endif
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if ((CH_CFG_USE_FACTORY == TRUE) && (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE)) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_015_001 [15.1] Objects Factory performance
+ *
+ * <h2>Description</h2>
+ * A set of objects is registered in the factory then the number of
+ * find and release operations performed in one second is measured and
+ * printed on the output log.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_CFG_USE_FACTORY == TRUE) && (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [15.1.1] Registering the objects, all registrations must succeed.
+ * - [15.1.2] The number of find and release operations is counted in a
+ *   one second time window.
+ * - [15.1.3] Score is printed.
+ * .
+ */
+
+static void oslib_test_015_001_teardown(void) {
+  unsigned i;
+
+  for (i = 0U; i < BMK_FACTORY_OBJECTS; i++) {
+    if (bmk_rops[i] != NULL) {
+      chFactoryReleaseObject(bmk_rops[i]);
+      bmk_rops[i] = NULL;
+    }
+  }
+}
+
+static void oslib_test_015_001_execute(void) {
+  uint32_t n;
+
+  /* [15.1.1] Registering the objects, all registrations must
+     succeed.*/
+  test_set_step(1);
+  {
+    unsigned i;
+
+    bmk_factory_names();
+    for (i = 0U; i < BMK_FACTORY_OBJECTS; i++) {
+      bmk_rops[i] = chFactoryRegisterObject(bmk_names[i], (void *)&bmk_rops[i]);
+      test_assert(bmk_rops[i] != NULL, "cannot register");
+    }
+  }
+  test_end_step(1);
+
+  /* [15.1.2] The number of find and release operations is counted in a
+     one second time window.*/
+  test_set_step(2);
+  {
+    systime_t start, end;
+
+    n = 0;
+    start = bmk_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      registered_object_t *rop;
+
+      rop = chFactoryFindObject(bmk_names[n & (BMK_FACTORY_OBJECTS - 1)]);
+      chFactoryReleaseObject(rop);
+      n++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+  }
+  test_end_step(2);
+
+  /* [15.1.3] Score is printed.*/
+  test_set_step(3);
+  {
+    bmk_print_score(n, " lookups/S");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t oslib_test_015_001 = {
+  "Objects Factory performance",
+  NULL,
+  oslib_test_015_001_teardown,
+  oslib_test_015_001_execute
+};
+#endif /* (CH_CFG_USE_FACTORY == TRUE) && (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE) */
+
+#if (CH_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_015_002 [15.2] Mailboxes single messages performance
+ *
+ * <h2>Description</h2>
+ * A consumer thread with higher priority fetches messages one at time
+ * while the test thread posts them one at time, the number of messages
+ * transferred in one second is measured and printed on the output log.
+ * Each message causes a context switch.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_MAILBOXES == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [15.2.1] Starting the consumer thread.
+ * - [15.2.2] The number of posted messages is counted in a one second
+ *   time window.
+ * - [15.2.3] Stopping the consumer thread and printing the score.
+ * .
+ */
+
+static void oslib_test_015_002_setup(void) {
+  chMBObjectInit(&bmk_mb, bmk_mb_buffer, BMK_MB_SIZE);
+}
+
+static void oslib_test_015_002_execute(void) {
+  thread_t *tp;
+  uint32_t n;
+
+  /* [15.2.1] Starting the consumer thread.*/
+  test_set_step(1);
+  {
+    thread_descriptor_t td = {
+      .name  = "consumer",
+      .wbase = bmk_wa,
+      .wend  = THD_WORKING_AREA_END(bmk_wa),
+      .prio  = chThdGetPriorityX() + 1,
+      .funcp = bmk_mb_consumer,
+      .arg   = NULL
+    };
+    tp = chThdCreate(&td);
+  }
+  test_end_step(1);
+
+  /* [15.2.2] The number of posted messages is counted in a one second
+     time window.*/
+  test_set_step(2);
+  {
+    systime_t start, end;
+
+    n = 0;
+    start = bmk_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      (void) chMBPostTimeout(&bmk_mb, (msg_t)n, TIME_INFINITE);
+      n++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+  }
+  test_end_step(2);
+
+  /* [15.2.3] Stopping the consumer thread and printing the score.*/
+  test_set_step(3);
+  {
+    chMBReset(&bmk_mb);
+    (void) chThdWait(tp);
+    bmk_print_score(n, " msgs/S");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t oslib_test_015_002 = {
+  "Mailboxes single messages performance",
+  oslib_test_015_002_setup,
+  NULL,
+  oslib_test_015_002_execute
+};
+#endif /* CH_CFG_USE_MAILBOXES == TRUE */
+
+#if (CH_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_015_003 [15.3] Mailboxes batched messages performance
+ *
+ * <h2>Description</h2>
+ * A consumer thread with higher priority fetches messages in batches
+ * using a watermark while the test thread posts them in batches, the
+ * number of messages transferred in one second is measured and printed
+ * on the output log.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_MAILBOXES == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [15.3.1] Starting the consumer thread.
+ * - [15.3.2] The number of posted messages is counted in a one second
+ *   time window.
+ * - [15.3.3] Stopping the consumer thread and printing the score.
+ * .
+ */
+
+static void oslib_test_015_003_setup(void) {
+  chMBObjectInit(&bmk_mb, bmk_mb_buffer, BMK_MB_SIZE);
+  chMBSetWatermark(&bmk_mb, BMK_MB_BATCH);
+}
+
+static void oslib_test_015_003_execute(void) {
+  thread_t *tp;
+  uint32_t n;
+
+  /* [15.3.1] Starting the consumer thread.*/
+  test_set_step(1);
+  {
+    thread_descriptor_t td = {
+      .name  = "consumer",
+      .wbase = bmk_wa,
+      .wend  = THD_WORKING_AREA_END(bmk_wa),
+      .prio  = chThdGetPriorityX() + 1,
+      .funcp = bmk_mb_batch_consumer,
+      .arg   = NULL
+    };
+    tp = chThdCreate(&td);
+  }
+  test_end_step(1);
+
+  /* [15.3.2] The number of posted messages is counted in a one second
+     time window.*/
+  test_set_step(2);
+  {
+    systime_t start, end;
+    msg_t msgs[BMK_MB_BATCH] = {0};
+
+    n = 0;
+    start = bmk_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      n += (uint32_t)chMBPostNTimeout(&bmk_mb, msgs, BMK_MB_BATCH, TIME_INFINITE);
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+  }
+  test_end_step(2);
+
+  /* [15.3.3] Stopping the consumer thread and printing the score.*/
+  test_set_step(3);
+  {
+    chMBReset(&bmk_mb);
+    (void) chThdWait(tp);
+    bmk_print_score(n, " msgs/S");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t oslib_test_015_003 = {
+  "Mailboxes batched messages performance",
+  oslib_test_015_003_setup,
+  NULL,
+  oslib_test_015_003_execute
+};
+#endif /* CH_CFG_USE_MAILBOXES == TRUE */
+
+#if ((CH_CFG_USE_JOBS == TRUE) && (CH_CFG_USE_WAITEXIT == TRUE)) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_015_004 [15.4] Jobs Executor performance
+ *
+ * <h2>Description</h2>
+ * A jobs executor with two workers is fed with jobs for one second,
+ * the number of executed jobs is measured and printed on the output
+ * log.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_CFG_USE_JOBS == TRUE) && (CH_CFG_USE_WAITEXIT == TRUE)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [15.4.1] Starting the worker threads.
+ * - [15.4.2] Jobs are posted continuously in a one second time window
+ *   then the executor is shut down.
+ * - [15.4.3] Score is printed.
+ * .
+ */
+
+static void oslib_test_015_004_setup(void) {
+  chJobExecObjectInit(&bmk_je, BMK_EXEC_JOBS, bmk_exec_jobs);
+  bmk_exec_count = 0U;
+}
+
+static void oslib_test_015_004_execute(void) {
+
+  /* [15.4.1] Starting the worker threads.*/
+  test_set_step(1);
+  {
+    chJobExecStart(&bmk_je, bmk_exec_wa, BMK_EXEC_WORKERS, 256,
+                   chThdGetPriorityX() - 1);
+  }
+  test_end_step(1);
+
+  /* [15.4.2] Jobs are posted continuously in a one second time window
+     then the executor is shut down.*/
+  test_set_step(2);
+  {
+    systime_t start, end;
+
+    start = bmk_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      exec_job_t *jp;
+
+      jp = chJobExecGet(&bmk_je);
+      jp->jobfunc = bmk_exec_job;
+      jp->jobarg  = NULL;
+      chJobExecPost(&bmk_je, jp, 0U);
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+    chJobExecShutdown(&bmk_je);
+  }
+  test_end_step(2);
+
+  /* [15.4.3] Score is printed.*/
+  test_set_step(3);
+  {
+    bmk_print_score(bmk_exec_count, " jobs/S");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t oslib_test_015_004 = {
+  "Jobs Executor performance",
+  oslib_test_015_004_setup,
+  NULL,
+  oslib_test_015_004_execute
+};
+#endif /* (CH_CFG_USE_JOBS == TRUE) && (CH_CFG_USE_WAITEXIT == TRUE) */
+
+#if (CH_CFG_USE_RINGS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_015_005 [15.5] SPSC ring performance
+ *
+ * <h2>Description</h2>
+ * A producer writes batches of messages into a SPSC ring while a
+ * consumer thread waits for batches of messages, the number of
+ * messages transferred in one second is measured and printed on the
+ * output log.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_RINGS == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [15.5.1] Starting the consumer thread.
+ * - [15.5.2] Messages are written in a one second time window.
+ * - [15.5.3] Stopping the consumer thread.
+ * - [15.5.4] Score is printed.
+ * .
+ */
+
+static void oslib_test_015_005_setup(void) {
+  chRingObjectInit(&bmk_ring, bmk_ring_buffer, sizeof (msg_t),
+                   BMK_STREAM_BATCH * 2);
+  bmk_stop = false;
+}
+
+static void oslib_test_015_005_execute(void) {
+  thread_t *tp;
+  uint32_t n;
+
+  /* [15.5.1] Starting the consumer thread.*/
+  test_set_step(1);
+  {
+    thread_descriptor_t td = {
+      .name  = "consumer",
+      .wbase = bmk_wa,
+      .wend  = THD_WORKING_AREA_END(bmk_wa),
+      .prio  = chThdGetPriorityX() + 1,
+      .funcp = bmk_ring_consumer,
+      .arg   = NULL
+    };
+    tp = chThdCreate(&td);
+  }
+  test_end_step(1);
+
+  /* [15.5.2] Messages are written in a one second time window.*/
+  test_set_step(2);
+  {
+    systime_t start, end;
+
+    n = 0;
+    start = bmk_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      msg_t msgs[BMK_STREAM_BATCH] = {0};
+
+      n += (uint32_t)chRingWriteX(&bmk_ring, msgs, BMK_STREAM_BATCH);
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+  }
+  test_end_step(2);
+
+  /* [15.5.3] Stopping the consumer thread.*/
+  test_set_step(3);
+  {
+    bmk_stop = true;
+    (void) chThdWait(tp);
+  }
+  test_end_step(3);
+
+  /* [15.5.4] Score is printed.*/
+  test_set_step(4);
+  {
+    bmk_print_score(n, " msgs/S");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t oslib_test_015_005 = {
+  "SPSC ring performance",
+  oslib_test_015_005_setup,
+  NULL,
+  oslib_test_015_005_execute
+};
+#endif /* CH_CFG_USE_RINGS == TRUE */
+
+#if (CH_CFG_USE_PIPES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_015_006 [15.6] Pipes performance
+ *
+ * <h2>Description</h2>
+ * A producer writes batches of messages into a pipe while a consumer
+ * thread reads batches of messages, the number of messages transferred
+ * in one second is measured and printed on the output log.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_PIPES == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [15.6.1] Starting the consumer thread.
+ * - [15.6.2] Messages are written in a one second time window.
+ * - [15.6.3] Stopping the consumer thread.
+ * - [15.6.4] Score is printed.
+ * .
+ */
+
+static void oslib_test_015_006_setup(void) {
+  chPipeObjectInit(&bmk_pipe, bmk_pipe_buffer, sizeof bmk_pipe_buffer);
+}
+
+static void oslib_test_015_006_execute(void) {
+  thread_t *tp;
+  uint32_t n;
+
+  /* [15.6.1] Starting the consumer thread.*/
+  test_set_step(1);
+  {
+    thread_descriptor_t td = {
+      .name  = "consumer",
+      .wbase = bmk_wa,
+      .wend  = THD_WORKING_AREA_END(bmk_wa),
+      .prio  = chThdGetPriorityX() + 1,
+      .funcp = bmk_pipe_consumer,
+      .arg   = NULL
+    };
+    tp = chThdCreate(&td);
+  }
+  test_end_step(1);
+
+  /* [15.6.2] Messages are written in a one second time window.*/
+  test_set_step(2);
+  {
+    systime_t start, end;
+
+    n = 0;
+    start = bmk_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      msg_t msgs[BMK_STREAM_BATCH] = {0};
+
+      (void) chPipeWriteTimeout(&bmk_pipe, (const uint8_t *)msgs, sizeof msgs,
+                                TIME_INFINITE);
+      n += BMK_STREAM_BATCH;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+  }
+  test_end_step(2);
+
+  /* [15.6.3] Stopping the consumer thread.*/
+  test_set_step(3);
+  {
+    chPipeReset(&bmk_pipe);
+    (void) chThdWait(tp);
+  }
+  test_end_step(3);
+
+  /* [15.6.4] Score is printed.*/
+  test_set_step(4);
+  {
+    bmk_print_score(n, " msgs/S");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t oslib_test_015_006 = {
+  "Pipes performance",
+  oslib_test_015_006_setup,
+  NULL,
+  oslib_test_015_006_execute
+};
+#endif /* CH_CFG_USE_PIPES == TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const oslib_test_sequence_015_array[] = {
+#if ((CH_CFG_USE_FACTORY == TRUE) && (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE)) || defined(__DOXYGEN__)
+  &oslib_test_015_001,
+#endif
+#if (CH_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_015_002,
+#endif
+#if (CH_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_015_003,
+#endif
+#if ((CH_CFG_USE_JOBS == TRUE) && (CH_CFG_USE_WAITEXIT == TRUE)) || defined(__DOXYGEN__)
+  &oslib_test_015_004,
+#endif
+#if (CH_CFG_USE_RINGS == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_015_005,
+#endif
+#if (CH_CFG_USE_PIPES == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_015_006,
+#endif
+  NULL
+};
+
+/**
+ * @brief   Benchmarks.
+ */
+const testsequence_t oslib_test_sequence_015 = {
+  "Benchmarks",
+  oslib_test_sequence_015_array
+};